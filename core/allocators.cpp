@@ -0,0 +1,114 @@
+#include <fuse/core/allocators.hpp>
+
+#include <algorithm>
+
+using namespace fuse;
+
+/* Frame arena */
+
+frame_arena::frame_arena(size_t blockSize) :
+	m_block(nullptr),
+	m_top(0),
+	m_end(0),
+	m_blockSize(blockSize),
+	m_capacity(0),
+	m_retiredSize(0) { }
+
+frame_arena::~frame_arena(void)
+{
+	free_blocks();
+}
+
+frame_arena & frame_arena::get_thread_arena(void)
+{
+	static thread_local frame_arena arena;
+	return arena;
+}
+
+void frame_arena::reset(void)
+{
+
+	size_t used = get_used_size();
+
+	// The frame did not fit in one block, the next ones get a block for all of it with some slack
+
+	if (m_block && m_block->previous)
+	{
+
+		free_blocks();
+
+		size_t size = std::max(m_blockSize, used + used / 8 + sizeof(block));
+
+		m_block = static_cast<block*>(tagged_aligned_malloc(size, alignof(std::max_align_t), FUSE_MEMORY_TAG_FRAME));
+
+		if (!m_block)
+		{
+			throw std::bad_alloc();
+		}
+
+		m_block->previous = nullptr;
+		m_block->size     = size;
+
+		m_end       = reinterpret_cast<uintptr_t>(m_block) + size;
+		m_capacity += size - sizeof(block);
+
+	}
+
+	m_top         = m_block ? reinterpret_cast<uintptr_t>(m_block + 1) : 0;
+	m_retiredSize = 0;
+
+}
+
+size_t frame_arena::get_used_size(void) const
+{
+	return m_retiredSize + (m_block ? m_top - reinterpret_cast<uintptr_t>(m_block + 1) : 0);
+}
+
+void * frame_arena::allocate_block(size_t size, size_t alignment)
+{
+
+	// The full block stays in the chain until the reset, the new one is at least twice as big
+
+	size_t blockSize = std::max(m_blockSize, size + alignment + sizeof(block));
+
+	if (m_block)
+	{
+		blockSize      = std::max(blockSize, 2 * m_block->size);
+		m_retiredSize += m_top - reinterpret_cast<uintptr_t>(m_block + 1);
+	}
+
+	block * b = static_cast<block*>(tagged_aligned_malloc(blockSize, alignof(std::max_align_t), FUSE_MEMORY_TAG_FRAME));
+
+	if (!b)
+	{
+		throw std::bad_alloc();
+	}
+
+	b->previous = m_block;
+	b->size     = blockSize;
+
+	m_block     = b;
+	m_top       = reinterpret_cast<uintptr_t>(b + 1);
+	m_end       = reinterpret_cast<uintptr_t>(b) + blockSize;
+	m_capacity += blockSize - sizeof(block);
+
+	return allocate(size, alignment);
+
+}
+
+void frame_arena::free_blocks(void)
+{
+
+	while (m_block)
+	{
+		block * previous = m_block->previous;
+		tagged_aligned_free(m_block);
+		m_block = previous;
+	}
+
+	m_top         = 0;
+	m_end         = 0;
+	m_capacity    = 0;
+	m_retiredSize = 0;
+
+}
\ No newline at end of file
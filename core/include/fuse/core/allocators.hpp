@@ -1,12 +1,71 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef _MSC_VER
 #include <malloc.h>
+#endif
+
+#include "memory_tracker.hpp"
 
 namespace fuse
 {
 
+	inline void * aligned_malloc(size_t size, size_t alignment)
+	{
+#ifdef _MSC_VER
+		return _aligned_malloc(size, alignment);
+#else
+		void * p;
+		return posix_memalign(&p, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) == 0 ? p : nullptr;
+#endif
+	}
+
+	inline void aligned_free(void * p)
+	{
+#ifdef _MSC_VER
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+
+	// aligned_malloc and aligned_free going through the memory_tracker when FUSE_MEMORY_TRACKING
+	// is defined, the memory allocated by one pair must be freed by the same pair
+
+#ifdef FUSE_MEMORY_TRACKING
+
+	inline void * tagged_aligned_malloc(size_t size, size_t alignment, memory_tag tag)
+	{
+		return memory_tracker::allocate(size, alignment, tag);
+	}
+
+#else
+
+	inline void * tagged_aligned_malloc(size_t size, size_t alignment, memory_tag)
+	{
+		return aligned_malloc(size, alignment);
+	}
+
+#endif
+
+	inline void tagged_aligned_free(void * p)
+	{
+#ifdef FUSE_MEMORY_TRACKING
+		memory_tracker::deallocate(p);
+#else
+		aligned_free(p);
+#endif
+	}
+
 	template <typename T>
 	struct allocator_base
 	{
@@ -22,7 +81,7 @@ namespace fuse
 		template <typename ... Args>
 		void construct(T * p, Args && ... args)
 		{
-			new (p) T(args ...);
+			new (p) T(std::forward<Args>(args) ...);
 		}
 
 		void destroy(T * p)
@@ -32,19 +91,22 @@ namespace fuse
 
 	};
 
-	template <typename T, size_t Alignment = std::alignment_of<T>::value>
+	template <typename T, size_t Alignment = std::alignment_of<T>::value, memory_tag Tag = FUSE_MEMORY_TAG_GENERAL>
 	struct aligned_allocator :
 		allocator_base<T>
 	{
 
-		template <class U> struct rebind { typedef aligned_allocator<U, Alignment> other; };
+		typedef typename allocator_base<T>::pointer   pointer;
+		typedef typename allocator_base<T>::size_type size_type;
+
+		template <class U> struct rebind { typedef aligned_allocator<U, Alignment, Tag> other; };
 
 		aligned_allocator(void) = default;
 		aligned_allocator(const aligned_allocator &) = default;
 		aligned_allocator(aligned_allocator &&) = default;
 
-		template <typename U>
-		aligned_allocator(const aligned_allocator<U> &) { }
+		template <typename U, size_t OtherAlignment>
+		aligned_allocator(const aligned_allocator<U, OtherAlignment, Tag> &) { }
 
 		inline void * allocate_generic(size_type n, const void * hint = 0)
 		{
@@ -65,9 +127,9 @@ namespace fuse
 			return static_cast<pointer>(allocate_generic(n, hint));
 		}
 
-		inline void * allocate_no_throw_generic(size_type n, const void * hint = 0)
+		inline void * allocate_no_throw_generic(size_type n, const void * = 0)
 		{
-			return _aligned_malloc(n * sizeof(T), Alignment);
+			return tagged_aligned_malloc(n * sizeof(T), Alignment, Tag);
 		}
 
 		inline pointer allocate_no_throw(size_type n, const void * hint = 0)
@@ -80,22 +142,526 @@ namespace fuse
 			deallocate_generic(static_cast<pointer>(p), n);
 		}
 
-		inline void deallocate_generic(void * p, size_type n)
+		inline void deallocate_generic(void * p, size_type)
 		{
-			_aligned_free(p);
+			tagged_aligned_free(p);
 		}
 
 		template<class U>
-		inline aligned_allocator<T, Alignment> & operator= (const aligned_allocator<U, Alignment> &)
+		inline aligned_allocator<T, Alignment, Tag> & operator= (const aligned_allocator<U, Alignment, Tag> &)
 		{
 			return (*this);
 		}
 
-		template <typename U, size_t OtherAlignment>
-		inline bool operator== (const aligned_allocator<U, OtherAlignment> &) { return OtherAlignment == Alignment; }
+		template <typename U, size_t OtherAlignment, memory_tag OtherTag>
+		inline bool operator== (const aligned_allocator<U, OtherAlignment, OtherTag> &) { return OtherAlignment == Alignment; }
 
-		template <typename U, size_t OtherAlignment>
-		inline bool operator!= (const aligned_allocator<U, OtherAlignment> &) { return OtherAlignment != Alignment; }
+		template <typename U, size_t OtherAlignment, memory_tag OtherTag>
+		inline bool operator!= (const aligned_allocator<U, OtherAlignment, OtherTag> &) { return OtherAlignment != Alignment; }
+
+	};
+
+	/* Frame arena */
+
+#define FUSE_FRAME_ARENA_BLOCK_SIZE (1 << 20)
+
+	/*
+	*
+	* Bump allocator for the data that only lives for a frame. Each thread has
+	* its own arena (get_thread_arena), reset by the thread at the end of the
+	* frame: the memory is never freed piece by piece. When a block is full a
+	* bigger one is chained, at reset the blocks are merged in a single one
+	* big enough for the whole frame, so after the first frames the arena does
+	* not go through malloc anymore.
+	*
+	* The containers using frame_allocator must not be used after the reset,
+	* the ones kept as members are assigned a new container every frame (an
+	* emptied container would keep writing in its old storage).
+	*
+	*/
+
+	class frame_arena
+	{
+
+	public:
+
+		frame_arena(size_t blockSize = FUSE_FRAME_ARENA_BLOCK_SIZE);
+		frame_arena(const frame_arena &) = delete;
+
+		~frame_arena(void);
+
+		frame_arena & operator= (const frame_arena &) = delete;
+
+		inline void * allocate(size_t size, size_t alignment)
+		{
+
+			uintptr_t p = (m_top + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+
+			if (p + size <= m_end && p >= m_top)
+			{
+				m_top = p + size;
+				return reinterpret_cast<void*>(p);
+			}
+
+			return allocate_block(size, alignment);
+
+		}
+
+		void reset(void);
+
+		// The bytes allocated since the last reset (the alignment padding included)
+
+		size_t get_used_size(void) const;
+
+		inline size_t get_capacity(void) const { return m_capacity; }
+
+		static frame_arena & get_thread_arena(void);
+
+	private:
+
+		struct block
+		{
+			block * previous;
+			size_t  size;
+		};
+
+		block   * m_block;
+		uintptr_t m_top;
+		uintptr_t m_end;
+
+		size_t m_blockSize;
+		size_t m_capacity;
+		size_t m_retiredSize;
+
+		void * allocate_block(size_t size, size_t alignment);
+		void   free_blocks(void);
+
+	};
+
+	template <typename T>
+	struct frame_allocator :
+		allocator_base<T>
+	{
+
+		typedef typename allocator_base<T>::pointer   pointer;
+		typedef typename allocator_base<T>::size_type size_type;
+
+		typedef std::true_type propagate_on_container_move_assignment;
+
+		template <class U> struct rebind { typedef frame_allocator<U> other; };
+
+		frame_allocator(void) : m_arena(&frame_arena::get_thread_arena()) { }
+		frame_allocator(frame_arena * arena) : m_arena(arena) { }
+		frame_allocator(const frame_allocator &) = default;
+
+		template <typename U>
+		frame_allocator(const frame_allocator<U> & allocator) : m_arena(allocator.get_arena()) { }
+
+		inline pointer allocate(size_type n, const void * = 0)
+		{
+			return static_cast<pointer>(m_arena->allocate(n * sizeof(T), std::alignment_of<T>::value));
+		}
+
+		inline void deallocate(pointer, size_type = 1) { }
+
+		inline frame_arena * get_arena(void) const { return m_arena; }
+
+		template <typename U>
+		inline bool operator== (const frame_allocator<U> & allocator) const { return m_arena == allocator.get_arena(); }
+
+		template <typename U>
+		inline bool operator!= (const frame_allocator<U> & allocator) const { return m_arena != allocator.get_arena(); }
+
+	private:
+
+		frame_arena * m_arena;
+
+	};
+
+	/* Slab allocator */
+
+#define FUSE_SLAB_ALLOCATOR_SLAB_SIZE     (64 << 10)
+#define FUSE_SLAB_ALLOCATOR_MAX_SLAB_SIZE (4 << 20)
+
+	/*
+	*
+	* Fixed size allocator for the objects of a single type (e.g. the nodes of
+	* the scene graph), plugged in through FUSE_DECLARE_ALLOCATOR_NEW. The
+	* slots are carved in order out of big slabs, so the objects created
+	* together end up next to each other, and the freed slots go in a free
+	* list to be reused. Each slab is twice as big as the previous one (up to
+	* FUSE_SLAB_ALLOCATOR_MAX_SLAB_SIZE), so a big import needs few of them.
+	*
+	* Once all the objects are gone the allocator can be rewound (reset), to
+	* carve the slabs in order again, or the slabs given back (release). A
+	* container tearing down all its objects can run their destructors in
+	* place and hand the slots back at once (discard) instead of deleting
+	* them one by one.
+	*
+	* The slots only fit objects of the type, a derived class needs its own
+	* allocator. The constructor is constexpr so the static allocators are
+	* ready before any dynamic initialization creates objects. The memory
+	* tracker accounts the slots in use to the tag, not the slabs.
+	*
+	*/
+
+	template <typename T, size_t Alignment = std::alignment_of<T>::value, memory_tag Tag = FUSE_MEMORY_TAG_GENERAL>
+	class slab_allocator
+	{
+
+	public:
+
+		typedef std::size_t size_type;
+
+		constexpr slab_allocator(void) :
+			m_firstSlab(nullptr),
+			m_currentSlab(nullptr),
+			m_freeList(nullptr),
+			m_top(nullptr),
+			m_end(nullptr),
+			m_used(0),
+			m_capacity(0) { }
+
+		slab_allocator(const slab_allocator &) = delete;
+
+		~slab_allocator(void)
+		{
+			release();
+		}
+
+		slab_allocator & operator= (const slab_allocator &) = delete;
+
+		inline void * allocate_generic(size_type n, const void * hint = 0)
+		{
+
+			void * p = allocate_no_throw_generic(n, hint);
+
+			if (!p)
+			{
+				throw std::bad_alloc();
+			}
+
+			return p;
+
+		}
+
+		inline void * allocate_no_throw_generic(size_type n, const void * = 0)
+		{
+
+			if (n > get_slot_size())
+			{
+				return nullptr;
+			}
+
+			lock();
+
+			void * p;
+
+			if (m_freeList)
+			{
+				p          = m_freeList;
+				m_freeList = m_freeList->next;
+			}
+			else if (m_top != m_end)
+			{
+				p      = m_top;
+				m_top += get_slot_size();
+			}
+			else
+			{
+				p = next_slab();
+			}
+
+			m_used += p != nullptr;
+
+			unlock();
+
+			if (p)
+			{
+				FUSE_MEMORY_TRACK_ALLOCATION(Tag, get_slot_size());
+			}
+
+			return p;
+
+		}
+
+		inline void deallocate_generic(void * p, size_type)
+		{
+
+			if (p)
+			{
+
+				lock();
+
+				free_slot * slot = static_cast<free_slot*>(p);
+
+				slot->next = m_freeList;
+				m_freeList = slot;
+
+				--m_used;
+
+				unlock();
+
+				FUSE_MEMORY_TRACK_DEALLOCATION(Tag, get_slot_size());
+
+			}
+
+		}
+
+		// Starts carving the slabs from the first one again if no object is left, returns false otherwise
+
+		bool reset(void)
+		{
+
+			lock();
+
+			bool empty = m_used == 0;
+
+			if (empty)
+			{
+				m_freeList    = nullptr;
+				m_currentSlab = m_firstSlab;
+
+				set_bump_range(m_currentSlab);
+			}
+
+			unlock();
+
+			return empty;
+
+		}
+
+	private:
+
+		struct free_slot;
+
+	public:
+
+		// The slots of objects whose destructor the caller ran in place, linked through the slots
+
+		class discard_list
+		{
+
+		public:
+
+			inline void push(void * p)
+			{
+				free_slot * slot = static_cast<free_slot*>(p);
+
+				slot->next = m_head;
+				m_head     = slot;
+				m_tail     = m_tail ? m_tail : slot;
+
+				++m_count;
+			}
+
+		private:
+
+			friend class slab_allocator;
+
+			free_slot * m_head  = nullptr;
+			free_slot * m_tail  = nullptr;
+			size_type   m_count = 0;
+
+		};
+
+		// Takes the discarded slots back. If they were all the objects left the slabs are rewound
+		// and true is returned, otherwise the slots go in the free list.
+
+		bool discard(const discard_list & slots)
+		{
+
+			lock();
+
+			bool empty = m_used == slots.m_count;
+
+			if (empty)
+			{
+				m_freeList    = nullptr;
+				m_currentSlab = m_firstSlab;
+
+				set_bump_range(m_currentSlab);
+			}
+			else if (slots.m_head)
+			{
+				slots.m_tail->next = m_freeList;
+				m_freeList         = slots.m_head;
+			}
+
+			m_used -= slots.m_count;
+
+			unlock();
+
+			for (size_type i = 0; i < slots.m_count; i++)
+			{
+				FUSE_MEMORY_TRACK_DEALLOCATION(Tag, get_slot_size());
+			}
+
+			return empty;
+
+		}
+
+		// True if p is a slot of one of the slabs, the objects of a derived type come from elsewhere
+
+		bool owns(const void * p)
+		{
+
+			lock();
+
+			const uint8_t * q = static_cast<const uint8_t*>(p);
+
+			slab * s = m_firstSlab;
+
+			while (s && !(q >= reinterpret_cast<uint8_t*>(s) + get_header_size() && q < reinterpret_cast<uint8_t*>(s) + get_header_size() + s->slots * get_slot_size()))
+			{
+				s = s->next;
+			}
+
+			unlock();
+
+			return s != nullptr;
+
+		}
+
+		// Frees all the slabs if no object is left, returns false otherwise
+
+		bool release(void)
+		{
+
+			lock();
+
+			bool empty = m_used == 0;
+
+			if (empty)
+			{
+
+				while (m_firstSlab)
+				{
+					slab * next = m_firstSlab->next;
+					aligned_free(m_firstSlab);
+					m_firstSlab = next;
+				}
+
+				m_currentSlab = nullptr;
+				m_freeList    = nullptr;
+				m_capacity    = 0;
+
+				set_bump_range(nullptr);
+
+			}
+
+			unlock();
+
+			return empty;
+
+		}
+
+		static constexpr size_type get_slot_size(void)
+		{
+			return ((sizeof(T) > sizeof(void*) ? sizeof(T) : sizeof(void*)) + Alignment - 1) & ~(Alignment - 1);
+		}
+
+		inline size_type get_used_slots(void) const { return m_used; }
+		inline size_type get_capacity(void) const { return m_capacity; }
+
+	private:
+
+		struct slab
+		{
+			slab    * next;
+			size_type slots;
+		};
+
+		struct free_slot
+		{
+			free_slot * next;
+		};
+
+		static constexpr size_type get_header_size(void)
+		{
+			return (sizeof(slab) + Alignment - 1) & ~(Alignment - 1);
+		}
+
+		static constexpr size_type get_slab_slots(size_type slabSize)
+		{
+			return get_header_size() + get_slot_size() < slabSize ?
+				(slabSize - get_header_size()) / get_slot_size() : 1;
+		}
+
+		slab      * m_firstSlab;
+		slab      * m_currentSlab;
+		free_slot * m_freeList;
+
+		uint8_t * m_top;
+		uint8_t * m_end;
+
+		size_type m_used;
+		size_type m_capacity;
+
+		std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+
+		inline void lock(void)
+		{
+			while (m_lock.test_and_set(std::memory_order_acquire));
+		}
+
+		inline void unlock(void)
+		{
+			m_lock.clear(std::memory_order_release);
+		}
+
+		inline void set_bump_range(slab * s)
+		{
+			m_top = s ? reinterpret_cast<uint8_t*>(s) + get_header_size() : nullptr;
+			m_end = s ? m_top + s->slots * get_slot_size() : nullptr;
+		}
+
+		// Moves the bump pointer to the next slab, chaining a new one after the last, and returns its first slot
+
+		void * next_slab(void)
+		{
+
+			if (!m_currentSlab || !m_currentSlab->next)
+			{
+
+				size_type slots = m_currentSlab ?
+					std::min(2 * m_currentSlab->slots, get_slab_slots(FUSE_SLAB_ALLOCATOR_MAX_SLAB_SIZE)) :
+					get_slab_slots(FUSE_SLAB_ALLOCATOR_SLAB_SIZE);
+
+				slab * s = static_cast<slab*>(aligned_malloc(get_header_size() + slots * get_slot_size(), Alignment > alignof(slab) ? Alignment : alignof(slab)));
+
+				if (!s)
+				{
+					return nullptr;
+				}
+
+				s->next  = nullptr;
+				s->slots = slots;
+
+				if (m_currentSlab)
+				{
+					m_currentSlab->next = s;
+				}
+				else
+				{
+					m_firstSlab = s;
+				}
+
+				m_capacity += slots;
+
+			}
+
+			m_currentSlab = m_currentSlab ? m_currentSlab->next : m_firstSlab;
+
+			set_bump_range(m_currentSlab);
+
+			void * p = m_top;
+
+			m_top += get_slot_size();
+
+			return p;
+
+		}
 
 	};
 
@@ -109,12 +675,27 @@ private:\
 public:\
 	inline void * operator new(size_t size) { return FUSE_ALLOCATOR_STATIC_MEMBER.allocate_generic(size); }\
 	inline void * operator new(size_t size, const std::nothrow_t &) { return FUSE_ALLOCATOR_STATIC_MEMBER.allocate_no_throw_generic(size); }\
-	inline void * operator new(size_t size, void * p){ return p; }\
+	inline void * operator new(size_t, void * p){ return p; }\
 	inline void operator delete(void * p) { FUSE_ALLOCATOR_STATIC_MEMBER.deallocate_generic(p, 1); }\
-	inline void operator delete(void * p, void * p2) { }
+	inline void operator delete(void *, void *) { }
 
 #define FUSE_DEFINE_ALLOCATOR_NEW(Class, Allocator) Allocator Class::FUSE_ALLOCATOR_STATIC_MEMBER;
 
 #define FUSE_ALIGNED_ALLOCATOR(Type, Alignment) fuse::aligned_allocator<Type, Alignment>
 #define FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(Alignment) FUSE_DECLARE_ALLOCATOR_NEW(FUSE_ALIGNED_ALLOCATOR(uint8_t, Alignment))
-#define FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(Class, Alignment) FUSE_DEFINE_ALLOCATOR_NEW(Class, FUSE_ALIGNED_ALLOCATOR(uint8_t, Alignment))
\ No newline at end of file
+#define FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(Class, Alignment) FUSE_DEFINE_ALLOCATOR_NEW(Class, FUSE_ALIGNED_ALLOCATOR(uint8_t, Alignment))
+
+#define FUSE_TAGGED_ALIGNED_ALLOCATOR(Type, Alignment, Tag) fuse::aligned_allocator<Type, Alignment, Tag>
+#define FUSE_DECLARE_TAGGED_ALIGNED_ALLOCATOR_NEW(Alignment, Tag) FUSE_DECLARE_ALLOCATOR_NEW(FUSE_TAGGED_ALIGNED_ALLOCATOR(uint8_t, Alignment, Tag))
+#define FUSE_DEFINE_TAGGED_ALIGNED_ALLOCATOR_NEW(Class, Alignment, Tag) FUSE_DEFINE_ALLOCATOR_NEW(Class, FUSE_TAGGED_ALIGNED_ALLOCATOR(uint8_t, Alignment, Tag))
+
+#define FUSE_SLAB_ALLOCATOR(Type, Alignment, Tag) fuse::slab_allocator<Type, Alignment, Tag>
+
+#define FUSE_DECLARE_SLAB_ALLOCATOR_NEW(Class, Alignment, Tag) FUSE_DECLARE_ALLOCATOR_NEW(FUSE_SLAB_ALLOCATOR(Class, Alignment, Tag))\
+	static inline bool reset_allocator_slabs(void) { return FUSE_ALLOCATOR_STATIC_MEMBER.reset(); }\
+	static inline bool release_allocator_slabs(void) { return FUSE_ALLOCATOR_STATIC_MEMBER.release(); }\
+	typedef FUSE_SLAB_ALLOCATOR(Class, Alignment, Tag)::discard_list allocator_discard_list;\
+	static inline bool discard_allocator_slots(const allocator_discard_list & slots) { return FUSE_ALLOCATOR_STATIC_MEMBER.discard(slots); }\
+	static inline bool allocator_owns(const void * p) { return FUSE_ALLOCATOR_STATIC_MEMBER.owns(p); }
+
+#define FUSE_DEFINE_SLAB_ALLOCATOR_NEW(Class, Alignment, Tag) FUSE_DEFINE_ALLOCATOR_NEW(Class, FUSE_SLAB_ALLOCATOR(Class, Alignment, Tag))
\ No newline at end of file
@@ -19,7 +19,7 @@ namespace fuse
 
 		inline void lock(void) const { m_lock.lock(); }
 		inline void unlock(void) const { m_lock.unlock(); }
-		inline bool try_lock(void) const { m_lock.try_lock(); }
+		inline bool try_lock(void) const { return m_lock.try_lock(); }
 
 	protected:
 
@@ -9,7 +9,12 @@
 
 #include <ostream>
 
+#ifdef _MSC_VER
 #define FUSE_LOG_LABEL               BOOST_PP_CAT(BOOST_PP_CAT(FUSE_LITERAL(__FUNCTION__), " @ "), BOOST_PP_CAT(BOOST_PP_CAT(__FILE__, ":"), BOOST_PP_CAT(, BOOST_PP_STRINGIZE(__LINE__))))
+#else
+// __FUNCTION__ is not a string literal on GCC and Clang
+#define FUSE_LOG_LABEL               FUSE_LITERAL(__FILE__ ":" BOOST_PP_STRINGIZE(__LINE__))
+#endif
 #define FUSE_LOG(Label, Message)     fuse::logger::get_singleton_reference().log(Label, Message);
 #define FUSE_LOG_OPT(Label, Message) { auto pLogger = fuse::logger::get_singleton_pointer(); if (pLogger) pLogger->log(Label, Message); }
 #define FUSE_LOG_DEBUG(Message)      FUSE_LOG(FUSE_LOG_LABEL, Message)
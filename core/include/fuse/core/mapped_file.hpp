@@ -0,0 +1,53 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fuse
+{
+
+	/*
+	*
+	* Read only file mapped in memory. The mapping is copy on write: the pages
+	* can be modified in memory without changing the file, and only the ones
+	* written get copied.
+	*
+	*/
+
+	class mapped_file
+	{
+
+	public:
+
+		mapped_file(void);
+		mapped_file(const mapped_file &) = delete;
+		mapped_file(mapped_file && file);
+
+		~mapped_file(void);
+
+		mapped_file & operator= (const mapped_file &) = delete;
+		mapped_file & operator= (mapped_file && file);
+
+		bool open(const char_t * filename);
+		void close(void);
+
+		inline bool      is_open(void) const { return m_data != nullptr; }
+
+		inline uint8_t * get_data(void) const { return m_data; }
+		inline size_t    get_size(void) const { return m_size; }
+
+	private:
+
+		uint8_t * m_data;
+		size_t    m_size;
+
+#ifdef _WIN32
+		void    * m_file;
+		void    * m_mapping;
+#endif
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#define FUSE_MEMORY_HISTOGRAM_BUCKETS    16
+#define FUSE_MEMORY_TRACKER_LOG_INTERVAL 10.f
+
+namespace fuse
+{
+
+	// The subsystem an allocation is accounted to
+
+	enum memory_tag
+	{
+		FUSE_MEMORY_TAG_GENERAL,
+		FUSE_MEMORY_TAG_OCTREE,
+		FUSE_MEMORY_TAG_MESH,
+		FUSE_MEMORY_TAG_IMAGE,
+		FUSE_MEMORY_TAG_SCENE,
+		FUSE_MEMORY_TAG_FRAME,
+		FUSE_MEMORY_TAG_COUNT
+	};
+
+	struct memory_tag_statistics
+	{
+		size_t liveBytes;
+		size_t peakBytes;
+		size_t allocations;
+		size_t deallocations;
+
+		// Allocations by size, the first bucket counts the ones up to 16 bytes, each
+		// next one the sizes up to twice as big, the last one everything bigger
+
+		size_t histogram[FUSE_MEMORY_HISTOGRAM_BUCKETS];
+	};
+
+	struct memory_snapshot
+	{
+		memory_tag_statistics tags[FUSE_MEMORY_TAG_COUNT];
+		size_t                liveBytes;
+	};
+
+	/*
+	*
+	* Accounts the allocations of the tagged allocators (aligned_allocator,
+	* slab_allocator and the frame arena blocks) to their subsystem. Only
+	* built with FUSE_MEMORY_TRACKING: without it the allocators call
+	* aligned_malloc directly, the snapshots are empty and the logging does
+	* nothing.
+	*
+	* The aligned allocations keep their size and tag in a header before the
+	* returned pointer, so they are accounted correctly when freed through
+	* operator delete, which does not know the size.
+	*
+	*/
+
+	class memory_tracker
+	{
+
+	public:
+
+		static const char_t * get_tag_name(memory_tag tag);
+
+#ifdef FUSE_MEMORY_TRACKING
+
+		static void * allocate(size_t size, size_t alignment, memory_tag tag);
+		static void   deallocate(void * p);
+
+		// For the allocators that know the size of what they free (e.g. fixed size slots)
+
+		static void record_allocation(memory_tag tag, size_t size);
+		static void record_deallocation(memory_tag tag, size_t size);
+
+		static memory_snapshot get_snapshot(void);
+
+		static void log_snapshot(void);
+
+		// Called once per frame, logs a snapshot every interval seconds (0 never does)
+
+		static void update(float dt);
+
+		static void  set_log_interval(float seconds);
+		static float get_log_interval(void);
+
+#else
+
+		inline static memory_snapshot get_snapshot(void) { return memory_snapshot{}; }
+
+		inline static void log_snapshot(void) { }
+
+		inline static void update(float) { }
+
+		inline static void  set_log_interval(float) { }
+		inline static float get_log_interval(void) { return 0.f; }
+
+#endif
+
+	};
+
+}
+
+#ifdef FUSE_MEMORY_TRACKING
+#define FUSE_MEMORY_TRACK_ALLOCATION(Tag, Size)   fuse::memory_tracker::record_allocation(Tag, Size)
+#define FUSE_MEMORY_TRACK_DEALLOCATION(Tag, Size) fuse::memory_tracker::record_deallocation(Tag, Size)
+#else
+#define FUSE_MEMORY_TRACK_ALLOCATION(Tag, Size)
+#define FUSE_MEMORY_TRACK_DEALLOCATION(Tag, Size)
+#endif
\ No newline at end of file
@@ -1,15 +1,44 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
+#include <vector>
 
 #define FUSE_POOL_INVALID ((pool_size_t) -1)
 
+#define FUSE_POOL_SL_LOG2  4
+#define FUSE_POOL_SL_COUNT (1 << FUSE_POOL_SL_LOG2)
+#define FUSE_POOL_FL_COUNT (32 - FUSE_POOL_SL_LOG2 + 1)
+
 namespace fuse
 {
 
 	typedef uint32_t pool_size_t;
 
+	struct pool_statistics
+	{
+		pool_size_t size;
+		pool_size_t freeElements;
+		pool_size_t freeBlocks;
+		pool_size_t largestFreeBlock;
+
+		// 1 - largestFreeBlock / freeElements, 0 when the free space is in one piece
+
+		float fragmentation;
+	};
+
+	/*
+	*
+	* Allocates ranges of elements (e.g. descriptors) out of a pool, the memory
+	* itself lives elsewhere. The free blocks are kept in two level segregated
+	* lists (TLSF): the first level is the power of two of the size, the second
+	* splits it in FUSE_POOL_SL_COUNT linear classes, and bitmaps tell which lists
+	* are not empty. Allocating takes the first block of the smallest class whose
+	* blocks are all big enough, freeing merges the block with its free neighbours
+	* found through the tags at the boundaries of the free blocks, both in
+	* constant time.
+	*
+	*/
+
 	class pool_manager
 	{
 
@@ -30,18 +59,38 @@ namespace fuse
 
 		void clear(void);
 
+		// Walks the list of the largest blocks only
+
+		pool_statistics get_statistics(void) const;
+
 	private:
 
-		using map_type = std::map<pool_size_t, pool_size_t>;
-		using map_iterator = map_type::iterator;
+		// The size and the links are set on the first element of a free block, the
+		// head on its last element, and cleared when the block leaves the lists
+
+		struct block_tag
+		{
+			pool_size_t size;
+			pool_size_t previous;
+			pool_size_t next;
+			pool_size_t head;
+		};
 
-		map_type m_freeChunks;
+		std::vector<block_tag> m_tags;
+
+		pool_size_t m_freeLists[FUSE_POOL_FL_COUNT][FUSE_POOL_SL_COUNT];
+
+		uint32_t m_firstLevelMap;
+		uint32_t m_secondLevelMap[FUSE_POOL_FL_COUNT];
 
 		uint32_t m_objectsCount;
 
-		map_iterator find_free_chunk(pool_size_t elements);
-		void allocate_chunk(map_iterator it, pool_size_t elements);
-		void free_chunk(pool_size_t offset, pool_size_t elements);
+		pool_size_t m_freeElements;
+		pool_size_t m_freeBlocks;
+
+		pool_size_t find_free_chunk(pool_size_t elements) const;
+		void insert_free_chunk(pool_size_t offset, pool_size_t elements);
+		void remove_free_chunk(pool_size_t offset);
 
 	};
 
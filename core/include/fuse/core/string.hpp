@@ -86,7 +86,7 @@ namespace fuse
 	inline std::string to_string_t(long double value) { return std::to_string(value); }
 
 	inline std::string to_string_t(const std::wstring & s) { return string_narrow(s); }
-	inline std::string to_string_t(const std::sstring & s) { return s; }
+	inline std::string to_string_t(const std::string & s) { return s; }
 
 #endif
 
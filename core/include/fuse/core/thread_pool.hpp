@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fuse
+{
+
+	/*
+	*
+	* Work-stealing thread pool. Each worker owns a queue: tasks enqueued from
+	* a worker go in its own queue and are popped LIFO, idle workers steal the
+	* oldest tasks from the other queues.
+	*
+	* wait() blocks until every enqueued task (including the ones enqueued by
+	* other tasks) has been executed, the calling thread runs tasks meanwhile.
+	*
+	* parallel_for() splits [0, count) in chunks of grain elements and returns
+	* when all of them are processed. The calling thread processes chunks too,
+	* so it can be used from within a task, where wait() would never return.
+	*
+	*/
+
+	class thread_pool
+	{
+
+	public:
+
+		using task_type  = std::function<void(void)>;
+		using range_type = std::function<void(size_t, size_t)>;
+
+		thread_pool(void);
+		thread_pool(unsigned int threads);
+		thread_pool(const thread_pool &) = delete;
+		thread_pool(thread_pool &&) = delete;
+
+		~thread_pool(void);
+
+		thread_pool & operator= (const thread_pool &) = delete;
+		thread_pool & operator= (thread_pool &&) = delete;
+
+		void enqueue(task_type task);
+		void wait(void);
+
+		void parallel_for(size_t count, size_t grain, range_type body);
+
+		inline unsigned int get_threads_count(void) const { return static_cast<unsigned int>(m_threads.size()); }
+
+	private:
+
+		struct worker_queue
+		{
+			std::mutex            lock;
+			std::deque<task_type> tasks;
+		};
+
+		std::vector<std::thread>                   m_threads;
+		std::vector<std::unique_ptr<worker_queue>> m_queues;
+
+		std::atomic<uint32_t> m_queuedTasks;
+		std::atomic<uint32_t> m_pendingTasks;
+		std::atomic<uint32_t> m_nextQueue;
+
+		bool                    m_stop;
+		std::mutex              m_sleepLock;
+		std::condition_variable m_wakeCondition;
+		std::condition_variable m_doneCondition;
+
+		void create_workers(unsigned int threads);
+
+		void worker_main(unsigned int index);
+
+		bool pop(unsigned int index, task_type & task);
+		bool steal(unsigned int index, task_type & task);
+		bool execute(unsigned int index);
+
+		unsigned int get_current_queue(void);
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <fuse/core.hpp>
+#include <fuse/core/pool_manager.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#define FUSE_TRANSIENT_PAGE_SIZE 64
+
+namespace fuse
+{
+
+	/*
+	*
+	* Range of a pool reserved for the elements (e.g. descriptors) that only
+	* live for one frame. The range is split in one segment per frame in
+	* flight, each segment in pages handed out by an atomic bump pointer, so
+	* any thread can take pages without locking. begin_frame resets the
+	* segment of the new frame, which must not be in use by the GPU anymore:
+	* with numFrames buffered frames, frame N reuses the pages of frame
+	* N - numFrames.
+	*
+	* Each begin_frame (and init) starts a new epoch, even when the frame
+	* index is the same as the previous one: the allocators compare the
+	* epoch to know when their pages are gone.
+	*
+	*/
+
+	class transient_pool
+	{
+
+	public:
+
+		transient_pool(void);
+		transient_pool(const transient_pool &) = delete;
+
+		bool init(pool_size_t base, pool_size_t pageSize, pool_size_t pagesPerFrame, uint32_t numFrames);
+		void shutdown(void);
+
+		// Not thread safe, called before the threads start allocating for the frame
+
+		void begin_frame(uint64_t frameIndex);
+
+		// Returns the first element of numPages contiguous pages of the current frame, FUSE_POOL_INVALID when the frame is out of pages
+
+		pool_size_t allocate_pages(pool_size_t numPages = 1u);
+
+		inline uint64_t get_frame_index(void) const { return m_frameIndex.load(std::memory_order_acquire); }
+
+		inline uint64_t get_epoch(void) const { return m_epoch.load(std::memory_order_acquire); }
+
+		// Pages taken during the current frame, to size the pool
+
+		inline pool_size_t get_used_pages(void) const { return std::min(m_nextPage.load(std::memory_order_relaxed), m_lastPage) - m_firstPage; }
+
+	private:
+
+		pool_size_t m_base;
+		pool_size_t m_pageSize;
+		pool_size_t m_pagesPerFrame;
+		uint32_t    m_numFrames;
+
+		pool_size_t m_firstPage;
+		pool_size_t m_lastPage;
+
+		std::atomic<pool_size_t> m_nextPage;
+		std::atomic<uint64_t>    m_frameIndex;
+		std::atomic<uint64_t>    m_epoch;
+
+		// Set by the first allocation failing in the frame, so the exhaustion is logged once
+
+		std::atomic<bool> m_exhausted;
+
+	public:
+
+		FUSE_PROPERTIES_BY_VALUE_READ_ONLY(
+			(base, m_base)
+			(page_size, m_pageSize)
+			(pages_per_frame, m_pagesPerFrame)
+			(num_frames, m_numFrames)
+		)
+
+	};
+
+	/*
+	*
+	* Linear allocator over the pages of a transient_pool, meant to be owned
+	* by a single thread (e.g. one per thread recording command lists). The
+	* allocations are never freed, the allocator starts over from a new page
+	* when the pool starts a new epoch.
+	*
+	*/
+
+	class transient_allocator
+	{
+
+	public:
+
+		transient_allocator(transient_pool * pool = nullptr);
+
+		void reset(transient_pool * pool = nullptr);
+
+		// The elements are contiguous, FUSE_POOL_INVALID when the pool is out of pages for the frame
+
+		pool_size_t allocate(pool_size_t elements = 1u);
+
+	private:
+
+		transient_pool * m_pool;
+
+		pool_size_t m_offset;
+		pool_size_t m_end;
+		uint64_t    m_epoch;
+
+	public:
+
+		FUSE_PROPERTIES_BY_VALUE_READ_ONLY(
+			(pool, m_pool)
+		)
+
+	};
+
+}
\ No newline at end of file
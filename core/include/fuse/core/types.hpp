@@ -13,7 +13,7 @@ namespace fuse
 #else
 
 	typedef char char_t;
-	FUSE_LITERAL(Literal) Literal
+#define FUSE_LITERAL(Literal) Literal
 
 #endif
 
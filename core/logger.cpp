@@ -12,7 +12,7 @@ void logger::log(const char_t * label, const char_t * message) const
 	auto now   = std::chrono::system_clock::now();
 	auto now_c = std::chrono::system_clock::to_time_t(now);
 	
-	*m_logStream << "[" << std::put_time(std::localtime(&now_c), L"%c") << "] " << label << ": " << message << std::endl;
+	*m_logStream << "[" << std::put_time(std::localtime(&now_c), FUSE_LITERAL("%c")) << "] " << label << ": " << message << std::endl;
 }
 
 void logger::log(const char_t * label, const std::basic_ostream<char_t> & os) const
@@ -20,5 +20,5 @@ void logger::log(const char_t * label, const std::basic_ostream<char_t> & os) co
 	auto now = std::chrono::system_clock::now();
 	auto now_c = std::chrono::system_clock::to_time_t(now);
 
-	*m_logStream << "[" << std::put_time(std::localtime(&now_c), L"%c") << "] " << label << ": " << os.rdbuf() << std::endl;
+	*m_logStream << "[" << std::put_time(std::localtime(&now_c), FUSE_LITERAL("%c")) << "] " << label << ": " << os.rdbuf() << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include <fuse/core/mapped_file.hpp>
+#include <fuse/core/string.hpp>
+
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace fuse;
+
+mapped_file::mapped_file(void) :
+	m_data(nullptr),
+	m_size(0)
+#ifdef _WIN32
+	, m_file(INVALID_HANDLE_VALUE),
+	m_mapping(nullptr)
+#endif
+{
+}
+
+mapped_file::mapped_file(mapped_file && file) :
+	mapped_file()
+{
+	*this = std::move(file);
+}
+
+mapped_file::~mapped_file(void)
+{
+	close();
+}
+
+mapped_file & mapped_file::operator= (mapped_file && file)
+{
+	std::swap(m_data, file.m_data);
+	std::swap(m_size, file.m_size);
+
+#ifdef _WIN32
+	std::swap(m_file, file.m_file);
+	std::swap(m_mapping, file.m_mapping);
+#endif
+
+	return *this;
+}
+
+#ifdef _WIN32
+
+bool mapped_file::open(const char_t * filename)
+{
+	close();
+
+	m_file = CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	LARGE_INTEGER size;
+
+	if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	m_mapping = CreateFileMapping(m_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	m_data    = m_mapping ? static_cast<uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0)) : nullptr;
+	m_size    = static_cast<size_t>(size.QuadPart);
+
+	if (!m_data)
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void mapped_file::close(void)
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+	}
+
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_file);
+	}
+
+	m_data    = nullptr;
+	m_size    = 0;
+	m_file    = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+}
+
+#else
+
+bool mapped_file::open(const char_t * filename)
+{
+	close();
+
+	int fd = ::open(string_narrow(string_t(filename)).c_str(), O_RDONLY);
+
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat status;
+
+	if (fstat(fd, &status) == 0 && status.st_size > 0)
+	{
+		void * data = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+		if (data != MAP_FAILED)
+		{
+			m_data = static_cast<uint8_t*>(data);
+			m_size = static_cast<size_t>(status.st_size);
+		}
+	}
+
+	// The mapping stays valid after closing the descriptor
+
+	::close(fd);
+
+	return m_data != nullptr;
+}
+
+void mapped_file::close(void)
+{
+	if (m_data)
+	{
+		munmap(m_data, m_size);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include <fuse/core.hpp>
+#include <fuse/core/memory_tracker.hpp>
+
+using namespace fuse;
+
+const char_t * memory_tracker::get_tag_name(memory_tag tag)
+{
+	static const char_t * names[] = {
+		FUSE_LITERAL("general"),
+		FUSE_LITERAL("octree"),
+		FUSE_LITERAL("mesh"),
+		FUSE_LITERAL("image"),
+		FUSE_LITERAL("scene"),
+		FUSE_LITERAL("frame")
+	};
+
+	static_assert(sizeof(names) / sizeof(names[0]) == FUSE_MEMORY_TAG_COUNT, "Missing memory tag name.");
+
+	return tag < FUSE_MEMORY_TAG_COUNT ? names[tag] : FUSE_LITERAL("unknown");
+}
+
+#ifdef FUSE_MEMORY_TRACKING
+
+#include <atomic>
+
+namespace
+{
+
+	// Zero initialized before any dynamic initialization, so the allocations of the
+	// static objects are accounted too
+
+	struct tag_counters
+	{
+		std::atomic<size_t> liveBytes;
+		std::atomic<size_t> peakBytes;
+		std::atomic<size_t> allocations;
+		std::atomic<size_t> deallocations;
+		std::atomic<size_t> histogram[FUSE_MEMORY_HISTOGRAM_BUCKETS];
+	};
+
+	tag_counters g_counters[FUSE_MEMORY_TAG_COUNT];
+
+	float g_logInterval = FUSE_MEMORY_TRACKER_LOG_INTERVAL;
+	float g_logTime;
+
+	struct allocation_header
+	{
+		size_t   size;
+		uint32_t tag;
+		uint32_t offset;
+	};
+
+	inline size_t histogram_bucket(size_t size)
+	{
+		size_t bucket = 0;
+
+		for (size_t limit = 16; limit < size && bucket < FUSE_MEMORY_HISTOGRAM_BUCKETS - 1; limit <<= 1)
+		{
+			bucket++;
+		}
+
+		return bucket;
+	}
+
+}
+
+void * memory_tracker::allocate(size_t size, size_t alignment, memory_tag tag)
+{
+
+	// The header goes right before the returned pointer, its offset keeps the pointer aligned
+
+	if (alignment < alignof(allocation_header))
+	{
+		alignment = alignof(allocation_header);
+	}
+
+	size_t offset = (sizeof(allocation_header) + alignment - 1) & ~(alignment - 1);
+
+	uint8_t * base = static_cast<uint8_t*>(aligned_malloc(offset + size, alignment));
+
+	if (!base)
+	{
+		return nullptr;
+	}
+
+	allocation_header * header = reinterpret_cast<allocation_header*>(base + offset) - 1;
+
+	header->size   = size;
+	header->tag    = tag;
+	header->offset = static_cast<uint32_t>(offset);
+
+	record_allocation(tag, size);
+
+	return base + offset;
+
+}
+
+void memory_tracker::deallocate(void * p)
+{
+
+	if (p)
+	{
+
+		allocation_header * header = static_cast<allocation_header*>(p) - 1;
+
+		record_deallocation(static_cast<memory_tag>(header->tag), header->size);
+
+		aligned_free(static_cast<uint8_t*>(p) - header->offset);
+
+	}
+
+}
+
+void memory_tracker::record_allocation(memory_tag tag, size_t size)
+{
+
+	tag_counters & counters = g_counters[tag];
+
+	size_t live = counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	size_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+
+	while (peak < live && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+
+	counters.allocations.fetch_add(1, std::memory_order_relaxed);
+	counters.histogram[histogram_bucket(size)].fetch_add(1, std::memory_order_relaxed);
+
+}
+
+void memory_tracker::record_deallocation(memory_tag tag, size_t size)
+{
+	tag_counters & counters = g_counters[tag];
+
+	counters.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+	counters.deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+memory_snapshot memory_tracker::get_snapshot(void)
+{
+
+	memory_snapshot snapshot = {};
+
+	for (int tag = 0; tag < FUSE_MEMORY_TAG_COUNT; tag++)
+	{
+
+		const tag_counters    & counters   = g_counters[tag];
+		memory_tag_statistics & statistics = snapshot.tags[tag];
+
+		statistics.liveBytes     = counters.liveBytes.load(std::memory_order_relaxed);
+		statistics.peakBytes     = counters.peakBytes.load(std::memory_order_relaxed);
+		statistics.allocations   = counters.allocations.load(std::memory_order_relaxed);
+		statistics.deallocations = counters.deallocations.load(std::memory_order_relaxed);
+
+		for (int bucket = 0; bucket < FUSE_MEMORY_HISTOGRAM_BUCKETS; bucket++)
+		{
+			statistics.histogram[bucket] = counters.histogram[bucket].load(std::memory_order_relaxed);
+		}
+
+		snapshot.liveBytes += statistics.liveBytes;
+
+	}
+
+	return snapshot;
+
+}
+
+void memory_tracker::log_snapshot(void)
+{
+
+	memory_snapshot snapshot = get_snapshot();
+
+	stringstream_t ss;
+
+	ss << snapshot.liveBytes << " bytes live.";
+
+	for (int tag = 0; tag < FUSE_MEMORY_TAG_COUNT; tag++)
+	{
+
+		const memory_tag_statistics & statistics = snapshot.tags[tag];
+
+		if (!statistics.allocations)
+		{
+			continue;
+		}
+
+		ss << std::endl << get_tag_name(static_cast<memory_tag>(tag)) << ": " <<
+			statistics.liveBytes << " bytes live, " <<
+			statistics.peakBytes << " peak, " <<
+			statistics.allocations << " allocations, " <<
+			statistics.deallocations << " deallocations, sizes";
+
+		for (int bucket = 0; bucket < FUSE_MEMORY_HISTOGRAM_BUCKETS; bucket++)
+		{
+			if (statistics.histogram[bucket])
+			{
+				ss << (bucket < FUSE_MEMORY_HISTOGRAM_BUCKETS - 1 ? " <=" : " >") <<
+					(size_t(16) << (bucket < FUSE_MEMORY_HISTOGRAM_BUCKETS - 1 ? bucket : bucket - 1)) << ": " <<
+					statistics.histogram[bucket];
+			}
+		}
+
+	}
+
+	FUSE_LOG_OPT(FUSE_LITERAL("memory_tracker"), ss);
+
+}
+
+void memory_tracker::update(float dt)
+{
+
+	if (g_logInterval > 0.f)
+	{
+
+		g_logTime += dt;
+
+		if (g_logTime >= g_logInterval)
+		{
+			g_logTime = 0.f;
+			log_snapshot();
+		}
+
+	}
+
+}
+
+void memory_tracker::set_log_interval(float seconds)
+{
+	g_logInterval = seconds;
+	g_logTime     = 0.f;
+}
+
+float memory_tracker::get_log_interval(void)
+{
+	return g_logInterval;
+}
+
+#endif
\ No newline at end of file
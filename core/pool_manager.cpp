@@ -1,24 +1,83 @@
 #include <fuse/core.hpp>
 #include <fuse/core/pool_manager.hpp>
 
+#include <algorithm>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 using namespace fuse;
 
-pool_manager::pool_manager(void) : m_objectsCount(0) { }
+/* Bit scans */
 
-pool_manager::pool_manager(pool_size_t size) :
-	m_freeChunks({ { 0, size } }),
-	m_objectsCount(size) { }
+static inline uint32_t most_significant_bit(uint32_t x)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, x);
+	return index;
+#else
+	return 31 - __builtin_clz(x);
+#endif
+}
 
-pool_manager::pool_manager(pool_manager && manager)
+static inline uint32_t least_significant_bit(uint32_t x)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, x);
+	return index;
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+// The classes below FUSE_POOL_SL_COUNT hold a single size each
+
+static inline void pool_mapping(pool_size_t size, uint32_t & fl, uint32_t & sl)
+{
+	if (size < FUSE_POOL_SL_COUNT)
+	{
+		fl = 0;
+		sl = size;
+	}
+	else
+	{
+		uint32_t msb = most_significant_bit(size);
+
+		fl = msb - FUSE_POOL_SL_LOG2 + 1;
+		sl = (size >> (msb - FUSE_POOL_SL_LOG2)) - FUSE_POOL_SL_COUNT;
+	}
+}
+
+/* Construction */
+
+pool_manager::pool_manager(void)
 {
-	
 	clear();
+}
 
-	m_objectsCount = manager.m_objectsCount;
-	m_freeChunks   = std::move(manager.m_freeChunks);
+pool_manager::pool_manager(pool_size_t size)
+{
+
+	clear();
+
+	if (size)
+	{
+		m_tags.resize(size, block_tag { 0, FUSE_POOL_INVALID, FUSE_POOL_INVALID, FUSE_POOL_INVALID });
+		m_objectsCount = size;
+
+		insert_free_chunk(0, size);
+	}
 
-	manager.m_objectsCount = 0;
+}
 
+pool_manager::pool_manager(pool_manager && manager)
+{
+	clear();
+	*this = std::move(manager);
 }
 
 pool_manager::~pool_manager(void)
@@ -29,111 +88,251 @@ pool_manager::~pool_manager(void)
 pool_manager & pool_manager::operator= (pool_manager && manager)
 {
 
-	clear();
+	m_tags = std::move(manager.m_tags);
 
+	std::memcpy(m_freeLists, manager.m_freeLists, sizeof(m_freeLists));
+	std::memcpy(m_secondLevelMap, manager.m_secondLevelMap, sizeof(m_secondLevelMap));
 
-	m_objectsCount = manager.m_objectsCount;
-	m_freeChunks   = std::move(manager.m_freeChunks);
+	m_firstLevelMap = manager.m_firstLevelMap;
+	m_objectsCount  = manager.m_objectsCount;
+	m_freeElements  = manager.m_freeElements;
+	m_freeBlocks    = manager.m_freeBlocks;
 
-	manager.m_objectsCount = 0;
+	manager.clear();
 
 	return *this;
 
 }
 
+/* Allocation */
+
 pool_size_t pool_manager::allocate(pool_size_t elements)
 {
-	
-	auto it = find_free_chunk(elements);
 
-	if (it == m_freeChunks.end())
+	pool_size_t offset = elements ? find_free_chunk(elements) : FUSE_POOL_INVALID;
+
+	if (offset == FUSE_POOL_INVALID)
 	{
 		FUSE_LOG_OPT(FUSE_LITERAL("pool_manager"), FUSE_LITERAL("Not enough memory available for the requested allocation."))
 		return FUSE_POOL_INVALID;
 	}
 
-	pool_size_t allocatedOffset = it->first + it->second - elements;
+	pool_size_t size = m_tags[offset].size;
 
-	allocate_chunk(it, elements);
+	remove_free_chunk(offset);
 
-	return allocatedOffset;
+	// The rest of the block goes back in the lists
+
+	if (size > elements)
+	{
+		insert_free_chunk(offset + elements, size - elements);
+	}
+
+	return offset;
 
 }
 
 void pool_manager::free(pool_size_t offset, pool_size_t elements)
 {
-	free_chunk(offset, elements);
+
+	if (!elements || offset >= m_objectsCount || elements > m_objectsCount - offset) return;
+
+	pool_size_t end = offset + elements;
+
+	// Merge with the free block ending right before and the one starting right after
+
+	if (offset > 0 && m_tags[offset - 1].head != FUSE_POOL_INVALID)
+	{
+		pool_size_t previous = m_tags[offset - 1].head;
+
+		remove_free_chunk(previous);
+		offset = previous;
+	}
+
+	if (end < m_objectsCount && m_tags[end].size)
+	{
+		pool_size_t size = m_tags[end].size;
+
+		remove_free_chunk(end);
+		end += size;
+	}
+
+	insert_free_chunk(offset, end - offset);
+
 }
 
 void pool_manager::clear(void)
 {
-	m_objectsCount = 0;
-	m_freeChunks.clear();
+
+	m_tags.clear();
+	m_tags.shrink_to_fit();
+
+	std::fill(&m_freeLists[0][0], &m_freeLists[0][0] + FUSE_POOL_FL_COUNT * FUSE_POOL_SL_COUNT, FUSE_POOL_INVALID);
+	std::fill(m_secondLevelMap, m_secondLevelMap + FUSE_POOL_FL_COUNT, 0u);
+
+	m_firstLevelMap = 0;
+	m_objectsCount  = 0;
+	m_freeElements  = 0;
+	m_freeBlocks    = 0;
+
 }
 
-pool_manager::map_iterator pool_manager::find_free_chunk(pool_size_t elements)
+pool_statistics pool_manager::get_statistics(void) const
 {
 
-	auto end = m_freeChunks.end();
+	pool_statistics statistics = {};
+
+	statistics.size         = m_objectsCount;
+	statistics.freeElements = m_freeElements;
+	statistics.freeBlocks   = m_freeBlocks;
 
-	for (auto it = m_freeChunks.begin(); it != end; it++)
+	if (m_firstLevelMap)
 	{
 
-		if (it->second >= elements)
+		uint32_t fl = most_significant_bit(m_firstLevelMap);
+		uint32_t sl = most_significant_bit(m_secondLevelMap[fl]);
+
+		for (pool_size_t offset = m_freeLists[fl][sl]; offset != FUSE_POOL_INVALID; offset = m_tags[offset].next)
 		{
-			return it;
+			statistics.largestFreeBlock = std::max(statistics.largestFreeBlock, m_tags[offset].size);
 		}
 
+		statistics.fragmentation = 1.f - statistics.largestFreeBlock / (float) m_freeElements;
+
 	}
 
-	return end;
+	return statistics;
 
 }
 
-void pool_manager::allocate_chunk(pool_manager::map_iterator it, pool_size_t elements)
-{
-	it->second -= elements;
-}
+/* Free lists */
 
-void pool_manager::free_chunk(pool_size_t offset, pool_size_t elements)
+pool_size_t pool_manager::find_free_chunk(pool_size_t elements) const
 {
 
-	if (offset > m_objectsCount) return;
-	
-	auto lb = m_freeChunks.lower_bound(offset);
-	auto ub = m_freeChunks.upper_bound(offset);
+	// Rounding the size up to the next class makes any block of the class found big enough
+
+	uint32_t fl, sl;
 
-	// We can merge with the lower bound if we're freeing the element(s) right after it
-	bool mergeLower = lb != m_freeChunks.end() && ((lb->first + lb->second) == offset);
+	uint64_t rounded = elements;
 
-	// We can merge with the upper bound if we're freeing the element(s) righte before it
-	bool mergeUpper = ub != m_freeChunks.end() && (ub->first == (offset + elements));
+	if (elements >= FUSE_POOL_SL_COUNT)
+	{
+		rounded += (1ull << (most_significant_bit(elements) - FUSE_POOL_SL_LOG2)) - 1;
+	}
 
-	if (mergeLower)
+	if (rounded <= UINT32_MAX)
 	{
 
-		if (mergeUpper)
+		pool_mapping(static_cast<pool_size_t>(rounded), fl, sl);
+
+		uint32_t secondLevel = m_secondLevelMap[fl] & (~0u << sl);
+
+		if (!secondLevel)
 		{
-			// Merge both into the lb
-			lb->second += elements + ub->second;
-			m_freeChunks.erase(ub);
+			uint32_t firstLevel = m_firstLevelMap & (~0u << (fl + 1));
+
+			if (firstLevel)
+			{
+				fl          = least_significant_bit(firstLevel);
+				secondLevel = m_secondLevelMap[fl];
+			}
 		}
-		else
+
+		if (secondLevel)
 		{
-			// Merge with the lb only
-			lb->second += elements;
+			return m_freeLists[fl][least_significant_bit(secondLevel)];
 		}
-		
+
+	}
+
+	// The class of the size itself may still hold a block big enough, which only
+	// matters when the pool is almost full
+
+	pool_mapping(elements, fl, sl);
+
+	for (pool_size_t offset = m_freeLists[fl][sl]; offset != FUSE_POOL_INVALID; offset = m_tags[offset].next)
+	{
+		if (m_tags[offset].size >= elements)
+		{
+			return offset;
+		}
+	}
+
+	return FUSE_POOL_INVALID;
+
+}
+
+void pool_manager::insert_free_chunk(pool_size_t offset, pool_size_t elements)
+{
+
+	uint32_t fl, sl;
+	pool_mapping(elements, fl, sl);
+
+	pool_size_t next = m_freeLists[fl][sl];
+
+	block_tag & tag = m_tags[offset];
+
+	tag.size     = elements;
+	tag.previous = FUSE_POOL_INVALID;
+	tag.next     = next;
+
+	if (next != FUSE_POOL_INVALID)
+	{
+		m_tags[next].previous = offset;
 	}
-	else if (mergeUpper)
+
+	m_tags[offset + elements - 1].head = offset;
+
+	m_freeLists[fl][sl] = offset;
+
+	m_firstLevelMap      |= 1u << fl;
+	m_secondLevelMap[fl] |= 1u << sl;
+
+	m_freeElements += elements;
+	++m_freeBlocks;
+
+}
+
+void pool_manager::remove_free_chunk(pool_size_t offset)
+{
+
+	block_tag & tag = m_tags[offset];
+
+	uint32_t fl, sl;
+	pool_mapping(tag.size, fl, sl);
+
+	if (tag.previous != FUSE_POOL_INVALID)
 	{
-		// Merge with the ub only
-		m_freeChunks.emplace(offset, elements + ub->second);
-		m_freeChunks.erase(ub);
+		m_tags[tag.previous].next = tag.next;
 	}
 	else
 	{
-		m_freeChunks.emplace(offset, elements);
+		m_freeLists[fl][sl] = tag.next;
+
+		if (tag.next == FUSE_POOL_INVALID)
+		{
+			m_secondLevelMap[fl] &= ~(1u << sl);
+
+			if (!m_secondLevelMap[fl])
+			{
+				m_firstLevelMap &= ~(1u << fl);
+			}
+		}
 	}
 
+	if (tag.next != FUSE_POOL_INVALID)
+	{
+		m_tags[tag.next].previous = tag.previous;
+	}
+
+	m_freeElements -= tag.size;
+	--m_freeBlocks;
+
+	m_tags[offset + tag.size - 1].head = FUSE_POOL_INVALID;
+
+	tag.size     = 0;
+	tag.previous = FUSE_POOL_INVALID;
+	tag.next     = FUSE_POOL_INVALID;
+
 }
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include <fuse/core/thread_pool.hpp>
+
+#include <algorithm>
+
+using namespace fuse;
+
+/* The pool the current thread is a worker of, and its queue */
+
+static thread_local thread_pool * t_workerPool;
+static thread_local unsigned int  t_workerQueue;
+
+thread_pool::thread_pool(void)
+{
+	create_workers(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+thread_pool::thread_pool(unsigned int threads)
+{
+	create_workers(threads);
+}
+
+thread_pool::~thread_pool(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepLock);
+		m_stop = true;
+	}
+
+	m_wakeCondition.notify_all();
+
+	for (std::thread & t : m_threads)
+	{
+		t.join();
+	}
+}
+
+void thread_pool::create_workers(unsigned int threads)
+{
+	m_queuedTasks  = 0;
+	m_pendingTasks = 0;
+	m_nextQueue    = 0;
+	m_stop         = false;
+
+	// With no worker threads tasks are executed by the thread calling wait()
+
+	unsigned int numQueues = std::max(1u, threads);
+
+	for (unsigned int i = 0; i < numQueues; i++)
+	{
+		m_queues.push_back(std::make_unique<worker_queue>());
+	}
+
+	for (unsigned int i = 0; i < threads; i++)
+	{
+		m_threads.emplace_back(&thread_pool::worker_main, this, i);
+	}
+}
+
+void thread_pool::enqueue(task_type task)
+{
+	worker_queue & queue = *m_queues[get_current_queue()];
+
+	m_pendingTasks++;
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepLock);
+		m_queuedTasks++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queue.lock);
+		queue.tasks.push_back(std::move(task));
+	}
+
+	m_wakeCondition.notify_one();
+}
+
+void thread_pool::wait(void)
+{
+	unsigned int index = get_current_queue();
+
+	while (m_pendingTasks > 0)
+	{
+		if (!execute(index))
+		{
+			// Everything left is running on the workers
+
+			std::unique_lock<std::mutex> lock(m_sleepLock);
+			m_doneCondition.wait(lock, [this]() { return m_pendingTasks == 0 || m_queuedTasks > 0; });
+		}
+	}
+}
+
+void thread_pool::parallel_for(size_t count, size_t grain, range_type body)
+{
+	grain = std::max<size_t>(grain, 1);
+
+	size_t numChunks = (count + grain - 1) / grain;
+
+	if (numChunks <= 1 || m_threads.empty())
+	{
+		if (count)
+		{
+			body(0, count);
+		}
+
+		return;
+	}
+
+	// Helpers can start after the loop is over, the state they share outlives the call
+
+	struct range_state
+	{
+		range_type            body;
+		size_t                count;
+		size_t                grain;
+		size_t                numChunks;
+		std::atomic<size_t>   next;
+		std::atomic<size_t>   done;
+	};
+
+	auto state = std::make_shared<range_state>();
+
+	state->body      = std::move(body);
+	state->count     = count;
+	state->grain     = grain;
+	state->numChunks = numChunks;
+	state->next      = 0;
+	state->done      = 0;
+
+	auto run = [](range_state & s)
+	{
+		for (size_t chunk = s.next++; chunk < s.numChunks; chunk = s.next++)
+		{
+			size_t begin = chunk * s.grain;
+			s.body(begin, std::min(begin + s.grain, s.count));
+			s.done++;
+		}
+	};
+
+	size_t numHelpers = std::min<size_t>(m_threads.size(), numChunks - 1);
+
+	for (size_t i = 0; i < numHelpers; i++)
+	{
+		enqueue([state, run]() { run(*state); });
+	}
+
+	run(*state);
+
+	// The chunks left are being processed by the helpers
+
+	while (state->done < numChunks)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void thread_pool::worker_main(unsigned int index)
+{
+	t_workerPool  = this;
+	t_workerQueue = index;
+
+	for (;;)
+	{
+		if (!execute(index))
+		{
+			std::unique_lock<std::mutex> lock(m_sleepLock);
+
+			m_wakeCondition.wait(lock, [this]() { return m_stop || m_queuedTasks > 0; });
+
+			if (m_stop && m_queuedTasks == 0)
+			{
+				return;
+			}
+		}
+	}
+}
+
+bool thread_pool::pop(unsigned int index, task_type & task)
+{
+	worker_queue & queue = *m_queues[index];
+
+	std::lock_guard<std::mutex> lock(queue.lock);
+
+	if (queue.tasks.empty())
+	{
+		return false;
+	}
+
+	task = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+
+	return true;
+}
+
+bool thread_pool::steal(unsigned int index, task_type & task)
+{
+	unsigned int numQueues = static_cast<unsigned int>(m_queues.size());
+
+	for (unsigned int i = 1; i < numQueues; i++)
+	{
+		worker_queue & queue = *m_queues[(index + i) % numQueues];
+
+		std::lock_guard<std::mutex> lock(queue.lock);
+
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool thread_pool::execute(unsigned int index)
+{
+	task_type task;
+
+	if (!pop(index, task) && !steal(index, task))
+	{
+		return false;
+	}
+
+	m_queuedTasks--;
+
+	task();
+
+	if (--m_pendingTasks == 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepLock);
+		}
+
+		m_doneCondition.notify_all();
+	}
+
+	return true;
+}
+
+unsigned int thread_pool::get_current_queue(void)
+{
+	// Workers use their own queue, other threads spread the tasks
+
+	return t_workerPool == this ?
+		t_workerQueue :
+		m_nextQueue++ % static_cast<unsigned int>(m_queues.size());
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <fuse/core.hpp>
+#include <fuse/core/transient_pool.hpp>
+
+using namespace fuse;
+
+/* Pool */
+
+transient_pool::transient_pool(void) :
+	m_epoch(0)
+{
+	shutdown();
+}
+
+bool transient_pool::init(pool_size_t base, pool_size_t pageSize, pool_size_t pagesPerFrame, uint32_t numFrames)
+{
+
+	shutdown();
+
+	if (base == FUSE_POOL_INVALID || !pageSize || !pagesPerFrame || !numFrames)
+	{
+		return false;
+	}
+
+	m_base          = base;
+	m_pageSize      = pageSize;
+	m_pagesPerFrame = pagesPerFrame;
+	m_numFrames     = numFrames;
+
+	begin_frame(0);
+
+	return true;
+
+}
+
+void transient_pool::shutdown(void)
+{
+
+	m_base          = FUSE_POOL_INVALID;
+	m_pageSize      = 0;
+	m_pagesPerFrame = 0;
+	m_numFrames     = 0;
+
+	m_firstPage = 0;
+	m_lastPage  = 0;
+
+	m_nextPage.store(0, std::memory_order_relaxed);
+	m_exhausted.store(false, std::memory_order_relaxed);
+	m_frameIndex.store(0, std::memory_order_release);
+
+	m_epoch.fetch_add(1, std::memory_order_acq_rel);
+
+}
+
+void transient_pool::begin_frame(uint64_t frameIndex)
+{
+
+	if (m_numFrames)
+	{
+		m_firstPage = static_cast<pool_size_t>(frameIndex % m_numFrames) * m_pagesPerFrame;
+		m_lastPage  = m_firstPage + m_pagesPerFrame;
+
+		m_nextPage.store(m_firstPage, std::memory_order_relaxed);
+	}
+
+	m_exhausted.store(false, std::memory_order_relaxed);
+	m_frameIndex.store(frameIndex, std::memory_order_release);
+
+	// The pages handed out before are reused from now on, whatever the frame index
+
+	m_epoch.fetch_add(1, std::memory_order_acq_rel);
+
+}
+
+pool_size_t transient_pool::allocate_pages(pool_size_t numPages)
+{
+
+	if (!numPages)
+	{
+		return FUSE_POOL_INVALID;
+	}
+
+	pool_size_t page = m_nextPage.load(std::memory_order_relaxed);
+
+	// Never moves past the end of the segment, so a failed allocation leaves the pool untouched
+
+	do
+	{
+
+		if (numPages > m_lastPage - page)
+		{
+
+			if (!m_exhausted.exchange(true, std::memory_order_relaxed))
+			{
+				FUSE_LOG_OPT(FUSE_LITERAL("transient_pool"), FUSE_LITERAL("Not enough pages left for the frame."))
+			}
+
+			return FUSE_POOL_INVALID;
+
+		}
+
+	} while (!m_nextPage.compare_exchange_weak(page, page + numPages, std::memory_order_relaxed));
+
+	return m_base + page * m_pageSize;
+
+}
+
+/* Allocator */
+
+transient_allocator::transient_allocator(transient_pool * pool)
+{
+	reset(pool);
+}
+
+void transient_allocator::reset(transient_pool * pool)
+{
+	m_pool   = pool;
+	m_offset = 0;
+	m_end    = 0;
+	m_epoch  = 0;
+}
+
+pool_size_t transient_allocator::allocate(pool_size_t elements)
+{
+
+	if (!m_pool || !elements)
+	{
+		return FUSE_POOL_INVALID;
+	}
+
+	uint64_t epoch = m_pool->get_epoch();
+
+	// The pages taken before the last begin_frame may be handed out again already
+
+	if (epoch != m_epoch)
+	{
+		m_offset = 0;
+		m_end    = 0;
+		m_epoch  = epoch;
+	}
+
+	if (m_end - m_offset < elements)
+	{
+
+		pool_size_t pageSize = m_pool->get_page_size();
+		pool_size_t numPages = (elements + pageSize - 1) / pageSize;
+		pool_size_t first    = m_pool->allocate_pages(numPages);
+
+		if (first == FUSE_POOL_INVALID)
+		{
+			return FUSE_POOL_INVALID;
+		}
+
+		m_offset = first;
+		m_end    = first + numPages * pageSize;
+
+	}
+
+	pool_size_t offset = m_offset;
+
+	m_offset += elements;
+
+	return offset;
+
+}
\ No newline at end of file
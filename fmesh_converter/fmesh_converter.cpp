@@ -0,0 +1,132 @@
+#include <fuse/core.hpp>
+#include <fuse/assimp_loader.hpp>
+#include <fuse/mesh_manager.hpp>
+#include <fuse/mesh_optimizer.hpp>
+#include <fuse/resource_factory.hpp>
+
+#include <iostream>
+
+using namespace fuse;
+
+// Converts the meshes of any file Assimp can read to .fmesh files, with the
+// same post-processing the renderer applies when importing a scene, then
+// optimizes them for the vertex cache and overdraw. With --compress the
+// meshes are written in the compressed layout (see vertex_compression.hpp),
+// with --lods a chain of simplified index buffers is stored along each mesh,
+// with --clusters the triangles are grouped in clusters that can be culled.
+// Mesh i is written to <output directory>/<i>.fmesh.
+
+int main(int argc, char * argv[])
+{
+	bool compress = false;
+	bool lods     = false;
+	bool clusters = false;
+
+	while (argc > 1)
+	{
+		std::string option = argv[1];
+
+		if (option == "--compress")
+		{
+			compress = true;
+		}
+		else if (option == "--lods")
+		{
+			lods = true;
+		}
+		else if (option == "--clusters")
+		{
+			clusters = true;
+		}
+		else
+		{
+			break;
+		}
+
+		--argc;
+		++argv;
+	}
+
+	if (argc < 2)
+	{
+		std::cout << "Usage: fmesh_converter [--compress] [--lods] [--clusters] <scene file> [output directory]" << std::endl;
+		return 1;
+	}
+
+	string_t filename  = to_string_t(std::string(argv[1]));
+	string_t directory = argc > 2 ? to_string_t(std::string(argv[2])) : string_t(FUSE_LITERAL("."));
+
+	resource_factory factory;
+	mesh_manager     meshManager;
+
+	factory.register_manager(&meshManager);
+
+	assimp_loader loader(filename.c_str());
+
+	if (!loader.is_loaded())
+	{
+		std::cout << "Failed to load \"" << argv[1] << "\": " << loader.get_error_string() << std::endl;
+		return 1;
+	}
+
+	const aiScene * scene = loader.get_scene();
+
+	int failures = 0;
+
+	for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+	{
+		std::shared_ptr<mesh> m = loader.create_mesh(i);
+
+		string_t output = directory + FUSE_LITERAL("/") + to_string_t(i) + FUSE_LITERAL(".fmesh");
+
+		if (!m->load())
+		{
+			std::cout << "Failed to load mesh " << i << "." << std::endl;
+			++failures;
+			continue;
+		}
+
+		vertex_cache_statistics before = analyze_vertex_cache(m->get_indices(), m->get_num_indices(), m->get_num_vertices());
+
+		m->optimize();
+
+		vertex_cache_statistics after = analyze_vertex_cache(m->get_indices(), m->get_num_indices(), m->get_num_vertices());
+
+		if (clusters && !m->build_clusters())
+		{
+			std::cout << "Failed to build the clusters of mesh " << i << "." << std::endl;
+		}
+
+		if (lods && !m->generate_lods())
+		{
+			std::cout << "No LODs generated for mesh " << i << "." << std::endl;
+		}
+
+		size_t uncompressedSize = m->get_size();
+
+		if (compress && !m->compress())
+		{
+			std::cout << "Failed to compress mesh " << i << "." << std::endl;
+		}
+
+		if (!m->save_fmesh(output.c_str()))
+		{
+			std::cout << "Failed to write \"" << string_narrow(output) << "\"." << std::endl;
+			++failures;
+			continue;
+		}
+
+		std::cout << string_narrow(output) << ": " << m->get_num_vertices() << " vertices, " << m->get_num_triangles() << " triangles, "
+		          << "ACMR " << before.acmr << " -> " << after.acmr << ", "
+		          << "ATVR " << before.atvr << " -> " << after.atvr << ", "
+		          << m->get_num_lods() << " LODs, "
+		          << m->get_num_clusters() << " clusters, "
+		          << uncompressedSize << " -> " << m->get_size() << " bytes." << std::endl;
+
+		m->unload();
+	}
+
+	factory.unregister_manager(FUSE_RESOURCE_TYPE_MESH);
+
+	return failures ? 1 : 0;
+}
\ No newline at end of file
@@ -6,11 +6,13 @@
 #include <fuse/resource_factory.hpp>
 #include <fuse/resource_manager.hpp>
 #include <fuse/mesh_manager.hpp>
+#include <fuse/mesh_optimizer.hpp>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <assimp/cimport.h>
+#include <assimp/DefaultIOSystem.h>
 
 #include <algorithm>
 #include <cstring>
@@ -18,11 +20,83 @@
 
 using namespace fuse;
 
+/* File recording */
+
+class assimp_recording_io_system :
+	public Assimp::DefaultIOSystem
+{
+
+public:
+
+	assimp_recording_io_system(std::vector<string_t> & files) :
+		m_files(files) { }
+
+	Assimp::IOStream * Open(const char * file, const char * mode) override
+	{
+		Assimp::IOStream * stream = Assimp::DefaultIOSystem::Open(file, mode);
+
+		if (stream)
+		{
+			string_t filename = to_string_t(std::string(file));
+
+			if (std::find(m_files.begin(), m_files.end(), filename) == m_files.end())
+			{
+				m_files.push_back(filename);
+			}
+		}
+
+		return stream;
+	}
+
+private:
+
+	std::vector<string_t> & m_files;
+
+};
+
+/* Materials */
+
+static void set_material_textures(material * m, aiMaterial * pMat)
+{
+
+	if (pMat->GetTextureCount(aiTextureType_DIFFUSE))
+	{
+		aiString path;
+		pMat->GetTexture(aiTextureType_DIFFUSE, 0, &path);
+		m->set_diffuse_texture(path.C_Str());
+	}
+
+	if (pMat->GetTextureCount(aiTextureType_SPECULAR))
+	{
+		aiString path;
+		pMat->GetTexture(aiTextureType_SPECULAR, 0, &path);
+		m->set_specular_texture(path.C_Str());
+	}
+
+	if (pMat->GetTextureCount(aiTextureType_NORMALS))
+	{
+		aiString path;
+		pMat->GetTexture(aiTextureType_NORMALS, 0, &path);
+		m->set_normal_map(path.C_Str());
+	}
+
+}
+
+/* assimp_loader */
+
 assimp_loader::assimp_loader(const char_t * filename, unsigned int flags) :
-	m_filename(filename)
+	m_filename(filename),
+	m_compressMeshes(false),
+	m_generateLods(false),
+	m_buildClusters(false),
+	m_threadPool(nullptr)
 {
 	auto fnString = string_narrow(filename);
 
+	// The importer owns the IO system
+
+	m_importer.SetIOHandler(new assimp_recording_io_system(m_sourceFiles));
+
 	m_scene = m_importer.ReadFile(fnString.c_str(), flags | aiProcess_Triangulate);
 
 	m_importer.SetPropertyFloat(AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE, 80.f);
@@ -80,7 +154,16 @@ std::shared_ptr<mesh> assimp_loader::create_mesh(unsigned int meshIndex)
 
 std::shared_ptr<material> assimp_loader::create_material(unsigned int materialIndex)
 {
-	return resource_factory::get_singleton_pointer()->create<material>(FUSE_RESOURCE_TYPE_MATERIAL, (to_string_t(materialIndex) + FUSE_LITERAL("_assimp_material_") + m_filename).c_str(), default_parameters(), this);
+	std::shared_ptr<material> m = resource_factory::get_singleton_pointer()->create<material>(FUSE_RESOURCE_TYPE_MATERIAL, (to_string_t(materialIndex) + FUSE_LITERAL("_assimp_material_") + m_filename).c_str(), default_parameters(), this);
+
+	// The textures are known before the load, so load_async loads them first as dependencies
+
+	if (m && m->get_status() == FUSE_RESOURCE_NOT_LOADED && m_scene && materialIndex < m_scene->mNumMaterials)
+	{
+		set_material_textures(m.get(), m_scene->mMaterials[materialIndex]);
+	}
+
+	return m;
 }
 
 bool assimp_loader::load_mesh(mesh * m)
@@ -157,6 +240,8 @@ bool assimp_loader::load_mesh(mesh * m)
 			}
 		}
 
+		process_mesh(m, id);
+
 		return true;
 	}
 	else
@@ -170,6 +255,50 @@ void assimp_loader::unload_mesh(mesh * m)
 	m->clear();
 }
 
+void assimp_loader::process_mesh(mesh * m, unsigned int meshIndex)
+{
+	if (!m->has_storage_semantic(FUSE_MESH_STORAGE_TANGENTS))
+	{
+		m->calculate_tangent_space(m_threadPool);
+	}
+
+	// TODO: remove phony texcoords to handle the objects with no diffuse texture (add shaders permutations)
+
+	if (m->add_storage_semantic(FUSE_MESH_STORAGE_TEXCOORDS0))
+	{
+		FUSE_LOG_OPT(FUSE_LITERAL("assimp_loader"), FUSE_LITERAL("Added phony texcoords to mesh."));
+	}
+
+	vertex_cache_statistics before = analyze_vertex_cache(m->get_indices(), m->get_num_indices(), m->get_num_vertices());
+
+	m->optimize();
+
+	vertex_cache_statistics after = analyze_vertex_cache(m->get_indices(), m->get_num_indices(), m->get_num_vertices());
+
+	FUSE_LOG_OPT_DEBUG(stringstream_t() << "Optimized mesh " << meshIndex << ", ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << ".");
+
+	if (m_buildClusters && m->build_clusters())
+	{
+		FUSE_LOG_OPT_DEBUG(stringstream_t() << "Split mesh " << meshIndex << " in " << m->get_num_clusters() << " clusters.");
+	}
+
+	if (m_generateLods && m->generate_lods())
+	{
+		uint32_t lastLod = m->get_num_lods() - 1;
+		FUSE_LOG_OPT_DEBUG(stringstream_t() << "Generated " << lastLod << " LODs for mesh " << meshIndex << ", " << m->get_num_triangles() << " -> " << m->get_lod(lastLod).numIndices / 3 << " triangles.");
+	}
+
+	if (m_compressMeshes)
+	{
+		size_t uncompressedSize = m->get_size();
+
+		if (m->compress())
+		{
+			FUSE_LOG_OPT_DEBUG(stringstream_t() << "Compressed mesh " << meshIndex << ", " << uncompressedSize << " -> " << m->get_size() << " bytes.");
+		}
+	}
+}
+
 bool assimp_loader::load_material(material * m)
 {
 	const char_t * name = m->get_name();
@@ -189,26 +318,7 @@ bool assimp_loader::load_material(material * m)
 
 	aiMaterial * pMat = m_scene->mMaterials[id];
 
-	if (pMat->GetTextureCount(aiTextureType_DIFFUSE))
-	{
-		aiString path;
-		pMat->GetTexture(aiTextureType_DIFFUSE, 0, &path);
-		m->set_diffuse_texture(path.C_Str());
-	}
-
-	if (pMat->GetTextureCount(aiTextureType_SPECULAR))
-	{
-		aiString path;
-		pMat->GetTexture(aiTextureType_SPECULAR, 0, &path);
-		m->set_specular_texture(path.C_Str());
-	}
-
-	if (pMat->GetTextureCount(aiTextureType_NORMALS))
-	{
-		aiString path;
-		pMat->GetTexture(aiTextureType_NORMALS, 0, &path);
-		m->set_normal_map(path.C_Str());
-	}
+	set_material_textures(m, pMat);
 
 	aiColor3D baseAlbedo, diffuseAlbedo, specularAlbedo, emissive;
 
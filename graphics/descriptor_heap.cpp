@@ -29,9 +29,25 @@ bool descriptor_heap::init(ID3D12Device * device, const D3D12_DESCRIPTOR_HEAP_DE
 void descriptor_heap::shutdown(void)
 {
 	m_maxDescriptors = 0;
+	m_transientPool.shutdown();
 	reset();
 }
 
+bool descriptor_heap::init_transient(UINT descriptorsPerFrame, UINT numFrames, UINT pageSize)
+{
+
+	UINT pagesPerFrame = (descriptorsPerFrame + pageSize - 1) / pageSize;
+
+	// The pages come out of the persistent pool once and stay reserved until shutdown
+
+	descriptor_token_t base = pagesPerFrame && numFrames ?
+		m_poolManager.allocate(pagesPerFrame * pageSize * numFrames) :
+		FUSE_DESCRIPTOR_INVALID;
+
+	return m_transientPool.init(base, pageSize, pagesPerFrame, numFrames);
+
+}
+
 descriptor_token_t descriptor_heap::allocate(UINT descriptors)
 {
 	return m_poolManager.allocate(descriptors);
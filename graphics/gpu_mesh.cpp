@@ -21,79 +21,140 @@ bool gpu_mesh::create(ID3D12Device * device, gpu_command_queue & commandQueue, g
 	m_numTriangles = mesh->get_num_triangles();
 	m_storageFlags = mesh->get_storage_semantic_flags();
 
-	size_t bufferSize = mesh->get_size();
-	
-	std::unique_ptr<uint8_t[]> intermediateBuffer(new uint8_t[bufferSize]);
-
-	size_t offset = 0;
+	m_compressed     = mesh->is_compressed();
+	m_positionScale  = mesh->get_position_scale();
+	m_positionOffset = mesh->get_position_offset();
 
-	// Copy all the vertices
-
-	uint8_t * bufferPosition = intermediateBuffer.get();
-	float * tmp = (float*)bufferPosition;
+	m_lods.clear();
 
-	size_t verticesBufferSize = mesh->get_num_vertices() * 3 * sizeof(float);
-	offset += verticesBufferSize;
+	for (uint32_t i = 0; i < mesh->get_num_lods(); i++)
+	{
+		m_lods.push_back(mesh->get_lod(i));
+	}
 
-	std::memcpy(bufferPosition, mesh->get_vertices(), verticesBufferSize);
-	bufferPosition += verticesBufferSize;
+	m_clusters.assign(mesh->get_clusters(), mesh->get_clusters() + mesh->get_num_clusters());
 
-	// Then copy the indices
+	uint32_t numIndices = mesh->get_total_num_indices();
 
-	size_t indicesBufferSize = mesh->get_num_triangles() * 3 * sizeof(uint32_t);
+	// 16 bit indices whenever they can address all the vertices
 
-	offset += indicesBufferSize;
+	bool shortIndices = m_numVertices <= 0x10000;
 
-	std::memcpy(bufferPosition, mesh->get_indices(), indicesBufferSize);
-	bufferPosition += indicesBufferSize;
+	size_t positionStride = m_compressed ? sizeof(compressed_position) : 3 * sizeof(float);
+	size_t indexSize      = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
 
-	// Now we need to interleave the non vertex data
+	// Now we need to interleave the non vertex data, compressed meshes have it interleaved already
 
 	std::vector<uint8_t*> iterators;
 	std::vector<uint32_t> dataSize;
 
-	if (has_storage_semantic(FUSE_MESH_STORAGE_NORMALS))
+	if (m_compressed)
 	{
-		iterators.push_back(reinterpret_cast<uint8_t*>(mesh->get_normals()));
-		dataSize.push_back(3 * sizeof(float));
-	}
+		uint32_t compressedStride = mesh->get_compressed_attributes_stride();
 
-	if (has_storage_semantic(FUSE_MESH_STORAGE_TANGENTS))
-	{
-		iterators.push_back(reinterpret_cast<uint8_t*>(mesh->get_tangents()));
-		dataSize.push_back(3 * sizeof(float));
+		if (compressedStride)
+		{
+			iterators.push_back(const_cast<uint8_t*>(mesh->get_compressed_attributes()));
+			dataSize.push_back(compressedStride);
+		}
 	}
-
-	if (has_storage_semantic(FUSE_MESH_STORAGE_BITANGENTS))
+	else
 	{
-		iterators.push_back(reinterpret_cast<uint8_t*>(mesh->get_bitangents()));
-		dataSize.push_back(3 * sizeof(float));
-	}
 
-	for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
-	{
+		if (has_storage_semantic(FUSE_MESH_STORAGE_NORMALS))
+		{
+			iterators.push_back(reinterpret_cast<uint8_t*>(mesh->get_normals()));
+			dataSize.push_back(3 * sizeof(float));
+		}
 
-		uint32_t texcoordSemantic = FUSE_MESH_STORAGE_TEXCOORDS0 << i;
+		if (has_storage_semantic(FUSE_MESH_STORAGE_TANGENTS))
+		{
+			iterators.push_back(reinterpret_cast<uint8_t*>(mesh->get_tangents()));
+			dataSize.push_back(3 * sizeof(float));
+		}
 
-		if (has_storage_semantic(static_cast<mesh_storage_semantic>(texcoordSemantic)))
+		if (has_storage_semantic(FUSE_MESH_STORAGE_BITANGENTS))
 		{
-			iterators.push_back(reinterpret_cast<uint8_t*>(mesh->get_texcoords(i)));
-			dataSize.push_back(2 * sizeof(float));
+			iterators.push_back(reinterpret_cast<uint8_t*>(mesh->get_bitangents()));
+			dataSize.push_back(3 * sizeof(float));
 		}
 
+		for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
+		{
+
+			uint32_t texcoordSemantic = FUSE_MESH_STORAGE_TEXCOORDS0 << i;
+
+			if (has_storage_semantic(static_cast<mesh_storage_semantic>(texcoordSemantic)))
+			{
+				iterators.push_back(reinterpret_cast<uint8_t*>(mesh->get_texcoords(i)));
+				dataSize.push_back(2 * sizeof(float));
+			}
+
+		}
+
+	}
+
+	uint32_t stride = 0;
+	std::for_each(dataSize.begin(), dataSize.end(), [&stride](uint32_t x) { stride += x; });
+
+	// Positions, indices then the non position data, aligned for the vertex fetch
+
+	size_t verticesBufferSize    = m_numVertices * positionStride;
+	size_t indicesBufferSize     = numIndices * indexSize;
+	size_t nonPositionBufferSize = m_numVertices * stride;
+
+	size_t nonPositionOffset = (verticesBufferSize + indicesBufferSize + 15) & ~static_cast<size_t>(15);
+
+	size_t bufferSize = nonPositionOffset + nonPositionBufferSize;
+
+	std::unique_ptr<uint8_t[]> intermediateBuffer(new uint8_t[bufferSize]);
+
+	// Copy all the vertices
+
+	uint8_t * bufferPosition = intermediateBuffer.get();
+
+	std::memcpy(bufferPosition, m_compressed ?
+		static_cast<const void *>(mesh->get_compressed_positions()) :
+		static_cast<const void *>(mesh->get_vertices()), verticesBufferSize);
+
+	bufferPosition += verticesBufferSize;
+
+	// Then copy the indices, the ones of the LODs follow the ones of the mesh
+
+	for (uint32_t i = 0; i < mesh->get_num_lods(); i++)
+	{
+		const mesh_lod & lod     = m_lods[i];
+		const uint32_t * indices = mesh->get_lod_indices(i);
+
+		if (shortIndices)
+		{
+			std::copy(indices, indices + lod.numIndices, reinterpret_cast<uint16_t*>(bufferPosition) + lod.firstIndex);
+		}
+		else
+		{
+			std::memcpy(reinterpret_cast<uint32_t*>(bufferPosition) + lod.firstIndex, indices, lod.numIndices * sizeof(uint32_t));
+		}
 	}
 
-	for (int vertexIndex = 0; vertexIndex < m_numVertices; vertexIndex++)
+	bufferPosition = intermediateBuffer.get() + nonPositionOffset;
+
+	if (m_compressed && !iterators.empty())
 	{
-		for (int iteratorIndex = 0; iteratorIndex < iterators.size(); iteratorIndex++)
+		std::memcpy(bufferPosition, iterators[0], nonPositionBufferSize);
+	}
+	else
+	{
+		for (int vertexIndex = 0; vertexIndex < m_numVertices; vertexIndex++)
 		{
-			uint32_t copySize = dataSize[iteratorIndex];
+			for (int iteratorIndex = 0; iteratorIndex < iterators.size(); iteratorIndex++)
+			{
+				uint32_t copySize = dataSize[iteratorIndex];
 
-			std::memcpy(bufferPosition, iterators[iteratorIndex], copySize);
-			bufferPosition += copySize;
+				std::memcpy(bufferPosition, iterators[iteratorIndex], copySize);
+				bufferPosition += copySize;
 
-			offset                   += copySize;
-			iterators[iteratorIndex] += copySize;
+				iterators[iteratorIndex] += copySize;
+			}
 		}
 	}
 
@@ -122,19 +183,18 @@ bool gpu_mesh::create(ID3D12Device * device, gpu_command_queue & commandQueue, g
 		D3D12_GPU_VIRTUAL_ADDRESS dataAddress = m_dataBuffer->GetGPUVirtualAddress();
 
 		m_positionData.BufferLocation = dataAddress;
-		m_positionData.StrideInBytes  = sizeof(float) * 3;
+		m_positionData.StrideInBytes  = positionStride;
 		m_positionData.SizeInBytes    = verticesBufferSize;
 
 		m_indexData.BufferLocation = m_positionData.BufferLocation + m_positionData.SizeInBytes;
 		m_indexData.SizeInBytes    = indicesBufferSize;
-		m_indexData.Format         = DXGI_FORMAT_R32_UINT;
-
-		uint32_t stride = 0;
-		std::for_each(dataSize.begin(), dataSize.end(), [&stride](uint32_t x) { stride += x; });
+		m_indexData.Format         = shortIndices ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 
-		m_nonPositionData.BufferLocation = m_indexData.BufferLocation + m_indexData.SizeInBytes;
+		m_nonPositionData.BufferLocation = dataAddress + nonPositionOffset;
 		m_nonPositionData.StrideInBytes  = stride;
-		m_nonPositionData.SizeInBytes    = stride * m_numVertices;
+		m_nonPositionData.SizeInBytes    = nonPositionBufferSize;
+
+		m_bufferSize = bufferSize;
 
 		recalculate_size();
 
@@ -148,6 +208,8 @@ void gpu_mesh::clear(gpu_command_queue & commandQueue)
 {
 	commandQueue.safe_release(m_dataBuffer.get());
 	m_dataBuffer.reset();
+
+	m_bufferSize = 0;
 }
 
 bool gpu_mesh::load_impl(void)
@@ -158,12 +220,18 @@ bool gpu_mesh::load_impl(void)
 	if (m && m->load())
 	{
 		auto renderContext = gpu_render_context::get_singleton_pointer();
+		std::lock_guard<gpu_render_context> lock(*renderContext);
 		return create(renderContext->get_device(), renderContext->get_command_queue(), renderContext->get_command_list(), renderContext->get_ring_buffer(), m.get());
 	}
 
 	return false;
 }
 
+void gpu_mesh::get_dependencies_impl(std::vector<std::shared_ptr<resource>> & dependencies)
+{
+	dependencies.push_back(resource_factory::get_singleton_pointer()->create<mesh>(FUSE_RESOURCE_TYPE_MESH, get_name()));
+}
+
 void gpu_mesh::unload_impl(void)
 {
 	auto renderContext = gpu_render_context::get_singleton_pointer();
@@ -172,38 +240,5 @@ void gpu_mesh::unload_impl(void)
 
 size_t gpu_mesh::calculate_size_impl(void)
 {
-	size_t indicesSize   = m_numTriangles * 3 * sizeof(uint32_t);
-	size_t verticesSize  = m_numVertices * 3 * sizeof(float);
-	size_t texcoordsSize = m_numVertices * 2 * sizeof(float);
-
-	int texcoordsMultiplier = 1;
-	int verticesMultiplier  = 1;
-
-	if (has_storage_semantic(FUSE_MESH_STORAGE_NORMALS))
-	{
-		verticesMultiplier++;
-	}
-
-	if (has_storage_semantic(FUSE_MESH_STORAGE_TANGENTS))
-	{
-		verticesMultiplier++;
-	}
-
-	if (has_storage_semantic(FUSE_MESH_STORAGE_BITANGENTS))
-	{
-		verticesMultiplier++;
-	}
-
-	uint32_t texcoordFlag = FUSE_MESH_STORAGE_TEXCOORDS0;
-
-	for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
-	{
-		if (m_storageFlags & texcoordFlag)
-		{
-			texcoordsMultiplier++;
-		}
-		texcoordFlag <<= 1;
-	}
-
-	return verticesSize * verticesMultiplier + texcoordsSize * texcoordsMultiplier + indicesSize;
+	return m_bufferSize;
 }
\ No newline at end of file
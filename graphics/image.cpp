@@ -4,6 +4,7 @@
 #include <IL/il.h>
 #include <IL/ilu.h>
 
+#include <mutex>
 #include <utility>
 
 using namespace fuse;
@@ -13,6 +14,10 @@ image::devil_initializer::~devil_initializer(void) { ilShutDown(); }
 
 image::devil_initializer image::m_initializer;
 
+// DevIL works on a global bound image, the images loading in parallel take turns
+
+static std::mutex g_devilLock;
+
 static std::pair<ILenum, ILenum> get_image_devil_format(image_format format);
 
 struct scoped_devil_handle
@@ -52,6 +57,8 @@ bool image::load_impl(void)
 
 	clear();
 
+	std::lock_guard<std::mutex> devilLock(g_devilLock);
+
 	scoped_devil_handle handle = ilGenImage();
 
 	if (handle != IL_INVALID_VALUE)
@@ -41,6 +41,11 @@ namespace fuse
 		UINT maxCBVUAVSRV;
 		UINT maxRTV;
 
+		// Reserved out of the heaps for each frame in flight, for the descriptors that live one frame
+
+		UINT transientCBVUAVSRV;
+		UINT transientRTV;
+
 		UINT uploadHeapSize;
 	};
 
@@ -272,9 +277,19 @@ namespace fuse
 				UINT64 frameToWait = lastFrame + 1 < m_configuration.swapChainBufferCount ? 0 : lastFrame + 1 - m_configuration.swapChainBufferCount;
 
 				get_command_queue().wait_for_frame(frameToWait);
+
+				// The transient descriptors of the frame waited for can be reused, the loading threads record under the lock
+
+				{
+					std::lock_guard<gpu_render_context> lock(m_renderContext);
+					m_shaderDescriptorHeap.begin_frame(lastFrame);
+					m_renderTargetDescriptorHeap.begin_frame(lastFrame);
+				}
 				//get_command_queue().wait_for_frame(lastFrame);
 				float dt = update_fps_counter();
 
+				memory_tracker::update(dt);
+
 				on_update(dt);
 				
 				if (!update_swapchain())
@@ -289,6 +304,10 @@ namespace fuse
 
 				m_renderContext.advance_frame_index();
 
+				// Everything allocated for the frame on this thread is dropped at once
+
+				frame_arena::get_thread_arena().reset();
+
 			} while (msg.message != WM_QUIT);
 
 		}
@@ -99,6 +99,9 @@ namespace fuse
 		m_configuration.maxCBVUAVSRV = 2048;
 		m_configuration.maxRTV       = 2048;
 
+		m_configuration.transientCBVUAVSRV = 256;
+		m_configuration.transientRTV       = 256;
+
 		m_configuration.uploadHeapSize = 1 << 20;
 	}
 
@@ -202,7 +205,9 @@ namespace fuse
 	{
 		return m_depthStencilDescriptorHeap.init(m_device.get(), m_configuration.maxDSV) &&
 			m_renderTargetDescriptorHeap.init(m_device.get(), m_configuration.maxRTV) &&
-			m_shaderDescriptorHeap.init(m_device.get(), m_configuration.maxCBVUAVSRV);
+			m_shaderDescriptorHeap.init(m_device.get(), m_configuration.maxCBVUAVSRV) &&
+			(!m_configuration.transientRTV || m_renderTargetDescriptorHeap.init_transient(m_configuration.transientRTV, m_configuration.swapChainBufferCount)) &&
+			(!m_configuration.transientCBVUAVSRV || m_shaderDescriptorHeap.init_transient(m_configuration.transientCBVUAVSRV, m_configuration.swapChainBufferCount));
 	}
 
 	template <typename WindowingSystem>
@@ -11,9 +11,13 @@
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
+#include <vector>
+
 namespace fuse
 {
 
+	class thread_pool;
+
 	class assimp_loader :
 		public resource_loader
 	{
@@ -34,14 +38,36 @@ namespace fuse
 		inline bool is_loaded(void) const { return m_scene != nullptr;  }
 		inline const char * get_error_string(void) const { return m_importer.GetErrorString(); }
 
+		// Every file Assimp opened to read the scene (the scene itself, .mtl, .bin...)
+
+		inline const std::vector<string_t> & get_source_files(void) const { return m_sourceFiles; }
+
+		// The processing of the meshes is part of their load, so that a mesh evicted by a
+		// resource budget comes back the same. The tangents and the first texcoords are
+		// always added, the pool (if any) splits the computation of the tangents.
+
+		FUSE_PROPERTIES_BY_VALUE (
+			(compress_meshes, m_compressMeshes)
+			(generate_lods, m_generateLods)
+			(build_clusters, m_buildClusters)
+			(thread_pool, m_threadPool)
+		)
+
 	private:
 
-		string_t           m_filename;
-		const aiScene    * m_scene;
-		Assimp::Importer   m_importer;
+		string_t              m_filename;
+		const aiScene       * m_scene;
+		Assimp::Importer      m_importer;
+		std::vector<string_t> m_sourceFiles;
+
+		bool                  m_compressMeshes;
+		bool                  m_generateLods;
+		bool                  m_buildClusters;
+		thread_pool         * m_threadPool;
 
 		bool load_mesh(mesh * m);
 		void unload_mesh(mesh * m);
+		void process_mesh(mesh * m, unsigned int meshIndex);
 
 		bool load_material(material * m);
 		void unload_material(material * m);
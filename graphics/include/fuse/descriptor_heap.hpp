@@ -2,6 +2,7 @@
 
 #include <fuse/core.hpp>
 #include <fuse/core/pool_manager.hpp>
+#include <fuse/core/transient_pool.hpp>
 
 #include <fuse/directx_helper.hpp>
 
@@ -24,6 +25,19 @@ namespace fuse
 		descriptor_token_t allocate(UINT descriptors = 1);
 		void free(UINT element, UINT descriptors = 1);
 
+		inline pool_statistics get_statistics(void) const { return m_poolManager.get_statistics(); }
+
+		// Reserves descriptorsPerFrame descriptors (rounded up to pages) for each of the numFrames
+		// frames in flight, handed out by the transient_allocator of each thread and never freed
+
+		bool init_transient(UINT descriptorsPerFrame, UINT numFrames, UINT pageSize = FUSE_TRANSIENT_PAGE_SIZE);
+
+		// The GPU must be done with frameIndex - numFrames
+
+		inline void begin_frame(UINT64 frameIndex) { m_transientPool.begin_frame(frameIndex); }
+
+		inline transient_pool & get_transient_pool(void) { return m_transientPool; }
+
 	protected:
 
 		UINT m_maxDescriptors;
@@ -37,7 +51,8 @@ namespace fuse
 
 	private:
 
-		pool_manager m_poolManager;
+		pool_manager   m_poolManager;
+		transient_pool m_transientPool;
 
 	public:
 
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+
+#define FUSE_FMESH_MAGIC     0x48534D46 // "FMSH"
+#define FUSE_FMESH_VERSION   4
+#define FUSE_FMESH_ALIGNMENT 16
+
+#define FUSE_FMESH_FLAG_COMPRESSED 1
+#define FUSE_FMESH_FLAG_LODS       2
+#define FUSE_FMESH_FLAG_CLUSTERS   4
+
+#define FUSE_FMESH_STREAM_COMPRESSED_POSITIONS  0x40000000
+#define FUSE_FMESH_STREAM_COMPRESSED_ATTRIBUTES 0x80000000
+
+namespace fuse
+{
+
+	/*
+	*
+	* Layout of the .fmesh files: the header, the table of the attribute
+	* streams, then the streams and the indices, each one at an offset
+	* aligned to FUSE_FMESH_ALIGNMENT. The streams have the layout mesh keeps
+	* in memory (one array per mesh_storage_semantic), so they are used from
+	* the file mapping as they are. The positions are the stream with
+	* semantic FUSE_MESH_STORAGE_NONE, the indices can be 16 or 32 bits.
+	* Little endian.
+	*
+	* Version 2 adds the compressed meshes (see vertex_compression.hpp): with
+	* FUSE_FMESH_FLAG_COMPRESSED the header is followed by fmesh_quantization
+	* and the streams are the compressed positions and the interleaved
+	* attributes. Version 1 files are still valid.
+	*
+	* Version 3 adds the LODs (see mesh::generate_lods): with FUSE_FMESH_FLAG_LODS
+	* fmesh_lods and its table of fmesh_lod come next, before the streams table.
+	* The LOD indices follow the ones of the mesh and have the same size.
+	*
+	* Version 4 adds the clusters (see mesh_clusters.hpp): with
+	* FUSE_FMESH_FLAG_CLUSTERS fmesh_clusters and its table of fmesh_cluster
+	* follow the LODs, the clusters are ranges of the indices of the mesh.
+	*
+	*/
+
+	struct fmesh_header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t storageFlags;
+		uint32_t numVertices;
+		uint32_t numTriangles;
+		uint32_t indexSize;
+		uint32_t numStreams;
+		uint32_t flags;
+		uint64_t indicesOffset;
+	};
+
+	struct fmesh_quantization
+	{
+		float positionScale[3];
+		float positionOffset[3];
+	};
+
+	struct fmesh_lods
+	{
+		uint32_t numLods;
+		uint32_t numIndices;
+		uint64_t indicesOffset;
+	};
+
+	// firstIndex counts the indices of the mesh, as in mesh_lod
+
+	struct fmesh_lod
+	{
+		uint32_t firstIndex;
+		uint32_t numIndices;
+		float    error;
+		uint32_t reserved;
+	};
+
+	struct fmesh_clusters
+	{
+		uint32_t numClusters;
+		uint32_t reserved[3];
+	};
+
+	struct fmesh_cluster
+	{
+		float    center[3];
+		float    radius;
+		float    coneAxis[3];
+		float    coneCutoff;
+		uint32_t firstIndex;
+		uint32_t numIndices;
+		uint32_t reserved[2];
+	};
+
+	struct fmesh_stream
+	{
+		uint32_t semantic;
+		uint32_t stride;
+		uint64_t offset;
+	};
+
+	static_assert(sizeof(fmesh_header) == 40, "Unexpected fmesh_header padding.");
+	static_assert(sizeof(fmesh_stream) == 16, "Unexpected fmesh_stream padding.");
+	static_assert(sizeof(fmesh_quantization) == 24, "Unexpected fmesh_quantization padding.");
+	static_assert(sizeof(fmesh_lods) == 16, "Unexpected fmesh_lods padding.");
+	static_assert(sizeof(fmesh_lod) == 16, "Unexpected fmesh_lod padding.");
+	static_assert(sizeof(fmesh_clusters) == 16, "Unexpected fmesh_clusters padding.");
+	static_assert(sizeof(fmesh_cluster) == 48, "Unexpected fmesh_cluster padding.");
+
+}
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include <fuse/gpu_command_queue.hpp>
 #include <fuse/gpu_ring_buffer.hpp>
 
+#include <algorithm>
+#include <vector>
+
 namespace fuse
 {
 
@@ -24,14 +27,31 @@ namespace fuse
 
 		inline uint32_t get_num_indices(void) const { return 3 * m_numTriangles; }
 
+		// The index ranges of the LODs of the mesh, the LODs past the last one are the last one
+
+		inline uint32_t get_num_lods(void) const { return static_cast<uint32_t>(m_lods.size()); }
+		inline const mesh_lod & get_lod(uint32_t lod) const { return m_lods[std::min<size_t>(lod, m_lods.size() - 1)]; }
+
+		// The clusters of LOD 0, with their ranges in the index buffer (see mesh_clusters.hpp)
+
+		inline uint32_t get_num_clusters(void) const { return static_cast<uint32_t>(m_clusters.size()); }
+		inline const mesh_cluster * get_clusters(void) const { return m_clusters.data(); }
+
 		inline bool has_storage_semantic(mesh_storage_semantic semantic) const { return (semantic & m_storageFlags) != 0; }
 
+		// Compressed meshes use the layout of vertex_compression.hpp, the positions
+		// are decoded as unorm16 position * scale + offset
+
+		inline bool is_compressed(void) const { return m_compressed; }
+
 	protected:
 
 		bool   load_impl(void) override;
 		void   unload_impl(void) override;
 		size_t calculate_size_impl(void) override;
 
+		void   get_dependencies_impl(std::vector<std::shared_ptr<resource>> & dependencies) override;
+
 	private:
 
 		uint32_t m_storageFlags;
@@ -39,6 +59,15 @@ namespace fuse
 		uint32_t m_numVertices;
 		uint32_t m_numTriangles;
 
+		bool     m_compressed;
+		float3   m_positionScale;
+		float3   m_positionOffset;
+
+		size_t   m_bufferSize = 0;
+
+		std::vector<mesh_lod>     m_lods;
+		std::vector<mesh_cluster> m_clusters;
+
 		com_ptr<ID3D12Resource> m_dataBuffer;
 
 		union
@@ -67,6 +96,11 @@ namespace fuse
 			(index_data, m_indexData)
 		)
 
+		FUSE_PROPERTIES_BY_CONST_REFERENCE_READ_ONLY(
+			(position_scale, m_positionScale)
+			(position_offset, m_positionOffset)
+		)
+
 		FUSE_PROPERTIES_SMART_POINTER_READ_ONLY(
 			(resource, m_dataBuffer)
 		)
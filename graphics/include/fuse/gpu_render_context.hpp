@@ -11,8 +11,11 @@
 namespace fuse
 {
 
+	// Locked by the resources that record their uploads on the command list, so they can be loaded from any thread
+
 	class gpu_render_context :
-		public singleton<gpu_render_context>
+		public singleton<gpu_render_context>,
+		public lockable
 	{
 
 	public:
@@ -55,7 +55,7 @@ namespace fuse
 	private:
 
 
-		std::vector<uint8_t> m_data;
+		std::vector<uint8_t, aligned_allocator<uint8_t, 1, FUSE_MEMORY_TAG_IMAGE>> m_data;
 				     
 		image_format         m_format;
 
@@ -2,12 +2,16 @@
 
 #include <fuse/resource.hpp>
 #include <fuse/math.hpp>
+#include <fuse/core/mapped_file.hpp>
+#include <fuse/mesh_clusters.hpp>
+#include <fuse/vertex_compression.hpp>
 
 #include <cstdint>
 #include <memory>
 #include <vector>
 
 #define FUSE_MESH_MAX_TEXCOORDS 8
+#define FUSE_MESH_MAX_LODS      8
 
 enum mesh_storage_semantic
 {
@@ -29,13 +33,28 @@ enum mesh_storage_semantic
 namespace fuse
 {
 
+	// A range of the index buffer, where the indices of the LODs follow the ones of
+	// the mesh. The error is the distance in object space the LOD can deviate from it.
+
+	struct mesh_lod
+	{
+		uint32_t firstIndex;
+		uint32_t numIndices;
+		float    error;
+	};
+
+	// The vertex and index data, accounted to FUSE_MEMORY_TAG_MESH
+
+	template <typename T>
+	using mesh_vector = std::vector<T, aligned_allocator<T, std::alignment_of<T>::value, FUSE_MEMORY_TAG_MESH>>;
+
 	class mesh :
 		public resource
 	{
 
 	public:
 
-		mesh(void) = default;
+		mesh(void);
 		mesh(const char_t * name, resource_loader * loader, resource_manager * owner);
 		~mesh(void);
 
@@ -45,25 +64,87 @@ namespace fuse
 		bool add_storage_semantic(mesh_storage_semantic semantic);
 		bool remove_storage_semantic(mesh_storage_semantic semantic);
 
-		bool calculate_tangent_space(void);
+		// Tangents and bitangents following the first texcoords set if any, the
+		// work is split on the pool when given (see tangent_space.hpp)
+
+		bool calculate_tangent_space(thread_pool * pool = nullptr);
+
+		// Reorders the triangles for the vertex cache and optionally for overdraw,
+		// then the vertices in the order the triangles use them (see mesh_optimizer.hpp)
+
+		bool optimize(bool overdraw = true);
+
+		// Simplified versions of the mesh sharing its vertices (see mesh_simplifier.hpp),
+		// each one with about reduction times the triangles of the previous one, until the
+		// error relative to the extent of the mesh gets to maxError. LOD 0 is the mesh.
+
+		bool generate_lods(uint32_t maxLods = FUSE_MESH_MAX_LODS - 1, float reduction = .5f, float maxError = .05f);
+		void clear_lods(void);
+
+		// Reorders the triangles of LOD 0 in clusters with their bounds, so that the parts
+		// of the mesh out of the view can be skipped (see mesh_clusters.hpp). optimize
+		// builds them again as it changes the order of the triangles.
+
+		bool build_clusters(void);
+		void clear_clusters(void);
+
+		// Replaces the float streams with the compact layout of vertex_compression.hpp:
+		// positions quantized in the bounding box, octahedral normals and tangents with
+		// the bitangent sign, half texcoords. The float getters return null until
+		// decompress, the decode functions work on both layouts.
+
+		bool compress(void);
+		bool decompress(void);
+
+		float3 decode_position(uint32_t vertex) const;
+		float3 decode_normal(uint32_t vertex) const;
+		float3 decode_tangent(uint32_t vertex) const;
+		float3 decode_bitangent(uint32_t vertex) const;
+		float2 decode_texcoord(int i, uint32_t vertex) const;
+
+		// .fmesh files (see fmesh.hpp), load_impl loads the file named as the mesh.
+		// The attributes stay in the file mapping, 16 bit indices are widened to 32 bits.
+
+		bool load_fmesh(const char_t * filename);
+		bool save_fmesh(const char_t * filename) const;
 
 		inline uint32_t get_num_triangles(void) const { return m_numTriangles; }
 		inline uint32_t get_num_vertices(void) const { return m_numVertices; }
 		inline uint32_t get_num_indices(void) const { return 3 * m_numTriangles; }
 
+		inline uint32_t get_num_lods(void) const { return 1 + static_cast<uint32_t>(m_lods.size()); }
+		inline uint32_t get_total_num_indices(void) const { return get_num_indices() + m_numLodIndices; }
+
+		mesh_lod         get_lod(uint32_t lod) const;
+		const uint32_t * get_lod_indices(uint32_t lod) const;
+
+		inline uint32_t get_num_clusters(void) const { return static_cast<uint32_t>(m_clusters.size()); }
+		inline const mesh_cluster * get_clusters(void) const { return m_clusters.data(); }
+
 		inline bool     has_storage_semantic(mesh_storage_semantic semantic) const { return (semantic & m_storageFlags) != 0;  }
 		inline uint32_t get_storage_semantic_flags(void) const { return m_storageFlags; }
 
 		uint32_t get_parameters_storage_semantic_flags(void);
 
-		inline float * get_vertices(void) const { return &m_vertices[0].x; }
-		inline float * get_normals(void) const { return &m_normals[0].x; }
-		inline float * get_tangents(void) const { return &m_tangents[0].x; }
-		inline float * get_bitangents(void) const { return &m_bitangents[0].x; }
+		inline float * get_vertices(void) const { return reinterpret_cast<float*>(m_verticesStream); }
+		inline float * get_normals(void) const { return reinterpret_cast<float*>(m_normalsStream); }
+		inline float * get_tangents(void) const { return reinterpret_cast<float*>(m_tangentsStream); }
+		inline float * get_bitangents(void) const { return reinterpret_cast<float*>(m_bitangentsStream); }
+
+		inline float * get_texcoords(int i) const { return reinterpret_cast<float*>(m_texcoordsStream[i]); }
+
+		inline uint32_t * get_indices(void) const { return reinterpret_cast<uint32_t*>(m_indicesStream); }
 
-		inline float * get_texcoords(int i) const { return &m_texcoords[i][0].x; }
+		inline bool is_compressed(void) const { return m_compressed; }
 
-		inline uint32_t * get_indices(void) const { return &m_indices[0].x; }
+		inline const compressed_position * get_compressed_positions(void) const { return m_compressedPositionsStream; }
+		inline const uint8_t * get_compressed_attributes(void) const { return m_compressedAttributesStream; }
+		inline uint32_t get_compressed_attributes_stride(void) const { return fuse::get_compressed_attributes_stride(m_storageFlags); }
+
+		// position = unorm16 position * scale + offset
+
+		inline const float3 & get_position_scale(void) const { return m_positionScale; }
+		inline const float3 & get_position_offset(void) const { return m_positionOffset; }
 
 	protected:
 
@@ -73,18 +154,51 @@ namespace fuse
 
 	private:
 
-		mutable std::vector<float3> m_vertices;
-		mutable std::vector<float3> m_normals;
-		mutable std::vector<float3> m_tangents;
-		mutable std::vector<float3> m_bitangents;
-		mutable std::vector<float2> m_texcoords[FUSE_MESH_MAX_TEXCOORDS];
-		mutable std::vector<uint3>  m_indices;
+		mutable mesh_vector<float3> m_vertices;
+		mutable mesh_vector<float3> m_normals;
+		mutable mesh_vector<float3> m_tangents;
+		mutable mesh_vector<float3> m_bitangents;
+		mutable mesh_vector<float2> m_texcoords[FUSE_MESH_MAX_TEXCOORDS];
+		mutable mesh_vector<uint3>  m_indices;
+
+		mesh_vector<uint32_t> m_lodIndices;
+		std::vector<mesh_lod> m_lods;
+
+		std::vector<mesh_cluster> m_clusters;
+
+		/* The arrays the getters return, in the vectors or in the mapped file */
+
+		float3 * m_verticesStream;
+		float3 * m_normalsStream;
+		float3 * m_tangentsStream;
+		float3 * m_bitangentsStream;
+		float2 * m_texcoordsStream[FUSE_MESH_MAX_TEXCOORDS];
+		uint3  * m_indicesStream;
+		uint32_t * m_lodIndicesStream;
+
+		/* Compressed layout */
+
+		mesh_vector<compressed_position> m_compressedPositions;
+		mesh_vector<uint8_t>             m_compressedAttributes;
+
+		compressed_position * m_compressedPositionsStream;
+		uint8_t             * m_compressedAttributesStream;
+
+		float3 m_positionScale;
+		float3 m_positionOffset;
+
+		bool   m_compressed;
+
+		mapped_file m_file;
 
 		uint32_t   m_numVertices;
 		uint32_t   m_numTriangles;
+		uint32_t   m_numLodIndices;
 
 		uint32_t   m_storageFlags;
 
+		void copy_mapped_indices(void);
+
 	};
 
 	typedef std::shared_ptr<mesh> mesh_ptr;
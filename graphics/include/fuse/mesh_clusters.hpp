@@ -0,0 +1,85 @@
+#pragma once
+
+#include <fuse/core.hpp>
+#include <fuse/math.hpp>
+#include <fuse/geometry/frustum_culling.hpp>
+#include <fuse/geometry/sphere.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define FUSE_MESH_CLUSTER_MAX_TRIANGLES 128
+
+namespace fuse
+{
+
+	// A group of neighbouring triangles, contiguous in the index buffer, with the
+	// bounding sphere of its vertices and the cone containing the normals of its
+	// triangles. coneCutoff is the sine of the cone half angle, 1 when the cone is
+	// too wide for the cluster to ever be culled as backfacing.
+
+	struct mesh_cluster
+	{
+		float3   center;
+		float    radius;
+		float3   coneAxis;
+		float    coneCutoff;
+		uint32_t firstIndex;
+		uint32_t numIndices;
+	};
+
+	struct mesh_index_range
+	{
+		uint32_t firstIndex;
+		uint32_t numIndices;
+	};
+
+	// Reorders the triangles so that they form clusters of up to
+	// FUSE_MESH_CLUSTER_MAX_TRIANGLES and writes their bounds in clusters. Each
+	// cluster grows from the first triangle left in the current order, adding
+	// the adjacent triangle that brings the fewest new vertices and deviates
+	// the least from the normals gathered so far, which keeps the clusters
+	// compact and their cones narrow. The triangles are left in the order they
+	// are added, close to the order of a vertex cache optimization.
+
+	void build_clusters(uint32_t * indices, size_t numIndices, const float3 * vertices, size_t numVertices, std::vector<mesh_cluster> & clusters);
+
+	/*
+	*
+	* Culls the clusters of an object against the frustum and against the
+	* camera position (backfacing cones), the visible clusters that follow each
+	* other in the index buffer are merged in a single range. The scratch
+	* buffers are kept between the calls.
+	*
+	*/
+
+	class cluster_culler
+	{
+
+	public:
+
+		cluster_culler(void) = default;
+		cluster_culler(const cluster_culler &) = delete;
+
+		// The planes and the eye are in world space, the clusters in the object
+		// space of world. Appends the visible ranges to ranges and returns their number.
+
+		size_t cull(
+			const mesh_cluster * clusters,
+			size_t numClusters,
+			const mat128 & world,
+			const frustum_planes_soa & planes,
+			const float3 & eye,
+			std::vector<mesh_index_range> & ranges);
+
+	private:
+
+		std::vector<sphere, aligned_allocator<sphere, 16>> m_localSpheres;
+		std::vector<sphere, aligned_allocator<sphere, 16>> m_spheres;
+
+		std::vector<uint32_t> m_visible;
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <fuse/math.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#define FUSE_VERTEX_CACHE_SIZE 16
+
+namespace fuse
+{
+
+	struct vertex_cache_statistics
+	{
+		uint32_t transformedVertices;
+		float    acmr; // Average cache miss ratio, transformed vertices per triangle (3 is the worst case, about .5 the best)
+		float    atvr; // Average transformed vertex ratio, transformed vertices per vertex (1 is the best case)
+	};
+
+	// Simulates a FIFO post-transform vertex cache
+
+	vertex_cache_statistics analyze_vertex_cache(const uint32_t * indices, size_t numIndices, size_t numVertices, uint32_t cacheSize = FUSE_VERTEX_CACHE_SIZE);
+
+	// Reorders the triangles for the post-transform vertex cache (Tom Forsyth, Linear-Speed Vertex Cache Optimisation)
+
+	void optimize_vertex_cache(uint32_t * indices, size_t numIndices, size_t numVertices);
+
+	// Reorders the clusters of triangles of an index buffer optimized for the vertex cache
+	// so that the ones facing outwards, which are likely to occlude the others, are drawn
+	// first (Sander et al., Fast Triangle Reordering for Vertex Locality and Reduced Overdraw).
+	// The clusters are cut where the ACMR stays within threshold times the original one.
+
+	void optimize_overdraw(uint32_t * indices, size_t numIndices, const float3 * vertices, size_t numVertices, float threshold = 1.05f);
+
+	// Renames the vertices in the order the indices first reference them, to fetch the
+	// vertex buffers sequentially. Writes remap[oldIndex] = newIndex, the unreferenced
+	// vertices are moved at the end.
+
+	void optimize_vertex_fetch_remap(uint32_t * remap, uint32_t * indices, size_t numIndices, size_t numVertices);
+
+}
\ No newline at end of file
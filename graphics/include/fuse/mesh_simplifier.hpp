@@ -0,0 +1,36 @@
+#pragma once
+
+#include <fuse/math.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fuse
+{
+
+	// Edge collapses ordered by quadric error (Garland and Heckbert, Surface
+	// Simplification Using Quadric Error Metrics). A vertex collapses onto one of its
+	// neighbours, so the result indexes the same vertices as the input. The vertices on
+	// the borders and on the attribute seams (different vertices at the same position)
+	// are kept. The collapses that would flip a triangle, turn it too far from its
+	// normal in the input or leave a sliver are skipped.
+	// The collapses stop once the index count is down to targetIndices or when the next
+	// one would move the surface by more than targetError, relative to simplify_scale.
+	// Returns the number of indices written to destination (at most numIndices), the
+	// error reached is written to resultError if not null.
+
+	size_t simplify(
+		uint32_t * destination,
+		const uint32_t * indices,
+		size_t numIndices,
+		const float3 * vertices,
+		size_t numVertices,
+		size_t targetIndices,
+		float targetError,
+		float * resultError = nullptr);
+
+	// The largest extent of the bounding box, the unit of the simplify errors
+
+	float simplify_scale(const float3 * vertices, size_t numVertices);
+
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <fuse/core.hpp>
+#include <fuse/core/thread_pool.hpp>
+#include <fuse/math.hpp>
+#include <fuse/geometry/aabb.hpp>
+#include <fuse/vertex_compression.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define FUSE_OCCLUSION_TILE_WIDTH  32
+#define FUSE_OCCLUSION_TILE_HEIGHT 16
+
+namespace fuse
+{
+
+	/*
+	*
+	* Software rasterized depth buffer at a low resolution, to test the bounding
+	* boxes of the objects against a few large occluders before drawing them.
+	*
+	* The occluders are referenced by add_occluder and drawn by render: the
+	* triangles are set up in clip space and binned in screen tiles, the tiles
+	* are rasterized 4 pixels at a time, each by a single thread, then the
+	* pyramid keeping the farthest depth of each 2x2 block is built on top of
+	* the buffer. Backfacing triangles are skipped as the GPU would, triangles
+	* crossing the near plane are skipped too (there is no clipping), which can
+	* only let more objects through.
+	*
+	* Depths are z/w in [0, 1], the buffer is cleared to the far plane.
+	* Coverage is sampled at the pixel centers in single precision, an edge
+	* passing within a small fraction of a pixel of a center may cover it or
+	* not. Past that tolerance, a box in front of the occluders at any pixel
+	* center is never reported hidden.
+	*
+	*/
+
+	class alignas(16) occlusion_buffer
+	{
+
+	public:
+
+		FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+
+		occlusion_buffer(void);
+		occlusion_buffer(const occlusion_buffer &) = delete;
+
+		// The resolution is rounded up to whole tiles
+
+		bool init(uint32_t width, uint32_t height);
+		void shutdown(void);
+
+		// Forgets the occluders of the previous frame, viewProjection maps world space to clip space
+
+		void clear(const mat128 & viewProjection);
+
+		// The vertices are in the object space of world and must stay valid until render.
+		// Compressed positions are decoded as unorm16 position * scale + offset.
+
+		void add_occluder(const float3 * vertices, size_t numVertices, const uint32_t * indices, size_t numIndices, const mat128 & world);
+		void add_occluder(const compressed_position * vertices, size_t numVertices, const uint32_t * indices, size_t numIndices, const mat128 & world, const float3 & scale, const float3 & offset);
+
+		void render(thread_pool * pool = nullptr);
+
+		// False when the box (in world space) is entirely behind the occluders.
+		// The box is tested at the pyramid level where its screen rectangle
+		// spans at most 4x4 texels, against the nearest of its corners.
+
+		bool test(const aabb & box) const;
+
+		inline uint32_t get_num_levels(void) const { return static_cast<uint32_t>(m_levels.size()); }
+
+		// The depth buffer is level 0, each level keeps the farthest depth of 2x2 texels of the previous one
+
+		inline const float * get_depth(uint32_t level = 0) const { return m_levels[level].depth; }
+
+		inline uint32_t get_level_width(uint32_t level) const { return m_levels[level].width; }
+		inline uint32_t get_level_height(uint32_t level) const { return m_levels[level].height; }
+
+	private:
+
+		struct occluder
+		{
+			mat128           worldViewProjection;
+			const void     * vertices;
+			const uint32_t * indices;
+			uint32_t         numVertices;
+			uint32_t         numTriangles;
+			uint32_t         firstVertex;
+			uint32_t         firstTriangle;
+			bool             compressed;
+		};
+
+		// Edge functions e = a * x + b * y + c, positive inside, and the depth plane,
+		// at the pixel centers. The bounds are the pixels whose center is in the bounding box.
+
+		struct triangle_setup
+		{
+			float a[3];
+			float b[3];
+			float c[3];
+			float zx, zy, z0;
+			int32_t minX, minY, maxX, maxY;
+		};
+
+		struct level
+		{
+			float  * depth;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		uint32_t m_width;
+		uint32_t m_height;
+		uint32_t m_tilesX;
+		uint32_t m_tilesY;
+
+		mat128 m_viewProjection;
+
+		std::vector<occluder> m_occluders;
+		std::vector<float4, aligned_allocator<float4, 16>> m_screenVertices;
+		std::vector<triangle_setup> m_triangles;
+		std::vector<std::vector<uint32_t>> m_bins;
+		std::vector<uint32_t> m_chunkTriangles;
+
+		std::vector<float, aligned_allocator<float, 16>> m_depth;
+		std::vector<float> m_pyramid;
+		std::vector<level> m_levels;
+
+		uint32_t m_numChunks;
+		uint32_t m_numTriangles;
+
+		void add_occluder(const void * vertices, size_t numVertices, const uint32_t * indices, size_t numIndices, const mat128 & worldViewProjection, bool compressed);
+
+		void transform_vertices(size_t begin, size_t end);
+		void setup_triangles(size_t begin, size_t end);
+		void rasterize_tile(uint32_t tile);
+		void build_pyramid(void);
+
+	public:
+
+		FUSE_PROPERTIES_BY_VALUE_READ_ONLY(
+			(width, m_width)
+			(height, m_height)
+			(num_triangles, m_numTriangles)
+		)
+
+	};
+
+}
\ No newline at end of file
@@ -2,9 +2,13 @@
 
 #include <fuse/core.hpp>
 
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <functional>
+#include <future>
+#include <memory>
+#include <vector>
 
 #include <boost/property_tree/ptree.hpp>
 
@@ -21,6 +25,7 @@ namespace fuse
 
 	class resource;
 	class resource_manager;
+	class thread_pool;
 
 	struct resource_loader
 	{
@@ -39,10 +44,10 @@ namespace fuse
 		using parameters_type = boost::property_tree::basic_ptree<string_t, string_t>;
 
 		resource(void) :
-			m_owner(nullptr), m_loader(nullptr), m_size(0), m_status(FUSE_RESOURCE_NOT_LOADED) { }
+			m_loader(nullptr), m_owner(nullptr), m_size(0), m_status(FUSE_RESOURCE_NOT_LOADED), m_referenced(false) { }
 
 		resource(const char_t * name, resource_loader * loader = nullptr, resource_manager * owner = nullptr) :
-			m_name(name), m_owner(owner), m_loader(loader), m_size(0), m_status(FUSE_RESOURCE_NOT_LOADED) { }
+			m_loader(loader), m_owner(owner), m_size(0), m_status(FUSE_RESOURCE_NOT_LOADED), m_name(name), m_referenced(false) { }
 
 		resource(const resource &) = delete;
 		resource(resource &&)      = delete;
@@ -67,16 +72,32 @@ namespace fuse
 		bool lock_and_load(void);
 		void unload(void);
 
+		// True if loaded, false while a load or an eviction holds the resource. Unlike
+		// get_status the answer is taken under the lock, so it stays true as long as the
+		// caller holds a pointer to the resource: the owner only evicts the unused ones.
+
+		bool is_loaded(void) const;
+
+		// Loads the resource on the pool once its dependencies are loaded, the status is
+		// FUSE_RESOURCE_LOADING meanwhile and load() waits for the result instead of loading again.
+		// The resource and the pool must outlive the load, as they do for managed resources.
+
+		std::shared_future<bool> load_async(thread_pool & pool);
+
 	protected:
 
 		virtual bool   load_impl(void) = 0;
 		virtual void   unload_impl(void) = 0;
 		virtual size_t calculate_size_impl(void) = 0;
 
-		void recalculate_size(void) { m_size = calculate_size_impl(); }
+		// The resources load_impl loads, load_async loads them in parallel before this one
+
+		virtual void   get_dependencies_impl(std::vector<std::shared_ptr<resource>> &) { }
+
+		void recalculate_size(void);
 
 		template <typename UserdataType>
-		UserdataType get_owner_userdata(void) { return reinterpret_cast<UserdataType>(m_owner->get_userdata()); }
+		UserdataType get_owner_userdata(void);
 
 	private:
 
@@ -91,10 +112,22 @@ namespace fuse
 		string_t           m_name;
 		parameters_type    m_parameters;
 
+		// Set when the resource is used, cleared by the eviction policy of the owner
+
+		std::atomic<bool>                      m_referenced;
+
+		std::promise<bool>                     m_loadPromise;
+		std::shared_future<bool>               m_loadFuture;
+		std::vector<std::function<void(void)>> m_loadCallbacks;
+
 		friend class resource_manager;
 
 		inline void set_id(id_type id) { m_id = id; }
 
+		void load_locked(void);
+		void finish_load_async(void);
+		void on_load(std::function<void(void)> callback);
+
 	};
 
 	inline resource::parameters_type default_parameters(void) { return resource::parameters_type(); }
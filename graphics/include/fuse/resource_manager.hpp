@@ -1,8 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include <fuse/core.hpp>
 #include <fuse/resource.hpp>
@@ -10,13 +11,42 @@
 namespace fuse
 {
 
+	struct resource_manager_statistics
+	{
+		size_t   budget;
+		size_t   residentSize;
+		uint64_t loads;
+		uint64_t evictions;
+		uint64_t evictedBytes;
+	};
+
+	/*
+	*
+	* Resources are never removed from a manager, so the name and id tables
+	* are insert only open addressing hash tables: find_by_name and find_by_id
+	* probe them without taking the lock, only create locks to insert.
+	* When a table grows, the bigger one is published atomically and the old
+	* one is kept until the manager is destroyed, so that readers still probing
+	* it never see freed memory.
+	*
+	* With a budget set, the loaded resources nobody else holds a pointer to
+	* are unloaded with a CLOCK policy when a load exceeds it: the resources
+	* used (looked up or loaded) since the clock hand last passed are given a
+	* second chance. An evicted resource is loaded again by the next load(),
+	* so the loads must give the same resource every time: the processing of a
+	* resource belongs to its load (or loader), not to the code that loads it.
+	* The code that uses a resource without calling load() checks is_loaded:
+	* it takes the resource lock, while get_status can be read mid-eviction.
+	*
+	*/
+
 	class resource_manager :
 		public lockable
 	{
 
 	public:
 
-		resource_manager(const char_t * type, void * userdata = nullptr) : m_type(type), m_userdata(userdata), m_lastID(0){ }
+		resource_manager(const char_t * type, void * userdata = nullptr);
 
 		virtual ~resource_manager(void) { }
 
@@ -31,6 +61,15 @@ namespace fuse
 
 		void * get_userdata(void) const { return m_userdata; }
 
+		// Bytes of loaded resources (as in resource::get_size) to keep at most, 0 disables the eviction
+
+		inline void   set_budget(size_t budget) { m_budget = budget; }
+		inline size_t get_budget(void) const { return m_budget; }
+
+		inline size_t get_resident_size(void) const { return m_residentSize; }
+
+		resource_manager_statistics get_statistics(void) const;
+
 	protected:
 
 		virtual resource * create_impl(const char_t * name, resource_loader * loader) = 0;
@@ -38,18 +77,71 @@ namespace fuse
 
 	private:
 
+		struct entry
+		{
+			size_t                    hash;
+			string_t                  name;
+			resource::id_type         id;
+			std::shared_ptr<resource> handle;
+		};
+
+		struct table
+		{
+			table(size_t capacity);
+
+			entry * find(size_t hash, const char_t * name) const;
+			entry * find(resource::id_type id) const;
+
+			void insert(size_t hash, entry * e);
+
+			std::unique_ptr<std::atomic<entry*>[]> slots;
+			size_t                                 capacity;
+			size_t                                 size;
+		};
+
 		void              * m_userdata;
 		resource::id_type   m_lastID;
 		string_t            m_type;
 
-		std::unordered_map<string_t, resource::id_type>                  m_namedResources;
-		std::unordered_map<resource::id_type, std::shared_ptr<resource>> m_resources;
+		std::atomic<table*> m_namedResources;
+		std::atomic<table*> m_resources;
+
+		/* Owned by the writers, they are only modified under lock */
+
+		std::vector<std::unique_ptr<table>> m_tables;
+		std::vector<std::unique_ptr<entry>> m_entries;
+
+		template <typename Hash>
+		void insert(std::atomic<table*> & current, entry * e, Hash hash);
+
+		/* Eviction */
+
+		std::atomic<size_t>   m_budget;
+		std::atomic<size_t>   m_residentSize;
+		size_t                m_clockHand;
 
-		/* Non interlocked implementations */
+		std::atomic<uint64_t> m_loads;
+		std::atomic<uint64_t> m_evictions;
+		std::atomic<uint64_t> m_evictedBytes;
 
-		std::shared_ptr<resource> find_by_name_unsafe(const char_t * name) const;
-		std::shared_ptr<resource> find_by_id_unsafe(resource::id_type id)    const;
+		friend class resource;
+
+		static void mark_referenced(resource * r);
+
+		void on_resource_load(resource * r);
+		void on_resource_unload(resource * r);
+		void on_resource_resize(resource * r, size_t oldSize);
+
+		void evict(resource * loading);
 
 	};
 
+	/* resource_manager needs to be complete */
+
+	template <typename UserdataType>
+	UserdataType resource::get_owner_userdata(void)
+	{
+		return reinterpret_cast<UserdataType>(m_owner->get_userdata());
+	}
+
 }
\ No newline at end of file
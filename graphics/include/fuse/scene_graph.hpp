@@ -1,7 +1,9 @@
 #pragma once
 
 #include <fuse/core.hpp>
+#include <fuse/core/thread_pool.hpp>
 #include <fuse/transform_hierarchy.hpp>
+#include <fuse/transform_system_node.hpp>
 #include <fuse/mesh.hpp>
 #include <fuse/gpu_mesh.hpp>
 #include <fuse/material.hpp>
@@ -23,19 +25,45 @@ namespace fuse
 
 	class alignas(16) scene_graph_node;
 
+	struct alignas(16) scene_graph_node_move
+	{
+		mat128             oldTransform;
+		mat128             newTransform;
+		scene_graph_node * node;
+	};
+
+	using scene_graph_node_move_vector = std::vector<scene_graph_node_move, aligned_allocator<scene_graph_node_move, 16>>;
+
 	struct scene_graph_node_listener
 	{
-		virtual void on_scene_graph_node_destruction(scene_graph_node * node) {}
-		virtual void on_scene_graph_node_move(scene_graph_node * node, const mat128 & oldTransform, const mat128 & newTransform) {}
+		virtual void on_scene_graph_node_destruction(scene_graph_node *) {}
+		virtual void on_scene_graph_node_move(scene_graph_node *, const mat128 &, const mat128 &) {}
+
+		// Called by the parallel scene_graph::update with all the moves of the nodes
+		// the listener is registered to, in the same order the serial update would use
+
+		virtual void on_scene_graph_node_move_batch(const std::vector<const scene_graph_node_move*> & moves)
+		{
+			for (const scene_graph_node_move * move : moves)
+			{
+				on_scene_graph_node_move(move->node, move->oldTransform, move->newTransform);
+			}
+		}
 	};
 
+#ifdef FUSE_SCENE_GRAPH_FLAT_TRANSFORMS
+	using scene_graph_transform = transform_system_node;
+#else
+	using scene_graph_transform = transform_hierarchy<scene_graph_node>;
+#endif
+
 	class alignas(16) scene_graph_node :
-		public transform_hierarchy<scene_graph_node>
+		public scene_graph_transform
 	{
 
 	public:
 
-		FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+		FUSE_DECLARE_TAGGED_ALIGNED_ALLOCATOR_NEW(16, FUSE_MEMORY_TAG_SCENE)
 
 		using children_iterator       = std::vector<scene_graph_node*>::iterator;
 		using children_const_iterator = std::vector<scene_graph_node*>::const_iterator;
@@ -113,6 +141,9 @@ namespace fuse
 	protected:
 
 		scene_graph_node(scene_graph_node_type type, scene_graph_node * parent) :
+#ifdef FUSE_SCENE_GRAPH_FLAT_TRANSFORMS
+			transform_system_node(parent),
+#endif
 			m_type(type),
 			m_parent(parent) {}
 
@@ -123,6 +154,8 @@ namespace fuse
 
 	private:
 
+		friend class scene_graph;
+
 		scene_graph_node_type m_type;
 		scene_graph_node * m_parent;
 
@@ -131,6 +164,11 @@ namespace fuse
 
 		string_t m_name;
 
+		bool update_node(mat128 & oldTransform, mat128 & newTransform);
+		void update_subtree(scene_graph_node_move_vector & moves);
+
+#ifndef FUSE_SCENE_GRAPH_FLAT_TRANSFORMS
+
 		inline transform_hierarchy<scene_graph_node> * get_transform_hierarchy_parent(void)
 		{
 			return m_parent;
@@ -161,6 +199,8 @@ namespace fuse
 			return m_children.cend();
 		}
 
+#endif
+
 	public:
 
 		FUSE_PROPERTIES_STRING(
@@ -173,6 +213,8 @@ namespace fuse
 		)
 	};
 
+#ifndef FUSE_SCENE_GRAPH_FLAT_TRANSFORMS
+
 	template <>
 	inline scene_graph_node * get_transform_hierarchy_parent(transform_hierarchy<scene_graph_node> * node)
 	{
@@ -197,6 +239,8 @@ namespace fuse
 		return static_cast<scene_graph_node*>(node)->end();
 	}
 
+#endif
+
 	/* Group node */
 
 	class alignas(16) scene_graph_group :
@@ -205,7 +249,7 @@ namespace fuse
 
 	public:
 
-		FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+		FUSE_DECLARE_SLAB_ALLOCATOR_NEW(scene_graph_group, 16, FUSE_MEMORY_TAG_SCENE)
 
 		scene_graph_group(void) :
 			scene_graph_group(nullptr) {}
@@ -229,7 +273,7 @@ namespace fuse
 		scene_graph_camera(scene_graph_node * parent) :
 			scene_graph_node(FUSE_SCENE_GRAPH_CAMERA, parent) {}
 
-		FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+		FUSE_DECLARE_SLAB_ALLOCATOR_NEW(scene_graph_camera, 16, FUSE_MEMORY_TAG_SCENE)
 
 		camera * get_camera(void)
 		{
@@ -259,7 +303,7 @@ namespace fuse
 
 	public:
 
-		FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+		FUSE_DECLARE_SLAB_ALLOCATOR_NEW(scene_graph_geometry, 16, FUSE_MEMORY_TAG_SCENE)
 
 		sphere get_global_bounding_sphere(void)
 		{
@@ -283,6 +327,8 @@ namespace fuse
 		mesh_ptr     m_mesh;
 		gpu_mesh_ptr m_gpumesh;
 
+		uint32_t     m_lod = 0;
+
 	public:
 
 		FUSE_PROPERTIES_BY_CONST_REFERENCE(
@@ -292,6 +338,12 @@ namespace fuse
 			(gpu_mesh, m_gpumesh)
 		)
 
+		// The LOD of the GPU mesh to draw, chosen for the current view (see scene::select_lods)
+
+		FUSE_PROPERTIES_BY_VALUE(
+			(lod, m_lod)
+		)
+
 	};
 
 	/* Scene graph */
@@ -312,10 +364,19 @@ namespace fuse
 			m_root->update();
 		}
 
-		void clear(void)
-		{
-			m_root = std::make_unique<scene_graph_group>();
-		}
+		// Parallel update, the top levels of the tree are updated serially until there
+		// are enough independent subtrees to feed the pool. The listeners are notified
+		// in batch once all the subtrees are done, the other tasks of the pool are not
+		// waited for.
+
+		void update(thread_pool & pool);
+
+		// Destroys all the nodes, the slots of the node allocators are taken back at once
+		// rather than freed one by one. The slabs are rewound if no other graph has nodes
+		// left in them, so the next import is laid out in order. They are kept,
+		// release_allocator_slabs on the node types frees them.
+
+		void clear(void);
 
 		scene_graph_node * get_root(void) const
 		{
@@ -346,6 +407,11 @@ namespace fuse
 			}
 		}
 
+		void clear_impl(scene_graph_node * n,
+			scene_graph_group::allocator_discard_list & groups,
+			scene_graph_geometry::allocator_discard_list & geometry,
+			scene_graph_camera::allocator_discard_list & cameras);
+
 		std::unique_ptr<scene_graph_group> m_root;
 
 	};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <fuse/math.hpp>
+#include <fuse/core/thread_pool.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#define FUSE_TANGENT_SPACE_GRAIN 16384
+
+namespace fuse
+{
+
+	// Per vertex tangents and bitangents following the texture coordinates
+	// (Lengyel, Computing Tangent Space Basis Vectors for an Arbitrary Mesh).
+	// The directions of the triangles are accumulated on their vertices, then
+	// the tangent is orthogonalized against the normal and the bitangent is
+	// rebuilt as cross(normal, tangent) with the handedness of the UVs.
+	// Without texcoords, or where they are degenerate, the basis is derived
+	// from the normal alone. The work is split in chunks on the pool if any.
+
+	void compute_tangent_space(
+		const float3 * positions,
+		const float3 * normals,
+		const float2 * texcoords,
+		const uint32_t * indices,
+		size_t numIndices,
+		size_t numVertices,
+		float3 * tangents,
+		float3 * bitangents,
+		thread_pool * pool = nullptr);
+
+}
\ No newline at end of file
@@ -39,6 +39,8 @@ namespace fuse
 		void   unload_impl(void) override;
 		size_t calculate_size_impl(void) override;
 
+		void   get_dependencies_impl(std::vector<std::shared_ptr<resource>> & dependencies) override;
+
 	private:
 
 		com_ptr<ID3D12Resource> m_buffer;
@@ -30,19 +30,19 @@ namespace fuse
 		FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
 
 		transform_hierarchy(void) :
-			m_globalMatrixUptodate(false),
-			m_globalTranslationRotationMatrixUptodate(false),
-			m_localMatricesUptodate(false),
-			m_globalSRTUptodate(false),
+			m_globalMatrix(mat128_identity()),
+			m_globalTranslationRotationMatrix(mat128_identity()),
+			m_localMatrix(mat128_identity()),
+			m_localTranslation(vec128_zero()),
 			m_localRotation(quat128_identity()),
 			m_localScale(vec128_one()),
-			m_localTranslation(vec128_zero()),
-			m_localMatrix(mat128_identity()),
-			m_globalMatrix(mat128_identity()),
-			m_globalScale(vec128_one()),
-			m_globalRotation(quat128_identity()),
 			m_globalTranslation(vec128_zero()),
-			m_globalTranslationRotationMatrix(mat128_identity()),
+			m_globalRotation(quat128_identity()),
+			m_globalScale(vec128_one()),
+			m_globalMatrixUptodate(false),
+			m_localMatricesUptodate(false),
+			m_globalTranslationRotationMatrixUptodate(false),
+			m_globalSRTUptodate(false),
 			m_moved(true) {}
 
 	public:
@@ -161,6 +161,13 @@ namespace fuse
 			}
 		}
 
+		// The global matrix as it was last computed, before the pending moves
+
+		inline const mat128 & get_previous_global_matrix(void) const
+		{
+			return m_globalMatrix;
+		}
+
 		bool is_global_matrix_uptodate(void) const
 		{
 			return m_globalMatrixUptodate;
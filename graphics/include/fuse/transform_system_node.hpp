@@ -0,0 +1,159 @@
+#pragma once
+
+#include <fuse/math.hpp>
+#include <fuse/geometry.hpp>
+#include <fuse/geometry/transform_system.hpp>
+
+namespace fuse
+{
+
+	/*
+	*
+	* Drop-in replacement for transform_hierarchy that keeps the transform in a
+	* slot of a transform_system instead of storing the matrices in the node.
+	* Nodes are created in the system of their parent, global matrices are
+	* computed for the whole system at once when the first one is requested.
+	*
+	*/
+
+	class transform_system_node
+	{
+
+	public:
+
+		transform_system_node(transform_system_node * parent) :
+			m_system(parent ? parent->m_system : &get_default_system()),
+			m_transform(m_system->create(parent ? parent->m_transform : FUSE_TRANSFORM_INVALID_HANDLE)) {}
+
+		transform_system_node(const transform_system_node &) = delete;
+
+		~transform_system_node(void)
+		{
+			m_system->destroy(m_transform);
+		}
+
+		transform_system_node & operator= (const transform_system_node &) = delete;
+
+		inline const mat128 & get_global_matrix(void)
+		{
+			m_system->update();
+			return m_system->get_world_matrix(m_transform);
+		}
+
+		inline void set_local_translation(const float3 & t)
+		{
+			set_local_translation(to_vec128(t));
+		}
+
+		inline void set_local_rotation(const quaternion & q)
+		{
+			set_local_rotation(to_quat128(q));
+		}
+
+		inline void set_local_scale(const float3 & s)
+		{
+			set_local_scale(to_vec128(s));
+		}
+
+		inline void FUSE_VECTOR_CALL set_local_translation(vec128 t)
+		{
+			m_system->set_local_translation(m_transform, t);
+		}
+
+		inline void FUSE_VECTOR_CALL set_local_rotation(vec128 r)
+		{
+			m_system->set_local_rotation(m_transform, r);
+		}
+
+		inline void FUSE_VECTOR_CALL set_local_scale(vec128 s)
+		{
+			m_system->set_local_scale(m_transform, s);
+		}
+
+		inline vec128 get_local_translation(void) const
+		{
+			return m_system->get_local_translation(m_transform);
+		}
+
+		inline vec128 get_local_rotation(void) const
+		{
+			return m_system->get_local_rotation(m_transform);
+		}
+
+		inline vec128 get_local_scale(void) const
+		{
+			return m_system->get_local_scale(m_transform);
+		}
+
+		inline vec128 get_global_translation(void)
+		{
+			vec128 s, r, t;
+			get_global_srt(&s, &r, &t);
+			return t;
+		}
+
+		inline vec128 get_global_rotation(void)
+		{
+			vec128 s, r, t;
+			get_global_srt(&s, &r, &t);
+			return r;
+		}
+
+		inline vec128 get_global_scale(void)
+		{
+			vec128 s, r, t;
+			get_global_srt(&s, &r, &t);
+			return s;
+		}
+
+		inline transform_system * get_transform_system(void) const
+		{
+			return m_system;
+		}
+
+		inline transform_handle get_transform_handle(void) const
+		{
+			return m_transform;
+		}
+
+		static transform_system & get_default_system(void);
+
+	protected:
+
+		inline void get_global_srt(vec128 * scale, vec128 * rotation, vec128 * translation)
+		{
+			m_system->update();
+			m_system->get_world_srt(m_transform, scale, rotation, translation);
+		}
+
+		// The global matrix before the moves that happened since the last set_moved(false)
+
+		inline const mat128 & get_previous_global_matrix(void) const
+		{
+			return m_system->get_previous_world_matrix(m_transform);
+		}
+
+		inline bool was_moved(void)
+		{
+			m_system->update();
+			return m_system->was_moved(m_transform);
+		}
+
+		inline void set_moved(bool moved)
+		{
+			m_system->set_moved(m_transform, moved);
+		}
+
+		inline void switch_parent(transform_system_node * parent)
+		{
+			m_system->set_parent(m_transform, parent ? parent->m_transform : FUSE_TRANSFORM_INVALID_HANDLE);
+		}
+
+	private:
+
+		transform_system * m_system;
+		transform_handle   m_transform;
+
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <fuse/math.hpp>
+
+#include <cstdint>
+
+namespace fuse
+{
+
+	// Position quantized to 16 bits inside the mesh bounding box, w is 0 or
+	// 0xFFFF for a negative or positive bitangent sign (R16G16B16A16_UNORM)
+
+	struct compressed_position
+	{
+		uint16_t x;
+		uint16_t y;
+		uint16_t z;
+		uint16_t w;
+	};
+
+	// Unit vectors mapped on the octahedron and unfolded on a square, stored as
+	// two snorm16 (Cigolle et al., A Survey of Efficient Representations for
+	// Independent Unit Vectors)
+
+	void   octahedral_encode(const float3 & v, int16_t * encoded);
+	float3 octahedral_decode(const int16_t * encoded);
+
+	// IEEE 754 half precision, rounded to the nearest even
+
+	uint16_t half_encode(float x);
+	float    half_decode(uint16_t h);
+
+	uint16_t unorm16_encode(float x);
+	float    unorm16_decode(uint16_t x);
+
+	// Interleaved attributes of the compressed meshes, in this order: normal and
+	// tangent (octahedral, 4 bytes each), the texcoords sets (half2, 4 bytes each).
+	// The bitangents are rebuilt from the sign in compressed_position::w.
+
+	uint32_t get_compressed_attributes_stride(uint32_t storageFlags);
+
+}
\ No newline at end of file
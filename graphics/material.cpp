@@ -1,4 +1,7 @@
 #include <fuse/material.hpp>
+#include <fuse/resource_factory.hpp>
+#include <fuse/resource_types.hpp>
+#include <fuse/texture.hpp>
 
 using namespace fuse;
 
@@ -23,6 +26,24 @@ size_t material::calculate_size_impl(void)
 	return 1;
 }
 
+void material::get_dependencies_impl(std::vector<std::shared_ptr<resource>> & dependencies)
+{
+
+	// The loaders set the texture paths when creating the material, embedded textures
+	// (named "*<index>") have no file to load
+
+	const std::string * textures[] = { &m_diffuseTexture, &m_specularTexture, &m_normalMap };
+
+	for (const std::string * path : textures)
+	{
+		if (!path->empty() && (*path)[0] != '*')
+		{
+			dependencies.push_back(resource_factory::get_singleton_pointer()->create<texture>(FUSE_RESOURCE_TYPE_TEXTURE, to_string_t(*path).c_str()));
+		}
+	}
+
+}
+
 void material::set_default(void)
 {
 
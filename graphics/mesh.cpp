@@ -1,9 +1,25 @@
 #include <fuse/mesh.hpp>
+#include <fuse/fmesh.hpp>
+#include <fuse/mesh_optimizer.hpp>
+#include <fuse/mesh_simplifier.hpp>
+#include <fuse/tangent_space.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 
 using namespace fuse;
 
+mesh::mesh(void)
+{
+	clear();
+}
+
 mesh::mesh(const char_t * name, resource_loader * loader, resource_manager * owner) :
-	resource(name, loader, owner) { }
+	resource(name, loader, owner)
+{
+	clear();
+}
 
 mesh::~mesh(void)
 {
@@ -22,19 +38,25 @@ bool mesh::create(size_t vertices, size_t triangles, unsigned int storage_semant
 	m_indices.resize(m_numTriangles);
 	m_vertices.resize(m_numVertices);
 
+	m_indicesStream  = m_indices.data();
+	m_verticesStream = m_vertices.data();
+
 	if (has_storage_semantic(FUSE_MESH_STORAGE_NORMALS))
 	{
 		m_normals.resize(m_numVertices);
+		m_normalsStream = m_normals.data();
 	}
 
 	if (has_storage_semantic(FUSE_MESH_STORAGE_TANGENTS))
 	{
 		m_tangents.resize(m_numVertices);
+		m_tangentsStream = m_tangents.data();
 	}
 
 	if (has_storage_semantic(FUSE_MESH_STORAGE_BITANGENTS))
 	{
 		m_bitangents.resize(m_numVertices);
+		m_bitangentsStream = m_bitangents.data();
 	}
 
 	for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
@@ -45,6 +67,7 @@ bool mesh::create(size_t vertices, size_t triangles, unsigned int storage_semant
 		if (has_storage_semantic(static_cast<mesh_storage_semantic>(texcoordSemantic)))
 		{
 			m_texcoords[i].resize(m_numVertices);
+			m_texcoordsStream[i] = m_texcoords[i].data();
 		}
 
 	}
@@ -80,9 +103,9 @@ uint32_t mesh::get_parameters_storage_semantic_flags(void)
 	return flags;
 }
 
-bool mesh::calculate_tangent_space(void)
+bool mesh::calculate_tangent_space(thread_pool * pool)
 {
-	if (!has_storage_semantic(FUSE_MESH_STORAGE_NORMALS))
+	if (m_compressed || !has_storage_semantic(FUSE_MESH_STORAGE_NORMALS))
 	{
 		return false;
 	}
@@ -90,37 +113,506 @@ bool mesh::calculate_tangent_space(void)
 	add_storage_semantic(FUSE_MESH_STORAGE_TANGENTS);
 	add_storage_semantic(FUSE_MESH_STORAGE_BITANGENTS);
 
-	//if (!has_storage_semantic(FUSE_MESH_STORAGE_TEXCOORDS0))
+	compute_tangent_space(
+		m_verticesStream,
+		m_normalsStream,
+		m_texcoordsStream[0],
+		get_indices(),
+		get_num_indices(),
+		m_numVertices,
+		m_tangentsStream,
+		m_bitangentsStream,
+		pool);
+
+	return true;
+}
+
+template <typename T>
+static void remap_stream(T * stream, const uint32_t * remap, size_t n)
+{
+	if (stream)
 	{
+		std::vector<T> source(stream, stream + n);
 
-		for (int i = 0; i < m_numVertices; i++)
+		for (size_t i = 0; i < n; i++)
 		{
-			float absNx = fabs(m_normals[i].x);
+			stream[remap[i]] = source[i];
+		}
+	}
+}
+
+bool mesh::optimize(bool overdraw)
+{
+	uint32_t * indices = get_indices();
+
+	if (!indices || m_compressed)
+	{
+		return false;
+	}
+
+	optimize_vertex_cache(indices, get_num_indices(), m_numVertices);
+
+	if (overdraw)
+	{
+		optimize_overdraw(indices, get_num_indices(), m_verticesStream, m_numVertices);
+	}
+
+	std::vector<uint32_t> remap(m_numVertices);
+
+	optimize_vertex_fetch_remap(remap.data(), indices, get_num_indices(), m_numVertices);
+
+	// The LODs follow the vertex order of the mesh
+
+	for (uint32_t i = 0; i < m_numLodIndices; i++)
+	{
+		m_lodIndicesStream[i] = remap[m_lodIndicesStream[i]];
+	}
+
+	for (const mesh_lod & lod : m_lods)
+	{
+		optimize_vertex_cache(m_lodIndicesStream + (lod.firstIndex - get_num_indices()), lod.numIndices, m_numVertices);
+	}
+
+	remap_stream(m_verticesStream, remap.data(), m_numVertices);
+	remap_stream(m_normalsStream, remap.data(), m_numVertices);
+	remap_stream(m_tangentsStream, remap.data(), m_numVertices);
+	remap_stream(m_bitangentsStream, remap.data(), m_numVertices);
+
+	for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
+	{
+		remap_stream(m_texcoordsStream[i], remap.data(), m_numVertices);
+	}
+
+	// The clusters are ranges of the triangles just reordered
+
+	if (!m_clusters.empty())
+	{
+		build_clusters();
+	}
+
+	return true;
+}
+
+/* LODs */
+
+bool mesh::generate_lods(uint32_t maxLods, float reduction, float maxError)
+{
+	uint32_t * indices = get_indices();
+
+	if (!indices || m_compressed)
+	{
+		return false;
+	}
+
+	clear_lods();
 
-			float3 v = { absNx > .99f ? 0.f : 1.f, absNx > .99f ? 1.f : 0.f, 0.f };
+	float scale = simplify_scale(m_verticesStream, m_numVertices);
 
-			vec128 N = to_vec128(m_normals[i]);
-			vec128 T = to_vec128(v);
-			vec128 B = vec128_cross(N, T);
+	// Each LOD simplifies the previous one, so their errors add up
 
-			T = vec128_cross(N, B);
+	std::vector<uint32_t> source(indices, indices + get_num_indices());
+	mesh_vector<uint32_t> lodIndices;
 
-			m_tangents[i]   = to_float3(T);
-			m_bitangents[i] = to_float3(B);
+	float error = 0.f;
+
+	for (uint32_t i = 0; i < maxLods && error < maxError; i++)
+	{
+		size_t target = static_cast<size_t>(source.size() * reduction) / 3 * 3;
+
+		std::vector<uint32_t> lod(source.size());
+
+		float  lodError;
+		size_t numIndices = simplify(lod.data(), source.data(), source.size(), m_verticesStream, m_numVertices, target, maxError - error, &lodError);
+
+		// Not worth a LOD if the mesh barely got simpler
+
+		if (!numIndices || numIndices > source.size() - (source.size() - target) / 2)
+		{
+			break;
 		}
 
+		lod.resize(numIndices);
+
+		optimize_vertex_cache(lod.data(), lod.size(), m_numVertices);
+
+		error += lodError;
+
+		mesh_lod entry = {
+			static_cast<uint32_t>(get_num_indices() + lodIndices.size()),
+			static_cast<uint32_t>(numIndices),
+			error * scale
+		};
+
+		m_lods.push_back(entry);
+
+		lodIndices.insert(lodIndices.end(), lod.begin(), lod.end());
+		source.swap(lod);
 	}
-	//else
+
+	m_lodIndices.swap(lodIndices);
+
+	m_lodIndicesStream = m_lodIndices.empty() ? nullptr : m_lodIndices.data();
+	m_numLodIndices    = static_cast<uint32_t>(m_lodIndices.size());
+
+	recalculate_size();
+
+	return !m_lods.empty();
+}
+
+void mesh::clear_lods(void)
+{
+	m_lodIndices.clear();
+	m_lodIndices.shrink_to_fit();
+
+	m_lods.clear();
+
+	m_lodIndicesStream = nullptr;
+	m_numLodIndices    = 0;
+}
+
+mesh_lod mesh::get_lod(uint32_t lod) const
+{
+	if (lod == 0 || m_lods.empty())
 	{
+		mesh_lod base = { 0, get_num_indices(), 0.f };
+		return base;
+	}
 
-		//throw;
-		// Tangent space with texcoord
+	return m_lods[std::min<size_t>(lod, m_lods.size()) - 1];
+}
 
+const uint32_t * mesh::get_lod_indices(uint32_t lod) const
+{
+	return lod == 0 || m_lods.empty() ?
+		get_indices() :
+		m_lodIndicesStream + (get_lod(lod).firstIndex - get_num_indices());
+}
+
+void mesh::copy_mapped_indices(void)
+{
+	if (m_indicesStream != m_indices.data())
+	{
+		m_indices.assign(m_indicesStream, m_indicesStream + m_numTriangles);
+		m_indicesStream = m_indices.data();
+	}
+
+	if (m_lodIndicesStream && m_lodIndicesStream != m_lodIndices.data())
+	{
+		m_lodIndices.assign(m_lodIndicesStream, m_lodIndicesStream + m_numLodIndices);
+		m_lodIndicesStream = m_lodIndices.data();
 	}
+}
+
+/* Clusters */
+
+bool mesh::build_clusters(void)
+{
+	uint32_t * indices = get_indices();
+
+	if (!indices || m_compressed)
+	{
+		return false;
+	}
+
+	fuse::build_clusters(indices, get_num_indices(), m_verticesStream, m_numVertices, m_clusters);
+
+	recalculate_size();
+
+	return !m_clusters.empty();
+}
+
+void mesh::clear_clusters(void)
+{
+	m_clusters.clear();
+	m_clusters.shrink_to_fit();
+}
+
+/* Compression */
+
+template <typename T, typename Allocator>
+static inline void release_vector(std::vector<T, Allocator> & v)
+{
+	std::vector<T, Allocator>().swap(v);
+}
+
+// Offset of an attribute in the compressed interleaved stream, the ones
+// with a lower semantic come first
+
+static inline uint32_t get_compressed_attribute_offset(uint32_t storageFlags, uint32_t semantic)
+{
+	return get_compressed_attributes_stride(storageFlags & (semantic - 1));
+}
+
+bool mesh::compress(void)
+{
+	bool normals    = has_storage_semantic(FUSE_MESH_STORAGE_NORMALS);
+	bool tangents   = has_storage_semantic(FUSE_MESH_STORAGE_TANGENTS);
+	bool bitangents = has_storage_semantic(FUSE_MESH_STORAGE_BITANGENTS);
+
+	// Bitangents are rebuilt from the normals and the tangents
+
+	if (m_compressed || !m_verticesStream || (bitangents && !(normals && tangents)))
+	{
+		return false;
+	}
+
+	float3 minimum = m_numVertices ? m_verticesStream[0] : float3(0, 0, 0);
+	float3 maximum = minimum;
+
+	for (uint32_t v = 1; v < m_numVertices; v++)
+	{
+		const float3 & p = m_verticesStream[v];
+
+		minimum = float3(std::min(minimum.x, p.x), std::min(minimum.y, p.y), std::min(minimum.z, p.z));
+		maximum = float3(std::max(maximum.x, p.x), std::max(maximum.y, p.y), std::max(maximum.z, p.z));
+	}
+
+	float3 scale = maximum - minimum;
+	float3 invScale(
+		scale.x > 0.f ? 1.f / scale.x : 0.f,
+		scale.y > 0.f ? 1.f / scale.y : 0.f,
+		scale.z > 0.f ? 1.f / scale.z : 0.f);
+
+	uint32_t stride = get_compressed_attributes_stride();
+
+	mesh_vector<compressed_position> positions(m_numVertices);
+	mesh_vector<uint8_t>             attributes(static_cast<size_t>(stride) * m_numVertices);
+
+	for (uint32_t v = 0; v < m_numVertices; v++)
+	{
+		const float3 & p = m_verticesStream[v];
+
+		compressed_position & q = positions[v];
+
+		q.x = unorm16_encode((p.x - minimum.x) * invScale.x);
+		q.y = unorm16_encode((p.y - minimum.y) * invScale.y);
+		q.z = unorm16_encode((p.z - minimum.z) * invScale.z);
+		q.w = 0xFFFF;
+
+		uint8_t * a = attributes.data() + static_cast<size_t>(stride) * v;
+
+		int16_t encoded[2];
+
+		if (normals)
+		{
+			octahedral_encode(m_normalsStream[v], encoded);
+			std::memcpy(a, encoded, sizeof(encoded));
+			a += sizeof(encoded);
+		}
+
+		if (tangents)
+		{
+			octahedral_encode(m_tangentsStream[v], encoded);
+			std::memcpy(a, encoded, sizeof(encoded));
+			a += sizeof(encoded);
+		}
+
+		if (bitangents && dot(cross(m_normalsStream[v], m_tangentsStream[v]), m_bitangentsStream[v]) < 0.f)
+		{
+			q.w = 0;
+		}
+
+		for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
+		{
+			if (m_texcoordsStream[i])
+			{
+				uint16_t h[2] = { half_encode(m_texcoordsStream[i][v].x), half_encode(m_texcoordsStream[i][v].y) };
+				std::memcpy(a, h, sizeof(h));
+				a += sizeof(h);
+			}
+		}
+	}
+
+	// The indices can be in the file mapping released below
+
+	copy_mapped_indices();
+
+	release_vector(m_vertices);
+	release_vector(m_normals);
+	release_vector(m_tangents);
+	release_vector(m_bitangents);
+
+	for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
+	{
+		release_vector(m_texcoords[i]);
+		m_texcoordsStream[i] = nullptr;
+	}
+
+	m_verticesStream   = nullptr;
+	m_normalsStream    = nullptr;
+	m_tangentsStream   = nullptr;
+	m_bitangentsStream = nullptr;
+
+	m_file.close();
+
+	m_compressedPositions.swap(positions);
+	m_compressedAttributes.swap(attributes);
+
+	m_compressedPositionsStream  = m_compressedPositions.data();
+	m_compressedAttributesStream = m_compressedAttributes.data();
+
+	m_positionScale  = scale;
+	m_positionOffset = minimum;
+
+	m_compressed = true;
+
+	recalculate_size();
+
+	return true;
+}
+
+bool mesh::decompress(void)
+{
+	if (!m_compressed)
+	{
+		return false;
+	}
+
+	mesh_vector<float3> vertices(m_numVertices);
+	mesh_vector<float3> normals(has_storage_semantic(FUSE_MESH_STORAGE_NORMALS) ? m_numVertices : 0);
+	mesh_vector<float3> tangents(has_storage_semantic(FUSE_MESH_STORAGE_TANGENTS) ? m_numVertices : 0);
+	mesh_vector<float3> bitangents(has_storage_semantic(FUSE_MESH_STORAGE_BITANGENTS) ? m_numVertices : 0);
+	mesh_vector<float2> texcoords[FUSE_MESH_MAX_TEXCOORDS];
+
+	for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
+	{
+		if (m_storageFlags & (FUSE_MESH_STORAGE_TEXCOORDS0 << i))
+		{
+			texcoords[i].resize(m_numVertices);
+		}
+	}
+
+	for (uint32_t v = 0; v < m_numVertices; v++)
+	{
+		vertices[v] = decode_position(v);
+
+		if (!normals.empty())    normals[v]    = decode_normal(v);
+		if (!tangents.empty())   tangents[v]   = decode_tangent(v);
+		if (!bitangents.empty()) bitangents[v] = decode_bitangent(v);
+
+		for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
+		{
+			if (!texcoords[i].empty())
+			{
+				texcoords[i][v] = decode_texcoord(i, v);
+			}
+		}
+	}
+
+	copy_mapped_indices();
+
+	release_vector(m_compressedPositions);
+	release_vector(m_compressedAttributes);
+
+	m_compressedPositionsStream  = nullptr;
+	m_compressedAttributesStream = nullptr;
+
+	m_file.close();
+
+	m_vertices.swap(vertices);
+	m_normals.swap(normals);
+	m_tangents.swap(tangents);
+	m_bitangents.swap(bitangents);
+
+	m_verticesStream   = m_vertices.data();
+	m_normalsStream    = m_normals.empty() ? nullptr : m_normals.data();
+	m_tangentsStream   = m_tangents.empty() ? nullptr : m_tangents.data();
+	m_bitangentsStream = m_bitangents.empty() ? nullptr : m_bitangents.data();
+
+	for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
+	{
+		m_texcoords[i].swap(texcoords[i]);
+		m_texcoordsStream[i] = m_texcoords[i].empty() ? nullptr : m_texcoords[i].data();
+	}
+
+	m_positionScale  = float3(1, 1, 1);
+	m_positionOffset = float3(0, 0, 0);
+
+	m_compressed = false;
+
+	recalculate_size();
 
 	return true;
 }
 
+float3 mesh::decode_position(uint32_t vertex) const
+{
+	if (!m_compressed)
+	{
+		return m_verticesStream[vertex];
+	}
+
+	const compressed_position & q = m_compressedPositionsStream[vertex];
+
+	return float3(
+		unorm16_decode(q.x) * m_positionScale.x + m_positionOffset.x,
+		unorm16_decode(q.y) * m_positionScale.y + m_positionOffset.y,
+		unorm16_decode(q.z) * m_positionScale.z + m_positionOffset.z);
+}
+
+float3 mesh::decode_normal(uint32_t vertex) const
+{
+	if (!m_compressed)
+	{
+		return m_normalsStream[vertex];
+	}
+
+	int16_t encoded[2];
+
+	std::memcpy(encoded,
+		m_compressedAttributesStream + static_cast<size_t>(get_compressed_attributes_stride()) * vertex +
+		get_compressed_attribute_offset(m_storageFlags, FUSE_MESH_STORAGE_NORMALS),
+		sizeof(encoded));
+
+	return octahedral_decode(encoded);
+}
+
+float3 mesh::decode_tangent(uint32_t vertex) const
+{
+	if (!m_compressed)
+	{
+		return m_tangentsStream[vertex];
+	}
+
+	int16_t encoded[2];
+
+	std::memcpy(encoded,
+		m_compressedAttributesStream + static_cast<size_t>(get_compressed_attributes_stride()) * vertex +
+		get_compressed_attribute_offset(m_storageFlags, FUSE_MESH_STORAGE_TANGENTS),
+		sizeof(encoded));
+
+	return octahedral_decode(encoded);
+}
+
+float3 mesh::decode_bitangent(uint32_t vertex) const
+{
+	if (!m_compressed)
+	{
+		return m_bitangentsStream[vertex];
+	}
+
+	float sign = m_compressedPositionsStream[vertex].w ? 1.f : -1.f;
+
+	return cross(decode_normal(vertex), decode_tangent(vertex)) * sign;
+}
+
+float2 mesh::decode_texcoord(int i, uint32_t vertex) const
+{
+	if (!m_compressed)
+	{
+		return m_texcoordsStream[i][vertex];
+	}
+
+	uint16_t h[2];
+
+	std::memcpy(h,
+		m_compressedAttributesStream + static_cast<size_t>(get_compressed_attributes_stride()) * vertex +
+		get_compressed_attribute_offset(m_storageFlags, FUSE_MESH_STORAGE_TEXCOORDS0 << i),
+		sizeof(h));
+
+	return float2(half_decode(h[0]), half_decode(h[1]));
+}
+
 void mesh::clear(void)
 {
 	m_vertices.clear();
@@ -139,30 +631,61 @@ void mesh::clear(void)
 	{
 		m_texcoords[i].clear();
 		m_texcoords[i].shrink_to_fit();
+
+		m_texcoordsStream[i] = nullptr;
 	}
 
+	m_indices.clear();
+	m_indices.shrink_to_fit();
+
+	clear_lods();
+	clear_clusters();
+
+	m_verticesStream   = nullptr;
+	m_normalsStream    = nullptr;
+	m_tangentsStream   = nullptr;
+	m_bitangentsStream = nullptr;
+	m_indicesStream    = nullptr;
+
+	release_vector(m_compressedPositions);
+	release_vector(m_compressedAttributes);
+
+	m_compressedPositionsStream  = nullptr;
+	m_compressedAttributesStream = nullptr;
+
+	m_positionScale  = float3(1, 1, 1);
+	m_positionOffset = float3(0, 0, 0);
+
+	m_compressed = false;
+
+	m_file.close();
+
 	m_numVertices  = m_numTriangles = 0;
 	m_storageFlags = 0;
 }
 
 bool mesh::load_impl(void)
 {
-	// TODO: Implement own mesh file format loader
-	return false;
+	return load_fmesh(get_name());
 }
 
 void mesh::unload_impl(void)
 {
-
+	clear();
 }
 
 size_t mesh::calculate_size_impl(void)
 {
-	size_t indicesSize   = m_numTriangles * 3 * sizeof(uint32_t);
+	size_t indicesSize   = get_total_num_indices() * sizeof(uint32_t) + m_clusters.size() * sizeof(mesh_cluster);
 	size_t verticesSize  = m_numVertices * 3 * sizeof(float);
 	size_t texcoordsSize = m_numVertices * 2 * sizeof(float);
 
-	int texcoordsMultiplier = 1;
+	if (m_compressed)
+	{
+		return m_numVertices * (sizeof(compressed_position) + get_compressed_attributes_stride()) + indicesSize;
+	}
+
+	int texcoordsMultiplier = 0;
 	int verticesMultiplier  = 1;
 
 	if (has_storage_semantic(FUSE_MESH_STORAGE_NORMALS))
@@ -199,7 +722,7 @@ size_t mesh::calculate_size_impl(void)
 
 bool mesh::add_storage_semantic(mesh_storage_semantic semantic)
 {
-	if (has_storage_semantic(semantic))
+	if (m_compressed || has_storage_semantic(semantic))
 	{
 		return false;
 	}
@@ -214,18 +737,21 @@ bool mesh::add_storage_semantic(mesh_storage_semantic semantic)
 	case FUSE_MESH_STORAGE_NORMALS:
 		{
 			m_normals.resize(m_numVertices);
+			m_normalsStream = m_normals.data();
 			return true;
 		}
 
 	case FUSE_MESH_STORAGE_TANGENTS:
 		{
 			m_tangents.resize(m_numVertices);
+			m_tangentsStream = m_tangents.data();
 			return true;
 		}
 
 	case FUSE_MESH_STORAGE_BITANGENTS:
 		{
 			m_bitangents.resize(m_numVertices);
+			m_bitangentsStream = m_bitangents.data();
 			return true;
 		}
 
@@ -240,6 +766,7 @@ bool mesh::add_storage_semantic(mesh_storage_semantic semantic)
 		if (semantic == texcoordSemantic)
 		{
 			m_texcoords[i].resize(m_numVertices);
+			m_texcoordsStream[i] = m_texcoords[i].data();
 			return true;
 		}
 
@@ -250,7 +777,7 @@ bool mesh::add_storage_semantic(mesh_storage_semantic semantic)
 
 bool mesh::remove_storage_semantic(mesh_storage_semantic semantic)
 {
-	if (!has_storage_semantic(semantic))
+	if (m_compressed || !has_storage_semantic(semantic))
 	{
 		return false;
 	}
@@ -266,6 +793,7 @@ bool mesh::remove_storage_semantic(mesh_storage_semantic semantic)
 	{
 		m_normals.clear();
 		m_normals.shrink_to_fit();
+		m_normalsStream = nullptr;
 		return true;
 	}
 
@@ -273,6 +801,7 @@ bool mesh::remove_storage_semantic(mesh_storage_semantic semantic)
 	{
 		m_tangents.clear();
 		m_tangents.shrink_to_fit();
+		m_tangentsStream = nullptr;
 		return true;
 	}
 
@@ -280,6 +809,7 @@ bool mesh::remove_storage_semantic(mesh_storage_semantic semantic)
 	{
 		m_bitangents.clear();
 		m_bitangents.shrink_to_fit();
+		m_bitangentsStream = nullptr;
 		return true;
 	}
 
@@ -295,10 +825,459 @@ bool mesh::remove_storage_semantic(mesh_storage_semantic semantic)
 		{
 			m_texcoords[i].clear();
 			m_texcoords[i].shrink_to_fit();
+			m_texcoordsStream[i] = nullptr;
 			return true;
 		}
 
 	}
 
 	return false;
+}
+
+/* .fmesh */
+
+static inline uint64_t fmesh_align(uint64_t offset)
+{
+	return (offset + FUSE_FMESH_ALIGNMENT - 1) & ~static_cast<uint64_t>(FUSE_FMESH_ALIGNMENT - 1);
+}
+
+static inline uint32_t fmesh_stride(uint32_t semantic, uint32_t storageFlags)
+{
+	switch (semantic)
+	{
+	case FUSE_MESH_STORAGE_NONE:
+	case FUSE_MESH_STORAGE_NORMALS:
+	case FUSE_MESH_STORAGE_TANGENTS:
+	case FUSE_MESH_STORAGE_BITANGENTS:
+		return sizeof(float3);
+	case FUSE_FMESH_STREAM_COMPRESSED_POSITIONS:
+		return sizeof(compressed_position);
+	case FUSE_FMESH_STREAM_COMPRESSED_ATTRIBUTES:
+		return get_compressed_attributes_stride(storageFlags);
+	default:
+		return semantic >= FUSE_MESH_STORAGE_TEXCOORDS0 && (semantic & (semantic - 1)) == 0 ? sizeof(float2) : 0;
+	}
+}
+
+bool mesh::load_fmesh(const char_t * filename)
+{
+
+	clear();
+
+	mapped_file file;
+
+	if (!file.open(filename) || file.get_size() < sizeof(fmesh_header))
+	{
+		FUSE_LOG_OPT_DEBUG(stringstream_t() << "Unable to open mesh file \"" << filename << "\".");
+		return false;
+	}
+
+	const uint8_t      * data   = file.get_data();
+	const fmesh_header * header = reinterpret_cast<const fmesh_header *>(data);
+
+	bool compressed = (header->flags & FUSE_FMESH_FLAG_COMPRESSED) != 0;
+	bool lods       = (header->flags & FUSE_FMESH_FLAG_LODS) != 0;
+	bool clusters   = (header->flags & FUSE_FMESH_FLAG_CLUSTERS) != 0;
+
+	uint64_t size          = file.get_size();
+	uint64_t lodsBegin     = sizeof(fmesh_header) + (compressed ? sizeof(fmesh_quantization) : 0);
+	uint64_t clustersBegin = lodsBegin + (lods ? sizeof(fmesh_lods) : 0);
+
+	const fmesh_lods * lodsHeader = lods && clustersBegin <= size ? reinterpret_cast<const fmesh_lods *>(data + lodsBegin) : nullptr;
+
+	if (lodsHeader)
+	{
+		clustersBegin += static_cast<uint64_t>(lodsHeader->numLods) * sizeof(fmesh_lod);
+	}
+
+	uint64_t streamsBegin = clustersBegin + (clusters ? sizeof(fmesh_clusters) : 0);
+
+	const fmesh_clusters * clustersHeader = clusters && streamsBegin <= size ? reinterpret_cast<const fmesh_clusters *>(data + clustersBegin) : nullptr;
+
+	if (clustersHeader)
+	{
+		streamsBegin += static_cast<uint64_t>(clustersHeader->numClusters) * sizeof(fmesh_cluster);
+	}
+
+	uint64_t streamsEnd     = streamsBegin + static_cast<uint64_t>(header->numStreams) * sizeof(fmesh_stream);
+	uint64_t numIndices     = static_cast<uint64_t>(header->numTriangles) * 3;
+	uint64_t indicesSize    = numIndices * header->indexSize;
+	uint64_t lodIndicesSize = lodsHeader ? static_cast<uint64_t>(lodsHeader->numIndices) * header->indexSize : 0;
+
+	if (header->magic != FUSE_FMESH_MAGIC ||
+		header->version < 1 || header->version > FUSE_FMESH_VERSION ||
+		(compressed && header->version < 2) ||
+		(lods && (header->version < 3 || !lodsHeader)) ||
+		(clusters && (header->version < 4 || !clustersHeader)) ||
+		(header->indexSize != 2 && header->indexSize != 4) ||
+		streamsEnd > size ||
+		header->indicesOffset % FUSE_FMESH_ALIGNMENT ||
+		header->indicesOffset + indicesSize > size ||
+		(lodsHeader && (lodsHeader->indicesOffset % FUSE_FMESH_ALIGNMENT || lodsHeader->indicesOffset + lodIndicesSize > size)))
+	{
+		FUSE_LOG_OPT_DEBUG(stringstream_t() << "Invalid mesh file \"" << filename << "\".");
+		return false;
+	}
+
+	const fmesh_lod * lodTable = lodsHeader ? reinterpret_cast<const fmesh_lod *>(data + lodsBegin + sizeof(fmesh_lods)) : nullptr;
+
+	for (uint32_t i = 0; lodsHeader && i < lodsHeader->numLods; i++)
+	{
+		if (lodTable[i].firstIndex < numIndices ||
+			lodTable[i].numIndices % 3 ||
+			lodTable[i].firstIndex + static_cast<uint64_t>(lodTable[i].numIndices) > numIndices + lodsHeader->numIndices)
+		{
+			FUSE_LOG_OPT_DEBUG(stringstream_t() << "Invalid LOD in mesh file \"" << filename << "\".");
+			return false;
+		}
+	}
+
+	const fmesh_cluster * clusterTable = clustersHeader ? reinterpret_cast<const fmesh_cluster *>(data + clustersBegin + sizeof(fmesh_clusters)) : nullptr;
+
+	for (uint32_t i = 0; clustersHeader && i < clustersHeader->numClusters; i++)
+	{
+		if (clusterTable[i].firstIndex % 3 ||
+			clusterTable[i].numIndices % 3 ||
+			clusterTable[i].firstIndex + static_cast<uint64_t>(clusterTable[i].numIndices) > numIndices)
+		{
+			FUSE_LOG_OPT_DEBUG(stringstream_t() << "Invalid cluster in mesh file \"" << filename << "\".");
+			return false;
+		}
+	}
+
+	const fmesh_stream * streams = reinterpret_cast<const fmesh_stream *>(data + streamsBegin);
+
+	uint32_t foundFlags = 0;
+	bool     positions  = false;
+
+	for (uint32_t i = 0; i < header->numStreams; i++)
+	{
+
+		const fmesh_stream & stream = streams[i];
+
+		uint32_t stride = fmesh_stride(stream.semantic, header->storageFlags);
+
+		bool compressedStream =
+			stream.semantic == FUSE_FMESH_STREAM_COMPRESSED_POSITIONS ||
+			stream.semantic == FUSE_FMESH_STREAM_COMPRESSED_ATTRIBUTES;
+
+		if (!stride ||
+			compressedStream != compressed ||
+			stream.stride != stride ||
+			stream.offset % FUSE_FMESH_ALIGNMENT ||
+			stream.offset + static_cast<uint64_t>(stride) * header->numVertices > size)
+		{
+			FUSE_LOG_OPT_DEBUG(stringstream_t() << "Invalid stream in mesh file \"" << filename << "\".");
+			clear();
+			return false;
+		}
+
+		uint8_t * streamData = file.get_data() + stream.offset;
+
+		switch (stream.semantic)
+		{
+		case FUSE_MESH_STORAGE_NONE:
+			m_verticesStream = reinterpret_cast<float3 *>(streamData);
+			positions = true;
+			break;
+		case FUSE_MESH_STORAGE_NORMALS:
+			m_normalsStream = reinterpret_cast<float3 *>(streamData);
+			break;
+		case FUSE_MESH_STORAGE_TANGENTS:
+			m_tangentsStream = reinterpret_cast<float3 *>(streamData);
+			break;
+		case FUSE_MESH_STORAGE_BITANGENTS:
+			m_bitangentsStream = reinterpret_cast<float3 *>(streamData);
+			break;
+		case FUSE_FMESH_STREAM_COMPRESSED_POSITIONS:
+			m_compressedPositionsStream = reinterpret_cast<compressed_position *>(streamData);
+			positions = true;
+			break;
+		case FUSE_FMESH_STREAM_COMPRESSED_ATTRIBUTES:
+			m_compressedAttributesStream = streamData;
+			break;
+		default:
+			for (int t = 0; t < FUSE_MESH_MAX_TEXCOORDS; t++)
+			{
+				if (stream.semantic == (FUSE_MESH_STORAGE_TEXCOORDS0 << t))
+				{
+					m_texcoordsStream[t] = reinterpret_cast<float2 *>(streamData);
+				}
+			}
+			break;
+		}
+
+		if (!compressedStream)
+		{
+			foundFlags |= stream.semantic;
+		}
+
+	}
+
+	// The attributes of a compressed mesh are all in one stream, if it has any
+
+	if (compressed)
+	{
+		foundFlags = m_compressedAttributesStream || !fuse::get_compressed_attributes_stride(header->storageFlags) ?
+			header->storageFlags : 0;
+	}
+
+	if (!positions || foundFlags != header->storageFlags)
+	{
+		FUSE_LOG_OPT_DEBUG(stringstream_t() << "Missing streams in mesh file \"" << filename << "\".");
+		clear();
+		return false;
+	}
+
+	m_numVertices  = header->numVertices;
+	m_numTriangles = header->numTriangles;
+	m_storageFlags = header->storageFlags;
+
+	if (compressed)
+	{
+		const fmesh_quantization * quantization = reinterpret_cast<const fmesh_quantization *>(data + sizeof(fmesh_header));
+
+		m_positionScale  = float3(quantization->positionScale[0], quantization->positionScale[1], quantization->positionScale[2]);
+		m_positionOffset = float3(quantization->positionOffset[0], quantization->positionOffset[1], quantization->positionOffset[2]);
+
+		m_compressed = true;
+	}
+
+	const uint8_t * indices = data + header->indicesOffset;
+
+	if (header->indexSize == 4)
+	{
+		m_indicesStream = reinterpret_cast<uint3 *>(file.get_data() + header->indicesOffset);
+	}
+	else
+	{
+		const uint16_t * indices16 = reinterpret_cast<const uint16_t *>(indices);
+
+		m_indices.resize(m_numTriangles);
+
+		std::copy(indices16, indices16 + 3 * m_numTriangles, &m_indices[0].x);
+
+		m_indicesStream = m_indices.data();
+	}
+
+	if (lodsHeader)
+	{
+		for (uint32_t i = 0; i < lodsHeader->numLods; i++)
+		{
+			mesh_lod lod = { lodTable[i].firstIndex, lodTable[i].numIndices, lodTable[i].error };
+			m_lods.push_back(lod);
+		}
+
+		m_numLodIndices = lodsHeader->numIndices;
+
+		if (header->indexSize == 4)
+		{
+			m_lodIndicesStream = reinterpret_cast<uint32_t *>(file.get_data() + lodsHeader->indicesOffset);
+		}
+		else
+		{
+			const uint16_t * lodIndices16 = reinterpret_cast<const uint16_t *>(data + lodsHeader->indicesOffset);
+
+			m_lodIndices.assign(lodIndices16, lodIndices16 + m_numLodIndices);
+
+			m_lodIndicesStream = m_lodIndices.data();
+		}
+	}
+
+	for (uint32_t i = 0; clustersHeader && i < clustersHeader->numClusters; i++)
+	{
+		const fmesh_cluster & entry = clusterTable[i];
+
+		mesh_cluster cluster = {
+			float3(entry.center[0], entry.center[1], entry.center[2]),
+			entry.radius,
+			float3(entry.coneAxis[0], entry.coneAxis[1], entry.coneAxis[2]),
+			entry.coneCutoff,
+			entry.firstIndex,
+			entry.numIndices
+		};
+
+		m_clusters.push_back(cluster);
+	}
+
+	m_file = std::move(file);
+
+	return true;
+
+}
+
+bool mesh::save_fmesh(const char_t * filename) const
+{
+
+	std::ofstream file(filename, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	std::vector<std::pair<fmesh_stream, const void *>> streams;
+
+	auto addStream = [&](uint32_t semantic, const void * data)
+	{
+		fmesh_stream stream = { semantic, fmesh_stride(semantic, m_storageFlags), 0 };
+		streams.emplace_back(stream, data);
+	};
+
+	if (m_compressed)
+	{
+		addStream(FUSE_FMESH_STREAM_COMPRESSED_POSITIONS, m_compressedPositionsStream);
+
+		if (get_compressed_attributes_stride())
+		{
+			addStream(FUSE_FMESH_STREAM_COMPRESSED_ATTRIBUTES, m_compressedAttributesStream);
+		}
+	}
+	else
+	{
+		addStream(FUSE_MESH_STORAGE_NONE, m_verticesStream);
+
+		if (has_storage_semantic(FUSE_MESH_STORAGE_NORMALS))    addStream(FUSE_MESH_STORAGE_NORMALS, m_normalsStream);
+		if (has_storage_semantic(FUSE_MESH_STORAGE_TANGENTS))   addStream(FUSE_MESH_STORAGE_TANGENTS, m_tangentsStream);
+		if (has_storage_semantic(FUSE_MESH_STORAGE_BITANGENTS)) addStream(FUSE_MESH_STORAGE_BITANGENTS, m_bitangentsStream);
+
+		for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
+		{
+			uint32_t texcoordSemantic = FUSE_MESH_STORAGE_TEXCOORDS0 << i;
+
+			if (has_storage_semantic(static_cast<mesh_storage_semantic>(texcoordSemantic)))
+			{
+				addStream(texcoordSemantic, m_texcoordsStream[i]);
+			}
+		}
+	}
+
+	fmesh_header header = {};
+
+	header.magic        = FUSE_FMESH_MAGIC;
+	header.version      = FUSE_FMESH_VERSION;
+	header.storageFlags = m_storageFlags;
+	header.numVertices  = m_numVertices;
+	header.numTriangles = m_numTriangles;
+	header.numStreams   = static_cast<uint32_t>(streams.size());
+	header.flags        =
+		(m_compressed ? FUSE_FMESH_FLAG_COMPRESSED : 0) |
+		(m_lods.empty() ? 0 : FUSE_FMESH_FLAG_LODS) |
+		(m_clusters.empty() ? 0 : FUSE_FMESH_FLAG_CLUSTERS);
+
+	fmesh_quantization quantization = {
+		{ m_positionScale.x, m_positionScale.y, m_positionScale.z },
+		{ m_positionOffset.x, m_positionOffset.y, m_positionOffset.z }
+	};
+
+	// 16 bit indices whenever they can address all the vertices
+
+	header.indexSize = m_numVertices <= 0x10000 ? 2 : 4;
+
+	fmesh_lods lodsHeader = { static_cast<uint32_t>(m_lods.size()), m_numLodIndices, 0 };
+
+	std::vector<fmesh_lod> lodTable;
+
+	for (const mesh_lod & lod : m_lods)
+	{
+		fmesh_lod entry = { lod.firstIndex, lod.numIndices, lod.error, 0 };
+		lodTable.push_back(entry);
+	}
+
+	fmesh_clusters clustersHeader = { static_cast<uint32_t>(m_clusters.size()) };
+
+	std::vector<fmesh_cluster> clusterTable;
+
+	for (const mesh_cluster & cluster : m_clusters)
+	{
+		fmesh_cluster entry = {
+			{ cluster.center.x, cluster.center.y, cluster.center.z },
+			cluster.radius,
+			{ cluster.coneAxis.x, cluster.coneAxis.y, cluster.coneAxis.z },
+			cluster.coneCutoff,
+			cluster.firstIndex,
+			cluster.numIndices
+		};
+
+		clusterTable.push_back(entry);
+	}
+
+	uint64_t streamsBegin =
+		sizeof(fmesh_header) +
+		(m_compressed ? sizeof(fmesh_quantization) : 0) +
+		(m_lods.empty() ? 0 : sizeof(fmesh_lods) + lodTable.size() * sizeof(fmesh_lod)) +
+		(m_clusters.empty() ? 0 : sizeof(fmesh_clusters) + clusterTable.size() * sizeof(fmesh_cluster));
+
+	uint64_t offset = fmesh_align(streamsBegin + streams.size() * sizeof(fmesh_stream));
+
+	for (auto & stream : streams)
+	{
+		stream.first.offset = offset;
+		offset = fmesh_align(offset + static_cast<uint64_t>(stream.first.stride) * m_numVertices);
+	}
+
+	header.indicesOffset     = offset;
+	lodsHeader.indicesOffset = fmesh_align(offset + static_cast<uint64_t>(get_num_indices()) * header.indexSize);
+
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	if (m_compressed)
+	{
+		file.write(reinterpret_cast<const char *>(&quantization), sizeof(quantization));
+	}
+
+	if (!m_lods.empty())
+	{
+		file.write(reinterpret_cast<const char *>(&lodsHeader), sizeof(lodsHeader));
+		file.write(reinterpret_cast<const char *>(lodTable.data()), lodTable.size() * sizeof(fmesh_lod));
+	}
+
+	if (!m_clusters.empty())
+	{
+		file.write(reinterpret_cast<const char *>(&clustersHeader), sizeof(clustersHeader));
+		file.write(reinterpret_cast<const char *>(clusterTable.data()), clusterTable.size() * sizeof(fmesh_cluster));
+	}
+
+	for (auto & stream : streams)
+	{
+		file.write(reinterpret_cast<const char *>(&stream.first), sizeof(fmesh_stream));
+	}
+
+	auto pad = [&](uint64_t offset)
+	{
+		static const char zeros[FUSE_FMESH_ALIGNMENT] = {};
+		file.write(zeros, offset - static_cast<uint64_t>(file.tellp()));
+	};
+
+	for (auto & stream : streams)
+	{
+		pad(stream.first.offset);
+		file.write(reinterpret_cast<const char *>(stream.second), static_cast<std::streamsize>(stream.first.stride) * m_numVertices);
+	}
+
+	pad(header.indicesOffset);
+
+	auto writeIndices = [&](const uint32_t * indices, size_t numIndices)
+	{
+		if (header.indexSize == 4)
+		{
+			file.write(reinterpret_cast<const char *>(indices), numIndices * sizeof(uint32_t));
+		}
+		else
+		{
+			std::vector<uint16_t> indices16(indices, indices + numIndices);
+			file.write(reinterpret_cast<const char *>(indices16.data()), indices16.size() * sizeof(uint16_t));
+		}
+	};
+
+	writeIndices(get_indices(), get_num_indices());
+
+	if (!m_lods.empty())
+	{
+		pad(lodsHeader.indicesOffset);
+		writeIndices(m_lodIndicesStream, m_numLodIndices);
+	}
+
+	return file.good();
+
 }
\ No newline at end of file
@@ -0,0 +1,351 @@
+#include <fuse/mesh_clusters.hpp>
+#include <fuse/mesh_optimizer.hpp>
+#include <fuse/geometry/transform_affine.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace fuse;
+
+/* Bounds */
+
+static void compute_cluster_bounds(mesh_cluster & cluster, const uint32_t * indices, const float3 * vertices, const float3 * normals, const uint32_t * triangles)
+{
+	uint32_t numTriangles = cluster.numIndices / 3;
+
+	// Center of the bounding box, the radius reaches the farthest vertex
+
+	float3 minimum = vertices[indices[cluster.firstIndex]];
+	float3 maximum = minimum;
+
+	for (uint32_t i = cluster.firstIndex; i < cluster.firstIndex + cluster.numIndices; i++)
+	{
+		const float3 & p = vertices[indices[i]];
+
+		minimum = float3(std::min(minimum.x, p.x), std::min(minimum.y, p.y), std::min(minimum.z, p.z));
+		maximum = float3(std::max(maximum.x, p.x), std::max(maximum.y, p.y), std::max(maximum.z, p.z));
+	}
+
+	float3 center = (minimum + maximum) * .5f;
+	float  radius = 0.f;
+
+	for (uint32_t i = cluster.firstIndex; i < cluster.firstIndex + cluster.numIndices; i++)
+	{
+		float3 d = vertices[indices[i]] - center;
+		radius = std::max(radius, dot(d, d));
+	}
+
+	cluster.center = center;
+	cluster.radius = std::sqrt(radius);
+
+	// The axis is the average normal, the cutoff follows the normal farthest from it
+
+	float3 axis(0, 0, 0);
+
+	for (uint32_t t = 0; t < numTriangles; t++)
+	{
+		axis = axis + normals[triangles[t]];
+	}
+
+	float l = dot(axis, axis);
+
+	cluster.coneAxis   = l > 0.f ? axis * (1.f / std::sqrt(l)) : float3(0, 0, 1);
+	cluster.coneCutoff = 1.f;
+
+	if (l > 0.f)
+	{
+		float minDot = 1.f;
+
+		for (uint32_t t = 0; t < numTriangles; t++)
+		{
+			const float3 & n = normals[triangles[t]];
+
+			// Degenerate triangles are never drawn
+
+			if (dot(n, n) > 0.f)
+			{
+				minDot = std::min(minDot, dot(n, cluster.coneAxis));
+			}
+		}
+
+		if (minDot > 0.f)
+		{
+			cluster.coneCutoff = std::sqrt(1.f - minDot * minDot);
+		}
+	}
+}
+
+/* Clusters */
+
+void fuse::build_clusters(uint32_t * indices, size_t numIndices, const float3 * vertices, size_t numVertices, std::vector<mesh_cluster> & clusters)
+{
+	clusters.clear();
+
+	size_t numTriangles = numIndices / 3;
+
+	if (!numTriangles)
+	{
+		return;
+	}
+
+	// Unit normals of the triangles, null for the degenerate ones
+
+	std::vector<float3> normals(numTriangles);
+
+	for (size_t t = 0; t < numTriangles; t++)
+	{
+		const float3 & p0 = vertices[indices[3 * t]];
+
+		float3 n = cross(vertices[indices[3 * t + 1]] - p0, vertices[indices[3 * t + 2]] - p0);
+		float  l = dot(n, n);
+
+		normals[t] = l > 0.f ? n * (1.f / std::sqrt(l)) : float3(0, 0, 0);
+	}
+
+	// The triangles adjacent to each vertex
+
+	std::vector<uint32_t> offsets(numVertices + 1, 0);
+	std::vector<uint32_t> adjacency(3 * numTriangles);
+
+	for (size_t i = 0; i < 3 * numTriangles; i++)
+	{
+		++offsets[indices[i] + 1];
+	}
+
+	for (size_t v = 0; v < numVertices; v++)
+	{
+		offsets[v + 1] += offsets[v];
+	}
+
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+		for (size_t i = 0; i < 3 * numTriangles; i++)
+		{
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	// The stamps tell which vertices and candidates belong to the cluster being built
+
+	std::vector<uint32_t> order;
+	std::vector<uint8_t>  emitted(numTriangles, 0);
+	std::vector<uint32_t> vertexStamp(numVertices, 0);
+	std::vector<uint32_t> candidateStamp(numTriangles, 0);
+	std::vector<uint32_t> candidates;
+
+	order.reserve(numTriangles);
+
+	uint32_t stamp = 0;
+	size_t   seed  = 0;
+
+	while (order.size() < numTriangles)
+	{
+		while (emitted[seed])
+		{
+			++seed;
+		}
+
+		++stamp;
+
+		size_t first    = order.size();
+		float3 axis     = float3(0, 0, 0);
+		size_t triangle = seed;
+
+		candidates.clear();
+
+		for (;;)
+		{
+			emitted[triangle] = 1;
+			order.push_back(static_cast<uint32_t>(triangle));
+
+			axis = axis + normals[triangle];
+
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t v = indices[3 * triangle + k];
+
+				vertexStamp[v] = stamp;
+
+				for (uint32_t a = offsets[v]; a < offsets[v + 1]; a++)
+				{
+					uint32_t t = adjacency[a];
+
+					if (!emitted[t] && candidateStamp[t] != stamp)
+					{
+						candidateStamp[t] = stamp;
+						candidates.push_back(t);
+					}
+				}
+			}
+
+			if (order.size() - first >= FUSE_MESH_CLUSTER_MAX_TRIANGLES)
+			{
+				break;
+			}
+
+			// New vertices first, the distance to the average normal breaks the ties
+
+			float  l      = dot(axis, axis);
+			float3 normal = l > 0.f ? axis * (1.f / std::sqrt(l)) : float3(0, 0, 0);
+
+			float  bestScore = std::numeric_limits<float>::infinity();
+			size_t best      = numTriangles;
+
+			for (size_t c = 0; c < candidates.size();)
+			{
+				uint32_t t = candidates[c];
+
+				if (emitted[t])
+				{
+					candidates[c] = candidates.back();
+					candidates.pop_back();
+					continue;
+				}
+
+				int newVertices =
+					(vertexStamp[indices[3 * t]] != stamp) +
+					(vertexStamp[indices[3 * t + 1]] != stamp) +
+					(vertexStamp[indices[3 * t + 2]] != stamp);
+
+				float score = newVertices + 1.f - dot(normals[t], normal);
+
+				if (score < bestScore)
+				{
+					bestScore = score;
+					best      = t;
+				}
+
+				++c;
+			}
+
+			if (best == numTriangles)
+			{
+				break;
+			}
+
+			triangle = best;
+		}
+
+		mesh_cluster cluster = {};
+
+		cluster.firstIndex = static_cast<uint32_t>(3 * first);
+		cluster.numIndices = static_cast<uint32_t>(3 * (order.size() - first));
+
+		clusters.push_back(cluster);
+	}
+
+	std::vector<uint32_t> source(indices, indices + 3 * numTriangles);
+
+	for (size_t t = 0; t < numTriangles; t++)
+	{
+		std::copy(source.begin() + 3 * order[t], source.begin() + 3 * order[t] + 3, indices + 3 * t);
+	}
+
+	for (mesh_cluster & cluster : clusters)
+	{
+		compute_cluster_bounds(cluster, indices, vertices, normals.data(), order.data() + cluster.firstIndex / 3);
+	}
+
+	// The growth order of the clusters is not the best for the vertex cache, each cluster
+	// is optimized on its own with the vertices numbered locally to keep it cheap
+
+	std::vector<uint32_t> localIndices;
+	std::vector<uint32_t> globalIndices;
+	std::vector<uint32_t> localVertex(numVertices, std::numeric_limits<uint32_t>::max());
+
+	for (const mesh_cluster & cluster : clusters)
+	{
+		uint32_t * clusterIndices = indices + cluster.firstIndex;
+
+		localIndices.resize(cluster.numIndices);
+		globalIndices.clear();
+
+		for (uint32_t i = 0; i < cluster.numIndices; i++)
+		{
+			uint32_t & local = localVertex[clusterIndices[i]];
+
+			if (local == std::numeric_limits<uint32_t>::max())
+			{
+				local = static_cast<uint32_t>(globalIndices.size());
+				globalIndices.push_back(clusterIndices[i]);
+			}
+
+			localIndices[i] = local;
+		}
+
+		optimize_vertex_cache(localIndices.data(), localIndices.size(), globalIndices.size());
+
+		for (uint32_t i = 0; i < cluster.numIndices; i++)
+		{
+			clusterIndices[i] = globalIndices[localIndices[i]];
+		}
+
+		for (uint32_t v : globalIndices)
+		{
+			localVertex[v] = std::numeric_limits<uint32_t>::max();
+		}
+	}
+}
+
+/* Culling */
+
+size_t cluster_culler::cull(
+	const mesh_cluster * clusters,
+	size_t numClusters,
+	const mat128 & world,
+	const frustum_planes_soa & planes,
+	const float3 & eye,
+	std::vector<mesh_index_range> & ranges)
+{
+	m_localSpheres.resize(numClusters);
+	m_spheres.resize(numClusters);
+	m_visible.resize(numClusters);
+
+	for (size_t i = 0; i < numClusters; i++)
+	{
+		m_localSpheres[i] = sphere(clusters[i].center, clusters[i].radius);
+	}
+
+	transform_affine(m_localSpheres.data(), m_spheres.data(), numClusters, world);
+
+	size_t numVisible = frustum_cull(planes, m_spheres.data(), numClusters, m_visible.data());
+
+	// The cones are tested in object space, where the clusters bounds are exact. The sign
+	// of the dot product between a normal and the view direction survives an affine
+	// transform, but a mirroring one turns the triangles around.
+
+	vec128 determinant;
+	mat128 inverseWorld = mat128_inverse4(world, &determinant);
+
+	float3 localEye = to_float3(mat128_transform3(to_vec128(eye), inverseWorld));
+	float  facing   = vec128_get_x(determinant) < 0.f ? -1.f : 1.f;
+
+	size_t firstRange = ranges.size();
+
+	for (size_t i = 0; i < numVisible; i++)
+	{
+		const mesh_cluster & cluster = clusters[m_visible[i]];
+
+		float3 direction = cluster.center - localEye;
+		float  distance  = std::sqrt(dot(direction, direction));
+
+		if (facing * dot(direction, cluster.coneAxis) >= cluster.coneCutoff * distance + cluster.radius)
+		{
+			continue;
+		}
+
+		if (ranges.size() > firstRange && ranges.back().firstIndex + ranges.back().numIndices == cluster.firstIndex)
+		{
+			ranges.back().numIndices += cluster.numIndices;
+		}
+		else
+		{
+			mesh_index_range range = { cluster.firstIndex, cluster.numIndices };
+			ranges.push_back(range);
+		}
+	}
+
+	return ranges.size() - firstRange;
+}
\ No newline at end of file
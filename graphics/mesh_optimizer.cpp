@@ -0,0 +1,462 @@
+#include <fuse/mesh_optimizer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace fuse;
+
+/* Analysis */
+
+vertex_cache_statistics fuse::analyze_vertex_cache(const uint32_t * indices, size_t numIndices, size_t numVertices, uint32_t cacheSize)
+{
+	// The timestamp of the last transformation of each vertex tells if it is still in the FIFO
+
+	std::vector<uint32_t> timestamps(numVertices, 0);
+
+	uint32_t time = cacheSize + 1;
+	uint32_t transformed = 0;
+
+	for (size_t i = 0; i < numIndices; i++)
+	{
+		uint32_t v = indices[i];
+
+		if (time - timestamps[v] > cacheSize)
+		{
+			timestamps[v] = time++;
+			++transformed;
+		}
+	}
+
+	size_t numTriangles = numIndices / 3;
+
+	vertex_cache_statistics statistics;
+
+	statistics.transformedVertices = transformed;
+	statistics.acmr = numTriangles ? float(transformed) / numTriangles : 0.f;
+	statistics.atvr = numVertices ? float(transformed) / numVertices : 0.f;
+
+	return statistics;
+}
+
+/* Vertex cache optimization */
+
+#define FORSYTH_CACHE_SIZE       32
+#define FORSYTH_MAX_VALENCE      32
+#define FORSYTH_LAST_TRI_SCORE   .75f
+#define FORSYTH_CACHE_DECAY      1.5f
+#define FORSYTH_VALENCE_SCALE    2.f
+#define FORSYTH_VALENCE_POWER    .5f
+
+namespace
+{
+
+	struct forsyth_tables
+	{
+
+		float cache[FORSYTH_CACHE_SIZE];
+		float valence[FORSYTH_MAX_VALENCE];
+
+		forsyth_tables(void)
+		{
+			// The vertices of the last triangle have a fixed score, so that it does not matter in
+			// which order its edges are used. The others score less the older they get.
+
+			for (int i = 0; i < FORSYTH_CACHE_SIZE; i++)
+			{
+				cache[i] = i < 3 ?
+					FORSYTH_LAST_TRI_SCORE :
+					std::pow(1.f - float(i - 3) / (FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY);
+			}
+
+			// Vertices with few triangles left are boosted, to avoid leaving lone triangles behind
+
+			valence[0] = 0.f;
+
+			for (int i = 1; i < FORSYTH_MAX_VALENCE; i++)
+			{
+				valence[i] = FORSYTH_VALENCE_SCALE * std::pow(float(i), -FORSYTH_VALENCE_POWER);
+			}
+		}
+
+		inline float score(int cachePosition, uint32_t remaining) const
+		{
+			if (remaining == 0)
+			{
+				return -1.f;
+			}
+
+			float s = cachePosition >= 0 ? cache[cachePosition] : 0.f;
+
+			return s + (remaining < FORSYTH_MAX_VALENCE ?
+				valence[remaining] :
+				FORSYTH_VALENCE_SCALE * std::pow(float(remaining), -FORSYTH_VALENCE_POWER));
+		}
+
+	};
+
+}
+
+void fuse::optimize_vertex_cache(uint32_t * indices, size_t numIndices, size_t numVertices)
+{
+	static const forsyth_tables tables;
+
+	size_t numTriangles = numIndices / 3;
+
+	if (numTriangles == 0)
+	{
+		return;
+	}
+
+	std::vector<uint32_t> source(indices, indices + numTriangles * 3);
+
+	// Triangles adjacent to each vertex, the ones not emitted yet are kept at the front
+
+	std::vector<uint32_t> remaining(numVertices, 0);
+	std::vector<uint32_t> offsets(numVertices + 1, 0);
+
+	for (uint32_t v : source)
+	{
+		++remaining[v];
+	}
+
+	for (size_t v = 0; v < numVertices; v++)
+	{
+		offsets[v + 1] = offsets[v] + remaining[v];
+	}
+
+	std::vector<uint32_t> adjacency(numTriangles * 3);
+	std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+	for (size_t t = 0; t < numTriangles; t++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			adjacency[fill[source[3 * t + k]]++] = static_cast<uint32_t>(t);
+		}
+	}
+
+	std::vector<int>   cachePosition(numVertices, -1);
+	std::vector<float> vertexScore(numVertices);
+
+	for (size_t v = 0; v < numVertices; v++)
+	{
+		vertexScore[v] = tables.score(-1, remaining[v]);
+	}
+
+	std::vector<float> triangleScore(numTriangles);
+	std::vector<bool>  emitted(numTriangles, false);
+
+	size_t best = 0;
+
+	for (size_t t = 0; t < numTriangles; t++)
+	{
+		const uint32_t * tri = &source[3 * t];
+
+		triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+
+		if (triangleScore[t] > triangleScore[best])
+		{
+			best = t;
+		}
+	}
+
+	// LRU cache, 3 extra slots hold the vertices pushed out by the last triangle
+
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+	int      cacheSize = 0;
+
+	size_t cursor = 0;
+
+	for (size_t i = 0; i < numTriangles; i++)
+	{
+		if (best == numTriangles)
+		{
+			// Dead end, no triangle uses a cached vertex: continue in the input order
+
+			while (emitted[cursor])
+			{
+				++cursor;
+			}
+
+			best = cursor;
+		}
+
+		const uint32_t * tri = &source[3 * best];
+
+		indices[3 * i]     = tri[0];
+		indices[3 * i + 1] = tri[1];
+		indices[3 * i + 2] = tri[2];
+
+		emitted[best] = true;
+
+		// Remove the triangle from the adjacency of its vertices
+
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t v = tri[k];
+
+			uint32_t * begin = &adjacency[offsets[v]];
+			uint32_t * end   = begin + remaining[v];
+
+			*std::find(begin, end, static_cast<uint32_t>(best)) = *(end - 1);
+
+			--remaining[v];
+		}
+
+		// The triangle vertices move to the front of the cache
+
+		int newCacheSize = 0;
+
+		for (int k = 0; k < 3; k++)
+		{
+			if (std::find(newCache, newCache + newCacheSize, tri[k]) == newCache + newCacheSize)
+			{
+				newCache[newCacheSize++] = tri[k];
+			}
+		}
+
+		for (int k = 0; k < cacheSize; k++)
+		{
+			uint32_t v = cache[k];
+
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+			{
+				newCache[newCacheSize++] = v;
+			}
+		}
+
+		// Update the scores of the cached vertices and of their triangles, the vertices
+		// that fell out of the cache are updated too and only then dropped
+
+		best = numTriangles;
+
+		float bestScore = -1.f;
+
+		for (int k = 0; k < newCacheSize; k++)
+		{
+			uint32_t v = newCache[k];
+
+			int position = k < FORSYTH_CACHE_SIZE ? k : -1;
+
+			cachePosition[v] = position;
+
+			float score = tables.score(position, remaining[v]);
+			float delta = score - vertexScore[v];
+
+			vertexScore[v] = score;
+
+			for (uint32_t * t = &adjacency[offsets[v]], * end = t + remaining[v]; t != end; ++t)
+			{
+				triangleScore[*t] += delta;
+
+				if (position >= 0 && triangleScore[*t] > bestScore)
+				{
+					best      = *t;
+					bestScore = triangleScore[*t];
+				}
+			}
+		}
+
+		cacheSize = std::min(newCacheSize, FORSYTH_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheSize, cache);
+	}
+}
+
+/* Overdraw optimization */
+
+void fuse::optimize_overdraw(uint32_t * indices, size_t numIndices, const float3 * vertices, size_t numVertices, float threshold)
+{
+	size_t numTriangles = numIndices / 3;
+
+	if (numTriangles == 0)
+	{
+		return;
+	}
+
+	std::vector<uint32_t> timestamps(numVertices, 0);
+
+	uint32_t time = FUSE_VERTEX_CACHE_SIZE + 1;
+
+	auto cacheMisses = [&](size_t t)
+	{
+		int misses = 0;
+
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t v = indices[3 * t + k];
+
+			if (time - timestamps[v] > FUSE_VERTEX_CACHE_SIZE)
+			{
+				timestamps[v] = time++;
+				++misses;
+			}
+		}
+
+		return misses;
+	};
+
+	auto flushCache = [&]()
+	{
+		time += FUSE_VERTEX_CACHE_SIZE + 1;
+	};
+
+	// Hard boundaries, where a triangle misses all its vertices in the cache
+
+	std::vector<size_t> hardClusters;
+
+	for (size_t t = 0; t < numTriangles; t++)
+	{
+		int misses = cacheMisses(t);
+
+		if (t == 0 || misses == 3)
+		{
+			hardClusters.push_back(t);
+		}
+	}
+
+	hardClusters.push_back(numTriangles);
+
+	// Soft boundaries, where the ACMR of the cluster so far starting with an empty
+	// cache is within the threshold of the ACMR of the whole hard cluster
+
+	std::vector<size_t> clusters;
+
+	for (size_t h = 0; h + 1 < hardClusters.size(); h++)
+	{
+		size_t begin = hardClusters[h];
+		size_t end   = hardClusters[h + 1];
+
+		flushCache();
+
+		int hardMisses = 0;
+
+		for (size_t t = begin; t < end; t++)
+		{
+			hardMisses += cacheMisses(t);
+		}
+
+		float clusterThreshold = threshold * hardMisses / (end - begin);
+
+		flushCache();
+
+		clusters.push_back(begin);
+
+		int misses = 0;
+
+		for (size_t t = begin; t + 1 < end; t++)
+		{
+			misses += cacheMisses(t);
+
+			if (misses <= clusterThreshold * (t + 1 - clusters.back()))
+			{
+				clusters.push_back(t + 1);
+				misses = 0;
+				flushCache();
+			}
+		}
+	}
+
+	clusters.push_back(numTriangles);
+
+	size_t numClusters = clusters.size() - 1;
+
+	if (numClusters < 2)
+	{
+		return;
+	}
+
+	// Area weighted centroid and normal of each cluster
+
+	std::vector<float3> centroids(numClusters);
+	std::vector<float3> normals(numClusters);
+
+	float3 meshCentroid(0, 0, 0);
+	float  meshArea = 0.f;
+
+	for (size_t c = 0; c < numClusters; c++)
+	{
+		float3 centroid(0, 0, 0);
+		float3 normal(0, 0, 0);
+		float  area = 0.f;
+
+		for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const float3 & a = vertices[indices[3 * t]];
+			const float3 & b = vertices[indices[3 * t + 1]];
+			const float3 & d = vertices[indices[3 * t + 2]];
+
+			float3 n = cross(b - a, d - a);
+			float  w = length(n);
+
+			centroid = centroid + (a + b + d) * (w / 3.f);
+			normal   = normal + n;
+			area    += w;
+		}
+
+		centroids[c] = area > 0.f ? centroid / area : vertices[indices[3 * clusters[c]]];
+		normals[c]   = normal;
+
+		meshCentroid = meshCentroid + centroid;
+		meshArea    += area;
+	}
+
+	if (meshArea > 0.f)
+	{
+		meshCentroid = meshCentroid / meshArea;
+	}
+
+	// Clusters pointing away from the center of the mesh first
+
+	std::vector<float>    sortKeys(numClusters);
+	std::vector<uint32_t> order(numClusters);
+
+	for (size_t c = 0; c < numClusters; c++)
+	{
+		sortKeys[c] = dot(centroids[c] - meshCentroid, normals[c]);
+		order[c]    = static_cast<uint32_t>(c);
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> source(indices, indices + numTriangles * 3);
+
+	uint32_t * out = indices;
+
+	for (uint32_t c : order)
+	{
+		out = std::copy(source.begin() + 3 * clusters[c], source.begin() + 3 * clusters[c + 1], out);
+	}
+}
+
+/* Vertex fetch optimization */
+
+void fuse::optimize_vertex_fetch_remap(uint32_t * remap, uint32_t * indices, size_t numIndices, size_t numVertices)
+{
+	const uint32_t unused = ~0u;
+
+	std::fill(remap, remap + numVertices, unused);
+
+	uint32_t next = 0;
+
+	for (size_t i = 0; i < numIndices; i++)
+	{
+		uint32_t & r = remap[indices[i]];
+
+		if (r == unused)
+		{
+			r = next++;
+		}
+
+		indices[i] = r;
+	}
+
+	for (size_t v = 0; v < numVertices; v++)
+	{
+		if (remap[v] == unused)
+		{
+			remap[v] = next++;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,521 @@
+#include <fuse/mesh_simplifier.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace fuse;
+
+// A collapse is rejected when it turns a triangle more than 60 degrees away from the
+// normal it had in the input, or when it leaves a triangle thinner than this quality
+// (1 for an equilateral triangle, 0 for a degenerate one) and thinner than it was
+
+#define FUSE_SIMPLIFY_MIN_NORMAL_COSINE .5f
+#define FUSE_SIMPLIFY_MIN_QUALITY       .1f
+
+/* Quadrics */
+
+namespace
+{
+
+	// Sum of the squared distances to a set of planes, weighted by the area of the
+	// triangles: p^T A p + 2 b.p + c, A is symmetric
+
+	struct quadric
+	{
+		double a00, a01, a02, a11, a12, a22;
+		double b0, b1, b2;
+		double c;
+		double w;
+	};
+
+	inline quadric quadric_plane(double nx, double ny, double nz, double d, double w)
+	{
+		quadric q;
+
+		q.a00 = w * nx * nx;
+		q.a01 = w * nx * ny;
+		q.a02 = w * nx * nz;
+		q.a11 = w * ny * ny;
+		q.a12 = w * ny * nz;
+		q.a22 = w * nz * nz;
+
+		q.b0 = w * nx * d;
+		q.b1 = w * ny * d;
+		q.b2 = w * nz * d;
+
+		q.c = w * d * d;
+		q.w = w;
+
+		return q;
+	}
+
+	inline void quadric_add(quadric & q, const quadric & r)
+	{
+		q.a00 += r.a00;
+		q.a01 += r.a01;
+		q.a02 += r.a02;
+		q.a11 += r.a11;
+		q.a12 += r.a12;
+		q.a22 += r.a22;
+
+		q.b0 += r.b0;
+		q.b1 += r.b1;
+		q.b2 += r.b2;
+
+		q.c += r.c;
+		q.w += r.w;
+	}
+
+	// Mean squared distance of p to the planes of the quadric
+
+	inline double quadric_error(const quadric & q, const float3 & p)
+	{
+		double x = p.x;
+		double y = p.y;
+		double z = p.z;
+
+		double e =
+			x * (q.a00 * x + q.a01 * y + q.a02 * z) +
+			y * (q.a01 * x + q.a11 * y + q.a12 * z) +
+			z * (q.a02 * x + q.a12 * y + q.a22 * z) +
+			2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) +
+			q.c;
+
+		return q.w > 0.0 ? std::abs(e) / q.w : 0.0;
+	}
+
+	inline quadric quadric_sum(const quadric & q, const quadric & r)
+	{
+		quadric s = q;
+		quadric_add(s, r);
+		return s;
+	}
+
+	struct collapse
+	{
+		uint32_t source;
+		uint32_t target;
+		double   error;
+	};
+
+	// 4 sqrt(3) area / sum of the squared edges, the normal is the unnormalized one
+
+	inline float triangle_quality(const float3 * p, const float3 & normal)
+	{
+		float3 e0 = p[1] - p[0];
+		float3 e1 = p[2] - p[1];
+		float3 e2 = p[0] - p[2];
+
+		float edges = dot(e0, e0) + dot(e1, e1) + dot(e2, e2);
+
+		return edges > 0.f ? 3.46410162f * std::sqrt(dot(normal, normal)) / edges : 0.f;
+	}
+
+}
+
+float fuse::simplify_scale(const float3 * vertices, size_t numVertices)
+{
+	if (!numVertices)
+	{
+		return 0.f;
+	}
+
+	float3 minimum = vertices[0];
+	float3 maximum = vertices[0];
+
+	for (size_t v = 1; v < numVertices; v++)
+	{
+		const float3 & p = vertices[v];
+
+		minimum = float3(std::min(minimum.x, p.x), std::min(minimum.y, p.y), std::min(minimum.z, p.z));
+		maximum = float3(std::max(maximum.x, p.x), std::max(maximum.y, p.y), std::max(maximum.z, p.z));
+	}
+
+	float3 extent = maximum - minimum;
+
+	return std::max(extent.x, std::max(extent.y, extent.z));
+}
+
+/* Topology */
+
+// Each vertex is mapped to the first vertex with the same position
+
+static void weld_positions(const float3 * vertices, size_t numVertices, std::vector<uint32_t> & canonical, std::vector<uint8_t> & seam)
+{
+	std::vector<uint32_t> order(numVertices);
+	std::iota(order.begin(), order.end(), 0);
+
+	auto less = [vertices](uint32_t a, uint32_t b)
+	{
+		int c = std::memcmp(&vertices[a], &vertices[b], sizeof(float3));
+		return c < 0 || (c == 0 && a < b);
+	};
+
+	std::sort(order.begin(), order.end(), less);
+
+	canonical.resize(numVertices);
+	seam.assign(numVertices, 0);
+
+	for (size_t i = 0; i < numVertices;)
+	{
+		size_t j = i + 1;
+
+		while (j < numVertices && !std::memcmp(&vertices[order[i]], &vertices[order[j]], sizeof(float3)))
+		{
+			++j;
+		}
+
+		for (size_t k = i; k < j; k++)
+		{
+			canonical[order[k]] = order[i];
+			seam[order[k]]      = j - i > 1;
+		}
+
+		i = j;
+	}
+}
+
+// Vertices on an edge used by a single triangle, or used more than once in the same
+// direction (non manifold), in terms of positions
+
+static void find_borders(const uint32_t * indices, size_t numIndices, const std::vector<uint32_t> & canonical, std::vector<uint8_t> & border)
+{
+	std::vector<uint64_t> edges;
+
+	edges.reserve(numIndices);
+
+	for (size_t i = 0; i < numIndices; i += 3)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t a = canonical[indices[i + k]];
+			uint32_t b = canonical[indices[i + (k + 1) % 3]];
+
+			if (a != b)
+			{
+				edges.push_back((static_cast<uint64_t>(a) << 32) | b);
+			}
+		}
+	}
+
+	std::sort(edges.begin(), edges.end());
+
+	border.assign(canonical.size(), 0);
+
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		uint32_t a = static_cast<uint32_t>(edges[i] >> 32);
+		uint32_t b = static_cast<uint32_t>(edges[i]);
+
+		bool repeated = (i > 0 && edges[i - 1] == edges[i]) || (i + 1 < edges.size() && edges[i + 1] == edges[i]);
+		bool opposite = std::binary_search(edges.begin(), edges.end(), (static_cast<uint64_t>(b) << 32) | a);
+
+		if (repeated || !opposite)
+		{
+			border[a] = 1;
+			border[b] = 1;
+		}
+	}
+}
+
+/* Simplification */
+
+size_t fuse::simplify(
+	uint32_t * destination,
+	const uint32_t * indices,
+	size_t numIndices,
+	const float3 * vertices,
+	size_t numVertices,
+	size_t targetIndices,
+	float targetError,
+	float * resultError)
+{
+	size_t count = numIndices - numIndices % 3;
+
+	std::copy(indices, indices + count, destination);
+
+	if (resultError)
+	{
+		*resultError = 0.f;
+	}
+
+	if (count <= targetIndices || !numVertices)
+	{
+		return count;
+	}
+
+	// The errors are relative to the extent of the mesh
+
+	float scale    = simplify_scale(vertices, numVertices);
+	float invScale = scale > 0.f ? 1.f / scale : 0.f;
+
+	std::vector<float3> positions(vertices, vertices + numVertices);
+
+	for (float3 & p : positions)
+	{
+		p = (p - vertices[0]) * invScale;
+	}
+
+	std::vector<uint32_t> canonical;
+	std::vector<uint8_t>  seam;
+	std::vector<uint8_t>  border;
+
+	weld_positions(vertices, numVertices, canonical, seam);
+	find_borders(destination, count, canonical, border);
+
+	std::vector<uint8_t> locked(numVertices);
+
+	for (size_t v = 0; v < numVertices; v++)
+	{
+		locked[v] = seam[v] || border[canonical[v]];
+	}
+
+	// The quadrics are kept on the canonical vertices, so that the seams see the planes of both sides.
+	// The input normals of the triangles follow them as they are compacted.
+
+	std::vector<quadric> quadrics(numVertices, quadric_plane(0, 0, 0, 0, 0));
+	std::vector<float3>  normals(count / 3);
+
+	for (size_t i = 0; i < count; i += 3)
+	{
+		const float3 & p0 = positions[destination[i]];
+		const float3 & p1 = positions[destination[i + 1]];
+		const float3 & p2 = positions[destination[i + 2]];
+
+		float3 n = cross(p1 - p0, p2 - p0);
+
+		double l = std::sqrt(static_cast<double>(dot(n, n)));
+
+		normals[i / 3] = l > 0.0 ? n * static_cast<float>(1.0 / l) : float3(0.f, 0.f, 0.f);
+
+		if (l > 0.0)
+		{
+			double nx = n.x / l;
+			double ny = n.y / l;
+			double nz = n.z / l;
+
+			quadric q = quadric_plane(nx, ny, nz, -(nx * p0.x + ny * p0.y + nz * p0.z), .5 * l);
+
+			for (int k = 0; k < 3; k++)
+			{
+				quadric_add(quadrics[canonical[destination[i + k]]], q);
+			}
+		}
+	}
+
+	double limit    = static_cast<double>(targetError) * targetError;
+	double maxError = 0.0;
+
+	std::vector<uint32_t> offsets(numVertices + 1);
+	std::vector<uint32_t> adjacency;
+
+	std::vector<uint32_t> remap(numVertices);
+	std::vector<uint8_t>  touched(numVertices);
+
+	std::vector<collapse> collapses;
+
+	while (count > targetIndices)
+	{
+		// Triangles adjacent to each vertex
+
+		std::fill(offsets.begin(), offsets.end(), 0);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			++offsets[destination[i] + 1];
+		}
+
+		for (size_t v = 0; v < numVertices; v++)
+		{
+			offsets[v + 1] += offsets[v];
+		}
+
+		adjacency.resize(count);
+
+		{
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				adjacency[fill[destination[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		// The cheapest collapse of each vertex onto one of its neighbours
+
+		collapses.clear();
+
+		for (size_t v = 0; v < numVertices; v++)
+		{
+			if (locked[v])
+			{
+				continue;
+			}
+
+			collapse best = { static_cast<uint32_t>(v), 0, std::numeric_limits<double>::infinity() };
+
+			for (uint32_t k = offsets[v]; k < offsets[v + 1]; k++)
+			{
+				const uint32_t * triangle = destination + 3 * adjacency[k];
+
+				for (int c = 0; c < 3; c++)
+				{
+					uint32_t target = triangle[c];
+
+					if (canonical[target] == canonical[v])
+					{
+						continue;
+					}
+
+					double error = quadric_error(quadric_sum(quadrics[canonical[v]], quadrics[canonical[target]]), positions[target]);
+
+					if (error < best.error)
+					{
+						best.target = target;
+						best.error  = error;
+					}
+				}
+			}
+
+			if (best.error <= limit)
+			{
+				collapses.push_back(best);
+			}
+		}
+
+		if (collapses.empty())
+		{
+			break;
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const collapse & a, const collapse & b) { return a.error < b.error; });
+
+		// The cheapest collapses go first, the triangles around a collapse are left alone
+		// until the next pass as their adjacency is out of date
+
+		std::iota(remap.begin(), remap.end(), 0);
+		std::fill(touched.begin(), touched.end(), 0);
+
+		size_t trianglesLeft = (count - targetIndices + 2) / 3;
+		size_t applied       = 0;
+
+		for (const collapse & c : collapses)
+		{
+			if (!trianglesLeft)
+			{
+				break;
+			}
+
+			if (touched[c.source] || touched[c.target])
+			{
+				continue;
+			}
+
+			const float3 & target = positions[c.target];
+
+			bool reject  = false;
+			int  removed = 0;
+
+			for (uint32_t k = offsets[c.source]; k < offsets[c.source + 1] && !reject; k++)
+			{
+				const uint32_t * triangle = destination + 3 * adjacency[k];
+				const float3   & normal   = normals[adjacency[k]];
+
+				if (triangle[0] == c.target || triangle[1] == c.target || triangle[2] == c.target)
+				{
+					++removed;
+					continue;
+				}
+
+				float3 p0[3] = { positions[triangle[0]], positions[triangle[1]], positions[triangle[2]] };
+				float3 p[3]  = { p0[0], p0[1], p0[2] };
+
+				float3 before = cross(p0[1] - p0[0], p0[2] - p0[0]);
+
+				for (int i = 0; i < 3; i++)
+				{
+					if (triangle[i] == c.source)
+					{
+						p[i] = target;
+					}
+				}
+
+				float3 after = cross(p[1] - p[0], p[2] - p[0]);
+
+				// The flips against the current normal, the drift against the input one, and the slivers
+
+				float quality = triangle_quality(p, after);
+
+				reject = dot(before, after) <= 0.f ||
+					dot(normal, after) <= FUSE_SIMPLIFY_MIN_NORMAL_COSINE * std::sqrt(dot(after, after)) * std::sqrt(dot(normal, normal)) ||
+					(quality < FUSE_SIMPLIFY_MIN_QUALITY && quality < triangle_quality(p0, before));
+			}
+
+			if (reject)
+			{
+				continue;
+			}
+
+			for (uint32_t k = offsets[c.source]; k < offsets[c.source + 1]; k++)
+			{
+				const uint32_t * triangle = destination + 3 * adjacency[k];
+
+				touched[triangle[0]] = 1;
+				touched[triangle[1]] = 1;
+				touched[triangle[2]] = 1;
+			}
+
+			touched[c.target] = 1;
+
+			remap[c.source] = c.target;
+
+			quadric_add(quadrics[canonical[c.target]], quadrics[canonical[c.source]]);
+
+			maxError = std::max(maxError, c.error);
+
+			trianglesLeft -= std::min<size_t>(trianglesLeft, removed);
+
+			++applied;
+		}
+
+		if (!applied)
+		{
+			break;
+		}
+
+		// Remove the triangles collapsed to an edge
+
+		size_t write = 0;
+
+		for (size_t i = 0; i < count; i += 3)
+		{
+			uint32_t a = remap[destination[i]];
+			uint32_t b = remap[destination[i + 1]];
+			uint32_t c = remap[destination[i + 2]];
+
+			if (a != b && b != c && c != a)
+			{
+				destination[write]     = a;
+				destination[write + 1] = b;
+				destination[write + 2] = c;
+
+				normals[write / 3] = normals[i / 3];
+
+				write += 3;
+			}
+		}
+
+		count = write;
+	}
+
+	if (resultError)
+	{
+		*resultError = static_cast<float>(std::sqrt(maxError));
+	}
+
+	return count;
+}
\ No newline at end of file
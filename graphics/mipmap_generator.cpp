@@ -4,6 +4,23 @@
 
 using namespace fuse;
 
+// The descriptors only live for the frame, each thread generating mipmaps takes them from its own pages
+
+static thread_local transient_allocator t_rtvAllocator;
+static thread_local transient_allocator t_srvAllocator;
+
+static descriptor_token_t allocate_transient(transient_allocator & allocator, descriptor_heap * heap, UINT descriptors)
+{
+
+	if (allocator.get_pool() != &heap->get_transient_pool())
+	{
+		allocator.reset(&heap->get_transient_pool());
+	}
+
+	return allocator.allocate(descriptors);
+
+}
+
 mipmap_generator::mipmap_generator(ID3D12Device * device)
 {
 
@@ -48,7 +65,18 @@ bool mipmap_generator::generate_mipmaps(
 	// Create the mip 0 SRV
 	// For each mip, create the RTV and render
 
-	descriptor_token_t rtvToken = rtv_descriptor_heap::get_singleton_pointer()->allocate(desc.MipLevels - 1);
+	auto rtvHeap = rtv_descriptor_heap::get_singleton_pointer();
+	auto srvHeap = cbv_uav_srv_descriptor_heap::get_singleton_pointer();
+
+	// Falls back on the persistent descriptors when the frame is out of transient ones
+
+	descriptor_token_t rtvToken     = allocate_transient(t_rtvAllocator, rtvHeap, desc.MipLevels - 1);
+	bool               transientRTV = rtvToken != FUSE_DESCRIPTOR_INVALID;
+
+	if (!transientRTV)
+	{
+		rtvToken = rtvHeap->allocate(desc.MipLevels - 1);
+	}
 
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 
@@ -58,10 +86,20 @@ bool mipmap_generator::generate_mipmaps(
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	srvDesc.Texture2D.MipLevels       = 1;
 	
-	descriptor_token_t srvToken = cbv_uav_srv_descriptor_heap::get_singleton_pointer()->create_shader_resource_view(device, resource, &srvDesc);
+	descriptor_token_t srvToken     = allocate_transient(t_srvAllocator, srvHeap, 1);
+	bool               transientSRV = srvToken != FUSE_DESCRIPTOR_INVALID;
 
-	D3D12_CPU_DESCRIPTOR_HANDLE rtvHeapCPUDesc = rtv_descriptor_heap::get_singleton_pointer()->get_cpu_descriptor_handle(rtvToken);
-	D3D12_GPU_DESCRIPTOR_HANDLE srvHeapGPUDesc = cbv_uav_srv_descriptor_heap::get_singleton_pointer()->get_gpu_descriptor_handle(srvToken);
+	if (transientSRV)
+	{
+		device->CreateShaderResourceView(resource, &srvDesc, srvHeap->get_cpu_descriptor_handle(srvToken));
+	}
+	else
+	{
+		srvToken = srvHeap->create_shader_resource_view(device, resource, &srvDesc);
+	}
+
+	D3D12_CPU_DESCRIPTOR_HANDLE rtvHeapCPUDesc = rtvHeap->get_cpu_descriptor_handle(rtvToken);
+	D3D12_GPU_DESCRIPTOR_HANDLE srvHeapGPUDesc = srvHeap->get_gpu_descriptor_handle(srvToken);
 
 	UINT rtvDescSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
@@ -125,8 +163,15 @@ bool mipmap_generator::generate_mipmaps(
 
 	// Release the descriptors after the frame is done
 
-	commandQueue.safe_release(rtv_descriptor_heap::get_singleton_pointer(), rtvToken, desc.MipLevels - 1);
-	commandQueue.safe_release(cbv_uav_srv_descriptor_heap::get_singleton_pointer(), srvToken);
+	if (!transientRTV)
+	{
+		commandQueue.safe_release(rtvHeap, rtvToken, desc.MipLevels - 1);
+	}
+
+	if (!transientSRV)
+	{
+		commandQueue.safe_release(srvHeap, srvToken);
+	}
 
 	return true;
 
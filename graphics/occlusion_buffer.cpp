@@ -0,0 +1,591 @@
+#include <fuse/occlusion_buffer.hpp>
+#include <fuse/geometry/affine_transforms.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#define FUSE_OCCLUSION_VERTICES_GRAIN  4096
+#define FUSE_OCCLUSION_TRIANGLES_GRAIN 2048
+
+// Triangles reaching farther than this off the screen (in NDC) are skipped, the
+// edge functions lose the sub-pixel precision past it
+
+#define FUSE_OCCLUSION_GUARD_BAND 1024.f
+
+using namespace fuse;
+
+static inline void parallel_ranges(thread_pool * pool, size_t count, size_t grain, const thread_pool::range_type & body)
+{
+	if (pool)
+	{
+		pool->parallel_for(count, grain, body);
+	}
+	else if (count)
+	{
+		body(0, count);
+	}
+}
+
+static inline vec128 broadcast(float x)
+{
+	return vec128_set(x, x, x, x);
+}
+
+occlusion_buffer::occlusion_buffer(void) :
+	m_width(0),
+	m_height(0),
+	m_tilesX(0),
+	m_tilesY(0),
+	m_viewProjection(mat128_identity()),
+	m_numChunks(0),
+	m_numTriangles(0) {}
+
+bool occlusion_buffer::init(uint32_t width, uint32_t height)
+{
+	shutdown();
+
+	if (!width || !height)
+	{
+		return false;
+	}
+
+	m_tilesX = (width + FUSE_OCCLUSION_TILE_WIDTH - 1) / FUSE_OCCLUSION_TILE_WIDTH;
+	m_tilesY = (height + FUSE_OCCLUSION_TILE_HEIGHT - 1) / FUSE_OCCLUSION_TILE_HEIGHT;
+
+	m_width  = m_tilesX * FUSE_OCCLUSION_TILE_WIDTH;
+	m_height = m_tilesY * FUSE_OCCLUSION_TILE_HEIGHT;
+
+	m_depth.assign(m_width * m_height, 1.f);
+
+	// The levels past the buffer down to a single texel
+
+	size_t pyramidSize = 0;
+
+	for (uint32_t w = m_width, h = m_height; w > 1 || h > 1;)
+	{
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+
+		pyramidSize += w * h;
+	}
+
+	m_pyramid.assign(pyramidSize, 1.f);
+
+	level base = { m_depth.data(), m_width, m_height };
+	m_levels.push_back(base);
+
+	for (float * depth = m_pyramid.data(); m_levels.back().width > 1 || m_levels.back().height > 1;)
+	{
+		level next = { depth, (m_levels.back().width + 1) / 2, (m_levels.back().height + 1) / 2 };
+
+		m_levels.push_back(next);
+		depth += next.width * next.height;
+	}
+
+	return true;
+}
+
+void occlusion_buffer::shutdown(void)
+{
+	m_width  = 0;
+	m_height = 0;
+	m_tilesX = 0;
+	m_tilesY = 0;
+
+	m_numChunks    = 0;
+	m_numTriangles = 0;
+
+	m_occluders.clear();
+	m_screenVertices.clear();
+	m_triangles.clear();
+	m_bins.clear();
+	m_chunkTriangles.clear();
+
+	m_depth.clear();
+	m_pyramid.clear();
+	m_levels.clear();
+}
+
+void occlusion_buffer::clear(const mat128 & viewProjection)
+{
+	m_viewProjection = viewProjection;
+
+	m_occluders.clear();
+	m_screenVertices.clear();
+	m_triangles.clear();
+}
+
+/* Occluders */
+
+void occlusion_buffer::add_occluder(const float3 * vertices, size_t numVertices, const uint32_t * indices, size_t numIndices, const mat128 & world)
+{
+	add_occluder(vertices, numVertices, indices, numIndices, world * m_viewProjection, false);
+}
+
+void occlusion_buffer::add_occluder(const compressed_position * vertices, size_t numVertices, const uint32_t * indices, size_t numIndices, const mat128 & world, const float3 & scale, const float3 & offset)
+{
+	// The quantized positions are transformed as they are, the decoding goes in the matrix
+
+	const float unorm16 = 1.f / 65535.f;
+
+	mat128 decode = to_scale4(to_vec128(scale * unorm16)) * to_translation4(to_vec128(offset));
+
+	add_occluder(vertices, numVertices, indices, numIndices, decode * world * m_viewProjection, true);
+}
+
+void occlusion_buffer::add_occluder(const void * vertices, size_t numVertices, const uint32_t * indices, size_t numIndices, const mat128 & worldViewProjection, bool compressed)
+{
+	if (!numVertices || numIndices < 3)
+	{
+		return;
+	}
+
+	occluder o;
+
+	o.worldViewProjection = worldViewProjection;
+	o.vertices            = vertices;
+	o.indices             = indices;
+	o.numVertices         = static_cast<uint32_t>(numVertices);
+	o.numTriangles        = static_cast<uint32_t>(numIndices / 3);
+	o.firstVertex         = static_cast<uint32_t>(m_screenVertices.size());
+	o.firstTriangle       = static_cast<uint32_t>(m_triangles.size());
+	o.compressed          = compressed;
+
+	m_occluders.push_back(o);
+
+	m_screenVertices.resize(m_screenVertices.size() + o.numVertices);
+	m_triangles.resize(m_triangles.size() + o.numTriangles);
+}
+
+/* Rendering */
+
+void occlusion_buffer::render(thread_pool * pool)
+{
+	m_numTriangles = 0;
+
+	if (m_levels.empty())
+	{
+		return;
+	}
+
+	// Vertices and triangles are processed in chunks that may span several occluders
+
+	parallel_ranges(pool, m_screenVertices.size(), FUSE_OCCLUSION_VERTICES_GRAIN, [this](size_t begin, size_t end)
+	{
+		transform_vertices(begin, end);
+	});
+
+	// The triangles are binned by chunk, each tile goes through the bins of the chunks
+	// in order so that the result never depends on the threads
+
+	uint32_t numTiles = m_tilesX * m_tilesY;
+
+	m_numChunks = std::max<uint32_t>(1, static_cast<uint32_t>((m_triangles.size() + FUSE_OCCLUSION_TRIANGLES_GRAIN - 1) / FUSE_OCCLUSION_TRIANGLES_GRAIN));
+
+	if (m_bins.size() < m_numChunks * numTiles)
+	{
+		m_bins.resize(m_numChunks * numTiles);
+		m_chunkTriangles.resize(m_numChunks);
+	}
+
+	for (uint32_t i = 0; i < m_numChunks * numTiles; i++)
+	{
+		m_bins[i].clear();
+	}
+
+	std::fill(m_chunkTriangles.begin(), m_chunkTriangles.begin() + m_numChunks, 0);
+
+	parallel_ranges(pool, m_triangles.size(), FUSE_OCCLUSION_TRIANGLES_GRAIN, [this](size_t begin, size_t end)
+	{
+		setup_triangles(begin, end);
+	});
+
+	m_numTriangles = std::accumulate(m_chunkTriangles.begin(), m_chunkTriangles.begin() + m_numChunks, 0u);
+
+	parallel_ranges(pool, numTiles, 1, [this](size_t begin, size_t end)
+	{
+		for (size_t tile = begin; tile < end; tile++)
+		{
+			rasterize_tile(static_cast<uint32_t>(tile));
+		}
+	});
+
+	build_pyramid();
+}
+
+void occlusion_buffer::transform_vertices(size_t begin, size_t end)
+{
+	// Pixel coordinates and depth, the last component is 0 for the vertices in front of
+	// the near plane, behind the eye or past the guard band and 1 for the others
+
+	const float width  = static_cast<float>(m_width);
+	const float height = static_cast<float>(m_height);
+
+	const vec128 scale = vec128_set(.5f * width, -.5f * height, 1.f, 0.f);
+	const vec128 bias  = vec128_set(.5f * width, .5f * height, 0.f, 1.f);
+
+	auto project = [=](vec128 clip)
+	{
+		float x = vec128_get_x(clip);
+		float y = vec128_get_y(clip);
+		float z = vec128_get_z(clip);
+		float w = vec128_get_w(clip);
+
+		bool valid = z >= 0.f && w > 0.f &&
+			std::abs(x) <= FUSE_OCCLUSION_GUARD_BAND * w &&
+			std::abs(y) <= FUSE_OCCLUSION_GUARD_BAND * w;
+
+		return valid ? clip / vec128_splat<FUSE_W>(clip) * scale + bias : vec128_zero();
+	};
+
+	auto it = std::upper_bound(m_occluders.begin(), m_occluders.end(), begin,
+		[](size_t vertex, const occluder & o) { return vertex < o.firstVertex; }) - 1;
+
+	for (size_t v = begin; v < end; ++it)
+	{
+		const occluder & o = *it;
+
+		size_t first = v - o.firstVertex;
+		size_t last  = std::min<size_t>(end - o.firstVertex, o.numVertices);
+
+		mat128 rows = mat128_transpose(o.worldViewProjection);
+		vec128 * screen = reinterpret_cast<vec128 *>(m_screenVertices.data() + o.firstVertex);
+
+		if (o.compressed)
+		{
+			const compressed_position * vertices = static_cast<const compressed_position *>(o.vertices);
+
+			for (size_t i = first; i < last; i++)
+			{
+				const compressed_position & q = vertices[i];
+
+				screen[i] = project(
+					rows.c[0] * static_cast<float>(q.x) +
+					rows.c[1] * static_cast<float>(q.y) +
+					rows.c[2] * static_cast<float>(q.z) +
+					rows.c[3]);
+			}
+		}
+		else
+		{
+			const float3 * vertices = static_cast<const float3 *>(o.vertices);
+
+			for (size_t i = first; i < last; i++)
+			{
+				const float3 & p = vertices[i];
+
+				screen[i] = project(
+					rows.c[0] * p.x +
+					rows.c[1] * p.y +
+					rows.c[2] * p.z +
+					rows.c[3]);
+			}
+		}
+
+		v = o.firstVertex + last;
+	}
+}
+
+void occlusion_buffer::setup_triangles(size_t begin, size_t end)
+{
+	const float width  = static_cast<float>(m_width);
+	const float height = static_cast<float>(m_height);
+
+	uint32_t chunk = static_cast<uint32_t>(begin / FUSE_OCCLUSION_TRIANGLES_GRAIN);
+	uint32_t count = 0;
+
+	std::vector<uint32_t> * chunkBins = m_bins.data() + chunk * m_tilesX * m_tilesY;
+
+	auto it = std::upper_bound(m_occluders.begin(), m_occluders.end(), begin,
+		[](size_t triangle, const occluder & o) { return triangle < o.firstTriangle; }) - 1;
+
+	for (size_t triangle = begin; triangle < end; ++it)
+	{
+		const occluder & o = *it;
+
+		size_t first = triangle - o.firstTriangle;
+		size_t last  = std::min<size_t>(end - o.firstTriangle, o.numTriangles);
+
+		const float4 * screen = m_screenVertices.data() + o.firstVertex;
+
+		for (size_t i = first; i < last; i++)
+		{
+			uint32_t index = static_cast<uint32_t>(o.firstTriangle + i);
+
+			triangle_setup & t = m_triangles[index];
+
+			const float4 & v0 = screen[o.indices[3 * i]];
+			const float4 & v1 = screen[o.indices[3 * i + 1]];
+			const float4 & v2 = screen[o.indices[3 * i + 2]];
+
+			if (v0.w == 0.f || v1.w == 0.f || v2.w == 0.f)
+			{
+				continue;
+			}
+
+			float x[3] = { v0.x, v1.x, v2.x };
+			float y[3] = { v0.y, v1.y, v2.y };
+			float z[3] = { v0.z, v1.z, v2.z };
+
+			// Clockwise on the screen (y down) is front facing
+
+			float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+			if (!(area > 0.f))
+			{
+				continue;
+			}
+
+			for (int k = 0; k < 3; k++)
+			{
+				int j = k == 2 ? 0 : k + 1;
+
+				t.a[k] = y[k] - y[j];
+				t.b[k] = x[j] - x[k];
+				t.c[k] = -(t.a[k] * x[k] + t.b[k] * y[k]);
+			}
+
+			float invArea = 1.f / area;
+
+			t.zx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * invArea;
+			t.zy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * invArea;
+			t.z0 = z[0] - t.zx * x[0] - t.zy * y[0];
+
+			// The pixels whose center is in the bounding box
+
+			float minX = std::max(std::min(x[0], std::min(x[1], x[2])), 0.f);
+			float maxX = std::min(std::max(x[0], std::max(x[1], x[2])), width);
+			float minY = std::max(std::min(y[0], std::min(y[1], y[2])), 0.f);
+			float maxY = std::min(std::max(y[0], std::max(y[1], y[2])), height);
+
+			t.minX = static_cast<int32_t>(std::ceil(minX - .5f));
+			t.maxX = static_cast<int32_t>(std::floor(maxX - .5f));
+			t.minY = static_cast<int32_t>(std::ceil(minY - .5f));
+			t.maxY = static_cast<int32_t>(std::floor(maxY - .5f));
+
+			if (t.minX > t.maxX || t.minY > t.maxY)
+			{
+				continue;
+			}
+
+			for (int32_t y = t.minY / FUSE_OCCLUSION_TILE_HEIGHT; y <= t.maxY / FUSE_OCCLUSION_TILE_HEIGHT; y++)
+			{
+				for (int32_t x = t.minX / FUSE_OCCLUSION_TILE_WIDTH; x <= t.maxX / FUSE_OCCLUSION_TILE_WIDTH; x++)
+				{
+					chunkBins[y * m_tilesX + x].push_back(index);
+				}
+			}
+
+			++count;
+		}
+
+		triangle = o.firstTriangle + last;
+	}
+
+	m_chunkTriangles[chunk] = count;
+}
+
+// The pixels of the triangle in the rectangle [minX, maxX] x [minY, maxY], 4 at a time. The
+// rows start on a multiple of 4, the edge functions discard the pixels out of the triangle.
+
+static inline void rasterize_triangle(
+	float * depth,
+	uint32_t width,
+	const float * a,
+	const float * b,
+	const float * c,
+	float zx,
+	float zy,
+	float z0,
+	int32_t minX,
+	int32_t minY,
+	int32_t maxX,
+	int32_t maxY)
+{
+	const vec128 zero = vec128_zero();
+
+	vec128 a0 = broadcast(a[0]);
+	vec128 a1 = broadcast(a[1]);
+	vec128 a2 = broadcast(a[2]);
+	vec128 dz = broadcast(zx);
+
+	minX &= ~3;
+
+	vec128 px = vec128_set(.5f, 1.5f, 2.5f, 3.5f) + broadcast(static_cast<float>(minX));
+
+	vec128 a0Step = a0 * 4.f;
+	vec128 a1Step = a1 * 4.f;
+	vec128 a2Step = a2 * 4.f;
+	vec128 dzStep = dz * 4.f;
+
+	for (int32_t y = minY; y <= maxY; y++)
+	{
+		float py = y + .5f;
+
+		vec128 e0 = a0 * px + broadcast(b[0] * py + c[0]);
+		vec128 e1 = a1 * px + broadcast(b[1] * py + c[1]);
+		vec128 e2 = a2 * px + broadcast(b[2] * py + c[2]);
+		vec128 z  = dz * px + broadcast(zy * py + z0);
+
+		float * row = depth + y * width;
+
+		for (int32_t x = minX; x <= maxX; x += 4)
+		{
+			vec128 inside = vec128_ge(vec128_min(e0, vec128_min(e1, e2)), zero);
+
+			if (vec128_any_true(inside))
+			{
+				vec128 d = _mm_load_ps(row + x);
+				_mm_store_ps(row + x, _mm_blendv_ps(d, vec128_min(d, z), inside));
+			}
+
+			e0 = e0 + a0Step;
+			e1 = e1 + a1Step;
+			e2 = e2 + a2Step;
+			z  = z + dzStep;
+		}
+	}
+}
+
+void occlusion_buffer::rasterize_tile(uint32_t tile)
+{
+	int32_t tileX = (tile % m_tilesX) * FUSE_OCCLUSION_TILE_WIDTH;
+	int32_t tileY = (tile / m_tilesX) * FUSE_OCCLUSION_TILE_HEIGHT;
+
+	float * depth = m_depth.data();
+
+	for (int32_t y = tileY; y < tileY + FUSE_OCCLUSION_TILE_HEIGHT; y++)
+	{
+		std::fill(depth + y * m_width + tileX, depth + y * m_width + tileX + FUSE_OCCLUSION_TILE_WIDTH, 1.f);
+	}
+
+	for (uint32_t chunk = 0; chunk < m_numChunks; chunk++)
+	{
+		for (uint32_t i : m_bins[chunk * m_tilesX * m_tilesY + tile])
+		{
+			const triangle_setup & t = m_triangles[i];
+
+			rasterize_triangle(
+				depth, m_width,
+				t.a, t.b, t.c,
+				t.zx, t.zy, t.z0,
+				std::max(t.minX, tileX),
+				std::max(t.minY, tileY),
+				std::min(t.maxX, tileX + FUSE_OCCLUSION_TILE_WIDTH - 1),
+				std::min(t.maxY, tileY + FUSE_OCCLUSION_TILE_HEIGHT - 1));
+		}
+	}
+}
+
+void occlusion_buffer::build_pyramid(void)
+{
+	for (size_t l = 1; l < m_levels.size(); l++)
+	{
+		const level & source = m_levels[l - 1];
+		const level & target = m_levels[l];
+
+		for (uint32_t y = 0; y < target.height; y++)
+		{
+			const float * row0 = source.depth + std::min(2 * y, source.height - 1) * source.width;
+			const float * row1 = source.depth + std::min(2 * y + 1, source.height - 1) * source.width;
+
+			float * out = target.depth + y * target.width;
+
+			for (uint32_t x = 0; x < target.width; x++)
+			{
+				uint32_t x0 = std::min(2 * x, source.width - 1);
+				uint32_t x1 = std::min(2 * x + 1, source.width - 1);
+
+				out[x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+			}
+		}
+	}
+}
+
+/* Queries */
+
+bool occlusion_buffer::test(const aabb & box) const
+{
+	if (m_levels.empty())
+	{
+		return true;
+	}
+
+	float4 minimum = to_float4(box.get_min());
+	float4 maximum = to_float4(box.get_max());
+
+	float minX = std::numeric_limits<float>::infinity();
+	float minY = std::numeric_limits<float>::infinity();
+	float maxX = -std::numeric_limits<float>::infinity();
+	float maxY = -std::numeric_limits<float>::infinity();
+	float minZ = std::numeric_limits<float>::infinity();
+
+	for (int i = 0; i < 8; i++)
+	{
+		vec128 corner = vec128_set(
+			i & 1 ? maximum.x : minimum.x,
+			i & 2 ? maximum.y : minimum.y,
+			i & 4 ? maximum.z : minimum.z,
+			1.f);
+
+		float4 clip = to_float4(corner * m_viewProjection);
+
+		// A box crossing the near plane is visible
+
+		if (!(clip.z >= 0.f && clip.w > 0.f))
+		{
+			return true;
+		}
+
+		float invW = 1.f / clip.w;
+
+		float x = (clip.x * invW * .5f + .5f) * m_width;
+		float y = (.5f - clip.y * invW * .5f) * m_height;
+
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		minZ = std::min(minZ, clip.z * invW);
+	}
+
+	// Off the screen, the frustum culling knows better
+
+	if (maxX < 0.f || maxY < 0.f || minX >= m_width || minY >= m_height)
+	{
+		return true;
+	}
+
+	uint32_t x0 = static_cast<uint32_t>(std::max(minX, 0.f));
+	uint32_t y0 = static_cast<uint32_t>(std::max(minY, 0.f));
+	uint32_t x1 = static_cast<uint32_t>(std::min(maxX, m_width - 1.f));
+	uint32_t y1 = static_cast<uint32_t>(std::min(maxY, m_height - 1.f));
+
+	uint32_t l = 0;
+
+	while (x1 - x0 >= 4 || y1 - y0 >= 4)
+	{
+		x0 >>= 1;
+		y0 >>= 1;
+		x1 >>= 1;
+		y1 >>= 1;
+
+		++l;
+	}
+
+	const level & source = m_levels[l];
+
+	float maxDepth = 0.f;
+
+	for (uint32_t y = y0; y <= y1; y++)
+	{
+		for (uint32_t x = x0; x <= x1; x++)
+		{
+			maxDepth = std::max(maxDepth, source.depth[y * source.width + x]);
+		}
+	}
+
+	return minZ <= maxDepth;
+}
\ No newline at end of file
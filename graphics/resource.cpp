@@ -1,6 +1,9 @@
 #include <fuse/resource.hpp>
+#include <fuse/resource_manager.hpp>
 #include <fuse/core.hpp>
+#include <fuse/core/thread_pool.hpp>
 
+#include <atomic>
 #include <sstream>
 
 using namespace fuse;
@@ -17,23 +20,40 @@ bool resource::lock_and_load(void)
 
 	lock();
 
+	m_referenced.store(true, std::memory_order_relaxed);
+
+	// Being loaded by load_async, waits for the result
+
+	while (m_status == FUSE_RESOURCE_LOADING)
+	{
+		std::shared_future<bool> loading = m_loadFuture;
+		unlock();
+		loading.wait();
+		lock();
+	}
+
 	if (m_status == FUSE_RESOURCE_NOT_LOADED)
 	{
+		load_locked();
+	}
 
-		if ((m_loader && m_loader->load(this)) ||
-			(!m_loader && load_impl()))
-		{
-			m_status = FUSE_RESOURCE_LOADED;
-			m_size   = calculate_size_impl();
-		}
-		else
-		{
-			FUSE_LOG_OPT_DEBUG(stringstream_t() << "Failed to load resource \"" << m_name << "\".");
-		}
+	return m_status == FUSE_RESOURCE_LOADED;
+
+}
 
+bool resource::is_loaded(void) const
+{
+
+	if (!try_lock())
+	{
+		return false;
 	}
 
-	return m_status == FUSE_RESOURCE_LOADED;
+	bool loaded = m_status == FUSE_RESOURCE_LOADED;
+
+	unlock();
+
+	return loaded;
 
 }
 
@@ -56,6 +76,149 @@ void resource::unload(void)
 
 		m_status = FUSE_RESOURCE_NOT_LOADED;
 
+		if (m_owner)
+		{
+			m_owner->on_resource_unload(this);
+		}
+
+	}
+
+}
+
+void resource::recalculate_size(void)
+{
+
+	size_t oldSize = m_size;
+
+	m_size = calculate_size_impl();
+
+	// While loading the size is accounted once the load is done
+
+	if (m_owner && m_status == FUSE_RESOURCE_LOADED)
+	{
+		m_owner->on_resource_resize(this, oldSize);
+	}
+
+}
+
+std::shared_future<bool> resource::load_async(thread_pool & pool)
+{
+
+	std::shared_future<bool> loading;
+
+	{
+
+		guard_type lock(m_lock);
+
+		if (m_status == FUSE_RESOURCE_LOADED)
+		{
+			std::promise<bool> loaded;
+			loaded.set_value(true);
+			return loaded.get_future().share();
+		}
+		else if (m_status == FUSE_RESOURCE_LOADING)
+		{
+			return m_loadFuture;
+		}
+
+		m_status      = FUSE_RESOURCE_LOADING;
+		m_loadPromise = std::promise<bool>();
+		m_loadFuture  = m_loadPromise.get_future().share();
+
+		loading = m_loadFuture;
+
+	}
+
+	std::vector<std::shared_ptr<resource>> dependencies;
+	get_dependencies_impl(dependencies);
+
+	// The load is enqueued when the last dependency is done (loaded or not, load_impl
+	// handles the failures), the counter includes this thread so it cannot happen early
+
+	auto pending = std::make_shared<std::atomic<uint32_t>>(static_cast<uint32_t>(dependencies.size() + 1));
+
+	auto dependencyDone = [this, &pool, pending]()
+	{
+		if (--*pending == 0)
+		{
+			pool.enqueue([this]() { finish_load_async(); });
+		}
+	};
+
+	for (auto & dependency : dependencies)
+	{
+		dependency->load_async(pool);
+		dependency->on_load(dependencyDone);
+	}
+
+	dependencyDone();
+
+	return loading;
+
+}
+
+void resource::load_locked(void)
+{
+
+	if ((m_loader && m_loader->load(this)) ||
+		(!m_loader && load_impl()))
+	{
+		m_status = FUSE_RESOURCE_LOADED;
+		m_size   = calculate_size_impl();
+
+		m_referenced.store(true, std::memory_order_relaxed);
+
+		if (m_owner)
+		{
+			m_owner->on_resource_load(this);
+		}
+	}
+	else
+	{
+		m_status = FUSE_RESOURCE_NOT_LOADED;
+		FUSE_LOG_OPT_DEBUG(stringstream_t() << "Failed to load resource \"" << m_name << "\".");
+	}
+
+}
+
+void resource::finish_load_async(void)
+{
+
+	std::vector<std::function<void(void)>> callbacks;
+
+	{
+
+		guard_type lock(m_lock);
+
+		load_locked();
+
+		m_loadPromise.set_value(m_status == FUSE_RESOURCE_LOADED);
+		callbacks.swap(m_loadCallbacks);
+
+	}
+
+	for (auto & callback : callbacks)
+	{
+		callback();
 	}
 
+}
+
+void resource::on_load(std::function<void(void)> callback)
+{
+
+	{
+
+		guard_type lock(m_lock);
+
+		if (m_status == FUSE_RESOURCE_LOADING)
+		{
+			m_loadCallbacks.push_back(std::move(callback));
+			return;
+		}
+
+	}
+
+	callback();
+
 }
\ No newline at end of file
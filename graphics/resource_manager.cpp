@@ -4,6 +4,40 @@ using namespace fuse;
 
 #define FUSE_RESOURCE_IS_UNNAMED(Name) (!name || *name == '\0')
 
+#define FUSE_RESOURCE_MANAGER_INITIAL_CAPACITY 64
+
+// FNV-1a on the characters, to hash the names without building a string_t on lookup
+
+static inline size_t hash_name(const char_t * name)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (; *name; name++)
+	{
+		hash = (hash ^ static_cast<uint64_t>(*name)) * 1099511628211ULL;
+	}
+
+	return static_cast<size_t>(hash);
+}
+
+resource_manager::resource_manager(const char_t * type, void * userdata) :
+	m_userdata(userdata),
+	m_lastID(0),
+	m_type(type),
+	m_budget(0),
+	m_residentSize(0),
+	m_clockHand(0),
+	m_loads(0),
+	m_evictions(0),
+	m_evictedBytes(0)
+{
+	m_tables.emplace_back(new table(FUSE_RESOURCE_MANAGER_INITIAL_CAPACITY));
+	m_namedResources.store(m_tables.back().get(), std::memory_order_relaxed);
+
+	m_tables.emplace_back(new table(FUSE_RESOURCE_MANAGER_INITIAL_CAPACITY));
+	m_resources.store(m_tables.back().get(), std::memory_order_relaxed);
+}
+
 std::shared_ptr<resource> resource_manager::create(const char_t * name,
 	                                               const resource::parameters_type & parameters,
 	                                               resource_loader * loader)
@@ -11,7 +45,7 @@ std::shared_ptr<resource> resource_manager::create(const char_t * name,
 
 	guard_type lock(m_lock);
 
-	auto hResource = find_by_name_unsafe(name);
+	auto hResource = find_by_name(name);
 
 	if (!hResource)
 	{
@@ -22,19 +56,30 @@ std::shared_ptr<resource> resource_manager::create(const char_t * name,
 
 		newResource->set_id(newID);
 
-		if (!FUSE_RESOURCE_IS_UNNAMED(name))
-		{
-			m_namedResources[name] = newID;
-		}
-
 		hResource = std::shared_ptr<resource>(newResource);
-		m_resources[newID] = hResource;
 
 		newResource->set_parameters(parameters);
 
-	}
+		// The entry is complete before being published, readers only see it through the tables
+
+		entry * newEntry = new entry;
 
-	
+		newEntry->id     = newID;
+		newEntry->handle = hResource;
+
+		m_entries.emplace_back(newEntry);
+
+		insert(m_resources, newEntry, [](const entry * e) { return static_cast<size_t>(e->id); });
+
+		if (!FUSE_RESOURCE_IS_UNNAMED(name))
+		{
+			newEntry->hash = hash_name(name);
+			newEntry->name = name;
+
+			insert(m_namedResources, newEntry, [](const entry * e) { return e->hash; });
+		}
+
+	}
 
 	return hResource;
 
@@ -42,47 +87,250 @@ std::shared_ptr<resource> resource_manager::create(const char_t * name,
 
 std::shared_ptr<resource> resource_manager::find_by_name(const char_t * name) const
 {
-	guard_type lock(m_lock);
-	return find_by_name_unsafe(name);
+
+	if (!FUSE_RESOURCE_IS_UNNAMED(name))
+	{
+
+		const table * t = m_namedResources.load(std::memory_order_acquire);
+		const entry * e = t->find(hash_name(name), name);
+
+		if (e)
+		{
+			mark_referenced(e->handle.get());
+			return e->handle;
+		}
+
+	}
+
+	return std::shared_ptr<resource>();
+
 }
 
 std::shared_ptr<resource> resource_manager::find_by_id(resource::id_type id) const
 {
+
+	const table * t = m_resources.load(std::memory_order_acquire);
+	const entry * e = t->find(id);
+
+	if (e)
+	{
+		mark_referenced(e->handle.get());
+		return e->handle;
+	}
+
+	return std::shared_ptr<resource>();
+
+}
+
+resource_manager_statistics resource_manager::get_statistics(void) const
+{
+	resource_manager_statistics statistics;
+
+	statistics.budget       = m_budget;
+	statistics.residentSize = m_residentSize;
+	statistics.loads        = m_loads;
+	statistics.evictions    = m_evictions;
+	statistics.evictedBytes = m_evictedBytes;
+
+	return statistics;
+}
+
+/* Eviction */
+
+void resource_manager::mark_referenced(resource * r)
+{
+	// Only writes when the bit is clear, so the lookups of a hot resource do not bounce its cache line
+
+	if (!r->m_referenced.load(std::memory_order_relaxed))
+	{
+		r->m_referenced.store(true, std::memory_order_relaxed);
+	}
+}
+
+void resource_manager::on_resource_load(resource * r)
+{
+	m_loads++;
+	m_residentSize += r->m_size;
+
+	if (m_budget && m_residentSize > m_budget)
+	{
+		evict(r);
+	}
+}
+
+void resource_manager::on_resource_unload(resource * r)
+{
+	m_residentSize -= r->m_size;
+}
+
+void resource_manager::on_resource_resize(resource * r, size_t oldSize)
+{
+	m_residentSize += r->m_size - oldSize;
+
+	if (m_budget && r->m_size > oldSize && m_residentSize > m_budget)
+	{
+		evict(r);
+	}
+}
+
+void resource_manager::evict(resource * loading)
+{
+
 	guard_type lock(m_lock);
-	return find_by_id_unsafe(id);
+
+	size_t n = m_entries.size();
+
+	// Two turns of the clock at most, the first one can just clear the reference bits.
+	// The resources are only try-locked: the caller holds the lock of the one it loads,
+	// and a locked resource is being used anyway.
+
+	for (size_t visited = 0; visited < 2 * n && m_residentSize > m_budget; visited++)
+	{
+
+		entry    * e = m_entries[m_clockHand].get();
+		resource * r = e->handle.get();
+
+		m_clockHand = (m_clockHand + 1) % n;
+
+		if (r == loading ||
+			r->m_referenced.exchange(false, std::memory_order_relaxed) ||
+			e->handle.use_count() > 1 ||
+			!r->try_lock())
+		{
+			continue;
+		}
+
+		// The lookups copy the handle without the manager lock, so it can have been taken
+		// (and the resource used) since the checks above. Readers check the status under
+		// the resource lock, one that got it before this lock keeps the resource loaded.
+
+		if (e->handle.use_count() > 1 ||
+			r->m_referenced.load(std::memory_order_relaxed))
+		{
+			r->unlock();
+			continue;
+		}
+
+		// use_count is a relaxed load, the fence orders the unload after the uses of the
+		// last pointer released elsewhere (shared_ptr releases its count with acq_rel)
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (r->m_status == FUSE_RESOURCE_LOADED)
+		{
+			size_t size = r->m_size;
+
+			r->unload();
+
+			m_evictions++;
+			m_evictedBytes += size;
+		}
+
+		r->unlock();
+
+	}
+
 }
 
-/* Non interlocked implementations */
+/* Lookup tables */
 
-std::shared_ptr<resource> resource_manager::find_by_name_unsafe(const char_t * name) const
+template <typename Hash>
+void resource_manager::insert(std::atomic<table*> & current, entry * e, Hash hash)
 {
 
-	if (!FUSE_RESOURCE_IS_UNNAMED(name))
+	table * t = current.load(std::memory_order_relaxed);
+
+	// Keeps the load factor under 1/2 so the probe sequences stay short
+
+	if ((t->size + 1) * 2 > t->capacity)
 	{
 
-		auto it = m_namedResources.find(name);
+		table * grown = new table(t->capacity * 2);
 
-		if (it != m_namedResources.end())
+		m_tables.emplace_back(grown);
+
+		for (size_t i = 0; i < t->capacity; i++)
 		{
-			return find_by_id_unsafe(it->second);
+
+			entry * old = t->slots[i].load(std::memory_order_relaxed);
+
+			if (old)
+			{
+				grown->insert(hash(old), old);
+			}
+
 		}
 
+		t = grown;
+
 	}
 
-	return std::shared_ptr<resource>();
+	t->insert(hash(e), e);
+
+	current.store(t, std::memory_order_release);
 
 }
 
-std::shared_ptr<resource> resource_manager::find_by_id_unsafe(resource::id_type id) const
+resource_manager::table::table(size_t capacity) :
+	slots(new std::atomic<entry*>[capacity]),
+	capacity(capacity),
+	size(0)
+{
+	for (size_t i = 0; i < capacity; i++)
+	{
+		slots[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+resource_manager::entry * resource_manager::table::find(size_t hash, const char_t * name) const
 {
 
-	auto it = m_resources.find(id);
+	entry * e;
 
-	if (it != m_resources.end())
+	for (size_t i = hash & (capacity - 1); (e = slots[i].load(std::memory_order_acquire)); i = (i + 1) & (capacity - 1))
 	{
-		return it->second;
+
+		if (e->hash == hash && e->name == name)
+		{
+			return e;
+		}
+
 	}
-	
-	return std::shared_ptr<resource>();
+
+	return nullptr;
+
+}
+
+resource_manager::entry * resource_manager::table::find(resource::id_type id) const
+{
+
+	entry * e;
+
+	for (size_t i = id & (capacity - 1); (e = slots[i].load(std::memory_order_acquire)); i = (i + 1) & (capacity - 1))
+	{
+
+		if (e->id == id)
+		{
+			return e;
+		}
+
+	}
+
+	return nullptr;
+
+}
+
+void resource_manager::table::insert(size_t hash, entry * e)
+{
+
+	size_t i = hash & (capacity - 1);
+
+	while (slots[i].load(std::memory_order_relaxed))
+	{
+		i = (i + 1) & (capacity - 1);
+	}
+
+	slots[i].store(e, std::memory_order_release);
+	size++;
 
 }
\ No newline at end of file
@@ -1,12 +1,13 @@
 #include <fuse/scene_graph.hpp>
+#include <algorithm>
 #include <cassert>
 
 using namespace fuse;
 
-FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(scene_graph_node, 16)
-FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(scene_graph_group, 16)
-FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(scene_graph_geometry, 16)
-FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(scene_graph_camera, 16)
+FUSE_DEFINE_TAGGED_ALIGNED_ALLOCATOR_NEW(scene_graph_node, 16, FUSE_MEMORY_TAG_SCENE)
+FUSE_DEFINE_SLAB_ALLOCATOR_NEW(scene_graph_group, 16, FUSE_MEMORY_TAG_SCENE)
+FUSE_DEFINE_SLAB_ALLOCATOR_NEW(scene_graph_geometry, 16, FUSE_MEMORY_TAG_SCENE)
+FUSE_DEFINE_SLAB_ALLOCATOR_NEW(scene_graph_camera, 16, FUSE_MEMORY_TAG_SCENE)
 
 scene_graph_node::~scene_graph_node(void)
 {
@@ -68,6 +69,10 @@ void scene_graph_node::set_parent(scene_graph_node * parent)
 
 	switch_parent(parent);
 
+#ifdef FUSE_SCENE_GRAPH_FLAT_TRANSFORMS
+	m_parent = parent;
+#endif
+
 	if (parent)
 	{
 		parent->m_children.push_back(this);
@@ -76,22 +81,47 @@ void scene_graph_node::set_parent(scene_graph_node * parent)
 
 void scene_graph_node::update(void)
 {
-	if (was_moved())
-	{
-		mat128 oldTransform = m_globalMatrix;
-		mat128 newTransform = get_global_matrix();
-
-		update_impl();
+	mat128 oldTransform, newTransform;
 
+	if (update_node(oldTransform, newTransform))
+	{
 		for (scene_graph_node_listener * listener : m_listeners)
 		{
 			listener->on_scene_graph_node_move(this, oldTransform, newTransform);
 		}
+	}
+
+	for (scene_graph_node * n : m_children) n->update();
+}
+
+bool scene_graph_node::update_node(mat128 & oldTransform, mat128 & newTransform)
+{
+	if (was_moved())
+	{
+		oldTransform = get_previous_global_matrix();
+		newTransform = get_global_matrix();
+
+		update_impl();
 
 		set_moved(false);
+
+		return true;
 	}
 
-	for (scene_graph_node * n : m_children) n->update();
+	return false;
+}
+
+void scene_graph_node::update_subtree(scene_graph_node_move_vector & moves)
+{
+	scene_graph_node_move move;
+
+	if (update_node(move.oldTransform, move.newTransform))
+	{
+		move.node = this;
+		moves.push_back(move);
+	}
+
+	for (scene_graph_node * n : m_children) n->update_subtree(moves);
 }
 
 void scene_graph_node::on_parent_destruction(void)
@@ -116,8 +146,193 @@ void scene_graph_node::clear_children(void)
 	m_children.clear();
 }
 
+void scene_graph::clear(void)
+{
+	// The nodes of the slab allocators are destroyed in place and their slots taken back
+	// at once, which rewinds the slabs if no other graph has nodes left in them.
+
+	scene_graph_group::allocator_discard_list    groups;
+	scene_graph_geometry::allocator_discard_list geometry;
+	scene_graph_camera::allocator_discard_list   cameras;
+
+	clear_impl(m_root.release(), groups, geometry, cameras);
+
+	scene_graph_group::discard_allocator_slots(groups);
+	scene_graph_geometry::discard_allocator_slots(geometry);
+	scene_graph_camera::discard_allocator_slots(cameras);
+
+	m_root.reset(new scene_graph_group());
+}
+
+void scene_graph::clear_impl(scene_graph_node * n,
+	scene_graph_group::allocator_discard_list & groups,
+	scene_graph_geometry::allocator_discard_list & geometry,
+	scene_graph_camera::allocator_discard_list & cameras)
+{
+	// Children first, each node is gone before its parent so nothing is left to unlink
+
+	for (scene_graph_node * c : n->m_children)
+	{
+		clear_impl(c, groups, geometry, cameras);
+	}
+
+	n->m_children.clear();
+	n->m_parent = nullptr;
+
+	if (scene_graph_group::allocator_owns(n))
+	{
+		n->~scene_graph_node();
+		groups.push(n);
+	}
+	else if (scene_graph_geometry::allocator_owns(n))
+	{
+		n->~scene_graph_node();
+		geometry.push(n);
+	}
+	else if (scene_graph_camera::allocator_owns(n))
+	{
+		n->~scene_graph_node();
+		cameras.push(n);
+	}
+	else
+	{
+		delete n;
+	}
+}
+
 void scene_graph_camera::update_impl(void)
 {
 	m_camera.set_orientation(to_quaternion(get_global_rotation()));
 	m_camera.set_position(to_float3(get_global_translation()));
+}
+
+/* Parallel update */
+
+#define FUSE_SCENE_GRAPH_TASKS_PER_THREAD   4
+#define FUSE_SCENE_GRAPH_MAX_SERIAL_LEVELS 8
+
+namespace
+{
+
+	struct scene_graph_update_segment
+	{
+		scene_graph_node             * node;
+		bool                           expanded;
+		scene_graph_node_move_vector   moves;
+	};
+
+}
+
+void scene_graph::update(thread_pool & pool)
+{
+	// Segments are kept in pre-order, so concatenating their moves gives the
+	// same sequence the serial update would produce. An expanded segment holds
+	// the move of its node alone, the others the moves of the whole subtree.
+
+	std::vector<scene_graph_update_segment> segments;
+	segments.push_back({ m_root.get(), false, {} });
+
+	size_t targetTasks = FUSE_SCENE_GRAPH_TASKS_PER_THREAD * (pool.get_threads_count() + 1);
+
+	for (int level = 0; level < FUSE_SCENE_GRAPH_MAX_SERIAL_LEVELS; level++)
+	{
+		size_t tasks = std::count_if(segments.begin(), segments.end(),
+			[](const scene_graph_update_segment & segment) { return !segment.expanded; });
+
+		if (tasks == 0 || tasks >= targetTasks)
+		{
+			break;
+		}
+
+		std::vector<scene_graph_update_segment> expandedSegments;
+
+		for (scene_graph_update_segment & segment : segments)
+		{
+			if (segment.expanded)
+			{
+				expandedSegments.push_back(std::move(segment));
+				continue;
+			}
+
+			scene_graph_node * node = segment.node;
+
+			segment.expanded = true;
+
+			scene_graph_node_move move;
+
+			if (node->update_node(move.oldTransform, move.newTransform))
+			{
+				move.node = node;
+				segment.moves.push_back(move);
+			}
+
+			// The subtrees will read the global matrices of this node concurrently
+			// when computing their own, have them computed here
+
+			node->get_global_matrix();
+#ifndef FUSE_SCENE_GRAPH_FLAT_TRANSFORMS
+			node->get_global_translation_rotation_matrix();
+#endif
+
+			expandedSegments.push_back(std::move(segment));
+
+			for (scene_graph_node * child : node->m_children)
+			{
+				expandedSegments.push_back({ child, false, {} });
+			}
+		}
+
+		segments.swap(expandedSegments);
+	}
+
+	// parallel_for returns once these subtrees are done, pool.wait() would also wait for
+	// the unrelated tasks of the pool (e.g. the asynchronous loads)
+
+	std::vector<scene_graph_update_segment*> subtrees;
+
+	for (scene_graph_update_segment & segment : segments)
+	{
+		if (!segment.expanded)
+		{
+			subtrees.push_back(&segment);
+		}
+	}
+
+	pool.parallel_for(subtrees.size(), 1,
+		[&subtrees](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				subtrees[i]->node->update_subtree(subtrees[i]->moves);
+			}
+		});
+
+	// Deliver the moves grouped by listener
+
+	std::vector<std::pair<scene_graph_node_listener*, std::vector<const scene_graph_node_move*>>> batches;
+
+	for (const scene_graph_update_segment & segment : segments)
+	{
+		for (const scene_graph_node_move & move : segment.moves)
+		{
+			for (scene_graph_node_listener * listener : move.node->m_listeners)
+			{
+				auto it = std::find_if(batches.begin(), batches.end(),
+					[listener](const std::pair<scene_graph_node_listener*, std::vector<const scene_graph_node_move*>> & batch) { return batch.first == listener; });
+
+				if (it == batches.end())
+				{
+					batches.emplace_back(listener, std::vector<const scene_graph_node_move*>());
+					it = batches.end() - 1;
+				}
+
+				it->second.push_back(&move);
+			}
+		}
+	}
+
+	for (auto & batch : batches)
+	{
+		batch.first->on_scene_graph_node_move_batch(batch.second);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include <fuse/tangent_space.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace fuse;
+
+static inline void parallel_ranges(thread_pool * pool, size_t count, const thread_pool::range_type & body)
+{
+	if (pool)
+	{
+		pool->parallel_for(count, FUSE_TANGENT_SPACE_GRAIN, body);
+	}
+	else if (count)
+	{
+		body(0, count);
+	}
+}
+
+// The length of math.hpp is a fast approximation, the basis is normalized exactly
+// as it ends up quantized on the octahedron
+
+static inline float3 unit(const float3 & v)
+{
+	return v * (1.f / std::sqrt(dot(v, v)));
+}
+
+// Arbitrary orthonormal basis around the normal
+
+static inline void normal_basis(const float3 & normal, float3 & tangent, float3 & bitangent)
+{
+	float3 v = std::abs(normal.x) > .99f ? float3(0, 1, 0) : float3(1, 0, 0);
+
+	float3 b = cross(normal, v);
+	float3 t = cross(normal, b);
+
+	bitangent = unit(b);
+	tangent   = unit(t);
+}
+
+/* Triangle directions */
+
+// Component of the vertices of 4 consecutive triangles
+
+static inline vec128 gather(const float * base, size_t stride, const uint32_t * triangles, int corner, int component)
+{
+	return vec128_set(
+		base[triangles[corner] * stride + component],
+		base[triangles[3 + corner] * stride + component],
+		base[triangles[6 + corner] * stride + component],
+		base[triangles[9 + corner] * stride + component]);
+}
+
+// Tangent (s) and bitangent (t) directions of the triangles in [begin, end),
+// 4 triangles at a time. Triangles with degenerate UVs get null directions.
+
+static void triangle_directions(
+	const float3 * positions,
+	const float2 * texcoords,
+	const uint32_t * indices,
+	size_t begin,
+	size_t end,
+	float * sx, float * sy, float * sz,
+	float * tx, float * ty, float * tz)
+{
+	const float epsilon = 1e-20f;
+
+	const float * p  = reinterpret_cast<const float *>(positions);
+	const float * uv = reinterpret_cast<const float *>(texcoords);
+
+	size_t t = begin;
+
+	for (; t + 4 <= end; t += 4)
+	{
+		const uint32_t * triangles = indices + 3 * t;
+
+		vec128 x0 = gather(p, 3, triangles, 0, 0);
+		vec128 y0 = gather(p, 3, triangles, 0, 1);
+		vec128 z0 = gather(p, 3, triangles, 0, 2);
+
+		vec128 e1x = gather(p, 3, triangles, 1, 0) - x0;
+		vec128 e1y = gather(p, 3, triangles, 1, 1) - y0;
+		vec128 e1z = gather(p, 3, triangles, 1, 2) - z0;
+
+		vec128 e2x = gather(p, 3, triangles, 2, 0) - x0;
+		vec128 e2y = gather(p, 3, triangles, 2, 1) - y0;
+		vec128 e2z = gather(p, 3, triangles, 2, 2) - z0;
+
+		vec128 u0 = gather(uv, 2, triangles, 0, 0);
+		vec128 v0 = gather(uv, 2, triangles, 0, 1);
+
+		vec128 du1 = gather(uv, 2, triangles, 1, 0) - u0;
+		vec128 dv1 = gather(uv, 2, triangles, 1, 1) - v0;
+		vec128 du2 = gather(uv, 2, triangles, 2, 0) - u0;
+		vec128 dv2 = gather(uv, 2, triangles, 2, 1) - v0;
+
+		vec128 det    = du1 * dv2 - du2 * dv1;
+		vec128 absDet = vec128_max(det, vec128_negate(det));
+		vec128 r      = vec128_and(vec128_div(vec128_one(), det), vec128_gt(absDet, vec128_set(epsilon, epsilon, epsilon, epsilon)));
+
+		_mm_storeu_ps(sx + t, (e1x * dv2 - e2x * dv1) * r);
+		_mm_storeu_ps(sy + t, (e1y * dv2 - e2y * dv1) * r);
+		_mm_storeu_ps(sz + t, (e1z * dv2 - e2z * dv1) * r);
+
+		_mm_storeu_ps(tx + t, (e2x * du1 - e1x * du2) * r);
+		_mm_storeu_ps(ty + t, (e2y * du1 - e1y * du2) * r);
+		_mm_storeu_ps(tz + t, (e2z * du1 - e1z * du2) * r);
+	}
+
+	for (; t < end; t++)
+	{
+		const uint32_t * triangle = indices + 3 * t;
+
+		float3 e1 = positions[triangle[1]] - positions[triangle[0]];
+		float3 e2 = positions[triangle[2]] - positions[triangle[0]];
+
+		float2 d1 = texcoords[triangle[1]] - texcoords[triangle[0]];
+		float2 d2 = texcoords[triangle[2]] - texcoords[triangle[0]];
+
+		float det = d1.x * d2.y - d2.x * d1.y;
+		float r   = std::abs(det) > epsilon ? 1.f / det : 0.f;
+
+		float3 s = (e1 * d2.y - e2 * d1.y) * r;
+		float3 b = (e2 * d1.x - e1 * d2.x) * r;
+
+		sx[t] = s.x;
+		sy[t] = s.y;
+		sz[t] = s.z;
+
+		tx[t] = b.x;
+		ty[t] = b.y;
+		tz[t] = b.z;
+	}
+}
+
+/* Tangent space */
+
+void fuse::compute_tangent_space(
+	const float3 * positions,
+	const float3 * normals,
+	const float2 * texcoords,
+	const uint32_t * indices,
+	size_t numIndices,
+	size_t numVertices,
+	float3 * tangents,
+	float3 * bitangents,
+	thread_pool * pool)
+{
+	size_t numTriangles = numIndices / 3;
+
+	if (!texcoords || !numTriangles)
+	{
+		parallel_ranges(pool, numVertices, [=](size_t begin, size_t end)
+		{
+			for (size_t v = begin; v < end; v++)
+			{
+				normal_basis(normals[v], tangents[v], bitangents[v]);
+			}
+		});
+
+		return;
+	}
+
+	// The directions of each triangle, in parallel since triangles are independent
+
+	std::vector<float> directions(6 * numTriangles);
+
+	float * sx = directions.data();
+	float * sy = sx + numTriangles;
+	float * sz = sy + numTriangles;
+	float * tx = sz + numTriangles;
+	float * ty = tx + numTriangles;
+	float * tz = ty + numTriangles;
+
+	parallel_ranges(pool, numTriangles, [=](size_t begin, size_t end)
+	{
+		triangle_directions(positions, texcoords, indices, begin, end, sx, sy, sz, tx, ty, tz);
+	});
+
+	// The triangles adjacent to each vertex, so that every vertex is accumulated
+	// by a single thread with no atomics
+
+	std::vector<uint32_t> offsets(numVertices + 1, 0);
+	std::vector<uint32_t> adjacency(3 * numTriangles);
+
+	for (size_t i = 0; i < 3 * numTriangles; i++)
+	{
+		++offsets[indices[i] + 1];
+	}
+
+	for (size_t v = 0; v < numVertices; v++)
+	{
+		offsets[v + 1] += offsets[v];
+	}
+
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+		for (size_t i = 0; i < 3 * numTriangles; i++)
+		{
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	const uint32_t * vertexOffsets   = offsets.data();
+	const uint32_t * vertexTriangles = adjacency.data();
+
+	parallel_ranges(pool, numVertices, [=](size_t begin, size_t end)
+	{
+		for (size_t v = begin; v < end; v++)
+		{
+			float3 s(0, 0, 0);
+			float3 b(0, 0, 0);
+
+			for (uint32_t k = vertexOffsets[v]; k < vertexOffsets[v + 1]; k++)
+			{
+				uint32_t t = vertexTriangles[k];
+
+				s = s + float3(sx[t], sy[t], sz[t]);
+				b = b + float3(tx[t], ty[t], tz[t]);
+			}
+
+			// Gram-Schmidt, the bitangent keeps only the handedness of the accumulated one
+
+			const float3 & n = normals[v];
+
+			float3 tangent = s - n * dot(n, s);
+			float  l       = dot(tangent, tangent);
+
+			if (l > 1e-24f)
+			{
+				tangent = tangent * (1.f / std::sqrt(l));
+
+				float3 bitangent = cross(n, tangent);
+
+				tangents[v]   = tangent;
+				bitangents[v] = dot(bitangent, b) < 0.f ? bitangent * -1.f : bitangent;
+			}
+			else
+			{
+				normal_basis(n, tangents[v], bitangents[v]);
+			}
+		}
+	});
+}
\ No newline at end of file
@@ -38,7 +38,9 @@ void text_renderer::render(
 		};
 
 		size_t n = strlen(text);
-		std::vector<__char> data;
+		// Rebuilt for each text drawn, the frame arena saves the heap allocation
+
+		std::vector<__char, frame_allocator<__char>> data;
 
 		data.reserve(6 * n);
 
@@ -117,6 +117,7 @@ bool texture::load_impl(void)
 		auto & params = get_parameters();
 
 		auto renderContext = gpu_render_context::get_singleton_pointer();
+		std::lock_guard<gpu_render_context> lock(*renderContext);
 
 		auto mipmaps         = params.get_optional<UINT>(FUSE_LITERAL("mipmaps"));
 		auto generateMipmaps = params.get_optional<bool>(FUSE_LITERAL("generate_mipmaps"));
@@ -137,6 +138,11 @@ bool texture::load_impl(void)
 	return false;
 }
 
+void texture::get_dependencies_impl(std::vector<std::shared_ptr<resource>> & dependencies)
+{
+	dependencies.push_back(resource_factory::get_singleton_pointer()->create<image>(FUSE_RESOURCE_TYPE_IMAGE, get_name()));
+}
+
 void texture::unload_impl(void)
 {
 	auto renderContext = gpu_render_context::get_singleton_pointer();
@@ -0,0 +1,9 @@
+#include <fuse/transform_system_node.hpp>
+
+using namespace fuse;
+
+transform_system & transform_system_node::get_default_system(void)
+{
+	static transform_system system;
+	return system;
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include <fuse/vertex_compression.hpp>
+#include <fuse/mesh.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace fuse;
+
+/* Octahedral encoding */
+
+static inline float sign_not_zero(float x)
+{
+	return x >= 0.f ? 1.f : -1.f;
+}
+
+static inline int16_t snorm16_encode(float x)
+{
+	return static_cast<int16_t>(std::round(std::min(std::max(x, -1.f), 1.f) * 32767.f));
+}
+
+static inline float snorm16_decode(int16_t x)
+{
+	// -32768 and -32767 are both -1, as the GPU reads them
+	return std::max(x / 32767.f, -1.f);
+}
+
+void fuse::octahedral_encode(const float3 & v, int16_t * encoded)
+{
+	float l1 = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+
+	float x = l1 > 0.f ? v.x / l1 : 0.f;
+	float y = l1 > 0.f ? v.y / l1 : 0.f;
+
+	if (v.z < 0.f)
+	{
+		float ox = (1.f - std::abs(y)) * sign_not_zero(x);
+		float oy = (1.f - std::abs(x)) * sign_not_zero(y);
+
+		x = ox;
+		y = oy;
+	}
+
+	encoded[0] = snorm16_encode(x);
+	encoded[1] = snorm16_encode(y);
+}
+
+float3 fuse::octahedral_decode(const int16_t * encoded)
+{
+	float x = snorm16_decode(encoded[0]);
+	float y = snorm16_decode(encoded[1]);
+	float z = 1.f - std::abs(x) - std::abs(y);
+
+	if (z < 0.f)
+	{
+		float ox = (1.f - std::abs(y)) * sign_not_zero(x);
+		float oy = (1.f - std::abs(x)) * sign_not_zero(y);
+
+		x = ox;
+		y = oy;
+	}
+
+	float invLength = 1.f / std::sqrt(x * x + y * y + z * z);
+
+	return float3(x * invLength, y * invLength, z * invLength);
+}
+
+/* Half precision */
+
+uint16_t fuse::half_encode(float x)
+{
+	uint32_t f;
+	std::memcpy(&f, &x, sizeof(float));
+
+	uint16_t sign = static_cast<uint16_t>((f >> 16) & 0x8000);
+
+	f &= 0x7FFFFFFF;
+
+	uint16_t h;
+
+	if (f >= 0x47800000)
+	{
+		// Too large for a half, or already infinity or NaN
+		h = f > 0x7F800000 ? 0x7E00 : 0x7C00;
+	}
+	else if (f < 0x38800000)
+	{
+		// Denormal half, adding .5 aligns the mantissa so that the FPU does the rounding
+		float d;
+		std::memcpy(&d, &f, sizeof(float));
+
+		d += .5f;
+
+		uint32_t u;
+		std::memcpy(&u, &d, sizeof(float));
+
+		h = static_cast<uint16_t>(u - 0x3F000000);
+	}
+	else
+	{
+		// Rebias the exponent and round the mantissa to the nearest even
+		uint32_t odd = (f >> 13) & 1;
+
+		f += 0xC8000FFF + odd;
+
+		h = static_cast<uint16_t>(f >> 13);
+	}
+
+	return h | sign;
+}
+
+float fuse::half_decode(uint16_t h)
+{
+	uint32_t sign     = static_cast<uint32_t>(h & 0x8000) << 16;
+	uint32_t exponent = (h >> 10) & 0x1F;
+	uint32_t mantissa = h & 0x3FF;
+
+	if (exponent == 0)
+	{
+		float d = std::ldexp(static_cast<float>(mantissa), -24);
+		return sign ? -d : d;
+	}
+
+	uint32_t f = exponent == 0x1F ?
+		sign | 0x7F800000 | (mantissa << 13) :
+		sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+	float x;
+	std::memcpy(&x, &f, sizeof(float));
+
+	return x;
+}
+
+/* Unorm */
+
+uint16_t fuse::unorm16_encode(float x)
+{
+	return static_cast<uint16_t>(std::round(std::min(std::max(x, 0.f), 1.f) * 65535.f));
+}
+
+float fuse::unorm16_decode(uint16_t x)
+{
+	return x / 65535.f;
+}
+
+/* Layout */
+
+uint32_t fuse::get_compressed_attributes_stride(uint32_t storageFlags)
+{
+	uint32_t stride = 0;
+
+	if (storageFlags & FUSE_MESH_STORAGE_NORMALS)
+	{
+		stride += 2 * sizeof(int16_t);
+	}
+
+	if (storageFlags & FUSE_MESH_STORAGE_TANGENTS)
+	{
+		stride += 2 * sizeof(int16_t);
+	}
+
+	for (int i = 0; i < FUSE_MESH_MAX_TEXCOORDS; i++)
+	{
+		if (storageFlags & (FUSE_MESH_STORAGE_TEXCOORDS0 << i))
+		{
+			stride += 2 * sizeof(uint16_t);
+		}
+	}
+
+	return stride;
+}
\ No newline at end of file
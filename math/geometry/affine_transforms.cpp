@@ -1,5 +1,3 @@
-#pragma once
-
 #include <fuse/math.hpp>
 
 namespace fuse
@@ -76,8 +74,9 @@ namespace fuse
 		R.c[0] = mt.c[0] * vec128_splat<FUSE_X>(rcpScale);
 		R.c[1] = mt.c[1] * vec128_splat<FUSE_Y>(rcpScale);
 		R.c[2] = mt.c[2] * vec128_splat<FUSE_Z>(rcpScale);
+		R.c[3] = vec128_set(0.f, 0.f, 0.f, 1.f);
 
-		rotation = to_quat128(R);
+		rotation = to_quat128(mat128_transpose(R));
 
 		// Output
 
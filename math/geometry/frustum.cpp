@@ -41,6 +41,7 @@ static inline vec128 plane_intersection(const plane & p1, const plane & p2, cons
 	At.c[0] = p1v;
 	At.c[1] = p2v;
 	At.c[2] = p3v;
+	At.c[3] = vec128_zero();
 
 	A = mat128_transpose(At);
 	b = vec128_negate(vec128_shuffle<FUSE_X0, FUSE_Y0, FUSE_W1, FUSE_W1>(vec128_permute<FUSE_W0, FUSE_W1, FUSE_Z0, FUSE_W0>(p1v, p2v), p3v));
@@ -0,0 +1,259 @@
+#include <fuse/geometry/frustum_culling.hpp>
+#include <fuse/math/simd_dispatch.hpp>
+
+#include <algorithm>
+
+using namespace fuse;
+
+/* AVX kernels (frustum_culling_avx.cpp), 8 volumes at a time */
+
+namespace fuse
+{
+
+	namespace detail
+	{
+
+		size_t frustum_cull_spheres_avx(const float * planes, const float * spheres, size_t n, uint32_t * indices, uint32_t planeMask);
+		size_t frustum_classify_boxes_avx(const float * planes, const float * boxes, size_t n, uint32_t * indices, uint32_t * straddledMasks, uint32_t planeMask);
+
+	}
+
+}
+
+FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(frustum_planes_soa, 16)
+
+frustum_planes_soa::frustum_planes_soa(const frustum & f)
+{
+	auto & planes = f.get_planes();
+
+	for (int i = 0; i < 6; i++)
+	{
+		vec128 planeVector = planes[i].get_plane_vector();
+
+		x[i] = vec128_splat<FUSE_X>(planeVector);
+		y[i] = vec128_splat<FUSE_Y>(planeVector);
+		z[i] = vec128_splat<FUSE_Z>(planeVector);
+		w[i] = vec128_splat<FUSE_W>(planeVector);
+	}
+}
+
+/* SoA plane tests, return a 4 bit mask of the visible volumes */
+
+static inline int FUSE_VECTOR_CALL frustum_cull_spheres4(const frustum_planes_soa & f, uint32_t planeMask, vec128 cx, vec128 cy, vec128 cz, vec128 r)
+{
+	vec128 outside = vec128_zero();
+
+	for (int i = 0; i < 6; i++)
+	{
+		if (!(planeMask & (1 << i)))
+		{
+			continue;
+		}
+
+		vec128 d = vec128_add(vec128_add(vec128_mul(f.x[i], cx), vec128_mul(f.y[i], cy)),
+		                      vec128_add(vec128_mul(f.z[i], cz), f.w[i]));
+
+		outside = vec128_or(outside, vec128_gt(d, r));
+	}
+
+	return ~vec128_signmask(outside) & 0xF;
+}
+
+static inline int FUSE_VECTOR_CALL frustum_classify_boxes4(const frustum_planes_soa & f, uint32_t planeMask, vec128 cx, vec128 cy, vec128 cz, vec128 hx, vec128 hy, vec128 hz, uint32_t * straddledMasks)
+{
+	vec128 outside = vec128_zero();
+	vec128 signBit = vec128_minus_zero();
+
+	straddledMasks[0] = straddledMasks[1] = straddledMasks[2] = straddledMasks[3] = 0;
+
+	for (int i = 0; i < 6; i++)
+	{
+		if (!(planeMask & (1 << i)))
+		{
+			continue;
+		}
+
+		// The box is outside if its center is farther from the plane than the
+		// projection of the half extents on the plane normal
+
+		vec128 d = vec128_add(vec128_add(vec128_mul(f.x[i], cx), vec128_mul(f.y[i], cy)),
+		                      vec128_add(vec128_mul(f.z[i], cz), f.w[i]));
+
+		vec128 absX = vec128_xor(f.x[i], vec128_and(f.x[i], signBit));
+		vec128 absY = vec128_xor(f.y[i], vec128_and(f.y[i], signBit));
+		vec128 absZ = vec128_xor(f.z[i], vec128_and(f.z[i], signBit));
+
+		vec128 e = vec128_add(vec128_add(vec128_mul(absX, hx), vec128_mul(absY, hy)), vec128_mul(absZ, hz));
+
+		outside = vec128_or(outside, vec128_gt(d, e));
+
+		// Boxes not entirely on the inner side of the plane straddle it
+
+		int straddling = vec128_signmask(vec128_gt(d, vec128_negate(e)));
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			straddledMasks[lane] |= ((straddling >> lane) & 1) << i;
+		}
+	}
+
+	return ~vec128_signmask(outside) & 0xF;
+}
+
+static inline size_t frustum_cull_write_indices(int mask, uint32_t base, uint32_t * indices)
+{
+	// Branchless compaction, the index is always written and the
+	// counter only advances when the volume is visible
+
+	size_t count = 0;
+
+	for (uint32_t lane = 0; lane < 4; lane++)
+	{
+		indices[count] = base + lane;
+		count += (mask >> lane) & 1;
+	}
+
+	return count;
+}
+
+size_t fuse::frustum_cull(const frustum_planes_soa & f, const sphere * spheres, size_t n, uint32_t * indices, uint32_t planeMask)
+{
+	size_t count = 0;
+	size_t i     = 0;
+
+	// The AVX kernel culls the multiple of 8 part, the rest goes through the SSE path
+
+	if (simd_get_instruction_set() >= FUSE_SIMD_AVX)
+	{
+		i     = n & ~size_t(7);
+		count = detail::frustum_cull_spheres_avx(reinterpret_cast<const float*>(&f), reinterpret_cast<const float*>(spheres), i, indices, planeMask);
+	}
+
+	for (; i + 4 <= n; i += 4)
+	{
+		mat128 t;
+
+		t.c[0] = spheres[i].get_sphere_vector();
+		t.c[1] = spheres[i + 1].get_sphere_vector();
+		t.c[2] = spheres[i + 2].get_sphere_vector();
+		t.c[3] = spheres[i + 3].get_sphere_vector();
+
+		t = mat128_transpose(t);
+
+		int mask = frustum_cull_spheres4(f, planeMask, t.c[0], t.c[1], t.c[2], t.c[3]);
+		count += frustum_cull_write_indices(mask, (uint32_t) i, indices + count);
+	}
+
+	if (i < n)
+	{
+		// Pad the last batch replicating the last sphere, the padding lanes are masked out
+
+		size_t remaining = n - i;
+
+		mat128 t;
+
+		for (size_t lane = 0; lane < 4; lane++)
+		{
+			t.c[lane] = spheres[i + std::min(lane, remaining - 1)].get_sphere_vector();
+		}
+
+		t = mat128_transpose(t);
+
+		int mask = frustum_cull_spheres4(f, planeMask, t.c[0], t.c[1], t.c[2], t.c[3]) & ((1 << remaining) - 1);
+
+		for (uint32_t lane = 0; lane < remaining; lane++)
+		{
+			indices[count] = (uint32_t) i + lane;
+			count += (mask >> lane) & 1;
+		}
+	}
+
+	return count;
+}
+
+size_t fuse::frustum_cull(const frustum_planes_soa & f, const aabb * boxes, size_t n, uint32_t * indices, uint32_t planeMask)
+{
+	size_t count = 0;
+	size_t i     = 0;
+
+	if (simd_get_instruction_set() >= FUSE_SIMD_AVX)
+	{
+		i     = n & ~size_t(7);
+		count = detail::frustum_classify_boxes_avx(reinterpret_cast<const float*>(&f), reinterpret_cast<const float*>(boxes), i, indices, nullptr, planeMask);
+	}
+
+	for (; i < n; i += 4)
+	{
+		// Pad the last batch replicating the last box, the padding lanes are masked out
+
+		size_t batchSize = std::min<size_t>(4, n - i);
+
+		mat128 c, h;
+
+		for (size_t lane = 0; lane < 4; lane++)
+		{
+			const aabb & box = boxes[i + std::min(lane, batchSize - 1)];
+			c.c[lane] = box.get_center();
+			h.c[lane] = box.get_half_extents();
+		}
+
+		c = mat128_transpose(c);
+		h = mat128_transpose(h);
+
+		uint32_t laneMasks[4];
+
+		int mask = frustum_classify_boxes4(f, planeMask, c.c[0], c.c[1], c.c[2], h.c[0], h.c[1], h.c[2], laneMasks) & ((1 << batchSize) - 1);
+
+		for (uint32_t lane = 0; lane < batchSize; lane++)
+		{
+			indices[count] = (uint32_t) i + lane;
+			count += (mask >> lane) & 1;
+		}
+	}
+
+	return count;
+}
+
+size_t fuse::frustum_classify(const frustum_planes_soa & f, const aabb * boxes, size_t n, uint32_t * indices, uint32_t * straddledMasks, uint32_t planeMask)
+{
+	size_t count = 0;
+	size_t i     = 0;
+
+	if (simd_get_instruction_set() >= FUSE_SIMD_AVX)
+	{
+		i     = n & ~size_t(7);
+		count = detail::frustum_classify_boxes_avx(reinterpret_cast<const float*>(&f), reinterpret_cast<const float*>(boxes), i, indices, straddledMasks, planeMask);
+	}
+
+	for (; i < n; i += 4)
+	{
+		// Pad the last batch replicating the last box, the padding lanes are masked out
+
+		size_t batchSize = std::min<size_t>(4, n - i);
+
+		mat128 c, h;
+
+		for (size_t lane = 0; lane < 4; lane++)
+		{
+			const aabb & box = boxes[i + std::min(lane, batchSize - 1)];
+			c.c[lane] = box.get_center();
+			h.c[lane] = box.get_half_extents();
+		}
+
+		c = mat128_transpose(c);
+		h = mat128_transpose(h);
+
+		uint32_t laneMasks[4];
+
+		int mask = frustum_classify_boxes4(f, planeMask, c.c[0], c.c[1], c.c[2], h.c[0], h.c[1], h.c[2], laneMasks) & ((1 << batchSize) - 1);
+
+		for (uint32_t lane = 0; lane < batchSize; lane++)
+		{
+			indices[count]        = (uint32_t) i + lane;
+			straddledMasks[count] = laneMasks[lane];
+			count += (mask >> lane) & 1;
+		}
+	}
+
+	return count;
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+// Compiled with AVX code generation: only intrinsics are used here, no inline
+// functions shared with the other translation units, so that no VEX encoded
+// copy of them can be picked by the linker and run on older CPUs
+
+#include <immintrin.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fuse
+{
+
+	namespace detail
+	{
+
+		/* Helpers */
+
+		// Plane components of frustum_planes_soa, splatted to 8 lanes. Only
+		// the planes in the mask are kept.
+
+		struct frustum_planes_avx
+		{
+			__m256 x[6];
+			__m256 y[6];
+			__m256 z[6];
+			__m256 w[6];
+
+			int numPlanes;
+		};
+
+		static inline void load_planes(const float * planes, uint32_t planeMask, frustum_planes_avx & p, int * planeIndices)
+		{
+			p.numPlanes = 0;
+
+			for (int i = 0; i < 6; i++)
+			{
+				if (planeMask & (1 << i))
+				{
+					p.x[p.numPlanes] = _mm256_broadcast_ss(planes + 4 * i);
+					p.y[p.numPlanes] = _mm256_broadcast_ss(planes + 4 * (6 + i));
+					p.z[p.numPlanes] = _mm256_broadcast_ss(planes + 4 * (12 + i));
+					p.w[p.numPlanes] = _mm256_broadcast_ss(planes + 4 * (18 + i));
+
+					planeIndices[p.numPlanes++] = i;
+				}
+			}
+		}
+
+		// Loads the vec128 at in[0], in[stride], ..., in[7 * stride] and transposes them
+
+		static inline void load_transpose8(const float * in, size_t stride, __m256 & x, __m256 & y, __m256 & z, __m256 & w)
+		{
+			__m256 a0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(in)),              _mm_load_ps(in + 4 * stride), 1);
+			__m256 a1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(in + stride)),     _mm_load_ps(in + 5 * stride), 1);
+			__m256 a2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(in + 2 * stride)), _mm_load_ps(in + 6 * stride), 1);
+			__m256 a3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(in + 3 * stride)), _mm_load_ps(in + 7 * stride), 1);
+
+			__m256 t0 = _mm256_unpacklo_ps(a0, a1);
+			__m256 t1 = _mm256_unpackhi_ps(a0, a1);
+			__m256 t2 = _mm256_unpacklo_ps(a2, a3);
+			__m256 t3 = _mm256_unpackhi_ps(a2, a3);
+
+			x = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+			y = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			z = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			w = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		}
+
+		// Same summation order as the SSE kernels, so that both give the same results
+
+		static inline __m256 plane_distance(const frustum_planes_avx & p, int i, __m256 x, __m256 y, __m256 z)
+		{
+			return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p.x[i], x), _mm256_mul_ps(p.y[i], y)),
+			                     _mm256_add_ps(_mm256_mul_ps(p.z[i], z), p.w[i]));
+		}
+
+		static inline size_t write_indices8(int mask, uint32_t base, uint32_t * indices)
+		{
+			size_t count = 0;
+
+			for (uint32_t lane = 0; lane < 8; lane++)
+			{
+				indices[count] = base + lane;
+				count += (mask >> lane) & 1;
+			}
+
+			return count;
+		}
+
+		/* Kernels, n is a multiple of 8 */
+
+		size_t frustum_cull_spheres_avx(const float * planes, const float * spheres, size_t n, uint32_t * indices, uint32_t planeMask)
+		{
+			frustum_planes_avx p;
+			int planeIndices[6];
+
+			load_planes(planes, planeMask, p, planeIndices);
+
+			size_t count = 0;
+
+			for (size_t i = 0; i < n; i += 8, spheres += 32)
+			{
+				__m256 cx, cy, cz, r;
+				load_transpose8(spheres, 4, cx, cy, cz, r);
+
+				__m256 outside = _mm256_setzero_ps();
+
+				for (int j = 0; j < p.numPlanes; j++)
+				{
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(plane_distance(p, j, cx, cy, cz), r, _CMP_GT_OQ));
+				}
+
+				int mask = ~_mm256_movemask_ps(outside) & 0xFF;
+				count += write_indices8(mask, (uint32_t) i, indices + count);
+			}
+
+			return count;
+		}
+
+		size_t frustum_classify_boxes_avx(const float * planes, const float * boxes, size_t n, uint32_t * indices, uint32_t * straddledMasks, uint32_t planeMask)
+		{
+			frustum_planes_avx p;
+			int planeIndices[6];
+
+			load_planes(planes, planeMask, p, planeIndices);
+
+			__m256 signBit = _mm256_set1_ps(-0.f);
+
+			__m256 absX[6], absY[6], absZ[6];
+
+			for (int j = 0; j < p.numPlanes; j++)
+			{
+				absX[j] = _mm256_andnot_ps(signBit, p.x[j]);
+				absY[j] = _mm256_andnot_ps(signBit, p.y[j]);
+				absZ[j] = _mm256_andnot_ps(signBit, p.z[j]);
+			}
+
+			size_t count = 0;
+
+			for (size_t i = 0; i < n; i += 8, boxes += 64)
+			{
+				// Each box is a center and half extents vec128 pair
+
+				__m256 cx, cy, cz, cw;
+				__m256 hx, hy, hz, hw;
+
+				load_transpose8(boxes,     8, cx, cy, cz, cw);
+				load_transpose8(boxes + 4, 8, hx, hy, hz, hw);
+
+				__m256 outside = _mm256_setzero_ps();
+
+				uint32_t laneMasks[8] = { 0 };
+
+				for (int j = 0; j < p.numPlanes; j++)
+				{
+					__m256 d = plane_distance(p, j, cx, cy, cz);
+					__m256 e = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absX[j], hx), _mm256_mul_ps(absY[j], hy)), _mm256_mul_ps(absZ[j], hz));
+
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, e, _CMP_GT_OQ));
+
+					if (straddledMasks)
+					{
+						int straddling = _mm256_movemask_ps(_mm256_cmp_ps(d, _mm256_xor_ps(e, signBit), _CMP_GT_OQ));
+
+						for (int lane = 0; lane < 8; lane++)
+						{
+							laneMasks[lane] |= ((straddling >> lane) & 1) << planeIndices[j];
+						}
+					}
+				}
+
+				int mask = ~_mm256_movemask_ps(outside) & 0xFF;
+
+				if (straddledMasks)
+				{
+					for (uint32_t lane = 0; lane < 8; lane++)
+					{
+						indices[count]        = (uint32_t) i + lane;
+						straddledMasks[count] = laneMasks[lane];
+						count += (mask >> lane) & 1;
+					}
+				}
+				else
+				{
+					count += write_indices8(mask, (uint32_t) i, indices + count);
+				}
+			}
+
+			return count;
+		}
+
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include <fuse/geometry/transform_system.hpp>
+#include <fuse/geometry.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+
+#define FUSE_TRANSFORM_FLAG_ALIVE (1 << 0)
+#define FUSE_TRANSFORM_FLAG_DIRTY (1 << 1)
+#define FUSE_TRANSFORM_FLAG_MOVED (1 << 2)
+#define FUSE_TRANSFORM_FLAG_LOCAL (1 << 3)
+
+#define FUSE_TRANSFORM_INVALID_SLOT (0xFFFFFFFF)
+
+using namespace fuse;
+
+transform_system::transform_system(void) :
+	m_dirty(false),
+	m_reorder(false) { }
+
+transform_handle transform_system::create(transform_handle parent)
+{
+	transform_handle handle;
+	uint32_t         slot = static_cast<uint32_t>(m_handles.size());
+
+	if (m_freeHandles.empty())
+	{
+		handle = static_cast<transform_handle>(m_slots.size());
+		m_slots.push_back(slot);
+	}
+	else
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_slots[handle] = slot;
+	}
+
+	// Appending keeps the hierarchy order, the parent slot is always before the new one
+
+	m_localTranslation.push_back(vec128_zero());
+	m_localRotation.push_back(quat128_identity());
+	m_localScale.push_back(vec128_one());
+
+	m_localMatrix.push_back(mat128_identity());
+	m_worldMatrix.push_back(mat128_identity());
+	m_previousWorldMatrix.push_back(mat128_identity());
+
+	m_parents.push_back(parent == FUSE_TRANSFORM_INVALID_HANDLE ? FUSE_TRANSFORM_INVALID_SLOT : m_slots[parent]);
+	m_flags.push_back(FUSE_TRANSFORM_FLAG_ALIVE | FUSE_TRANSFORM_FLAG_DIRTY | FUSE_TRANSFORM_FLAG_MOVED | FUSE_TRANSFORM_FLAG_LOCAL);
+	m_handles.push_back(handle);
+
+	m_dirty = true;
+
+	return handle;
+}
+
+void transform_system::destroy(transform_handle transform)
+{
+	// The slot is only marked as dead, slots are compacted on the next update
+	// and the children of the transform become roots
+
+	uint32_t slot = m_slots[transform];
+
+	m_flags[slot]      = 0;
+	m_slots[transform] = FUSE_TRANSFORM_INVALID_SLOT;
+
+	m_freeHandles.push_back(transform);
+
+	m_dirty   = true;
+	m_reorder = true;
+}
+
+void transform_system::clear(void)
+{
+	m_localTranslation.clear();
+	m_localRotation.clear();
+	m_localScale.clear();
+
+	m_localMatrix.clear();
+	m_worldMatrix.clear();
+	m_previousWorldMatrix.clear();
+
+	m_parents.clear();
+	m_flags.clear();
+	m_handles.clear();
+
+	m_slots.clear();
+	m_freeHandles.clear();
+
+	m_dirty   = false;
+	m_reorder = false;
+}
+
+void transform_system::reserve(size_t size)
+{
+	m_localTranslation.reserve(size);
+	m_localRotation.reserve(size);
+	m_localScale.reserve(size);
+
+	m_localMatrix.reserve(size);
+	m_worldMatrix.reserve(size);
+	m_previousWorldMatrix.reserve(size);
+
+	m_parents.reserve(size);
+	m_flags.reserve(size);
+	m_handles.reserve(size);
+
+	m_slots.reserve(size);
+}
+
+void transform_system::update(void)
+{
+	if (!m_dirty)
+	{
+		return;
+	}
+
+	if (m_reorder)
+	{
+		reorder();
+	}
+
+	size_t numSlots = m_flags.size();
+
+	// Parents come first, so a dirty flag set on a parent in this sweep is
+	// seen by all of its children
+
+	for (size_t i = 0; i < numSlots; i++)
+	{
+		uint32_t parent = m_parents[i];
+		uint8_t  flags  = m_flags[i];
+
+		if ((flags & FUSE_TRANSFORM_FLAG_DIRTY) ||
+		    (parent != FUSE_TRANSFORM_INVALID_SLOT && (m_flags[parent] & FUSE_TRANSFORM_FLAG_DIRTY)))
+		{
+			// Transforms moved by their parent keep the local matrix
+
+			if (flags & FUSE_TRANSFORM_FLAG_LOCAL)
+			{
+				mat128 translationRotation = to_rotation4(m_localRotation[i]) * to_translation4(m_localTranslation[i]);
+				m_localMatrix[i] = to_scale4(m_localScale[i]) * translationRotation;
+			}
+
+			if (!(flags & FUSE_TRANSFORM_FLAG_MOVED))
+			{
+				m_previousWorldMatrix[i] = m_worldMatrix[i];
+			}
+
+			m_worldMatrix[i] = parent != FUSE_TRANSFORM_INVALID_SLOT ? m_localMatrix[i] * m_worldMatrix[parent] : m_localMatrix[i];
+			m_flags[i]       = (flags & ~FUSE_TRANSFORM_FLAG_LOCAL) | FUSE_TRANSFORM_FLAG_DIRTY | FUSE_TRANSFORM_FLAG_MOVED;
+		}
+	}
+
+	for (uint8_t & flags : m_flags)
+	{
+		flags &= ~FUSE_TRANSFORM_FLAG_DIRTY;
+	}
+
+	m_dirty = false;
+}
+
+transform_handle transform_system::get_parent(transform_handle transform) const
+{
+	uint32_t parent = m_parents[m_slots[transform]];
+
+	return parent != FUSE_TRANSFORM_INVALID_SLOT && (m_flags[parent] & FUSE_TRANSFORM_FLAG_ALIVE) ?
+		m_handles[parent] :
+		FUSE_TRANSFORM_INVALID_HANDLE;
+}
+
+void transform_system::set_parent(transform_handle transform, transform_handle parent, bool keepWorldTransform)
+{
+	uint32_t slot       = m_slots[transform];
+	uint32_t parentSlot = parent == FUSE_TRANSFORM_INVALID_HANDLE ? FUSE_TRANSFORM_INVALID_SLOT : m_slots[parent];
+
+	assert((parent == FUSE_TRANSFORM_INVALID_HANDLE || parentSlot != FUSE_TRANSFORM_INVALID_SLOT) && "Invalid parent transform.");
+
+#ifndef NDEBUG
+	for (transform_handle ancestor = parent; ancestor != FUSE_TRANSFORM_INVALID_HANDLE; ancestor = get_parent(ancestor))
+	{
+		assert(ancestor != transform && "Cannot parent a transform to one of its descendants.");
+	}
+#endif
+
+	if (keepWorldTransform)
+	{
+		update();
+
+		slot       = m_slots[transform];
+		parentSlot = parent == FUSE_TRANSFORM_INVALID_HANDLE ? FUSE_TRANSFORM_INVALID_SLOT : m_slots[parent];
+
+		mat128 local = parentSlot != FUSE_TRANSFORM_INVALID_SLOT ?
+			m_worldMatrix[slot] * mat128_inverse4(m_worldMatrix[parentSlot]) :
+			m_worldMatrix[slot];
+
+		decompose_affine(local, &m_localScale[slot], &m_localRotation[slot], &m_localTranslation[slot]);
+	}
+
+	m_parents[slot] = parentSlot;
+
+	// Parents need to be placed before their children
+
+	if (parentSlot != FUSE_TRANSFORM_INVALID_SLOT && parentSlot > slot)
+	{
+		m_reorder = true;
+	}
+
+	mark_dirty(slot, keepWorldTransform ? FUSE_TRANSFORM_FLAG_LOCAL : 0);
+}
+
+void FUSE_VECTOR_CALL transform_system::set_local_translation(transform_handle transform, vec128 t)
+{
+	uint32_t slot = m_slots[transform];
+	m_localTranslation[slot] = t;
+	mark_dirty(slot, FUSE_TRANSFORM_FLAG_LOCAL);
+}
+
+void FUSE_VECTOR_CALL transform_system::set_local_rotation(transform_handle transform, vec128 r)
+{
+	uint32_t slot = m_slots[transform];
+	m_localRotation[slot] = r;
+	mark_dirty(slot, FUSE_TRANSFORM_FLAG_LOCAL);
+}
+
+void FUSE_VECTOR_CALL transform_system::set_local_scale(transform_handle transform, vec128 s)
+{
+	uint32_t slot = m_slots[transform];
+	m_localScale[slot] = s;
+	mark_dirty(slot, FUSE_TRANSFORM_FLAG_LOCAL);
+}
+
+void transform_system::get_world_srt(transform_handle transform, vec128 * scale, vec128 * rotation, vec128 * translation) const
+{
+	decompose_affine(m_worldMatrix[m_slots[transform]], scale, rotation, translation);
+}
+
+bool transform_system::was_moved(transform_handle transform) const
+{
+	return (m_flags[m_slots[transform]] & FUSE_TRANSFORM_FLAG_MOVED) != 0;
+}
+
+void transform_system::set_moved(transform_handle transform, bool moved)
+{
+	uint8_t & flags = m_flags[m_slots[transform]];
+	flags = moved ? flags | FUSE_TRANSFORM_FLAG_MOVED : flags & ~FUSE_TRANSFORM_FLAG_MOVED;
+}
+
+void transform_system::clear_moved(void)
+{
+	for (uint8_t & flags : m_flags)
+	{
+		flags &= ~FUSE_TRANSFORM_FLAG_MOVED;
+	}
+}
+
+void transform_system::mark_dirty(uint32_t slot, uint8_t flags)
+{
+	m_flags[slot] |= FUSE_TRANSFORM_FLAG_DIRTY | flags;
+	m_dirty = true;
+}
+
+void transform_system::reorder(void)
+{
+	size_t numSlots = m_flags.size();
+
+	// Compute the depth of each live slot, parents of dead slots become roots
+
+	const uint32_t unknownDepth = 0xFFFFFFFF;
+
+	std::vector<uint32_t> depth(numSlots, unknownDepth);
+	std::vector<uint32_t> stack;
+
+	for (uint32_t i = 0; i < numSlots; i++)
+	{
+		if (m_parents[i] != FUSE_TRANSFORM_INVALID_SLOT && !(m_flags[m_parents[i]] & FUSE_TRANSFORM_FLAG_ALIVE))
+		{
+			m_parents[i] = FUSE_TRANSFORM_INVALID_SLOT;
+			m_flags[i]  |= FUSE_TRANSFORM_FLAG_DIRTY;
+		}
+	}
+
+	for (uint32_t i = 0; i < numSlots; i++)
+	{
+		uint32_t current = i;
+
+		while (depth[current] == unknownDepth)
+		{
+			uint32_t parent = m_parents[current];
+
+			if (parent == FUSE_TRANSFORM_INVALID_SLOT)
+			{
+				depth[current] = 0;
+			}
+			else
+			{
+				stack.push_back(current);
+				current = parent;
+			}
+		}
+
+		for (; !stack.empty(); stack.pop_back())
+		{
+			depth[stack.back()] = depth[m_parents[stack.back()]] + 1;
+		}
+	}
+
+	// Stable sort of the live slots by depth, keeps the relative order of siblings
+
+	std::vector<uint32_t> order;
+	order.reserve(numSlots);
+
+	for (uint32_t i = 0; i < numSlots; i++)
+	{
+		if (m_flags[i] & FUSE_TRANSFORM_FLAG_ALIVE)
+		{
+			order.push_back(i);
+		}
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&depth](uint32_t a, uint32_t b) { return depth[a] < depth[b]; });
+
+	std::vector<uint32_t> newSlots(numSlots, FUSE_TRANSFORM_INVALID_SLOT);
+
+	for (uint32_t i = 0; i < order.size(); i++)
+	{
+		newSlots[order[i]] = i;
+	}
+
+	// Permute the arrays
+
+	auto permute = [&order](auto & v)
+	{
+		typename std::remove_reference<decltype(v)>::type permuted;
+		permuted.reserve(v.capacity());
+
+		for (uint32_t slot : order)
+		{
+			permuted.push_back(v[slot]);
+		}
+
+		v.swap(permuted);
+	};
+
+	permute(m_localTranslation);
+	permute(m_localRotation);
+	permute(m_localScale);
+	permute(m_localMatrix);
+	permute(m_worldMatrix);
+	permute(m_previousWorldMatrix);
+	permute(m_parents);
+	permute(m_flags);
+	permute(m_handles);
+
+	for (uint32_t & parent : m_parents)
+	{
+		parent = parent == FUSE_TRANSFORM_INVALID_SLOT ? FUSE_TRANSFORM_INVALID_SLOT : newSlots[parent];
+	}
+
+	for (uint32_t i = 0; i < m_handles.size(); i++)
+	{
+		m_slots[m_handles[i]] = i;
+	}
+
+	m_reorder = false;
+}
\ No newline at end of file
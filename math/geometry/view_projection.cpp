@@ -1,5 +1,3 @@
-#pragma once
-
 #include <fuse/geometry/view_projection.hpp>
 
 namespace fuse
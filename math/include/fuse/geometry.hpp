@@ -7,8 +7,11 @@
 #include "geometry/sphere.hpp"
 
 #include "geometry/intersection.hpp"
+#include "geometry/frustum_culling.hpp"
 #include "geometry/bounding_volumes.hpp"
 #include "geometry/transform_affine.hpp"
 
 #include "geometry/affine_transforms.hpp"
-#include "geometry/view_projection.hpp"
\ No newline at end of file
+#include "geometry/view_projection.hpp"
+
+#include "geometry/transform_system.hpp"
\ No newline at end of file
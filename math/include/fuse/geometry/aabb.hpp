@@ -64,7 +64,9 @@ namespace fuse
 		inline vec128 get_min(void) const { return m_center - m_halfExtents; }
 		inline vec128 get_max(void) const { return m_center + m_halfExtents; }
 
+FUSE_VEC128_TEMPLATE_ARGUMENTS_BEGIN
 		std::array<vec128, 8> get_corners(void) const;
+FUSE_VEC128_TEMPLATE_ARGUMENTS_END
 
 	private:
 
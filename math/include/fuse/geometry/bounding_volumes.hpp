@@ -2,6 +2,8 @@
 
 #include <fuse/geometry/sphere.hpp>
 
+#include <cfloat>
+
 namespace fuse
 {
 
@@ -69,6 +71,7 @@ namespace fuse
 
 		vec128 matrix_zero = vec128_zero();
 
+FUSE_VEC128_TEMPLATE_ARGUMENTS_BEGIN
 		std::array<vec128, 6> points = {
 			svec + vec128_permute<FUSE_W1, FUSE_Y0, FUSE_Z0, FUSE_W0>(matrix_zero, svec),
 			svec + vec128_permute<FUSE_X0, FUSE_W1, FUSE_Z0, FUSE_W0>(matrix_zero, svec),
@@ -77,6 +80,7 @@ namespace fuse
 			svec + vec128_permute<FUSE_X0, FUSE_W1, FUSE_Z0, FUSE_W0>(matrix_zero, msvec),
 			svec + vec128_permute<FUSE_X0, FUSE_Y0, FUSE_W1, FUSE_W0>(matrix_zero, msvec)
 		};
+FUSE_VEC128_TEMPLATE_ARGUMENTS_END
 
 		return bounding_aabb(points.begin(), points.end());
 	}
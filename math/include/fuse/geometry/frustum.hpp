@@ -5,6 +5,8 @@
 
 #define FUSE_MAKE_FRUSTUM_CORNER(Z, Y, X) ((X) | (Y << 1) | (Z << 2))
 
+#define FUSE_FRUSTUM_PLANES_MASK_ALL (0x3F)
+
 enum frustum_corners
 {
 	FUSE_FRUSTUM_NEAR_BOTTOM_RIGHT = FUSE_MAKE_FRUSTUM_CORNER(0, 0, 0),
@@ -45,7 +47,9 @@ namespace fuse
 		frustum & operator= (const frustum &) = default;
 		frustum & operator= (frustum &&) = default;
 
+FUSE_VEC128_TEMPLATE_ARGUMENTS_BEGIN
 		std::array<vec128, 8> get_corners(void) const;
+FUSE_VEC128_TEMPLATE_ARGUMENTS_END
 
 	private:
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <fuse/core.hpp>
+#include <fuse/math.hpp>
+
+#include <fuse/geometry/aabb.hpp>
+#include <fuse/geometry/frustum.hpp>
+#include <fuse/geometry/sphere.hpp>
+
+#include <cstdint>
+
+namespace fuse
+{
+
+	/*
+	*
+	* Frustum planes in SoA layout, each plane component is splatted in a
+	* vec128 so that the planes can be tested against 4 volumes at once
+	*
+	*/
+
+	class alignas(16) frustum_planes_soa
+	{
+
+	public:
+
+		frustum_planes_soa(void) = default;
+		frustum_planes_soa(const frustum_planes_soa &) = default;
+
+		frustum_planes_soa(const frustum & f);
+
+		frustum_planes_soa & operator= (const frustum_planes_soa &) = default;
+
+		vec128 x[6];
+		vec128 y[6];
+		vec128 z[6];
+		vec128 w[6];
+
+		FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+
+	};
+
+	/* Batched frustum culling */
+
+	// Tests the volumes against the frustum 4 at a time and writes the indices of
+	// the ones intersecting it in the indices array, which must be large enough to
+	// hold n elements. Returns the number of visible volumes. Only the planes in
+	// planeMask are tested.
+
+	size_t frustum_cull(const frustum_planes_soa & f, const sphere * spheres, size_t n, uint32_t * indices, uint32_t planeMask = FUSE_FRUSTUM_PLANES_MASK_ALL);
+	size_t frustum_cull(const frustum_planes_soa & f, const aabb * boxes, size_t n, uint32_t * indices, uint32_t planeMask = FUSE_FRUSTUM_PLANES_MASK_ALL);
+
+	// Like frustum_cull, also writes for each visible box the mask of the planes
+	// it straddles (0 if the box is fully inside the frustum) in straddledMasks
+
+	size_t frustum_classify(const frustum_planes_soa & f, const aabb * boxes, size_t n, uint32_t * indices, uint32_t * straddledMasks, uint32_t planeMask = FUSE_FRUSTUM_PLANES_MASK_ALL);
+
+	inline size_t frustum_cull(const frustum & f, const sphere * spheres, size_t n, uint32_t * indices)
+	{
+		return frustum_cull(frustum_planes_soa(f), spheres, n, indices);
+	}
+
+	inline size_t frustum_cull(const frustum & f, const aabb * boxes, size_t n, uint32_t * indices)
+	{
+		return frustum_cull(frustum_planes_soa(f), boxes, n, indices);
+	}
+
+}
\ No newline at end of file
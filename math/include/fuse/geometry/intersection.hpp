@@ -3,6 +3,13 @@
 #include <type_traits>
 #include <utility>
 
+enum intersection_classification
+{
+	FUSE_CLASSIFY_OUTSIDE,
+	FUSE_CLASSIFY_INTERSECTING,
+	FUSE_CLASSIFY_INSIDE
+};
+
 namespace fuse
 {
 
@@ -34,6 +41,15 @@ namespace fuse
 		return detail::intersection_impl<T, U>::contains(a, b);
 	}
 
+	/* Three-state classification of a volume against another */
+
+	template <typename T, typename U, typename ... OptionalArguments>
+	inline intersection_classification classify(const T & a, const U & b, OptionalArguments && ... args)
+	{
+		static_assert(detail::intersection_impl<T, U>::implemented::value, "fuse::classify: No available implementation for given volumes (check template types for more information).");
+		return detail::intersection_impl<T, U>::classify(a, b, std::forward<OptionalArguments>(args) ...);
+	}
+
 	/* Intersection test functions */
 
 	template <typename T, typename U, typename ... OptionalArguments>
@@ -55,7 +71,7 @@ namespace fuse
 		typename std::enable_if_t<!detail::is_intersectable<T, U>::value && !detail::is_intersectable<U, T>::value, bool>
 		intersects(const T &, const U &, OptionalArguments && ...)
 	{
-		static_assert(false, "fuse::intersection: No available implementation for given volumes (check template types for more information).");
+		static_assert(sizeof(T) == 0, "fuse::intersection: No available implementation for given volumes (check template types for more information).");
 		return false;
 	}
 
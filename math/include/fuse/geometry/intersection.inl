@@ -147,6 +147,58 @@ namespace fuse
 				return true;
 			}
 
+			inline static intersection_classification FUSE_VECTOR_CALL classify(aabb a, frustum b)
+			{
+				uint32_t planeMask  = FUSE_FRUSTUM_PLANES_MASK_ALL;
+				uint32_t firstPlane = FUSE_FRUSTUM_PLANE_NEAR;
+				return classify(a, b, planeMask, firstPlane);
+			}
+
+			// Only the planes in planeMask are tested, on return it holds the planes the box
+			// straddles (so children of a box can skip the others). The firstPlane hint is
+			// tested first and gets updated with the rejecting plane when the box is outside.
+
+			inline static intersection_classification FUSE_VECTOR_CALL classify(aabb a, frustum b, uint32_t & planeMask, uint32_t & firstPlane)
+			{
+				auto & planes = b.get_planes();
+
+				vec128 center      = a.get_center();
+				vec128 halfExtents = a.get_half_extents();
+
+				uint32_t straddledMask = 0;
+
+				for (uint32_t k = 0; k < 6; k++)
+				{
+					uint32_t i = k == 0 ? firstPlane : (k <= firstPlane ? k - 1 : k);
+
+					if (planeMask & (1 << i))
+					{
+						vec128 planeVector = planes[i].get_plane_vector();
+						vec128 absNormal   = vec128_xor(planeVector, vec128_and(planeVector, vec128_minus_zero()));
+
+						// Distance of the center from the plane and projection of the
+						// half extents on the plane normal
+
+						float d = vec128_get_x(vec128_add(vec128_dot3(planeVector, center), vec128_splat<FUSE_W>(planeVector)));
+						float e = vec128_get_x(vec128_dot3(absNormal, halfExtents));
+
+						if (d - e > 0)
+						{
+							firstPlane = i;
+							return FUSE_CLASSIFY_OUTSIDE;
+						}
+						else if (d + e > 0)
+						{
+							straddledMask |= 1 << i;
+						}
+					}
+				}
+
+				planeMask = straddledMask;
+
+				return straddledMask ? FUSE_CLASSIFY_INTERSECTING : FUSE_CLASSIFY_INSIDE;
+			}
+
 		};
 
 		/* sphere/frustum */
@@ -186,6 +238,43 @@ namespace fuse
 
 			}
 
+			inline static intersection_classification FUSE_VECTOR_CALL classify(sphere a, frustum b)
+			{
+				uint32_t planeMask = FUSE_FRUSTUM_PLANES_MASK_ALL;
+				return classify(a, b, planeMask);
+			}
+
+			inline static intersection_classification FUSE_VECTOR_CALL classify(sphere a, frustum b, uint32_t & planeMask)
+			{
+				auto & planes = b.get_planes();
+
+				vec128 sphereCenter = a.get_center();
+				float  radius       = vec128_get_x(a.get_radius());
+
+				uint32_t straddledMask = 0;
+
+				for (uint32_t i = 0; i < 6; i++)
+				{
+					if (planeMask & (1 << i))
+					{
+						float distance = vec128_get_x(planes[i].dot(sphereCenter));
+
+						if (distance > radius)
+						{
+							return FUSE_CLASSIFY_OUTSIDE;
+						}
+						else if (distance > -radius)
+						{
+							straddledMask |= 1 << i;
+						}
+					}
+				}
+
+				planeMask = straddledMask;
+
+				return straddledMask ? FUSE_CLASSIFY_INTERSECTING : FUSE_CLASSIFY_INSIDE;
+			}
+
 		};
 
 		/* ray/aabb */
@@ -2,7 +2,9 @@
 
 #include <cstdint>
 
+#ifdef _MSC_VER
 #include <intrin.h>
+#endif
 
 #include <xmmintrin.h>
 #include <mmintrin.h>
@@ -17,6 +19,12 @@ namespace fuse
 	inline uint32_t leading_zeros(uint64_t x)
 	{
 
+#ifndef _MSC_VER
+
+		return x ? __builtin_clzll(x) : 64;
+
+#else
+
 		union
 		{
 			uint64_t ui64;
@@ -46,11 +54,19 @@ namespace fuse
 
 		return lz;
 
+#endif
+
 	}
 
 	inline uint32_t most_significant_one(uint64_t x)
 	{
 
+#ifndef _MSC_VER
+
+		return x ? 63 - __builtin_clzll(x) : FUSE_BSR_INVALID;
+
+#else
+
 		union
 		{
 			uint64_t ui64;
@@ -80,6 +96,8 @@ namespace fuse
 
 		return bsr;
 
+#endif
+
 	}
 
 }
\ No newline at end of file
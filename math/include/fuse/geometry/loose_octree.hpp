@@ -4,14 +4,19 @@
 #include <fuse/math.hpp>
 #include <fuse/core.hpp>
 
+#include <algorithm>
 #include <functional>
-#include <list>
-#include <unordered_map>
+#include <iterator>
+#include <vector>
 
+#include "frustum_culling.hpp"
 #include "morton.hpp"
 
 #define FUSE_LOOSEOCTREE_DEFAULT_MAXDEPTH 8
 
+#define FUSE_LOOSEOCTREE_ROOT_NODE    (0)
+#define FUSE_LOOSEOCTREE_INVALID_NODE (0xFFFFFFFF)
+
 enum loose_octree_children
 {
 	FUSE_LOOSEOCTREE_FRONT_BOTTOM_LEFT = 0, // 000
@@ -30,15 +35,31 @@ namespace fuse
 	namespace detail
 	{
 
-		template <typename Object>
+		typedef uint32_t loose_octree_node_index;
+
+		template <typename Object, typename BoundingVolume>
 		struct loose_octree_node
 		{
 
-			std::list<Object> objects;
-			uint8_t           childrenMask;
-			uint32_t          occupancy;
+			typedef std::vector<Object, aligned_allocator<Object, std::alignment_of<Object>::value, FUSE_MEMORY_TAG_OCTREE>> objects_vector;
+			typedef std::vector<BoundingVolume, aligned_allocator<BoundingVolume, 16, FUSE_MEMORY_TAG_OCTREE>>              volumes_vector;
+
+			objects_vector          objects;
+			volumes_vector          volumes;
+			morton_code             location;
+			loose_octree_node_index parent;
+			loose_octree_node_index children[8];
+			uint32_t                occupancy;
+			uint8_t                 childrenMask;
+			uint8_t                 rejectingPlane;
 
-			loose_octree_node(void) : childrenMask(0), occupancy(0) { }
+			loose_octree_node(void) : loose_octree_node(0, FUSE_LOOSEOCTREE_INVALID_NODE) { }
+
+			loose_octree_node(morton_code location, loose_octree_node_index parent) :
+				location(location), parent(parent), occupancy(0), childrenMask(0), rejectingPlane(FUSE_FRUSTUM_PLANE_NEAR)
+			{
+				std::fill(std::begin(children), std::end(children), FUSE_LOOSEOCTREE_INVALID_NODE);
+			}
 
 		};
 
@@ -47,10 +68,24 @@ namespace fuse
 
 	/*
 	*
-	* Loose octree with looseness factor k = 2, represented as a linear octree
-	* with 64 bit Morton code for octant location key (hence max depth is 21)
+	* Loose octree with looseness factor k = 2, with 64 bit Morton codes as
+	* octant location keys (hence max depth is 21)
+	*
+	* Nodes live in a pooled table and cache the indices of their parent and
+	* children, so locating an octant is a walk of at most maxdepth steps from
+	* the root with no hashing involved. Each octant keeps its objects in a
+	* contiguous array, released nodes are recycled through a free list.
 	*
-	* Insertion and removal are O(1)
+	* The bounding volumes of the objects are cached at insertion in an array
+	* parallel to the objects one, query_batch tests them against the frustum
+	* planes 4 at a time without calling the bounding volume functor.
+	*
+	* Frustum queries carry the mask of the planes straddled by the parent
+	* octant, so that fully contained subtrees are emitted without further
+	* tests. Each node remembers the plane that rejected it last, which is
+	* tested first on the next query.
+	*
+	* Insertion and removal are O(maxdepth)
 	*
 	*/
 
@@ -63,8 +98,13 @@ namespace fuse
 
 	public:
 
-		typedef std::list<Object> objects_list;
-		typedef typename objects_list::iterator objects_list_iterator;
+		typedef std::vector<Object> objects_vector;
+		typedef typename detail::loose_octree_node<Object, BoundingVolume>::objects_vector::iterator objects_iterator;
+
+		// The names used when the objects were kept in lists
+
+		typedef objects_vector   objects_list;
+		typedef objects_iterator objects_list_iterator;
 
 		loose_octree(void);
 
@@ -93,6 +133,14 @@ namespace fuse
 		template <typename QueryType, typename Visitor>
 		void query(const QueryType & query, Visitor visitor);
 
+		template <typename Visitor>
+		void query(const frustum & f, Visitor visitor);
+
+		// The result can use any allocator (e.g. frame_allocator for a per-frame result)
+
+		template <typename Allocator>
+		void query_batch(const frustum & f, std::vector<Object, Allocator> & result);
+
 		bool ray_pick(const ray & ray, Object & result, float & t);
 
 		template <typename Visitor>
@@ -107,10 +155,11 @@ namespace fuse
 
 	private:
 
-		typedef detail::loose_octree_node<Object>     node;
+		typedef detail::loose_octree_node<Object, BoundingVolume> node;
+		typedef detail::loose_octree_node_index   node_index;
 
-		typedef std::unordered_map<morton_code, node> node_hashmap;
-		typedef typename node_hashmap::iterator       node_hashmap_iterator;
+		typedef std::vector<node, aligned_allocator<node, std::alignment_of<node>::value, FUSE_MEMORY_TAG_OCTREE>>             node_pool;
+		typedef std::vector<node_index, aligned_allocator<node_index, std::alignment_of<node_index>::value, FUSE_MEMORY_TAG_OCTREE>> node_free_list;
 
 		vec128 m_center;
 		vec128 m_halfextent;
@@ -120,7 +169,8 @@ namespace fuse
 		BoundingVolumeFunctor m_functor;
 		Comparator            m_comparator;
 
-		node_hashmap m_nodes;
+		node_pool      m_nodes;
+		node_free_list m_freeNodes;
 
 		/* Private methods */
 
@@ -130,7 +180,11 @@ namespace fuse
 		                   BoundingVolumeFunctor functor,
 		                   Comparator comparator);
 
-		typename node_hashmap_iterator create_octant(morton_code octantLocation);
+		node_index create_node(morton_code location, node_index parent);
+		void       release_node(node_index octant);
+
+		node_index create_octant(morton_code octantLocation);
+		node_index find_octant(morton_code octantLocation) const;
 
 		morton_code calculate_fitting_octant(const aabb & aabb) const;
 
@@ -139,26 +193,44 @@ namespace fuse
 		uint3        get_octant_coords(morton_code octant) const;
 
 		template <typename QueryType, typename Visitor>
-		void traverse(morton_code currentLocation,
+		void traverse(node_index octant,
 		              const aabb & current,
 		              const QueryType & query,
 		              Visitor visitor);
 
-		inline void ray_pick(morton_code currentLocation,
+		template <typename Visitor>
+		void query(node_index octant,
+		           const aabb & current,
+		           const frustum & f,
+		           uint32_t planeMask,
+		           Visitor visitor);
+
+		template <typename Allocator>
+		void query_batch(node_index octant,
+		                 const aabb & current,
+		                 const frustum_planes_soa & f,
+		                 uint32_t planeMask,
+		                 std::vector<Object, Allocator> & result,
+		                 std::vector<uint32_t> & indices);
+
+		template <typename Visitor>
+		void visit_objects(node_index octant, Visitor visitor);
+
+		inline void ray_pick(node_index octant,
 		                     const aabb & current,
 		                     const ray  & ray,
 		                     float & minDistance,
 		                     Object * & object);
 
 		template <typename Visitor>
-		void dfs_visit(morton_code octant, Visitor visitor);
+		void dfs_visit(node_index octant, Visitor visitor);
 
-		void increase_occupancy(node_hashmap_iterator octant);
-		void decrease_occupancy(node_hashmap_iterator octant);
+		void increase_occupancy(node_index octant);
+		void decrease_occupancy(node_index octant);
 
 	public:
 
-		FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+		FUSE_DECLARE_TAGGED_ALIGNED_ALLOCATOR_NEW(16, FUSE_MEMORY_TAG_OCTREE)
 
 	};
 
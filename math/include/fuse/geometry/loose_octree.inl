@@ -17,7 +17,7 @@ namespace fuse
 {
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
-	FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(FUSE_LOOSEOCTREE_TYPE, 16)
+	FUSE_TAGGED_ALIGNED_ALLOCATOR(uint8_t, 16, FUSE_MEMORY_TAG_OCTREE) FUSE_LOOSEOCTREE_TYPE::FUSE_ALLOCATOR_STATIC_MEMBER;
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		FUSE_LOOSEOCTREE_TYPE::loose_octree(void)
@@ -38,13 +38,19 @@ namespace fuse
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		FUSE_LOOSEOCTREE_TYPE::~loose_octree(void)
 	{
-		clear();
+
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		void FUSE_LOOSEOCTREE_TYPE::clear(void)
 	{
-		m_nodes.clear();
+		if (!m_nodes.empty())
+		{
+			m_nodes.clear();
+			m_freeNodes.clear();
+
+			create_node(FUSE_LOOSEOCTREE_ROOT_INDEX, FUSE_LOOSEOCTREE_INVALID_NODE);
+		}
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
@@ -58,17 +64,18 @@ namespace fuse
 	{
 		aabb aabb = bounding_aabb(volume);
 
-		if (!contains(get_octant_aabb(FUSE_LOOSEOCTREE_ROOT_INDEX), aabb))
+		if (m_nodes.empty() ||
+		    !contains(get_octant_aabb(FUSE_LOOSEOCTREE_ROOT_INDEX), aabb))
 		{
 			return false;
 		}
 
-		morton_code octant = calculate_fitting_octant(aabb);
+		node_index octant = create_octant(calculate_fitting_octant(aabb));
 
-		node_hashmap_iterator it = create_octant(octant);
+		m_nodes[octant].objects.push_back(object);
+		m_nodes[octant].volumes.push_back(volume);
 
-		it->second.objects.push_back(object);
-		increase_occupancy(it);
+		increase_occupancy(octant);
 
 		return true;
 	}
@@ -82,22 +89,37 @@ namespace fuse
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		bool FUSE_LOOSEOCTREE_TYPE::remove(const Object & object, const BoundingVolume & volume)
 	{
-		aabb aabb = bounding_aabb(volume);
+		if (m_nodes.empty())
+		{
+			return false;
+		}
 
-		morton_code octant = calculate_fitting_octant(aabb);
+		aabb aabb = bounding_aabb(volume);
 
-		auto it = m_nodes.find(octant);
+		node_index octant = find_octant(calculate_fitting_octant(aabb));
 
-		if (it != m_nodes.end())
+		if (octant != FUSE_LOOSEOCTREE_INVALID_NODE)
 		{
-			node & node = it->second;
+			node & n = m_nodes[octant];
 
-			for (auto listIt = node.objects.begin(); listIt != node.objects.end(); listIt++)
+			for (size_t i = 0; i < n.objects.size(); i++)
 			{
-				if (m_comparator(*listIt, object))
+				if (m_comparator(n.objects[i], object))
 				{
-					node.objects.erase(listIt);
-					decrease_occupancy(it);
+					// Order within an octant is irrelevant, swap with the last
+					// element to avoid shifting the whole array
+
+					if (i != n.objects.size() - 1)
+					{
+						n.objects[i] = std::move(n.objects.back());
+						n.volumes[i] = n.volumes.back();
+					}
+
+					n.objects.pop_back();
+					n.volumes.pop_back();
+
+					decrease_occupancy(octant);
+
 					return true;
 				}
 			}
@@ -110,19 +132,71 @@ namespace fuse
 		template <typename QueryType, typename Visitor>
 	void FUSE_LOOSEOCTREE_TYPE::query(const QueryType & query, Visitor visitor)
 	{
-		aabb rootAABB = aabb::from_center_half_extents(m_center, m_halfextent * 2.f);
-		traverse(FUSE_LOOSEOCTREE_ROOT_INDEX, rootAABB, query, visitor);
+		if (!m_nodes.empty())
+		{
+			aabb rootAABB = aabb::from_center_half_extents(m_center, m_halfextent * 2.f);
+			traverse(FUSE_LOOSEOCTREE_ROOT_NODE, rootAABB, query, visitor);
+		}
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
-		bool FUSE_LOOSEOCTREE_TYPE::ray_pick(const ray & ray, Object & result, float & t)
+		template <typename Visitor>
+	void FUSE_LOOSEOCTREE_TYPE::query(const frustum & f, Visitor visitor)
 	{
+		if (!m_nodes.empty())
+		{
+			aabb rootAABB = aabb::from_center_half_extents(m_center, m_halfextent * 2.f);
+			query(FUSE_LOOSEOCTREE_ROOT_NODE, rootAABB, f, FUSE_FRUSTUM_PLANES_MASK_ALL, visitor);
+		}
+	}
+
+	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
+		template <typename Allocator>
+	void FUSE_LOOSEOCTREE_TYPE::query_batch(const frustum & f, std::vector<Object, Allocator> & result)
+	{
+		if (m_nodes.empty() || m_nodes[FUSE_LOOSEOCTREE_ROOT_NODE].occupancy == 0)
+		{
+			return;
+		}
+
+		node & root = m_nodes[FUSE_LOOSEOCTREE_ROOT_NODE];
+
 		aabb rootAABB = aabb::from_center_half_extents(m_center, m_halfextent * 2.f);
 
+		uint32_t planeMask  = FUSE_FRUSTUM_PLANES_MASK_ALL;
+		uint32_t firstPlane = root.rejectingPlane;
+
+		std::vector<uint32_t> indices;
+
+		switch (classify(rootAABB, f, planeMask, firstPlane))
+		{
+
+		case FUSE_CLASSIFY_OUTSIDE:
+			root.rejectingPlane = (uint8_t) firstPlane;
+			break;
+
+		case FUSE_CLASSIFY_INSIDE:
+			visit_objects(FUSE_LOOSEOCTREE_ROOT_NODE, [&](const Object & o) { result.push_back(o); });
+			break;
+
+		default:
+			query_batch(FUSE_LOOSEOCTREE_ROOT_NODE, rootAABB, frustum_planes_soa(f), planeMask, result, indices);
+			break;
+
+		}
+	}
+
+	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
+		bool FUSE_LOOSEOCTREE_TYPE::ray_pick(const ray & ray, Object & result, float & t)
+	{
 		Object * object = nullptr;
 		t = std::numeric_limits<float>::infinity();
 
-		ray_pick(FUSE_LOOSEOCTREE_ROOT_INDEX, rootAABB, ray, t, object);
+		if (!m_nodes.empty())
+		{
+			aabb rootAABB = aabb::from_center_half_extents(m_center, m_halfextent * 2.f);
+			ray_pick(FUSE_LOOSEOCTREE_ROOT_NODE, rootAABB, ray, t, object);
+		}
 
 		if (object != nullptr)
 		{
@@ -148,19 +222,26 @@ namespace fuse
 		m_functor    = functor;
 		m_comparator = comparator;
 
-		m_nodes.emplace(FUSE_LOOSEOCTREE_ROOT_INDEX, node());
+		m_nodes.clear();
+		m_freeNodes.clear();
+
+		create_node(FUSE_LOOSEOCTREE_ROOT_INDEX, FUSE_LOOSEOCTREE_INVALID_NODE);
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		template <typename Visitor>
 	void FUSE_LOOSEOCTREE_TYPE::traverse(Visitor visitor)
 	{
-		dfs_visit(FUSE_LOOSEOCTREE_ROOT_INDEX,
-			[this, visitor](node_hashmap_iterator it)
+		if (!m_nodes.empty())
 		{
-			aabb aabb = get_octant_aabb(it->first);
-			visitor(aabb, it->second.objects.begin(), it->second.objects.end());
-		});
+			dfs_visit(FUSE_LOOSEOCTREE_ROOT_NODE,
+				[this, visitor](node_index octant)
+			{
+				node & n = m_nodes[octant];
+				aabb aabb = get_octant_aabb(n.location);
+				visitor(aabb, n.objects.begin(), n.objects.end());
+			});
+		}
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
@@ -170,25 +251,91 @@ namespace fuse
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
-		typename FUSE_LOOSEOCTREE_TYPE::node_hashmap_iterator
+		typename FUSE_LOOSEOCTREE_TYPE::node_index
+		FUSE_LOOSEOCTREE_TYPE::create_node(morton_code location, node_index parent)
+	{
+		node_index octant;
+
+		if (m_freeNodes.empty())
+		{
+			octant = static_cast<node_index>(m_nodes.size());
+			m_nodes.emplace_back(location, parent);
+		}
+		else
+		{
+			// Recycle a released node, keeping the capacity of its objects array
+
+			octant = m_freeNodes.back();
+			m_freeNodes.pop_back();
+
+			node & n = m_nodes[octant];
+
+			n.location = location;
+			n.parent   = parent;
+		}
+
+		return octant;
+	}
+
+	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
+		void FUSE_LOOSEOCTREE_TYPE::release_node(node_index octant)
+	{
+		node & n = m_nodes[octant];
+
+		n.objects.clear();
+		n.volumes.clear();
+		n.location       = 0;
+		n.parent         = FUSE_LOOSEOCTREE_INVALID_NODE;
+		n.occupancy      = 0;
+		n.childrenMask   = 0;
+		n.rejectingPlane = FUSE_FRUSTUM_PLANE_NEAR;
+
+		std::fill(std::begin(n.children), std::end(n.children), FUSE_LOOSEOCTREE_INVALID_NODE);
+
+		m_freeNodes.push_back(octant);
+	}
+
+	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
+		typename FUSE_LOOSEOCTREE_TYPE::node_index
 		FUSE_LOOSEOCTREE_TYPE::create_octant(morton_code octantLocation)
 	{
-		auto nodeInsertResult = m_nodes.emplace(octantLocation, node());
+		// Walk down from the root following the location code triplets,
+		// creating the missing octants along the way
 
-		node_hashmap_iterator octant = nodeInsertResult.first;
+		node_index octant = FUSE_LOOSEOCTREE_ROOT_NODE;
 
-		// If the node was created, initialize it and continue in the recursion
-		if (nodeInsertResult.second)
+		for (int depth = (int) get_octant_depth(octantLocation) - 1; depth >= 0; depth--)
 		{
+			unsigned int child = (octantLocation >> (3 * depth)) & 7;
+			node_index   next  = m_nodes[octant].children[child];
 
-			morton_code childCode = (octantLocation & 7);
+			if (next == FUSE_LOOSEOCTREE_INVALID_NODE)
+			{
+				// create_node might reallocate the pool, no references to nodes across this call
+				next = create_node(octantLocation >> (3 * depth), octant);
 
-			morton_code parentLocation = octantLocation >> 3;
-			node_hashmap_iterator parent = create_octant(parentLocation);
+				m_nodes[octant].children[child] = next;
+				m_nodes[octant].childrenMask   |= FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child);
+			}
 
-			// Add the new node to the parent
-			parent->second.childrenMask |= FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(childCode);
+			octant = next;
+		}
+
+		return octant;
+	}
+
+	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
+		typename FUSE_LOOSEOCTREE_TYPE::node_index
+		FUSE_LOOSEOCTREE_TYPE::find_octant(morton_code octantLocation) const
+	{
+		node_index octant = FUSE_LOOSEOCTREE_ROOT_NODE;
 
+		for (int depth = (int) get_octant_depth(octantLocation) - 1;
+		     depth >= 0 && octant != FUSE_LOOSEOCTREE_INVALID_NODE;
+		     depth--)
+		{
+			unsigned int child = (octantLocation >> (3 * depth)) & 7;
+			octant = m_nodes[octant].children[child];
 		}
 
 		return octant;
@@ -197,18 +344,28 @@ namespace fuse
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		void FUSE_LOOSEOCTREE_TYPE::shrink(void)
 	{
-		dfs_visit(FUSE_LOOSEOCTREE_ROOT_INDEX,
-			[this](node_hashmap_iterator it)
+		if (m_nodes.empty())
+		{
+			return;
+		}
+
+		// Post-order visit, children are released before checking their parent
+
+		dfs_visit(FUSE_LOOSEOCTREE_ROOT_NODE,
+			[this](node_index octant)
 		{
+			node & n = m_nodes[octant];
 
-			if (it->second.occupancy == 0 && it->first != FUSE_LOOSEOCTREE_ROOT_INDEX)
+			if (n.occupancy == 0 && octant != FUSE_LOOSEOCTREE_ROOT_NODE)
 			{
-				morton_code parentCode = it->first >> 3;
-				auto parentIt = m_nodes.find(parentCode);
-				parentIt->second.childrenMask ^= FUSE_LOOSEOCTREE_MAKE_CHILDREN_MASK((it->first & 7));
-				m_nodes.erase(it);
-			}
+				unsigned int child  = n.location & 7;
+				node &       parent = m_nodes[n.parent];
+
+				parent.children[child] = FUSE_LOOSEOCTREE_INVALID_NODE;
+				parent.childrenMask   ^= FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child);
 
+				release_node(octant);
+			}
 		});
 	}
 
@@ -230,7 +387,7 @@ namespace fuse
 		unsigned int fitDepth = (unsigned int)std::floor(std::log2(vec128_get_x(m_halfextent) / maxExtent));
 		unsigned int depth = std::min(fitDepth, m_maxdepth);
 
-		vec128_f32 t = vec128_floor(normalizedCentroid * (1 << m_maxdepth));
+		vec128_f32 t = vec128_floor(normalizedCentroid * (float) (1 << m_maxdepth));
 
 		morton_unpacked octreeCenterCoordinates = {
 			static_cast<uint32_t>(t.f32[0]),
@@ -262,30 +419,23 @@ namespace fuse
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		aabb FUSE_LOOSEOCTREE_TYPE::get_octant_aabb(morton_code location) const
 	{
-		auto it = m_nodes.find(location);
-
-		if (it != m_nodes.end())
-		{
-			unsigned int depth = get_octant_depth(location);
+		unsigned int depth = get_octant_depth(location);
 
-			// The half extents of the regular octant
-			vec128 hd      = m_halfextent * (1.f / (1 << depth));
-			vec128 hdloose = hd * 2.f;
+		// The half extents of the regular octant
+		vec128 hd      = m_halfextent * (1.f / (1 << depth));
+		vec128 hdloose = hd * 2.f;
 
-			uint3 octantCoords = get_octant_coords(location);
+		uint3 octantCoords = get_octant_coords(location);
 
-			vec128 ijk = vec128_set(octantCoords.x, octantCoords.y, octantCoords.z, 0.f);
+		vec128 ijk = vec128_set(octantCoords.x, octantCoords.y, octantCoords.z, 0.f);
 
-			ijk = ijk * 2.f;
-			ijk = ijk + vec128_one();
-			
-			vec128 minPoint = m_center - m_halfextent;
-			vec128 center   = ijk * hd + minPoint;
+		ijk = ijk * 2.f;
+		ijk = ijk + vec128_one();
 
-			return aabb::from_center_half_extents(center, hdloose);
-		}
+		vec128 minPoint = m_center - m_halfextent;
+		vec128 center   = ijk * hd + minPoint;
 
-		return aabb::from_center_half_extents(vec128_zero(), vec128_zero());
+		return aabb::from_center_half_extents(center, hdloose);
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
@@ -295,23 +445,23 @@ namespace fuse
 
 		// Remove the sentinel
 		morton_code code = (1ULL << mso) ^ location;
-		return reinterpret_cast<const uint3&>(morton_decode3(code));
+		morton_unpacked coords = morton_decode3(code);
+		return uint3(coords.x, coords.y, coords.z);
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		template <typename QueryType, typename Visitor>
-	void FUSE_LOOSEOCTREE_TYPE::traverse(morton_code currentLocation,
+	void FUSE_LOOSEOCTREE_TYPE::traverse(node_index octant,
 	                                     const aabb & current,
 	                                     const QueryType & query,
 	                                     Visitor visitor)
 	{
-		auto it = m_nodes.find(currentLocation);
+		node & n = m_nodes[octant];
 
-		if (it != m_nodes.end() && 
-		    it->second.occupancy > 0 &&
+		if (n.occupancy > 0 &&
 		    intersects(current, query))
 		{
-			for (Object & o : it->second.objects)
+			for (Object & o : n.objects)
 			{
 				if (intersects(query, m_functor(o)))
 				{
@@ -327,12 +477,8 @@ namespace fuse
 
 			for (int child = 0; child < 8; child++)
 			{
-				morton_code nextLevelLocation = currentLocation << 3;
-
-				if (it->second.childrenMask & FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child))
+				if (n.childrenMask & FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child))
 				{
-					morton_code childCode = nextLevelLocation | child;
-
 					// Set the direction of shift setting the signbit to 0/1 according to the child
 					// location (thus moving in the positive/negative direction as needed) ...
 
@@ -347,14 +493,162 @@ namespace fuse
 
 					aabb childAABB = aabb::from_center_half_extents(currentCenter + centerShift, nextHalfExtents);
 
-					traverse(childCode, childAABB, query, visitor);
+					traverse(n.children[child], childAABB, query, visitor);
 				}
 			}
 		}
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
-		void FUSE_LOOSEOCTREE_TYPE::ray_pick(morton_code currentLocation,
+		template <typename Visitor>
+	void FUSE_LOOSEOCTREE_TYPE::query(node_index octant,
+	                                  const aabb & current,
+	                                  const frustum & f,
+	                                  uint32_t planeMask,
+	                                  Visitor visitor)
+	{
+		node & n = m_nodes[octant];
+
+		if (n.occupancy == 0)
+		{
+			return;
+		}
+
+		// Test first the plane that rejected the octant on the last query
+
+		uint32_t firstPlane = n.rejectingPlane;
+
+		switch (classify(current, f, planeMask, firstPlane))
+		{
+
+		case FUSE_CLASSIFY_OUTSIDE:
+			n.rejectingPlane = (uint8_t) firstPlane;
+			return;
+
+		case FUSE_CLASSIFY_INSIDE:
+			// No need to test anything in the subtree
+			visit_objects(octant, visitor);
+			return;
+
+		default:
+			break;
+
+		}
+
+		// Only the planes straddled by the octant need to be tested from now on
+
+		for (Object & o : n.objects)
+		{
+			uint32_t objectPlaneMask = planeMask;
+
+			if (classify(m_functor(o), f, objectPlaneMask) != FUSE_CLASSIFY_OUTSIDE)
+			{
+				visitor(o);
+			}
+		}
+
+		vec128 currentCenter      = current.get_center();
+		vec128 currentHalfExtents = current.get_half_extents();
+
+		vec128 nextHalfExtents = currentHalfExtents * .5f;
+		vec128 shiftSize       = currentHalfExtents * .25f;
+
+		for (int child = 0; child < 8; child++)
+		{
+			if (n.childrenMask & FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child))
+			{
+				vec128 centerShift = vec128_set(child & 1 ? 0.f : -0.f,
+				                                child & 2 ? 0.f : -0.f,
+				                                child & 4 ? 0.f : -0.f,
+				                                0.f);
+
+				centerShift = vec128_or(centerShift, shiftSize);
+
+				aabb childAABB = aabb::from_center_half_extents(currentCenter + centerShift, nextHalfExtents);
+
+				query(n.children[child], childAABB, f, planeMask, visitor);
+			}
+		}
+	}
+
+	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
+		template <typename Allocator>
+	void FUSE_LOOSEOCTREE_TYPE::query_batch(node_index octant,
+	                                        const aabb & current,
+	                                        const frustum_planes_soa & f,
+	                                        uint32_t planeMask,
+	                                        std::vector<Object, Allocator> & result,
+	                                        std::vector<uint32_t> & indices)
+	{
+		// The octant itself has already been classified as intersecting by the parent,
+		// test the cached volumes of its objects and then all its children at once
+		// against the planes it straddles
+
+		node & n = m_nodes[octant];
+
+		if (!n.objects.empty())
+		{
+			indices.resize(n.objects.size());
+
+			size_t visible = frustum_cull(f, n.volumes.data(), n.volumes.size(), indices.data(), planeMask);
+
+			for (size_t i = 0; i < visible; i++)
+			{
+				result.push_back(n.objects[indices[i]]);
+			}
+		}
+
+		aabb       childrenAABB[8];
+		node_index children[8];
+		uint32_t   visibleChildren[8];
+		uint32_t   childrenPlaneMasks[8];
+
+		size_t numChildren = 0;
+
+		vec128 currentCenter      = current.get_center();
+		vec128 currentHalfExtents = current.get_half_extents();
+
+		vec128 nextHalfExtents = currentHalfExtents * .5f;
+		vec128 shiftSize       = currentHalfExtents * .25f;
+
+		for (int child = 0; child < 8; child++)
+		{
+			if (n.childrenMask & FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child) &&
+			    m_nodes[n.children[child]].occupancy > 0)
+			{
+				vec128 centerShift = vec128_set(child & 1 ? 0.f : -0.f,
+				                                child & 2 ? 0.f : -0.f,
+				                                child & 4 ? 0.f : -0.f,
+				                                0.f);
+
+				centerShift = vec128_or(centerShift, shiftSize);
+
+				childrenAABB[numChildren] = aabb::from_center_half_extents(currentCenter + centerShift, nextHalfExtents);
+				children[numChildren]     = n.children[child];
+
+				numChildren++;
+			}
+		}
+
+		size_t visible = frustum_classify(f, childrenAABB, numChildren, visibleChildren, childrenPlaneMasks, planeMask);
+
+		for (size_t i = 0; i < visible; i++)
+		{
+			uint32_t child = visibleChildren[i];
+
+			if (childrenPlaneMasks[i] == 0)
+			{
+				visit_objects(children[child], [&](const Object & o) { result.push_back(o); });
+			}
+			else
+			{
+				query_batch(children[child], childrenAABB[child], f, childrenPlaneMasks[i], result, indices);
+			}
+		}
+	}
+
+	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
+		void FUSE_LOOSEOCTREE_TYPE::ray_pick(node_index octant,
 		                                     const aabb & current,
 		                                     const ray  & ray,
 		                                     float & minDistance,
@@ -362,9 +656,9 @@ namespace fuse
 	{
 		if (intersects(ray, current))
 		{
-			auto it = m_nodes.find(currentLocation);
+			node & n = m_nodes[octant];
 
-			for (Object & o : it->second.objects)
+			for (Object & o : n.objects)
 			{
 
 				float t;
@@ -383,12 +677,8 @@ namespace fuse
 
 			for (int child = 0; child < 8; child++)
 			{
-				morton_code nextLevelLocation = currentLocation << 3;
-
-				if (it->second.childrenMask & FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child))
+				if (n.childrenMask & FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child))
 				{
-					morton_code childCode = nextLevelLocation | child;
-
 					// Set the direction of shift setting the signbit to 0/1 according to the child
 					// location (thus moving in the positive/negative direction as needed) ...
 
@@ -404,7 +694,7 @@ namespace fuse
 
 					aabb childAABB = aabb::from_center_half_extents(currentCenter + centerShift, nextHalfExtents);
 
-					ray_pick(childCode, childAABB, ray, minDistance, object);
+					ray_pick(n.children[child], childAABB, ray, minDistance, object);
 				}
 			}
 		}
@@ -412,52 +702,64 @@ namespace fuse
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		template <typename Visitor>
-	void FUSE_LOOSEOCTREE_TYPE::dfs_visit(morton_code code, Visitor visitor)
+	void FUSE_LOOSEOCTREE_TYPE::visit_objects(node_index octant, Visitor visitor)
 	{
-		auto it = m_nodes.find(code);
+		node & n = m_nodes[octant];
 
-		morton_code nextLevelLocation = code << 3;
+		if (n.occupancy > 0)
+		{
+			for (Object & o : n.objects)
+			{
+				visitor(o);
+			}
+
+			for (int child = 0; child < 8; child++)
+			{
+				if (n.childrenMask & FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child))
+				{
+					visit_objects(n.children[child], visitor);
+				}
+			}
+		}
+	}
 
+	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
+		template <typename Visitor>
+	void FUSE_LOOSEOCTREE_TYPE::dfs_visit(node_index octant, Visitor visitor)
+	{
 		for (int child = 0; child < 8; child++)
 		{
-			if (it->second.childrenMask & FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child))
+			if (m_nodes[octant].childrenMask & FUSE_LOOSEOCTREE_MAKE_CHILD_MASK(child))
 			{
-				dfs_visit(nextLevelLocation | child, visitor);
+				dfs_visit(m_nodes[octant].children[child], visitor);
 			}
 		}
 
-		visitor(it);
+		visitor(octant);
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
-		void FUSE_LOOSEOCTREE_TYPE::increase_occupancy(node_hashmap_iterator octant)
+		void FUSE_LOOSEOCTREE_TYPE::increase_occupancy(node_index octant)
 	{
-		octant->second.occupancy++;
-
-		if (octant->first != FUSE_LOOSEOCTREE_ROOT_INDEX)
+		for (; octant != FUSE_LOOSEOCTREE_INVALID_NODE; octant = m_nodes[octant].parent)
 		{
-			auto parentIt = m_nodes.find(octant->first >> 3);
-			increase_occupancy(parentIt);
+			m_nodes[octant].occupancy++;
 		}
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
-		void FUSE_LOOSEOCTREE_TYPE::decrease_occupancy(node_hashmap_iterator octant)
+		void FUSE_LOOSEOCTREE_TYPE::decrease_occupancy(node_index octant)
 	{
-		octant->second.occupancy--;
-
-		if (octant->first != FUSE_LOOSEOCTREE_ROOT_INDEX)
+		for (; octant != FUSE_LOOSEOCTREE_INVALID_NODE; octant = m_nodes[octant].parent)
 		{
-			auto parentIt = m_nodes.find(octant->first >> 3);
-			decrease_occupancy(parentIt);
+			m_nodes[octant].occupancy--;
 		}
 	}
 
 	FUSE_LOOSEOCTREE_TEMPLATE_DECLARATION
 		size_t FUSE_LOOSEOCTREE_TYPE::size(void) const
 	{
-		auto it = m_nodes.find(FUSE_LOOSEOCTREE_ROOT_INDEX);
-		return it->second.occupancy;
+		return m_nodes.empty() ? 0 : m_nodes[FUSE_LOOSEOCTREE_ROOT_NODE].occupancy;
 	}
 
 }
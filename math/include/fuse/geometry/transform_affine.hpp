@@ -19,5 +19,10 @@ namespace fuse
 		return sphere(vec128_select<FUSE_X0, FUSE_Y0, FUSE_Z0, FUSE_W1>(newCenter, distance));
 	}
 
+	inline void transform_affine(const sphere * in, sphere * out, size_t n, const mat128 & transform)
+	{
+		mat128_transform_sphere_stream(reinterpret_cast<const vec128*>(in), reinterpret_cast<vec128*>(out), n, transform);
+	}
+
 }
 
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <fuse/core.hpp>
+#include <fuse/math.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#define FUSE_TRANSFORM_INVALID_HANDLE (0xFFFFFFFF)
+
+namespace fuse
+{
+
+	typedef uint32_t transform_handle;
+
+	/*
+	*
+	* Flat transform hierarchy. Local SRT, world matrices and parent indices
+	* are stored in parallel arrays sorted in hierarchy order (parents before
+	* children), so world matrices are computed by update() in a single linear
+	* sweep where each transform only reads the already computed parent.
+	*
+	* Transforms are referenced through handles, which stay valid while the
+	* slots are reordered. World matrices are only valid after update().
+	*
+	*/
+
+	class transform_system
+	{
+
+	public:
+
+		transform_system(void);
+		transform_system(const transform_system &) = delete;
+		transform_system(transform_system &&) = default;
+
+		transform_system & operator= (const transform_system &) = delete;
+		transform_system & operator= (transform_system &&) = default;
+
+		transform_handle create(transform_handle parent = FUSE_TRANSFORM_INVALID_HANDLE);
+		void destroy(transform_handle transform);
+
+		void clear(void);
+		void reserve(size_t size);
+
+		void update(void);
+
+		transform_handle get_parent(transform_handle transform) const;
+		void set_parent(transform_handle transform, transform_handle parent, bool keepWorldTransform = true);
+
+		void FUSE_VECTOR_CALL set_local_translation(transform_handle transform, vec128 t);
+		void FUSE_VECTOR_CALL set_local_rotation(transform_handle transform, vec128 r);
+		void FUSE_VECTOR_CALL set_local_scale(transform_handle transform, vec128 s);
+
+		inline vec128 get_local_translation(transform_handle transform) const { return m_localTranslation[m_slots[transform]]; }
+		inline vec128 get_local_rotation(transform_handle transform) const { return m_localRotation[m_slots[transform]]; }
+		inline vec128 get_local_scale(transform_handle transform) const { return m_localScale[m_slots[transform]]; }
+
+		inline const mat128 & get_world_matrix(transform_handle transform) const { return m_worldMatrix[m_slots[transform]]; }
+
+		// World matrix before the updates that moved the transform, since the
+		// last time the moved flag was cleared
+
+		inline const mat128 & get_previous_world_matrix(transform_handle transform) const { return m_previousWorldMatrix[m_slots[transform]]; }
+
+		void get_world_srt(transform_handle transform, vec128 * scale, vec128 * rotation, vec128 * translation) const;
+
+		bool was_moved(transform_handle transform) const;
+		void set_moved(transform_handle transform, bool moved);
+
+		void clear_moved(void);
+
+		inline bool is_uptodate(void) const { return !m_dirty; }
+		inline size_t size(void) const { return m_slots.size() - m_freeHandles.size(); }
+
+	private:
+
+FUSE_VEC128_TEMPLATE_ARGUMENTS_BEGIN
+		typedef std::vector<vec128, aligned_allocator<vec128, 16>> vec128_vector;
+FUSE_VEC128_TEMPLATE_ARGUMENTS_END
+		typedef std::vector<mat128, aligned_allocator<mat128, 16>> mat128_vector;
+
+		/* Per slot data, in hierarchy order */
+
+		vec128_vector m_localTranslation;
+		vec128_vector m_localRotation;
+		vec128_vector m_localScale;
+
+		mat128_vector m_localMatrix;
+		mat128_vector m_worldMatrix;
+		mat128_vector m_previousWorldMatrix;
+
+		std::vector<uint32_t>         m_parents;
+		std::vector<uint8_t>          m_flags;
+		std::vector<transform_handle> m_handles;
+
+		/* Per handle data */
+
+		std::vector<uint32_t>         m_slots;
+		std::vector<transform_handle> m_freeHandles;
+
+		bool     m_dirty;
+		bool     m_reorder;
+
+		void mark_dirty(uint32_t slot, uint8_t flags = 0);
+		void reorder(void);
+
+	};
+
+}
\ No newline at end of file
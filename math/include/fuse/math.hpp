@@ -57,6 +57,8 @@
 #include "math/quat128_impl.inl"
 #include "math/mat128_impl.inl"
 
+#include "math/mat128_stream.hpp"
+
 #include "math/convertions.hpp"
 
 #include "math/constants.hpp"
@@ -9,6 +9,8 @@
 #include "vec128_impl.inl"
 #include "mat128_impl.inl"
 
+#include <cstring>
+
 namespace fuse
 {
 
@@ -94,7 +96,7 @@ namespace fuse
 			lhs._20, lhs._21, lhs._22);
 	}
 
-	inline const float3x3 & FUSE_VECTOR_CALL to_float3x3(mat128 lhs)
+	inline float3x3 FUSE_VECTOR_CALL to_float3x3(mat128 lhs)
 	{
 		float3x3 r;
 		r.c[0] = transpose(to_float3(lhs.c[0]));
@@ -114,9 +116,11 @@ namespace fuse
 			0.f, 0.f, 0.f, 1.f);
 	}
 
-	inline const float4x4 & FUSE_VECTOR_CALL to_float4x4(mat128 lhs)
+	inline float4x4 FUSE_VECTOR_CALL to_float4x4(mat128 lhs)
 	{
-		return reinterpret_cast<const float4x4&>(lhs);
+		float4x4 r;
+		std::memcpy(&r, &lhs, sizeof(r));
+		return r;
 	}
 
 }
\ No newline at end of file
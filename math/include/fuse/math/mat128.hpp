@@ -40,7 +40,7 @@ namespace fuse
 			c[3] = rhs.c[3];
 		}
 
-		inline mat128_f32(float d)
+		inline mat128_f32(float)
 		{
 			c[0] = vec128_f32(1, 0, 0, 0);
 			c[1] = vec128_f32(0, 1, 0, 0);
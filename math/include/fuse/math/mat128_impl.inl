@@ -63,8 +63,14 @@ namespace fuse
 		inline void intel_sse_inverse4(const float * src, float * rows, __m128 * pDet)
 		{
 			__m128 minor0, minor1, minor2, minor3;
-			__m128 row0, row1, row2, row3;
-			__m128 det, tmp1;
+			__m128 row0, row2;
+			__m128 det;
+
+			// The loads only fill half of the registers, they start from zero so that nothing is read uninitialized
+
+			__m128 row1 = _mm_setzero_ps();
+			__m128 row3 = _mm_setzero_ps();
+			__m128 tmp1 = _mm_setzero_ps();
 
 			tmp1   = _mm_loadh_pi(_mm_loadl_pi(tmp1, (__m64*)(src)), (__m64*)(src + 4));
 			row1   = _mm_loadh_pi(_mm_loadl_pi(row1, (__m64*)(src + 8)), (__m64*)(src + 12));
@@ -163,6 +169,22 @@ namespace fuse
 	inline mat128 FUSE_VECTOR_CALL mat128_transform4(mat128 lhs, mat128 rhs)
 	{
 		mat128 r;
+
+#ifdef FUSE_FMA
+
+		// Each column of the product is the combination of the columns of lhs
+		// weighted by the elements of the same column of rhs
+
+		for (int j = 0; j < 4; j++)
+		{
+			vec128 t = _mm_mul_ps(lhs.c[0], vec128_splat<FUSE_X>(rhs.c[j]));
+			t = _mm_fmadd_ps(lhs.c[1], vec128_splat<FUSE_Y>(rhs.c[j]), t);
+			t = _mm_fmadd_ps(lhs.c[2], vec128_splat<FUSE_Z>(rhs.c[j]), t);
+			r.c[j] = _mm_fmadd_ps(lhs.c[3], vec128_splat<FUSE_W>(rhs.c[j]), t);
+		}
+
+#else
+
 		mat128 lhsT = mat128_transpose(lhs);
 
 		{
@@ -213,6 +235,8 @@ namespace fuse
 			r.c[3] = vec128_shuffle<FUSE_X0, FUSE_Z0, FUSE_X1, FUSE_Z1>(t0, t1);
 		}
 
+#endif
+
 		return r;
 	}
 
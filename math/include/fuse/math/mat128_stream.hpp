@@ -0,0 +1,37 @@
+#pragma once
+
+#include "vec128.hpp"
+#include "mat128.hpp"
+#include "simd_dispatch.hpp"
+
+#include <cstddef>
+
+namespace fuse
+{
+
+	/*
+	*
+	* Batched transforms, applying the same matrix to arrays of inputs. The
+	* kernel is chosen at runtime between the SSE2, SSE4.1 and AVX2 paths
+	* (see simd_dispatch.hpp). Input and output arrays can be the same.
+	*
+	*/
+
+	// out[i] = (in[i], 1) * m
+
+	void FUSE_VECTOR_CALL mat128_transform_stream(const float3 * in, float4 * out, size_t n, mat128 m);
+
+	// out[i] = in[i] * m, in and out must be 16 bytes aligned
+
+	void FUSE_VECTOR_CALL mat128_transform_stream(const vec128 * in, vec128 * out, size_t n, mat128 m);
+
+	// out[i] = in[i] * m, in and out must be 16 bytes aligned
+
+	void FUSE_VECTOR_CALL mat128_multiply_stream(const mat128 * in, mat128 * out, size_t n, mat128 m);
+
+	// Spheres stored as (center, radius) vectors, transformed like transform_affine
+	// does with a single sphere, in and out must be 16 bytes aligned
+
+	void FUSE_VECTOR_CALL mat128_transform_sphere_stream(const vec128 * in, vec128 * out, size_t n, mat128 m);
+
+}
\ No newline at end of file
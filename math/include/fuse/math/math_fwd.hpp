@@ -40,4 +40,24 @@ namespace fuse
 	struct mat128;
 	struct mat128_f32;
 
+	namespace detail
+	{
+
+		template <typename MatrixType, int I> struct matrix_cwise;
+
+		template <typename T, int N, int M> struct matrix_minus_impl;
+		template <typename T, int N, int M> struct matrix_add_impl;
+		template <typename T, int N, int M> struct matrix_sub_impl;
+		template <typename T, int N, int M> struct matrix_eq_impl;
+		template <typename T, int N, int M> struct matrix_scale_impl;
+		template <typename T, int N, int M> struct matrix_transpose_impl;
+
+		template <typename MatrixType, int I, int J> struct matrix_fill_impl;
+		template <typename MatrixType1, typename MatrixType2, int I, int J> struct matrix_multiplication_impl;
+
+		template <typename VectorType, int N> struct vector_dot_impl;
+		template <typename VectorType, int N> struct vector_length_impl;
+
+	}
+
 }
\ No newline at end of file
@@ -15,12 +15,12 @@ namespace fuse
 
 		matrix(T d)
 		{
-			initialize(d);
+			this->initialize(d);
 		}
 
-		matrix(std::initializer_list<scalar> init)
+		matrix(std::initializer_list<T> init)
 		{
-			std::copy(init.begin(), init.end(), row_begin());
+			std::copy(init.begin(), init.end(), this->row_begin());
 		}
 
 		T m[M * N];
@@ -11,6 +11,8 @@ namespace fuse
 		matrix_traits<T, 2, 2>
 	{
 
+		using scalar = typename matrix_traits<T, 2, 2>::scalar;
+
 		matrix(void) = default;
 		matrix(const matrix &) = default;
 
@@ -11,6 +11,8 @@ namespace fuse
 		matrix_traits<T, 3, 3>
 	{
 
+		using scalar = typename matrix_traits<T, 3, 3>::scalar;
+
 		matrix(void) = default;
 		matrix(const matrix &) = default;
 
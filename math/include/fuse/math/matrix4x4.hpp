@@ -12,6 +12,8 @@ namespace fuse
 		matrix_traits<T, 4, 4>
 	{
 
+		using scalar = typename matrix_traits<T, 4, 4>::scalar;
+
 		matrix(void) = default;
 		matrix(const matrix &) = default;
 
@@ -1,4 +1,4 @@
-#pragma
+#pragma once
 
 namespace fuse
 {
@@ -94,30 +94,30 @@ namespace fuse
 
 			using transpose_type = matrix<typename MatrixType::scalar, MatrixType::cols::value, MatrixType::rows::value>;
 
-			inline static void minus(MatrixType & r, const MatrixType & a) {}
+			inline static void minus(MatrixType &, const MatrixType &) {}
 
-			inline static void add(MatrixType & r, const MatrixType & a, const MatrixType & b) {}
+			inline static void add(MatrixType &, const MatrixType &, const MatrixType &) {}
 
 			template <typename Scalar>
-			inline static void add(MatrixType & r, const MatrixType & a, Scalar s) {}
+			inline static void add(MatrixType &, const MatrixType &, Scalar) {}
 
-			inline static void sub(MatrixType & r, const MatrixType & a, const MatrixType & b) {}
+			inline static void sub(MatrixType &, const MatrixType &, const MatrixType &) {}
 
 			template <typename Scalar>
-			inline static void sub(MatrixType & r, const MatrixType & a, Scalar s) {}
+			inline static void sub(MatrixType &, const MatrixType &, Scalar) {}
 
 			template <typename Scalar>
-			inline static void sub(MatrixType & r, Scalar s, const MatrixType & b) {}
+			inline static void sub(MatrixType &, Scalar, const MatrixType &) {}
 
 			template <typename Scalar>
-			inline static void scale(MatrixType & r, const MatrixType & a, Scalar s) {}
+			inline static void scale(MatrixType &, const MatrixType &, Scalar) {}
 
-			inline static void scale(MatrixType & r, const MatrixType & a, const MatrixType & b) {}
-			inline static void divide(MatrixType & r, const MatrixType & a, const MatrixType & b) {}
+			inline static void scale(MatrixType &, const MatrixType &, const MatrixType &) {}
+			inline static void divide(MatrixType &, const MatrixType &, const MatrixType &) {}
 
-			inline static void transpose(transpose_type & r, const MatrixType & a) {}
+			inline static void transpose(transpose_type &, const MatrixType &) {}
 
-			inline static void hadd(typename MatrixType::scalar & r, const MatrixType & a) { r = typename MatrixType::scalar(0); }
+			inline static void hadd(typename MatrixType::scalar & r, const MatrixType &) { r = typename MatrixType::scalar(0); }
 
 		};
 
@@ -145,7 +145,6 @@ namespace fuse
 				matrix_cwise<matrix_type, N * M>::add(r, a, b);
 				return r;
 			}
-			using matrix_type = matrix<T, N, M>;
 			inline static matrix_type add(const matrix_type & a, T s)
 			{
 				matrix_type r;
@@ -153,7 +152,6 @@ namespace fuse
 				return r;
 			}
 
-			using matrix_type = matrix<T, N, M>;
 			inline static matrix_type add(T s, const matrix_type & b)
 			{
 				return add(b, s);
@@ -171,7 +169,6 @@ namespace fuse
 				return r;
 			}
 
-			using matrix_type = matrix<T, N, M>;
 			inline static matrix_type sub(const matrix_type & a, T s)
 			{
 				matrix_type r;
@@ -179,7 +176,6 @@ namespace fuse
 				return r;
 			}
 
-			using matrix_type = matrix<T, N, M>;
 			inline static matrix_type sub(T s, const matrix_type & b)
 			{
 				matrix_type r;
@@ -288,7 +284,7 @@ namespace fuse
 		template <typename MatrixType, int I>
 		struct matrix_fill_impl<MatrixType, I, 0>
 		{
-			inline static void fill(MatrixType & r, typename MatrixType::scalar d, typename MatrixType::scalar f) {}
+			inline static void fill(MatrixType &, typename MatrixType::scalar, typename MatrixType::scalar) {}
 		};
 
 		/* Row-Column product */
@@ -307,7 +303,7 @@ namespace fuse
 		template <typename MatrixType1, typename MatrixType2, int I, int J>
 		struct matrix_row_col_prod_impl<MatrixType1, MatrixType2, I, J, 0>
 		{
-			inline static void multiply(typename MatrixType1::scalar & r, const MatrixType1 & a, const MatrixType2 & b)
+			inline static void multiply(typename MatrixType1::scalar & r, const MatrixType1 &, const MatrixType2 &)
 			{
 				r = 0;
 			}
@@ -350,7 +346,7 @@ namespace fuse
 		{
 			using result_type = matrix<typename MatrixType1::scalar, MatrixType1::rows::value, MatrixType2::cols::value>;
 
-			inline static void multiply(result_type & r, const MatrixType1 & a, const MatrixType2 & b) {}
+			inline static void multiply(result_type &, const MatrixType1 &, const MatrixType2 &) {}
 		};
 
 	}
@@ -80,12 +80,12 @@ namespace fuse
 
 		private:
 
-			static inline vec128 FUSE_VECTOR_CALL reciprocal_square_root_ps_step(vec128 x, vec128 yi)
+			static inline vec128 FUSE_VECTOR_CALL reciprocal_square_root_ps_step(vec128, vec128 yi)
 			{
 				return yi;
 			}
 
-			static inline vec128 FUSE_VECTOR_CALL reciprocal_square_root_ss_step(vec128 x, vec128 yi)
+			static inline vec128 FUSE_VECTOR_CALL reciprocal_square_root_ss_step(vec128, vec128 yi)
 			{
 				return yi;
 			}
@@ -1,5 +1,7 @@
 #include "newton_raphson.hpp"
 
+#include <cstring>
+
 namespace fuse
 {
 
@@ -110,6 +112,8 @@ namespace fuse
 
 	inline vec128 FUSE_VECTOR_CALL to_quat128(mat128 lhs)
 	{
-		return to_quat128(to_quaternion(reinterpret_cast<const float4x4&>(lhs)));
+		float4x4 m;
+		std::memcpy(&m, &lhs, sizeof(m));
+		return to_quat128(to_quaternion(m));
 	}
 }
\ No newline at end of file
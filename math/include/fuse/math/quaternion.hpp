@@ -5,6 +5,8 @@
 
 #include "vec128.hpp"
 
+#include <cmath>
+
 namespace fuse
 {
 
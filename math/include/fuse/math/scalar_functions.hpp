@@ -1,5 +1,9 @@
 #pragma once
 
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
 namespace fuse
 {
 
@@ -7,7 +11,10 @@ namespace fuse
 
 	inline float absolute(float a)
 	{
-		*(((int*)&a)) &= 0x7FFFFFFF;
+		uint32_t i;
+		std::memcpy(&i, &a, sizeof(i));
+		i &= 0x7FFFFFFFu;
+		std::memcpy(&a, &i, sizeof(a));
 		return a;
 	}
 
@@ -23,9 +30,11 @@ namespace fuse
 	inline float inverse_square_root(float x)
 	{
 		float halfx = .5f * x;
-		unsigned int i = *((unsigned int*)&x);
+		uint32_t i;
+		std::memcpy(&i, &x, sizeof(i));
 		i = 0x5f3759dfu - (i >> 1);
-		float yi = *((float*)&i);
+		float yi;
+		std::memcpy(&yi, &i, sizeof(yi));
 		float y0 = yi * (1.5f - (halfx * yi * yi));
 		return y0;
 	}
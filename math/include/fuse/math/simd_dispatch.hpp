@@ -0,0 +1,29 @@
+#pragma once
+
+enum simd_instruction_set
+{
+	FUSE_SIMD_SSE2,
+	FUSE_SIMD_SSE41,
+	FUSE_SIMD_AVX,
+	FUSE_SIMD_AVX2 // AVX2 and FMA3
+};
+
+namespace fuse
+{
+
+	/* Runtime selection of the instruction set used by the batched kernels */
+
+	// Best instruction set supported by both the CPU and the OS
+
+	simd_instruction_set simd_get_supported_instruction_set(void);
+
+	// Instruction set the batched kernels dispatch to, the best supported one by default
+
+	simd_instruction_set simd_get_instruction_set(void);
+
+	// Forces the batched kernels to use the given instruction set (e.g. to benchmark
+	// the different paths). Returns false and keeps the current one if it's not supported.
+
+	bool simd_set_instruction_set(simd_instruction_set instructionSet);
+
+}
\ No newline at end of file
@@ -40,7 +40,7 @@ namespace fuse
 
 	};
 
-	template <typename Char, typename T, int N, int M, template <typename Char, typename T, int N, int M> class Formatter = default_matrix_formatter>
+	template <typename Char, typename T, int N, int M, template <typename, typename, int, int> class Formatter = default_matrix_formatter>
 	std::basic_ostream<Char> & operator<< (std::basic_ostream<Char> & os, const matrix<T, N, M> & m)
 	{
 		Formatter<Char, T, N, M> f;
@@ -70,7 +70,7 @@ namespace fuse
 		return os;
 	}
 
-	template <typename Char, template <typename Char> class Formatter = default_quaternion_formatter>
+	template <typename Char, template <typename> class Formatter = default_quaternion_formatter>
 	std::basic_ostream<Char> & operator<< (std::basic_ostream<Char> & os, const quaternion & q)
 	{
 		Formatter<Char> f;
@@ -94,13 +94,13 @@ namespace fuse
 		return os;
 	}
 
-	template <typename Char, template <typename Char> class Formatter = default_quaternion_formatter>
+	template <typename Char, template <typename> class Formatter = default_quaternion_formatter>
 	std::basic_ostream<Char> & operator<< (std::basic_ostream<Char> & os, const vec128_f32 & v)
 	{
 		return operator<< <Char, float, 1, 4>(os, v.v4f);
 	}
 
-	template <typename Char, template <typename Char> class Formatter = default_quaternion_formatter>
+	template <typename Char, template <typename> class Formatter = default_quaternion_formatter>
 	std::basic_ostream<Char> & operator<< (std::basic_ostream<Char> & os, const mat128_f32 & v)
 	{
 		return operator<< <Char, float, 4, 4> (os, v.m);
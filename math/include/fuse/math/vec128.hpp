@@ -1,6 +1,8 @@
 #pragma once
 
 #include <xmmintrin.h>
+#include <pmmintrin.h>
+#include <smmintrin.h>
 
 #include "math_fwd.hpp"
 
@@ -12,7 +14,29 @@
 
 #include <cstdint>
 
+#ifdef _MSC_VER
 #define FUSE_VECTOR_CALL __vectorcall
+#else
+#define FUSE_VECTOR_CALL
+#endif
+
+// GCC warns that the may_alias attribute of __m128 is dropped when vec128 is a template
+// argument, the headers declaring containers of vec128 silence it between these two
+
+#ifdef __GNUC__
+#define FUSE_VEC128_TEMPLATE_ARGUMENTS_BEGIN _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wignored-attributes\"")
+#define FUSE_VEC128_TEMPLATE_ARGUMENTS_END   _Pragma("GCC diagnostic pop")
+#else
+#define FUSE_VEC128_TEMPLATE_ARGUMENTS_BEGIN
+#define FUSE_VEC128_TEMPLATE_ARGUMENTS_END
+#endif
+
+// Builds targeting AVX2 (FUSE_AVX2 option) use FMA in the inline functions
+
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define FUSE_FMA
+#include <immintrin.h>
+#endif
 
 namespace fuse
 {
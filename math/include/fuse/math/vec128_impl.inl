@@ -420,6 +420,10 @@ namespace fuse
 
 	/* Operators */
 
+	// GCC and Clang already define these operators on __m128 as vector extensions
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
 	inline vec128 FUSE_VECTOR_CALL operator+(vec128 lhs, vec128 rhs) { return vec128_add(lhs, rhs); }
 	inline vec128 FUSE_VECTOR_CALL operator-(vec128 lhs, vec128 rhs) { return vec128_sub(lhs, rhs); }
 	inline vec128 FUSE_VECTOR_CALL operator*(vec128 lhs, vec128 rhs) { return vec128_mul(lhs, rhs); }
@@ -433,4 +437,6 @@ namespace fuse
 
 	inline vec128 FUSE_VECTOR_CALL operator-(vec128 lhs) { return vec128_negate(lhs); }
 
+#endif
+
 }
\ No newline at end of file
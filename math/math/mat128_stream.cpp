@@ -0,0 +1,268 @@
+#include <fuse/math.hpp>
+#include <fuse/math/mat128_stream.hpp>
+
+#include <cmath>
+
+using namespace fuse;
+
+/* AVX kernels (mat128_stream_avx.cpp, mat128_stream_avx2.cpp) */
+
+namespace fuse
+{
+
+	namespace detail
+	{
+
+		void mat128_transform_float3_stream_avx(const float * in, float * out, size_t n, const float * m);
+		void mat128_transform_vec128_stream_avx(const float * in, float * out, size_t n, const float * m);
+		void mat128_multiply_stream_avx(const float * in, float * out, size_t n, const float * m);
+		void mat128_transform_sphere_stream_avx(const float * in, float * out, size_t n, const float * m);
+
+		void mat128_transform_float3_stream_avx2(const float * in, float * out, size_t n, const float * m);
+		void mat128_transform_vec128_stream_avx2(const float * in, float * out, size_t n, const float * m);
+		void mat128_multiply_stream_avx2(const float * in, float * out, size_t n, const float * m);
+		void mat128_transform_sphere_stream_avx2(const float * in, float * out, size_t n, const float * m);
+
+	}
+
+}
+
+/* SSE kernels */
+
+// The SSE and AVX kernels sum the terms in the same order, ((x * r0 + y * r1) + (z * r2 + w * r3)),
+// and give the same results. The AVX2 ones fuse the multiply-adds, which only changes the rounding.
+
+static inline vec128 FUSE_VECTOR_CALL transform4_sse2(vec128 v, const mat128 & rows)
+{
+	vec128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+	vec128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+	vec128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+	vec128 w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+
+	vec128 xy = _mm_add_ps(_mm_mul_ps(x, rows.c[0]), _mm_mul_ps(y, rows.c[1]));
+	vec128 zw = _mm_add_ps(_mm_mul_ps(z, rows.c[2]), _mm_mul_ps(w, rows.c[3]));
+
+	return _mm_add_ps(xy, zw);
+}
+
+static inline vec128 FUSE_VECTOR_CALL transform3_sse2(vec128 v, const mat128 & rows)
+{
+	vec128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+	vec128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+	vec128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+
+	vec128 xy = _mm_add_ps(_mm_mul_ps(x, rows.c[0]), _mm_mul_ps(y, rows.c[1]));
+	vec128 zw = _mm_add_ps(_mm_mul_ps(z, rows.c[2]), rows.c[3]);
+
+	return _mm_add_ps(xy, zw);
+}
+
+static void transform_float3_stream_sse2(const float3 * in, float4 * out, size_t n, const mat128 & m)
+{
+	// The matrix columns splatted, each output component is computed for 4 points at once
+
+	vec128 s[4][4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		s[i][0] = _mm_shuffle_ps(m.c[i], m.c[i], _MM_SHUFFLE(0, 0, 0, 0));
+		s[i][1] = _mm_shuffle_ps(m.c[i], m.c[i], _MM_SHUFFLE(1, 1, 1, 1));
+		s[i][2] = _mm_shuffle_ps(m.c[i], m.c[i], _MM_SHUFFLE(2, 2, 2, 2));
+		s[i][3] = _mm_shuffle_ps(m.c[i], m.c[i], _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	const float * src = in->m;
+	float       * dst = out->m;
+
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4, src += 12, dst += 16)
+	{
+		// Deinterleave (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+
+		vec128 a = _mm_loadu_ps(src);
+		vec128 b = _mm_loadu_ps(src + 4);
+		vec128 c = _mm_loadu_ps(src + 8);
+
+		vec128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		vec128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		vec128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+		vec128 r[4];
+
+		for (int j = 0; j < 4; j++)
+		{
+			vec128 xy = _mm_add_ps(_mm_mul_ps(x, s[j][0]), _mm_mul_ps(y, s[j][1]));
+			vec128 zw = _mm_add_ps(_mm_mul_ps(z, s[j][2]), s[j][3]);
+			r[j] = _mm_add_ps(xy, zw);
+		}
+
+		_MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+
+		_mm_storeu_ps(dst,      r[0]);
+		_mm_storeu_ps(dst + 4,  r[1]);
+		_mm_storeu_ps(dst + 8,  r[2]);
+		_mm_storeu_ps(dst + 12, r[3]);
+	}
+
+	mat128 rows = mat128_transpose(m);
+
+	for (; i < n; i++)
+	{
+		_mm_storeu_ps(out[i].m, transform3_sse2(vec128_load(in[i]), rows));
+	}
+}
+
+static void transform_vec128_stream_sse2(const vec128 * in, vec128 * out, size_t n, const mat128 & m)
+{
+	mat128 rows = mat128_transpose(m);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		out[i] = transform4_sse2(in[i], rows);
+	}
+}
+
+static void multiply_stream_sse2(const mat128 * in, mat128 * out, size_t n, const mat128 & m)
+{
+	// Each column of the product is a combination of the columns of in[i]:
+	// (A * M).c[j] = A.c[0] * M.c[j].x + A.c[1] * M.c[j].y + A.c[2] * M.c[j].z + A.c[3] * M.c[j].w
+
+	vec128 s[4][4];
+
+	for (int j = 0; j < 4; j++)
+	{
+		s[j][0] = _mm_shuffle_ps(m.c[j], m.c[j], _MM_SHUFFLE(0, 0, 0, 0));
+		s[j][1] = _mm_shuffle_ps(m.c[j], m.c[j], _MM_SHUFFLE(1, 1, 1, 1));
+		s[j][2] = _mm_shuffle_ps(m.c[j], m.c[j], _MM_SHUFFLE(2, 2, 2, 2));
+		s[j][3] = _mm_shuffle_ps(m.c[j], m.c[j], _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	for (size_t i = 0; i < n; i++)
+	{
+		mat128 a = in[i];
+
+		for (int j = 0; j < 4; j++)
+		{
+			vec128 xy = _mm_add_ps(_mm_mul_ps(a.c[0], s[j][0]), _mm_mul_ps(a.c[1], s[j][1]));
+			vec128 zw = _mm_add_ps(_mm_mul_ps(a.c[2], s[j][2]), _mm_mul_ps(a.c[3], s[j][3]));
+			out[i].c[j] = _mm_add_ps(xy, zw);
+		}
+	}
+}
+
+template <bool SSE41>
+static void transform_sphere_stream_sse(const vec128 * in, vec128 * out, size_t n, const mat128 & m)
+{
+	// The radius is scaled by the length of the transformed x axis, as in transform_affine
+
+	mat128 rows = mat128_transpose(m);
+
+	float xAxis[4];
+	_mm_storeu_ps(xAxis, rows.c[0]);
+
+	vec128 scale = _mm_set1_ps(std::sqrt(xAxis[0] * xAxis[0] + xAxis[1] * xAxis[1] + xAxis[2] * xAxis[2]));
+	vec128 mask  = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+	for (size_t i = 0; i < n; i++)
+	{
+		vec128 s      = in[i];
+		vec128 center = transform3_sse2(s, rows);
+		vec128 radius = _mm_mul_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3)), scale);
+
+		out[i] = SSE41 ?
+			_mm_blend_ps(center, radius, 0x8) :
+			_mm_or_ps(_mm_and_ps(mask, center), _mm_andnot_ps(mask, radius));
+	}
+}
+
+/* Dispatch */
+
+// The streams may be null when empty, nothing is dereferenced then
+
+void FUSE_VECTOR_CALL fuse::mat128_transform_stream(const float3 * in, float4 * out, size_t n, mat128 m)
+{
+	if (!n)
+	{
+		return;
+	}
+
+	switch (simd_get_instruction_set())
+	{
+	case FUSE_SIMD_AVX2:
+		detail::mat128_transform_float3_stream_avx2(in->m, out->m, n, reinterpret_cast<const float*>(&m));
+		break;
+	case FUSE_SIMD_AVX:
+		detail::mat128_transform_float3_stream_avx(in->m, out->m, n, reinterpret_cast<const float*>(&m));
+		break;
+	default:
+		transform_float3_stream_sse2(in, out, n, m);
+		break;
+	}
+}
+
+void FUSE_VECTOR_CALL fuse::mat128_transform_stream(const vec128 * in, vec128 * out, size_t n, mat128 m)
+{
+	if (!n)
+	{
+		return;
+	}
+
+	switch (simd_get_instruction_set())
+	{
+	case FUSE_SIMD_AVX2:
+		detail::mat128_transform_vec128_stream_avx2(reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n, reinterpret_cast<const float*>(&m));
+		break;
+	case FUSE_SIMD_AVX:
+		detail::mat128_transform_vec128_stream_avx(reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n, reinterpret_cast<const float*>(&m));
+		break;
+	default:
+		transform_vec128_stream_sse2(in, out, n, m);
+		break;
+	}
+}
+
+void FUSE_VECTOR_CALL fuse::mat128_multiply_stream(const mat128 * in, mat128 * out, size_t n, mat128 m)
+{
+	if (!n)
+	{
+		return;
+	}
+
+	switch (simd_get_instruction_set())
+	{
+	case FUSE_SIMD_AVX2:
+		detail::mat128_multiply_stream_avx2(reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n, reinterpret_cast<const float*>(&m));
+		break;
+	case FUSE_SIMD_AVX:
+		detail::mat128_multiply_stream_avx(reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n, reinterpret_cast<const float*>(&m));
+		break;
+	default:
+		multiply_stream_sse2(in, out, n, m);
+		break;
+	}
+}
+
+void FUSE_VECTOR_CALL fuse::mat128_transform_sphere_stream(const vec128 * in, vec128 * out, size_t n, mat128 m)
+{
+	if (!n)
+	{
+		return;
+	}
+
+	switch (simd_get_instruction_set())
+	{
+	case FUSE_SIMD_AVX2:
+		detail::mat128_transform_sphere_stream_avx2(reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n, reinterpret_cast<const float*>(&m));
+		break;
+	case FUSE_SIMD_AVX:
+		detail::mat128_transform_sphere_stream_avx(reinterpret_cast<const float*>(in), reinterpret_cast<float*>(out), n, reinterpret_cast<const float*>(&m));
+		break;
+	case FUSE_SIMD_SSE41:
+		transform_sphere_stream_sse<true>(in, out, n, m);
+		break;
+	default:
+		transform_sphere_stream_sse<false>(in, out, n, m);
+		break;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+// Compiled with AVX code generation, see mat128_stream_avx.inl
+
+#include <immintrin.h>
+
+#include <cstddef>
+
+namespace fuse
+{
+
+	namespace detail
+	{
+
+		namespace avx
+		{
+
+			static inline __m256 madd(__m256 a, __m256 b, __m256 c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+			static inline __m128 madd(__m128 a, __m128 b, __m128 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+#include "mat128_stream_avx.inl"
+
+		}
+
+		void mat128_transform_float3_stream_avx(const float * in, float * out, size_t n, const float * m)
+		{
+			avx::transform_float3_stream(in, out, n, m);
+		}
+
+		void mat128_transform_vec128_stream_avx(const float * in, float * out, size_t n, const float * m)
+		{
+			avx::transform_vec128_stream(in, out, n, m);
+		}
+
+		void mat128_multiply_stream_avx(const float * in, float * out, size_t n, const float * m)
+		{
+			avx::multiply_stream(in, out, n, m);
+		}
+
+		void mat128_transform_sphere_stream_avx(const float * in, float * out, size_t n, const float * m)
+		{
+			avx::transform_sphere_stream(in, out, n, m);
+		}
+
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,227 @@
+// AVX kernels of the mat128 streams, shared by the AVX and AVX2 translation units.
+// Only intrinsics are used, no inline functions shared with the other translation
+// units, so that no VEX encoded copy of them can be picked by the linker and run
+// on older CPUs
+
+/* Helpers */
+
+// The including translation unit defines madd(a, b, c) = a * b + c, which is
+// fused on FMA capable instruction sets
+
+static inline __m256 combine4(__m256 x, __m256 r0, __m256 y, __m256 r1, __m256 z, __m256 r2, __m256 w, __m256 r3)
+{
+	__m256 xy = madd(y, r1, _mm256_mul_ps(x, r0));
+	__m256 zw = madd(w, r3, _mm256_mul_ps(z, r2));
+	return _mm256_add_ps(xy, zw);
+}
+
+static inline __m256 combine3(__m256 x, __m256 r0, __m256 y, __m256 r1, __m256 z, __m256 r2, __m256 r3)
+{
+	__m256 xy = madd(y, r1, _mm256_mul_ps(x, r0));
+	__m256 zw = madd(z, r2, r3);
+	return _mm256_add_ps(xy, zw);
+}
+
+static inline __m128 combine3(__m128 x, __m128 r0, __m128 y, __m128 r1, __m128 z, __m128 r2, __m128 r3)
+{
+	__m128 xy = madd(y, r1, _mm_mul_ps(x, r0));
+	__m128 zw = madd(z, r2, r3);
+	return _mm_add_ps(xy, zw);
+}
+
+static inline void load_rows(const float * m, __m128 rows[4])
+{
+	rows[0] = _mm_loadu_ps(m);
+	rows[1] = _mm_loadu_ps(m + 4);
+	rows[2] = _mm_loadu_ps(m + 8);
+	rows[3] = _mm_loadu_ps(m + 12);
+
+	_MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+}
+
+static inline __m256 splat2(float a, float b)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(a)), _mm_set1_ps(b), 1);
+}
+
+static inline __m256 broadcast(__m128 v)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(v), v, 1);
+}
+
+/* Kernels */
+
+static void transform_float3_stream(const float * in, float * out, size_t n, const float * m)
+{
+	// 8 points at a time, 4 in each 128 bits lane, same layout as the SSE2 kernel
+
+	__m256 s[4][4];
+
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			s[i][j] = _mm256_set1_ps(m[4 * i + j]);
+		}
+	}
+
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8, in += 24, out += 32)
+	{
+		__m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in)),     _mm_loadu_ps(in + 12), 1);
+		__m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 4)), _mm_loadu_ps(in + 16), 1);
+		__m256 c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(in + 8)), _mm_loadu_ps(in + 20), 1);
+
+		__m256 x = _mm256_shuffle_ps(a, _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		__m256 y = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		__m256 z = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm256_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+		__m256 rx = combine3(x, s[0][0], y, s[0][1], z, s[0][2], s[0][3]);
+		__m256 ry = combine3(x, s[1][0], y, s[1][1], z, s[1][2], s[1][3]);
+		__m256 rz = combine3(x, s[2][0], y, s[2][1], z, s[2][2], s[2][3]);
+		__m256 rw = combine3(x, s[3][0], y, s[3][1], z, s[3][2], s[3][3]);
+
+		// 4x4 transpose in each lane
+
+		__m256 t0 = _mm256_unpacklo_ps(rx, ry);
+		__m256 t1 = _mm256_unpackhi_ps(rx, ry);
+		__m256 t2 = _mm256_unpacklo_ps(rz, rw);
+		__m256 t3 = _mm256_unpackhi_ps(rz, rw);
+
+		__m256 p0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 p1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 p2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 p3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+		_mm256_storeu_ps(out,      _mm256_permute2f128_ps(p0, p1, 0x20));
+		_mm256_storeu_ps(out + 8,  _mm256_permute2f128_ps(p2, p3, 0x20));
+		_mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(p0, p1, 0x31));
+		_mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(p2, p3, 0x31));
+	}
+
+	__m128 rows[4];
+	load_rows(m, rows);
+
+	for (; i < n; i++, in += 3, out += 4)
+	{
+		__m128 r = combine3(_mm_set1_ps(in[0]), rows[0], _mm_set1_ps(in[1]), rows[1], _mm_set1_ps(in[2]), rows[2], rows[3]);
+		_mm_storeu_ps(out, r);
+	}
+}
+
+static void transform_vec128_stream(const float * in, float * out, size_t n, const float * m)
+{
+	// 2 vectors at a time
+
+	__m128 rows[4];
+	load_rows(m, rows);
+
+	__m256 r0 = broadcast(rows[0]);
+	__m256 r1 = broadcast(rows[1]);
+	__m256 r2 = broadcast(rows[2]);
+	__m256 r3 = broadcast(rows[3]);
+
+	size_t i = 0;
+
+	for (; i + 2 <= n; i += 2, in += 8, out += 8)
+	{
+		__m256 v = _mm256_loadu_ps(in);
+
+		__m256 x = _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0));
+		__m256 y = _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1));
+		__m256 z = _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2));
+		__m256 w = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3));
+
+		_mm256_storeu_ps(out, combine4(x, r0, y, r1, z, r2, w, r3));
+	}
+
+	if (i < n)
+	{
+		__m256 v = _mm256_castps128_ps256(_mm_load_ps(in));
+
+		__m256 x = _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0));
+		__m256 y = _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1));
+		__m256 z = _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2));
+		__m256 w = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3));
+
+		_mm_store_ps(out, _mm256_castps256_ps128(combine4(x, r0, y, r1, z, r2, w, r3)));
+	}
+}
+
+static void multiply_stream(const float * in, float * out, size_t n, const float * m)
+{
+	// Two columns of the product at a time, each column of in[i] is broadcast
+	// to both lanes and multiplied by the splatted elements of two columns of m
+
+	__m256 s01[4], s23[4];
+
+	for (int j = 0; j < 4; j++)
+	{
+		s01[j] = splat2(m[j],     m[4 + j]);
+		s23[j] = splat2(m[8 + j], m[12 + j]);
+	}
+
+	for (size_t i = 0; i < n; i++, in += 16, out += 16)
+	{
+		__m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(in));
+		__m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(in + 4));
+		__m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(in + 8));
+		__m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(in + 12));
+
+		__m256 c01 = combine4(a0, s01[0], a1, s01[1], a2, s01[2], a3, s01[3]);
+		__m256 c23 = combine4(a0, s23[0], a1, s23[1], a2, s23[2], a3, s23[3]);
+
+		_mm256_storeu_ps(out,     c01);
+		_mm256_storeu_ps(out + 8, c23);
+	}
+}
+
+static void transform_sphere_stream(const float * in, float * out, size_t n, const float * m)
+{
+	// 2 spheres at a time
+
+	__m128 rows[4];
+	load_rows(m, rows);
+
+	__m256 r0 = broadcast(rows[0]);
+	__m256 r1 = broadcast(rows[1]);
+	__m256 r2 = broadcast(rows[2]);
+	__m256 r3 = broadcast(rows[3]);
+
+	float xAxis[4];
+	_mm_storeu_ps(xAxis, rows[0]);
+
+	float length = _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(xAxis[0] * xAxis[0] + xAxis[1] * xAxis[1] + xAxis[2] * xAxis[2])));
+	__m256 scale = _mm256_set1_ps(length);
+
+	size_t i = 0;
+
+	for (; i + 2 <= n; i += 2, in += 8, out += 8)
+	{
+		__m256 s = _mm256_loadu_ps(in);
+
+		__m256 x = _mm256_permute_ps(s, _MM_SHUFFLE(0, 0, 0, 0));
+		__m256 y = _mm256_permute_ps(s, _MM_SHUFFLE(1, 1, 1, 1));
+		__m256 z = _mm256_permute_ps(s, _MM_SHUFFLE(2, 2, 2, 2));
+
+		__m256 center = combine3(x, r0, y, r1, z, r2, r3);
+		__m256 radius = _mm256_mul_ps(_mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3)), scale);
+
+		_mm256_storeu_ps(out, _mm256_blend_ps(center, radius, 0x88));
+	}
+
+	if (i < n)
+	{
+		__m256 s = _mm256_castps128_ps256(_mm_load_ps(in));
+
+		__m256 x = _mm256_permute_ps(s, _MM_SHUFFLE(0, 0, 0, 0));
+		__m256 y = _mm256_permute_ps(s, _MM_SHUFFLE(1, 1, 1, 1));
+		__m256 z = _mm256_permute_ps(s, _MM_SHUFFLE(2, 2, 2, 2));
+
+		__m256 center = combine3(x, r0, y, r1, z, r2, r3);
+		__m256 radius = _mm256_mul_ps(_mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3)), scale);
+
+		_mm_store_ps(out, _mm256_castps256_ps128(_mm256_blend_ps(center, radius, 0x88)));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+// Compiled with AVX2 and FMA code generation, see mat128_stream_avx.inl
+
+#include <immintrin.h>
+
+#include <cstddef>
+
+namespace fuse
+{
+
+	namespace detail
+	{
+
+		namespace avx2
+		{
+
+			static inline __m256 madd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+			static inline __m128 madd(__m128 a, __m128 b, __m128 c) { return _mm_fmadd_ps(a, b, c); }
+
+#include "mat128_stream_avx.inl"
+
+		}
+
+		void mat128_transform_float3_stream_avx2(const float * in, float * out, size_t n, const float * m)
+		{
+			avx2::transform_float3_stream(in, out, n, m);
+		}
+
+		void mat128_transform_vec128_stream_avx2(const float * in, float * out, size_t n, const float * m)
+		{
+			avx2::transform_vec128_stream(in, out, n, m);
+		}
+
+		void mat128_multiply_stream_avx2(const float * in, float * out, size_t n, const float * m)
+		{
+			avx2::multiply_stream(in, out, n, m);
+		}
+
+		void mat128_transform_sphere_stream_avx2(const float * in, float * out, size_t n, const float * m)
+		{
+			avx2::transform_sphere_stream(in, out, n, m);
+		}
+
+	}
+
+}
\ No newline at end of file
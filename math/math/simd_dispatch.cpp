@@ -0,0 +1,93 @@
+#include <fuse/math/simd_dispatch.hpp>
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+using namespace fuse;
+
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+{
+#ifdef _MSC_VER
+	__cpuidex(reinterpret_cast<int*>(registers), leaf, subleaf);
+#else
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+static uint64_t xgetbv(uint32_t index)
+{
+#ifdef _MSC_VER
+	return _xgetbv(index);
+#else
+	uint32_t eax, edx;
+	__asm__ volatile ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (index));
+	return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+static simd_instruction_set detect_instruction_set(void)
+{
+	uint32_t registers[4];
+
+	cpuid(0, 0, registers);
+
+	uint32_t maxLeaf = registers[0];
+
+	cpuid(1, 0, registers);
+
+	bool sse41   = (registers[2] & (1 << 19)) != 0;
+	bool osxsave = (registers[2] & (1 << 27)) != 0;
+	bool fma     = (registers[2] & (1 << 12)) != 0;
+	bool avx     = (registers[2] & (1 << 28)) != 0;
+	bool avx2    = false;
+
+	// AVX needs the OS to save the YMM registers on context switch (XCR0 bits 1 and 2)
+
+	avx = avx && osxsave && (xgetbv(0) & 0x6) == 0x6;
+
+	if (maxLeaf >= 7 && avx)
+	{
+		cpuid(7, 0, registers);
+		avx2 = (registers[1] & (1 << 5)) != 0;
+	}
+
+	// The AVX2 kernels also use FMA, every Intel and AMD CPU with AVX2 has it
+
+	if (avx2 && fma)
+	{
+		return FUSE_SIMD_AVX2;
+	}
+
+	return avx ? FUSE_SIMD_AVX : (sse41 ? FUSE_SIMD_SSE41 : FUSE_SIMD_SSE2);
+}
+
+// Zero initialized (SSE2) until the dynamic initialization runs
+
+static simd_instruction_set g_supportedInstructionSet = detect_instruction_set();
+static simd_instruction_set g_instructionSet          = g_supportedInstructionSet;
+
+simd_instruction_set fuse::simd_get_supported_instruction_set(void)
+{
+	return g_supportedInstructionSet;
+}
+
+simd_instruction_set fuse::simd_get_instruction_set(void)
+{
+	return g_instructionSet;
+}
+
+bool fuse::simd_set_instruction_set(simd_instruction_set instructionSet)
+{
+	if (instructionSet > g_supportedInstructionSet)
+	{
+		return false;
+	}
+
+	g_instructionSet = instructionSet;
+	return true;
+}
\ No newline at end of file
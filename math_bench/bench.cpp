@@ -0,0 +1,178 @@
+#include "bench.hpp"
+
+#include <fuse/math/simd_dispatch.hpp>
+
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <thread>
+
+#ifdef _MSC_VER
+void * volatile g_benchSink;
+#endif
+
+/* Meshes */
+
+void bench_generate_sphere(std::vector<fuse::float3> & vertices, std::vector<uint32_t> & indices, uint32_t n, bool facingOutwards, float bump, std::vector<fuse::float2> * texcoords)
+{
+	const float pi = 3.14159265f;
+
+	vertices.clear();
+	indices.clear();
+
+	if (texcoords)
+	{
+		texcoords->clear();
+	}
+
+	for (uint32_t i = 0; i <= n; i++)
+	{
+		for (uint32_t j = 0; j <= n; j++)
+		{
+			float theta = pi * i / n;
+			float phi   = 2.f * pi * j / n;
+			float r     = 1.f + bump * std::sin(8.f * theta) * std::sin(6.f * phi);
+
+			vertices.emplace_back(r * std::sin(theta) * std::cos(phi), r * std::cos(theta), r * std::sin(theta) * std::sin(phi));
+
+			if (texcoords)
+			{
+				texcoords->emplace_back(float(j) / n, float(i) / n);
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		for (uint32_t j = 0; j < n; j++)
+		{
+			uint32_t a = i * (n + 1) + j;
+			uint32_t b = a + n + 1;
+
+			uint32_t inwards[6]  = { a, b, a + 1, a + 1, b, b + 1 };
+			uint32_t outwards[6] = { a, a + 1, b, a + 1, b + 1, b };
+
+			const uint32_t * quad = facingOutwards ? outwards : inwards;
+
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+/* Cameras */
+
+fuse::float4x4 bench_perspective_lh(float fovy, float aspectRatio, float znear, float zfar)
+{
+	float h = 1.f / std::tan(fovy * .5f);
+	float w = h / aspectRatio;
+	float q = zfar / (zfar - znear);
+
+	return fuse::float4x4(
+		w, 0, 0, 0,
+		0, h, 0, 0,
+		0, 0, q, 1,
+		0, 0, -q * znear, 0);
+}
+
+/* Results */
+
+static void bench_write_json_string(std::ostream & os, const std::string & s)
+{
+	os << '"';
+
+	for (char c : s)
+	{
+		if (c == '"' || c == '\\')
+		{
+			os << '\\';
+		}
+
+		os << c;
+	}
+
+	os << '"';
+}
+
+static const char * bench_instruction_set_name(simd_instruction_set instructionSet)
+{
+	switch (instructionSet)
+	{
+	case FUSE_SIMD_AVX2:
+		return "avx2+fma";
+	case FUSE_SIMD_AVX:
+		return "avx";
+	case FUSE_SIMD_SSE41:
+		return "sse4.1";
+	default:
+		return "sse2";
+	}
+}
+
+bench_reporter::bench_reporter(std::ostream & log, const std::string & filter) :
+	m_log(log),
+	m_filter(filter) { }
+
+bool bench_reporter::enabled(const char * name) const
+{
+	return m_filter.empty() || std::string(name).find(m_filter) != std::string::npos;
+}
+
+void bench_reporter::add(const char * name, const char * variant, double milliseconds, size_t items)
+{
+	m_results.push_back(result { name, variant, milliseconds, items });
+
+	m_log << std::left << std::setw(32) << name
+	      << std::setw(12) << variant
+	      << std::right << std::fixed << std::setprecision(3)
+	      << std::setw(12) << milliseconds << " ms"
+	      << std::setw(12) << (milliseconds * 1e6 / items) << " ns/item" << std::endl;
+}
+
+void bench_reporter::write_json(std::ostream & os, const char * executable) const
+{
+	std::time_t now = std::time(nullptr);
+	char date[32];
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+	os << "{" << std::endl;
+	os << "  \"context\": {" << std::endl;
+	os << "    \"date\": \"" << date << "\"," << std::endl;
+	os << "    \"executable\": ";
+	bench_write_json_string(os, executable);
+	os << "," << std::endl;
+	os << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "," << std::endl;
+	os << "    \"simd_instruction_set\": \"" << bench_instruction_set_name(fuse::simd_get_supported_instruction_set()) << "\"," << std::endl;
+#ifdef NDEBUG
+	os << "    \"library_build_type\": \"release\"" << std::endl;
+#else
+	os << "    \"library_build_type\": \"debug\"" << std::endl;
+#endif
+	os << "  }," << std::endl;
+	os << "  \"benchmarks\": [" << std::endl;
+
+	for (size_t i = 0; i < m_results.size(); i++)
+	{
+		const result & r = m_results[i];
+
+		// Times are per item, the items processed are reported as iterations
+
+		double nanoseconds = r.milliseconds * 1e6 / r.items;
+
+		os << "    {" << std::endl;
+		os << "      \"name\": ";
+		bench_write_json_string(os, r.name + "/" + r.variant);
+		os << "," << std::endl;
+		os << "      \"run_name\": ";
+		bench_write_json_string(os, r.name + "/" + r.variant);
+		os << "," << std::endl;
+		os << "      \"run_type\": \"iteration\"," << std::endl;
+		os << "      \"iterations\": " << r.items << "," << std::endl;
+		os << "      \"real_time\": " << std::setprecision(6) << nanoseconds << "," << std::endl;
+		os << "      \"cpu_time\": " << std::setprecision(6) << nanoseconds << "," << std::endl;
+		os << "      \"time_unit\": \"ns\"" << std::endl;
+		os << "    }" << (i + 1 < m_results.size() ? "," : "") << std::endl;
+	}
+
+	os << "  ]" << std::endl;
+	os << "}" << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <fuse/math.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* Timing */
+
+template <typename Setup, typename Function>
+double bench_run(int repetitions, Setup setup, Function function)
+{
+	double best = std::numeric_limits<double>::infinity();
+
+	for (int i = 0; i < repetitions; i++)
+	{
+		setup();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		function();
+		auto end   = std::chrono::high_resolution_clock::now();
+
+		best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	return best;
+}
+
+// Keeps the compiler from optimizing away the writes to the memory pointed by p
+
+#ifdef _MSC_VER
+
+extern void * volatile g_benchSink;
+
+template <typename T>
+inline void bench_do_not_optimize(T * p)
+{
+	g_benchSink = p;
+}
+
+#else
+
+template <typename T>
+inline void bench_do_not_optimize(T * p)
+{
+	asm volatile ("" : : "r" (p) : "memory");
+}
+
+#endif
+
+/* Meshes */
+
+// A sphere tessellated as a latitude/longitude grid of n x n quads, the triangles in
+// scanline order. The radius is 1 + bump sin(8 theta) sin(6 phi), so that the
+// curvature is not the same everywhere when bump is not 0. The texcoords are the
+// spherical coordinates, written if not null.
+
+void bench_generate_sphere(
+	std::vector<fuse::float3> & vertices,
+	std::vector<uint32_t> & indices,
+	uint32_t n,
+	bool facingOutwards = false,
+	float bump = 0.f,
+	std::vector<fuse::float2> * texcoords = nullptr);
+
+/* Cameras */
+
+// Left handed perspective projection, depth from 0 at znear to 1 at zfar
+
+fuse::float4x4 bench_perspective_lh(float fovy, float aspectRatio, float znear, float zfar);
+
+/*
+*
+* Collects the results of the benchmarks, prints them on the log stream as
+* they are added and writes them as JSON at the end of the run. The JSON
+* follows the Google Benchmark format so the usual comparison scripts work
+* on it.
+*
+*/
+
+class bench_reporter
+{
+
+public:
+
+	bench_reporter(std::ostream & log, const std::string & filter = std::string());
+
+	// Benchmarks and groups run only if their name contains the filter
+
+	bool enabled(const char * name) const;
+
+	void add(const char * name, const char * variant, double milliseconds, size_t items);
+
+	void write_json(std::ostream & os, const char * executable) const;
+
+	inline std::ostream & log(void) { return m_log; }
+
+private:
+
+	struct result
+	{
+		std::string name;
+		std::string variant;
+		double      milliseconds;
+		size_t      items;
+	};
+
+	std::ostream        & m_log;
+	std::string           m_filter;
+	std::vector<result>   m_results;
+
+};
+
+/* Benchmarks */
+
+// Every vec128, mat128, quat128 and matrix<T, N, M> operation, compared to
+// Eigen and DirectXMath when available
+
+void bench_operations(bench_reporter & reporter);
+
+// resource_manager::find_by_name from a growing number of threads
+
+void bench_resource_manager(bench_reporter & reporter);
+
+// Random allocations and frees of descriptor ranges, pool_manager compared to the
+// first fit search it replaced
+
+void bench_pool_manager(bench_reporter & reporter);
+
+// A frame of transient descriptors allocated from a growing number of threads, each
+// with its own transient_allocator, compared to pool_manager behind a mutex
+
+void bench_transient_pool(bench_reporter & reporter);
+
+// The per-frame containers of the renderer allocated from the heap and from a
+// frame_arena reset after each frame
+
+void bench_frame_arena(bench_reporter & reporter);
+
+// Import and teardown of a tree of scene graph sized nodes, allocated one by one with
+// aligned_malloc and from a slab_allocator, rewound or released after the teardown
+
+void bench_slab_allocator(bench_reporter & reporter);
+
+// Vertex cache, overdraw and vertex fetch optimization of a tessellated sphere, the
+// ACMR and ATVR before and after each stage are printed on the log
+
+void bench_mesh_optimizer(bench_reporter & reporter);
+
+// Quadric error simplification of a tessellated sphere down to a fraction of its
+// triangles, the triangles left and the error reached are printed on the log
+
+void bench_mesh_simplifier(bench_reporter & reporter);
+
+// Cluster decomposition of a tessellated sphere, then culling of the clusters for a
+// view containing the sphere and one seeing part of it
+
+void bench_mesh_clusters(bench_reporter & reporter);
+
+// Software occlusion of a wall of tessellated spheres, drawn on a thread pool with a
+// growing number of threads, then tests of boxes scattered behind it
+
+void bench_occlusion_buffer(bench_reporter & reporter);
+
+// Tangent space of a tessellated sphere with texcoords, split on a thread pool
+// with a growing number of threads
+
+void bench_tangent_space(bench_reporter & reporter);
\ No newline at end of file
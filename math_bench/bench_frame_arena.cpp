@@ -0,0 +1,91 @@
+#include "bench.hpp"
+
+#include <fuse/core/allocators.hpp>
+#include <fuse/math.hpp>
+
+#include <set>
+#include <vector>
+
+using namespace fuse;
+
+#define BENCH_FRAME_ARENA_FRAMES  1000
+#define BENCH_FRAME_ARENA_OBJECTS 4096
+#define BENCH_FRAME_ARENA_TEXTS   256
+#define BENCH_FRAME_ARENA_REPEAT  5
+
+/* Frames */
+
+// The containers a frame of the renderer builds: the culling results grown one
+// object at a time, a copy of them, the vertices of the texts (a vertex per
+// character here, short labels mostly) and a small set
+
+template <template <typename> class Allocator>
+static size_t bench_frame(void)
+{
+	std::vector<const void*, Allocator<const void*>> culled;
+
+	for (size_t i = 0; i < BENCH_FRAME_ARENA_OBJECTS; i++)
+	{
+		culled.push_back(reinterpret_cast<const void*>(i));
+	}
+
+	std::vector<const void*, Allocator<const void*>> visible(culled.begin(), culled.end());
+
+	size_t checksum = visible.size();
+
+	for (int t = 0; t < BENCH_FRAME_ARENA_TEXTS; t++)
+	{
+		std::vector<float4, Allocator<float4>> vertices;
+
+		size_t n = 8 + t % 32;
+
+		vertices.reserve(n);
+
+		for (size_t c = 0; c < n; c++)
+		{
+			vertices.emplace_back(float(c), 0.f, 1.f, 1.f);
+		}
+
+		checksum += vertices.size();
+	}
+
+	std::set<int, std::less<int>, Allocator<int>> updates;
+
+	for (int v = 0; v < 8; v++)
+	{
+		updates.insert(v * 7 % 5);
+	}
+
+	return checksum + updates.size();
+}
+
+void bench_frame_arena(bench_reporter & reporter)
+{
+	frame_arena & arena = frame_arena::get_thread_arena();
+
+	size_t checksum = 0;
+
+	double heapTime = bench_run(BENCH_FRAME_ARENA_REPEAT, [](){}, [&]()
+	{
+		for (int f = 0; f < BENCH_FRAME_ARENA_FRAMES; f++)
+		{
+			checksum += bench_frame<std::allocator>();
+		}
+	});
+
+	double arenaTime = bench_run(BENCH_FRAME_ARENA_REPEAT, [](){}, [&]()
+	{
+		for (int f = 0; f < BENCH_FRAME_ARENA_FRAMES; f++)
+		{
+			checksum += bench_frame<frame_allocator>();
+			arena.reset();
+		}
+	});
+
+	bench_do_not_optimize(&checksum);
+
+	reporter.add("frame_arena/frame", "heap", heapTime, BENCH_FRAME_ARENA_FRAMES);
+	reporter.add("frame_arena/frame", "arena", arenaTime, BENCH_FRAME_ARENA_FRAMES);
+
+	reporter.log() << "frame_arena/frame           " << arena.get_capacity() << " bytes reserved" << std::endl;
+}
\ No newline at end of file
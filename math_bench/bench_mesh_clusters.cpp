@@ -0,0 +1,83 @@
+#include "bench.hpp"
+
+#include <fuse/mesh_clusters.hpp>
+#include <fuse/mesh_optimizer.hpp>
+#include <fuse/geometry/view_projection.hpp>
+
+#include <cmath>
+#include <iomanip>
+#include <string>
+
+using namespace fuse;
+
+#define BENCH_CLUSTERS_GRID_SIZE 512
+#define BENCH_CLUSTERS_REPEAT    5
+
+/* Benchmark */
+
+void bench_mesh_clusters(bench_reporter & reporter)
+{
+	std::vector<float3>   vertices;
+	std::vector<uint32_t> source;
+
+	bench_generate_sphere(vertices, source, BENCH_CLUSTERS_GRID_SIZE, true);
+
+	optimize_vertex_cache(source.data(), source.size(), vertices.size());
+
+	size_t numTriangles = source.size() / 3;
+
+	std::vector<uint32_t>     indices;
+	std::vector<mesh_cluster> clusters;
+
+	double milliseconds = bench_run(BENCH_CLUSTERS_REPEAT,
+		[&]() { indices = source; },
+		[&]() { build_clusters(indices.data(), indices.size(), vertices.data(), vertices.size(), clusters); });
+
+	reporter.add("mesh_clusters/build", "greedy", milliseconds, numTriangles);
+
+	vertex_cache_statistics before = analyze_vertex_cache(source.data(), source.size(), vertices.size());
+	vertex_cache_statistics after  = analyze_vertex_cache(indices.data(), indices.size(), vertices.size());
+
+	reporter.log() << "Mesh: " << vertices.size() << " vertices, " << numTriangles << " triangles, "
+	               << clusters.size() << " clusters, ACMR " << before.acmr << " -> " << after.acmr << std::endl;
+
+	// The sphere fills the view from the side, about half of it faces the camera
+
+	struct
+	{
+		const char * name;
+		float3       eye;
+		float3       target;
+	} views[] = {
+		{ "inside",  float3(0, 0, -4), float3(0, 0, 0) },
+		{ "partial", float3(0, 0, -2), float3(1, 0, 0) }
+	};
+
+	cluster_culler                culler;
+	std::vector<mesh_index_range> ranges;
+
+	for (auto & view : views)
+	{
+		frustum f(look_at_lh(view.eye, view.target, float3(0, 1, 0)) * bench_perspective_lh(1.f, 16.f / 9.f, .1f, 100.f));
+
+		frustum_planes_soa planes(f);
+
+		std::string name = std::string("mesh_clusters/cull:") + view.name;
+
+		milliseconds = bench_run(BENCH_CLUSTERS_REPEAT,
+			[&]() { ranges.clear(); },
+			[&]() { culler.cull(clusters.data(), clusters.size(), mat128_identity(), planes, view.eye, ranges); });
+
+		reporter.add(name.c_str(), "soa", milliseconds, clusters.size());
+
+		size_t visible = 0;
+
+		for (const mesh_index_range & range : ranges)
+		{
+			visible += range.numIndices / 3;
+		}
+
+		reporter.log() << std::left << std::setw(28) << name
+		               << std::right << visible << " / " << numTriangles << " triangles in " << ranges.size() << " draws" << std::endl;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "bench.hpp"
+
+#include <fuse/mesh_optimizer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+using namespace fuse;
+
+#define BENCH_MESH_GRID_SIZE 256
+#define BENCH_MESH_REPEAT    5
+
+/* Mesh generation */
+
+static void bench_shuffle_triangles(std::vector<uint32_t> & indices, unsigned int seed)
+{
+	std::mt19937 generator(seed);
+
+	std::vector<uint32_t> order(indices.size() / 3);
+
+	for (size_t t = 0; t < order.size(); t++)
+	{
+		order[t] = static_cast<uint32_t>(t);
+	}
+
+	std::shuffle(order.begin(), order.end(), generator);
+
+	std::vector<uint32_t> source = indices;
+
+	for (size_t t = 0; t < order.size(); t++)
+	{
+		std::copy(source.begin() + 3 * order[t], source.begin() + 3 * order[t] + 3, indices.begin() + 3 * t);
+	}
+}
+
+static void bench_log_statistics(bench_reporter & reporter, const char * input, const char * stage, const std::vector<uint32_t> & indices, size_t numVertices)
+{
+	vertex_cache_statistics statistics = analyze_vertex_cache(indices.data(), indices.size(), numVertices);
+
+	reporter.log() << std::left << std::setw(12) << input
+	               << std::setw(20) << stage
+	               << std::right << std::fixed << std::setprecision(3)
+	               << "ACMR " << statistics.acmr << "  ATVR " << statistics.atvr << std::endl;
+}
+
+/* Benchmark */
+
+void bench_mesh_optimizer(bench_reporter & reporter)
+{
+	std::vector<float3>   vertices;
+	std::vector<uint32_t> scanline;
+
+	bench_generate_sphere(vertices, scanline, BENCH_MESH_GRID_SIZE);
+
+	std::vector<uint32_t> shuffled = scanline;
+	bench_shuffle_triangles(shuffled, 0);
+
+	size_t numTriangles = scanline.size() / 3;
+
+	reporter.log() << "Mesh: " << vertices.size() << " vertices, " << numTriangles << " triangles, FIFO cache of " << FUSE_VERTEX_CACHE_SIZE << " vertices" << std::endl;
+
+	struct
+	{
+		const char                  * name;
+		const std::vector<uint32_t> & indices;
+	} inputs[] = {
+		{ "scanline", scanline },
+		{ "shuffled", shuffled }
+	};
+
+	for (auto & input : inputs)
+	{
+		std::vector<uint32_t> indices;
+		std::vector<uint32_t> remap(vertices.size());
+
+		bench_log_statistics(reporter, input.name, "input", input.indices, vertices.size());
+
+		std::string name = std::string("mesh_vertex_cache/") + input.name;
+
+		double milliseconds = bench_run(BENCH_MESH_REPEAT,
+			[&]() { indices = input.indices; },
+			[&]() { optimize_vertex_cache(indices.data(), indices.size(), vertices.size()); });
+
+		reporter.add(name.c_str(), "forsyth", milliseconds, numTriangles);
+
+		bench_log_statistics(reporter, input.name, "vertex cache", indices, vertices.size());
+
+		std::vector<uint32_t> optimized = indices;
+
+		name = std::string("mesh_overdraw/") + input.name;
+
+		milliseconds = bench_run(BENCH_MESH_REPEAT,
+			[&]() { indices = optimized; },
+			[&]() { optimize_overdraw(indices.data(), indices.size(), vertices.data(), vertices.size()); });
+
+		reporter.add(name.c_str(), "clusters", milliseconds, numTriangles);
+
+		bench_log_statistics(reporter, input.name, "overdraw", indices, vertices.size());
+
+		optimized = indices;
+
+		name = std::string("mesh_vertex_fetch/") + input.name;
+
+		milliseconds = bench_run(BENCH_MESH_REPEAT,
+			[&]() { indices = optimized; },
+			[&]() { optimize_vertex_fetch_remap(remap.data(), indices.data(), indices.size(), vertices.size()); });
+
+		reporter.add(name.c_str(), "remap", milliseconds, indices.size());
+
+		bench_log_statistics(reporter, input.name, "vertex fetch", indices, vertices.size());
+	}
+}
\ No newline at end of file
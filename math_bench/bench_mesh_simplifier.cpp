@@ -0,0 +1,55 @@
+#include "bench.hpp"
+
+#include <fuse/mesh_simplifier.hpp>
+
+#include <cmath>
+#include <iomanip>
+#include <string>
+
+using namespace fuse;
+
+#define BENCH_SIMPLIFY_GRID_SIZE 256
+#define BENCH_SIMPLIFY_REPEAT    5
+
+/* Benchmark */
+
+void bench_mesh_simplifier(bench_reporter & reporter)
+{
+	std::vector<float3>   vertices;
+	std::vector<uint32_t> indices;
+
+	// A wavy sphere, so that the curvature is not the same everywhere
+
+	bench_generate_sphere(vertices, indices, BENCH_SIMPLIFY_GRID_SIZE, false, .05f);
+
+	size_t numTriangles = indices.size() / 3;
+
+	reporter.log() << "Mesh: " << vertices.size() << " vertices, " << numTriangles << " triangles" << std::endl;
+
+	std::vector<uint32_t> destination(indices.size());
+
+	const int ratios[] = { 50, 25, 10 };
+
+	for (int ratio : ratios)
+	{
+		size_t target = indices.size() * ratio / 300 * 3;
+		size_t result = 0;
+		float  error  = 0.f;
+
+		std::string name = "mesh_simplify/ratio:" + std::to_string(ratio);
+
+		double milliseconds = bench_run(BENCH_SIMPLIFY_REPEAT,
+			[]() {},
+			[&]()
+			{
+				result = simplify(destination.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), target, 1.f, &error);
+				bench_do_not_optimize(destination.data());
+			});
+
+		reporter.add(name.c_str(), "quadrics", milliseconds, numTriangles);
+
+		reporter.log() << std::left << std::setw(28) << name
+		               << std::right << std::fixed << std::setprecision(5)
+		               << result / 3 << " triangles, error " << error << std::endl;
+	}
+}
\ No newline at end of file
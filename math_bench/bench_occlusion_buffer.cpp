@@ -0,0 +1,123 @@
+#include "bench.hpp"
+
+#include <fuse/occlusion_buffer.hpp>
+#include <fuse/core/thread_pool.hpp>
+#include <fuse/geometry/affine_transforms.hpp>
+
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace fuse;
+
+#define BENCH_OCCLUSION_WIDTH       256
+#define BENCH_OCCLUSION_HEIGHT      144
+#define BENCH_OCCLUSION_SPHERE_SIZE 64
+#define BENCH_OCCLUSION_BOXES       100000
+#define BENCH_OCCLUSION_REPEAT      20
+
+/* Benchmark */
+
+void bench_occlusion_buffer(bench_reporter & reporter)
+{
+	std::vector<float3>   vertices;
+	std::vector<uint32_t> indices;
+
+	bench_generate_sphere(vertices, indices, BENCH_OCCLUSION_SPHERE_SIZE, true);
+
+	// A wall of 4x4 spheres in front of the camera (at the origin, looking down z)
+
+	std::vector<mat128, aligned_allocator<mat128, 16>> occluders;
+
+	for (int y = 0; y < 4; y++)
+	{
+		for (int x = 0; x < 4; x++)
+		{
+			occluders.push_back(
+				to_scale4(vec128_set(2.5f, 2.5f, 2.5f, 1.f)) *
+				to_translation4(vec128_set(6.f * x - 9.f, 3.f * y - 4.5f, 20.f, 1.f)));
+		}
+	}
+
+	size_t numTriangles = occluders.size() * indices.size() / 3;
+
+	mat128 viewProjection = mat128_load(bench_perspective_lh(1.f, 16.f / 9.f, .1f, 100.f));
+
+	occlusion_buffer buffer;
+
+	buffer.init(BENCH_OCCLUSION_WIDTH, BENCH_OCCLUSION_HEIGHT);
+
+	auto draw = [&](thread_pool * pool)
+	{
+		buffer.clear(viewProjection);
+
+		for (const mat128 & world : occluders)
+		{
+			buffer.add_occluder(vertices.data(), vertices.size(), indices.data(), indices.size(), world);
+		}
+
+		buffer.render(pool);
+	};
+
+	std::vector<unsigned int> threadCounts = { 1, 2, 4, 8 };
+
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+
+	if (hardwareThreads > 8)
+	{
+		threadCounts.push_back(hardwareThreads);
+	}
+
+	for (unsigned int threads : threadCounts)
+	{
+		// The calling thread processes chunks too
+
+		std::unique_ptr<thread_pool> pool(threads > 1 ? new thread_pool(threads - 1) : nullptr);
+
+		std::string name = "occlusion/render:threads:" + std::to_string(threads);
+
+		double milliseconds = bench_run(BENCH_OCCLUSION_REPEAT,
+			[]() {},
+			[&]() { draw(pool.get()); });
+
+		reporter.add(name.c_str(), "fuse", milliseconds, numTriangles);
+	}
+
+	reporter.log() << "Occluders: " << numTriangles << " triangles, " << buffer.get_num_triangles() << " rasterized on "
+	               << buffer.get_width() << "x" << buffer.get_height() << std::endl;
+
+	// Boxes scattered behind and around the occluders
+
+	std::mt19937 generator(1);
+
+	std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+	std::vector<aabb, aligned_allocator<aabb, 16>> boxes;
+
+	for (int i = 0; i < BENCH_OCCLUSION_BOXES; i++)
+	{
+		float3 center(24.f * uniform(generator) - 12.f, 12.f * uniform(generator) - 6.f, 25.f + 35.f * uniform(generator));
+		float  halfExtent = .25f + .75f * uniform(generator);
+
+		boxes.push_back(aabb::from_center_half_extents(center, float3(halfExtent, halfExtent, halfExtent)));
+	}
+
+	size_t visible = 0;
+
+	double milliseconds = bench_run(BENCH_OCCLUSION_REPEAT,
+		[&]() { visible = 0; },
+		[&]()
+		{
+			for (const aabb & box : boxes)
+			{
+				visible += buffer.test(box);
+			}
+		});
+
+	reporter.add("occlusion/test", "pyramid", milliseconds, boxes.size());
+
+	reporter.log() << std::left << std::setw(28) << "occlusion/test"
+	               << std::right << visible << " / " << boxes.size() << " boxes visible" << std::endl;
+}
\ No newline at end of file
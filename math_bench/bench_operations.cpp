@@ -0,0 +1,508 @@
+#include "bench.hpp"
+
+#include <fuse/math.hpp>
+#include <fuse/geometry.hpp>
+
+#ifdef FUSE_BENCH_EIGEN
+#include <Eigen/Dense>
+#endif
+
+#ifdef FUSE_BENCH_DIRECTXMATH
+#include <DirectXMath.h>
+#endif
+
+#include <random>
+
+using namespace fuse;
+
+#define BENCH_OPERATIONS_BATCH       1024
+#define BENCH_OPERATIONS_MIN_TIME    5.
+#define BENCH_OPERATIONS_REPETITIONS 5
+
+template <typename T>
+using bench_array = std::vector<T, aligned_allocator<T, 32>>;
+
+/* Runner */
+
+// Calls function(i) on each item of a batch small enough to stay in cache,
+// doubling the number of batches until a run takes at least the minimum time
+// (like Google Benchmark does), then reports the best of the repetitions
+
+template <typename T, typename Function>
+void bench_operation(bench_reporter & reporter, const char * name, const char * variant, T * output, Function function)
+{
+	if (!reporter.enabled(name))
+	{
+		return;
+	}
+
+	auto run = [&](size_t batches)
+	{
+		for (size_t batch = 0; batch < batches; batch++)
+		{
+			for (size_t i = 0; i < BENCH_OPERATIONS_BATCH; i++)
+			{
+				function(i);
+			}
+
+			bench_do_not_optimize(output);
+		}
+	};
+
+	size_t batches = 1;
+
+	while (bench_run(1, [](){}, [&]() { run(batches); }) < BENCH_OPERATIONS_MIN_TIME)
+	{
+		batches *= 2;
+	}
+
+	double milliseconds = bench_run(BENCH_OPERATIONS_REPETITIONS, [](){}, [&]() { run(batches); });
+
+	reporter.add(name, variant, milliseconds, batches * BENCH_OPERATIONS_BATCH);
+}
+
+/* Inputs */
+
+// Components in [.5, 2] so that divisions, square roots and normalizations are well defined
+
+struct bench_operations_inputs
+{
+	bench_operations_inputs(void)
+	{
+		std::mt19937 generator(42);
+
+		std::uniform_real_distribution<float> value(.5f, 2.f);
+		std::uniform_real_distribution<float> angle(-FUSE_PI, FUSE_PI);
+
+		a.resize(BENCH_OPERATIONS_BATCH);
+		b.resize(BENCH_OPERATIONS_BATCH);
+		m.resize(BENCH_OPERATIONS_BATCH);
+		n.resize(BENCH_OPERATIONS_BATCH);
+		q.resize(BENCH_OPERATIONS_BATCH);
+		p.resize(BENCH_OPERATIONS_BATCH);
+
+		for (size_t i = 0; i < BENCH_OPERATIONS_BATCH; i++)
+		{
+			a[i] = float4(value(generator), value(generator), value(generator), value(generator));
+			b[i] = float4(value(generator), value(generator), value(generator), value(generator));
+
+			// Diagonally dominant, so invertible
+
+			for (int r = 0; r < 4; r++)
+			{
+				for (int c = 0; c < 4; c++)
+				{
+					m[i](r, c) = value(generator) + (r == c ? 8.f : 0.f);
+					n[i](r, c) = value(generator) + (r == c ? 8.f : 0.f);
+				}
+			}
+
+			float3 axis = normalize(float3(value(generator), value(generator), value(generator)));
+
+			q[i] = quaternion(axis, angle(generator));
+			p[i] = quaternion(normalize(float3(value(generator), value(generator), value(generator))), angle(generator));
+		}
+	}
+
+	std::vector<float4>     a, b;
+	std::vector<float4x4>   m, n;
+	std::vector<quaternion> q, p;
+};
+
+/* vec128 */
+
+static void bench_vec128_operations(bench_reporter & reporter, const bench_operations_inputs & inputs)
+{
+	bench_array<vec128> a(BENCH_OPERATIONS_BATCH), b(BENCH_OPERATIONS_BATCH), r(BENCH_OPERATIONS_BATCH);
+
+	bench_array<float3> f3(BENCH_OPERATIONS_BATCH);
+	bench_array<float>  f(BENCH_OPERATIONS_BATCH);
+	bench_array<int>    k(BENCH_OPERATIONS_BATCH);
+
+	for (size_t i = 0; i < BENCH_OPERATIONS_BATCH; i++)
+	{
+		a[i]  = vec128_load(inputs.a[i]);
+		b[i]  = vec128_load(inputs.b[i]);
+		f3[i] = float3(inputs.a[i].x, inputs.a[i].y, inputs.a[i].z);
+	}
+
+	bench_operation(reporter, "vec128_load<float3>", "fuse", r.data(), [&](size_t i) { r[i] = vec128_load(f3[i]); });
+	bench_operation(reporter, "vec128_store<float3>", "fuse", f3.data(), [&](size_t i) { vec128_store(&f3[i], a[i]); });
+	bench_operation(reporter, "vec128_get_x", "fuse", f.data(), [&](size_t i) { f[i] = vec128_get_x(a[i]); });
+	bench_operation(reporter, "vec128_set_x", "fuse", r.data(), [&](size_t i) { r[i] = a[i]; vec128_set_x(r[i], f[i]); });
+
+	bench_operation(reporter, "vec128_add", "fuse", r.data(), [&](size_t i) { r[i] = vec128_add(a[i], b[i]); });
+	bench_operation(reporter, "vec128_sub", "fuse", r.data(), [&](size_t i) { r[i] = vec128_sub(a[i], b[i]); });
+	bench_operation(reporter, "vec128_mul", "fuse", r.data(), [&](size_t i) { r[i] = vec128_mul(a[i], b[i]); });
+	bench_operation(reporter, "vec128_div", "fuse", r.data(), [&](size_t i) { r[i] = vec128_div(a[i], b[i]); });
+	bench_operation(reporter, "vec128_negate", "fuse", r.data(), [&](size_t i) { r[i] = vec128_negate(a[i]); });
+
+	bench_operation(reporter, "vec128_and", "fuse", r.data(), [&](size_t i) { r[i] = vec128_and(a[i], b[i]); });
+	bench_operation(reporter, "vec128_or", "fuse", r.data(), [&](size_t i) { r[i] = vec128_or(a[i], b[i]); });
+	bench_operation(reporter, "vec128_xor", "fuse", r.data(), [&](size_t i) { r[i] = vec128_xor(a[i], b[i]); });
+
+	bench_operation(reporter, "vec128_shuffle", "fuse", r.data(), [&](size_t i) { r[i] = vec128_shuffle<FUSE_X0, FUSE_Z0, FUSE_Y1, FUSE_W1>(a[i], b[i]); });
+	bench_operation(reporter, "vec128_swizzle", "fuse", r.data(), [&](size_t i) { r[i] = vec128_swizzle<FUSE_W, FUSE_Z, FUSE_Y, FUSE_X>(a[i]); });
+	bench_operation(reporter, "vec128_splat", "fuse", r.data(), [&](size_t i) { r[i] = vec128_splat<FUSE_Y>(a[i]); });
+	bench_operation(reporter, "vec128_select", "fuse", r.data(), [&](size_t i) { r[i] = vec128_select<FUSE_X0, FUSE_Y1, FUSE_Z0, FUSE_W1>(a[i], b[i]); });
+	bench_operation(reporter, "vec128_permute", "fuse", r.data(), [&](size_t i) { r[i] = vec128_permute<FUSE_W0, FUSE_X1, FUSE_Y0, FUSE_Z1>(a[i], b[i]); });
+
+	bench_operation(reporter, "vec128_min", "fuse", r.data(), [&](size_t i) { r[i] = vec128_min(a[i], b[i]); });
+	bench_operation(reporter, "vec128_max", "fuse", r.data(), [&](size_t i) { r[i] = vec128_max(a[i], b[i]); });
+	bench_operation(reporter, "vec128_eq", "fuse", r.data(), [&](size_t i) { r[i] = vec128_eq(a[i], b[i]); });
+	bench_operation(reporter, "vec128_gt", "fuse", r.data(), [&](size_t i) { r[i] = vec128_gt(a[i], b[i]); });
+	bench_operation(reporter, "vec128_lt", "fuse", r.data(), [&](size_t i) { r[i] = vec128_lt(a[i], b[i]); });
+	bench_operation(reporter, "vec128_ge", "fuse", r.data(), [&](size_t i) { r[i] = vec128_ge(a[i], b[i]); });
+	bench_operation(reporter, "vec128_le", "fuse", r.data(), [&](size_t i) { r[i] = vec128_le(a[i], b[i]); });
+	bench_operation(reporter, "vec128_signmask", "fuse", k.data(), [&](size_t i) { k[i] = vec128_signmask(vec128_sub(a[i], b[i])); });
+	bench_operation(reporter, "vec128_all_true", "fuse", k.data(), [&](size_t i) { k[i] = vec128_all_true(vec128_gt(a[i], b[i])); });
+	bench_operation(reporter, "vec128_any_true", "fuse", k.data(), [&](size_t i) { k[i] = vec128_any_true(vec128_gt(a[i], b[i])); });
+
+	bench_operation(reporter, "vec128_floor", "fuse", r.data(), [&](size_t i) { r[i] = vec128_floor(a[i]); });
+	bench_operation(reporter, "vec128_ceil", "fuse", r.data(), [&](size_t i) { r[i] = vec128_ceil(a[i]); });
+	bench_operation(reporter, "vec128_sqrt", "fuse", r.data(), [&](size_t i) { r[i] = vec128_sqrt(a[i]); });
+	bench_operation(reporter, "vec128_invsqrt", "fuse", r.data(), [&](size_t i) { r[i] = vec128_invsqrt(a[i]); });
+	bench_operation(reporter, "vec128_reciprocal", "fuse", r.data(), [&](size_t i) { r[i] = vec128_reciprocal(a[i]); });
+	bench_operation(reporter, "vec128_saturate", "fuse", r.data(), [&](size_t i) { r[i] = vec128_saturate(a[i]); });
+
+	bench_operation(reporter, "vec128_dot2", "fuse", r.data(), [&](size_t i) { r[i] = vec128_dot2(a[i], b[i]); });
+	bench_operation(reporter, "vec128_dot3", "fuse", r.data(), [&](size_t i) { r[i] = vec128_dot3(a[i], b[i]); });
+	bench_operation(reporter, "vec128_dot4", "fuse", r.data(), [&](size_t i) { r[i] = vec128_dot4(a[i], b[i]); });
+	bench_operation(reporter, "vec128_cross", "fuse", r.data(), [&](size_t i) { r[i] = vec128_cross(a[i], b[i]); });
+	bench_operation(reporter, "vec128_length3", "fuse", r.data(), [&](size_t i) { r[i] = vec128_length3(a[i]); });
+	bench_operation(reporter, "vec128_length4", "fuse", r.data(), [&](size_t i) { r[i] = vec128_length4(a[i]); });
+	bench_operation(reporter, "vec128_normalize3", "fuse", r.data(), [&](size_t i) { r[i] = vec128_normalize3(a[i]); });
+	bench_operation(reporter, "vec128_normalize4", "fuse", r.data(), [&](size_t i) { r[i] = vec128_normalize4(a[i]); });
+}
+
+/* mat128 */
+
+static void bench_mat128_operations(bench_reporter & reporter, const bench_operations_inputs & inputs)
+{
+	bench_array<mat128> a(BENCH_OPERATIONS_BATCH), b(BENCH_OPERATIONS_BATCH), r(BENCH_OPERATIONS_BATCH), rotation(BENCH_OPERATIONS_BATCH);
+	bench_array<vec128> v(BENCH_OPERATIONS_BATCH), rv(BENCH_OPERATIONS_BATCH);
+
+	bench_array<float4x4> f(BENCH_OPERATIONS_BATCH);
+
+	for (size_t i = 0; i < BENCH_OPERATIONS_BATCH; i++)
+	{
+		f[i] = inputs.m[i];
+
+		a[i]        = mat128_load(inputs.m[i]);
+		b[i]        = mat128_load(inputs.n[i]);
+		rotation[i] = to_rotation4(to_quat128(inputs.q[i]));
+		v[i]        = vec128_load(inputs.a[i]);
+	}
+
+	bench_operation(reporter, "mat128_load<float4x4>", "fuse", r.data(), [&](size_t i) { r[i] = mat128_load(f[i]); });
+	bench_operation(reporter, "mat128_transpose", "fuse", r.data(), [&](size_t i) { r[i] = mat128_transpose(a[i]); });
+	bench_operation(reporter, "mat128_transform4<mat128>", "fuse", r.data(), [&](size_t i) { r[i] = mat128_transform4(a[i], b[i]); });
+	bench_operation(reporter, "mat128_inverse4", "fuse", r.data(), [&](size_t i) { r[i] = mat128_inverse4(a[i]); });
+	bench_operation(reporter, "mat128_determinant3", "fuse", rv.data(), [&](size_t i) { rv[i] = mat128_determinant3(a[i]); });
+	bench_operation(reporter, "mat128_determinant4", "fuse", rv.data(), [&](size_t i) { rv[i] = mat128_determinant4(a[i]); });
+
+	bench_operation(reporter, "mat128_transform4<vec128>", "fuse", rv.data(), [&](size_t i) { rv[i] = mat128_transform4(v[i], a[i]); });
+	bench_operation(reporter, "mat128_transform3", "fuse", rv.data(), [&](size_t i) { rv[i] = mat128_transform3(v[i], a[i]); });
+	bench_operation(reporter, "mat128_transform_normal", "fuse", rv.data(), [&](size_t i) { rv[i] = mat128_transform_normal(v[i], a[i]); });
+
+	bench_operation(reporter, "to_quat128<mat128>", "fuse", rv.data(), [&](size_t i) { rv[i] = to_quat128(rotation[i]); });
+}
+
+/* quat128 */
+
+static void bench_quat128_operations(bench_reporter & reporter, const bench_operations_inputs & inputs)
+{
+	bench_array<vec128> q(BENCH_OPERATIONS_BATCH), p(BENCH_OPERATIONS_BATCH), v(BENCH_OPERATIONS_BATCH), r(BENCH_OPERATIONS_BATCH);
+	bench_array<mat128> m(BENCH_OPERATIONS_BATCH);
+
+	bench_array<quaternion> fq(BENCH_OPERATIONS_BATCH);
+
+	for (size_t i = 0; i < BENCH_OPERATIONS_BATCH; i++)
+	{
+		fq[i] = inputs.q[i];
+
+		q[i] = to_quat128(inputs.q[i]);
+		p[i] = to_quat128(inputs.p[i]);
+		v[i] = vec128_load(inputs.a[i]);
+	}
+
+	bench_operation(reporter, "to_quat128<quaternion>", "fuse", r.data(), [&](size_t i) { r[i] = to_quat128(fq[i]); });
+	bench_operation(reporter, "to_quaternion<vec128>", "fuse", fq.data(), [&](size_t i) { fq[i] = to_quaternion(q[i]); });
+
+	bench_operation(reporter, "quat128_mul", "fuse", r.data(), [&](size_t i) { r[i] = quat128_mul(q[i], p[i]); });
+	bench_operation(reporter, "quat128_inverse", "fuse", r.data(), [&](size_t i) { r[i] = quat128_inverse(q[i]); });
+	bench_operation(reporter, "quat128_conjugate", "fuse", r.data(), [&](size_t i) { r[i] = quat128_conjugate(q[i]); });
+	bench_operation(reporter, "quat128_transform", "fuse", r.data(), [&](size_t i) { r[i] = quat128_transform(v[i], q[i]); });
+	bench_operation(reporter, "quat128_norm", "fuse", r.data(), [&](size_t i) { r[i] = quat128_norm(q[i]); });
+	bench_operation(reporter, "quat128_normalize", "fuse", r.data(), [&](size_t i) { r[i] = quat128_normalize(q[i]); });
+
+	bench_operation(reporter, "to_rotation4<quat128>", "fuse", m.data(), [&](size_t i) { m[i] = to_rotation4(q[i]); });
+}
+
+/* matrix<T, N, M> */
+
+static void bench_matrix_operations(bench_reporter & reporter, const bench_operations_inputs & inputs)
+{
+	std::vector<float4>     a(inputs.a), b(inputs.b), r(BENCH_OPERATIONS_BATCH);
+	std::vector<float3>     a3(BENCH_OPERATIONS_BATCH), b3(BENCH_OPERATIONS_BATCH), r3(BENCH_OPERATIONS_BATCH);
+	std::vector<float4x4>   m(inputs.m), n(inputs.n), rm(BENCH_OPERATIONS_BATCH);
+	std::vector<float3x3>   m3(BENCH_OPERATIONS_BATCH), n3(BENCH_OPERATIONS_BATCH), rm3(BENCH_OPERATIONS_BATCH);
+	std::vector<quaternion> q(inputs.q), p(inputs.p), rq(BENCH_OPERATIONS_BATCH);
+	std::vector<float>      f(BENCH_OPERATIONS_BATCH);
+
+	for (size_t i = 0; i < BENCH_OPERATIONS_BATCH; i++)
+	{
+		a3[i] = float3(a[i].x, a[i].y, a[i].z);
+		b3[i] = float3(b[i].x, b[i].y, b[i].z);
+
+		m3[i] = float3x3(m[i](0, 0), m[i](0, 1), m[i](0, 2), m[i](1, 0), m[i](1, 1), m[i](1, 2), m[i](2, 0), m[i](2, 1), m[i](2, 2));
+		n3[i] = float3x3(n[i](0, 0), n[i](0, 1), n[i](0, 2), n[i](1, 0), n[i](1, 1), n[i](1, 2), n[i](2, 0), n[i](2, 1), n[i](2, 2));
+	}
+
+	bench_operation(reporter, "operator+<float4>", "fuse", r.data(), [&](size_t i) { r[i] = a[i] + b[i]; });
+	bench_operation(reporter, "operator-<float4>", "fuse", r.data(), [&](size_t i) { r[i] = a[i] - b[i]; });
+	bench_operation(reporter, "operator*<float, float4>", "fuse", r.data(), [&](size_t i) { r[i] = 2.f * a[i]; });
+	bench_operation(reporter, "dot<float4>", "fuse", f.data(), [&](size_t i) { f[i] = dot(a[i], b[i]); });
+	bench_operation(reporter, "length<float4>", "fuse", f.data(), [&](size_t i) { f[i] = length(a[i]); });
+	bench_operation(reporter, "normalize<float4>", "fuse", r.data(), [&](size_t i) { r[i] = normalize(a[i]); });
+	bench_operation(reporter, "cross<float3>", "fuse", r3.data(), [&](size_t i) { r3[i] = cross(a3[i], b3[i]); });
+
+	bench_operation(reporter, "operator+<float4x4>", "fuse", rm.data(), [&](size_t i) { rm[i] = m[i] + n[i]; });
+	bench_operation(reporter, "operator-<float4x4>", "fuse", rm.data(), [&](size_t i) { rm[i] = m[i] - n[i]; });
+	bench_operation(reporter, "operator*<float4x4>", "fuse", rm.data(), [&](size_t i) { rm[i] = m[i] * n[i]; });
+	bench_operation(reporter, "operator*<float4, float4x4>", "fuse", r.data(), [&](size_t i) { r[i] = a[i] * m[i]; });
+	bench_operation(reporter, "transpose<float4x4>", "fuse", rm.data(), [&](size_t i) { rm[i] = transpose(m[i]); });
+	bench_operation(reporter, "inverse<float4x4>", "fuse", rm.data(), [&](size_t i) { rm[i] = inverse(m[i]); });
+	bench_operation(reporter, "determinant<float4x4>", "fuse", f.data(), [&](size_t i) { f[i] = determinant(m[i]); });
+
+	bench_operation(reporter, "operator*<float3x3>", "fuse", rm3.data(), [&](size_t i) { rm3[i] = m3[i] * n3[i]; });
+	bench_operation(reporter, "inverse<float3x3>", "fuse", rm3.data(), [&](size_t i) { rm3[i] = inverse(m3[i]); });
+	bench_operation(reporter, "determinant<float3x3>", "fuse", f.data(), [&](size_t i) { f[i] = determinant(m3[i]); });
+
+	bench_operation(reporter, "operator*<quaternion>", "fuse", rq.data(), [&](size_t i) { rq[i] = q[i] * p[i]; });
+	bench_operation(reporter, "inverse<quaternion>", "fuse", rq.data(), [&](size_t i) { rq[i] = inverse(q[i]); });
+	bench_operation(reporter, "normalize<quaternion>", "fuse", rq.data(), [&](size_t i) { rq[i] = normalize(q[i]); });
+}
+
+/* Eigen, under the names of the equivalent vec128, mat128 and quat128 operations */
+
+#ifdef FUSE_BENCH_EIGEN
+
+static void bench_eigen_operations(bench_reporter & reporter, const bench_operations_inputs & inputs)
+{
+	using vector3    = Eigen::Vector3f;
+	using vector4    = Eigen::Vector4f;
+	using matrix4    = Eigen::Matrix4f;
+	using quaternion = Eigen::Quaternionf;
+
+	bench_array<vector4>    a(BENCH_OPERATIONS_BATCH), b(BENCH_OPERATIONS_BATCH), r(BENCH_OPERATIONS_BATCH);
+	bench_array<vector3>    a3(BENCH_OPERATIONS_BATCH), r3(BENCH_OPERATIONS_BATCH);
+	bench_array<matrix4>    m(BENCH_OPERATIONS_BATCH), n(BENCH_OPERATIONS_BATCH), rm(BENCH_OPERATIONS_BATCH), rotation(BENCH_OPERATIONS_BATCH);
+	bench_array<quaternion> q(BENCH_OPERATIONS_BATCH), p(BENCH_OPERATIONS_BATCH), rq(BENCH_OPERATIONS_BATCH);
+	bench_array<float>      f(BENCH_OPERATIONS_BATCH);
+
+	for (size_t i = 0; i < BENCH_OPERATIONS_BATCH; i++)
+	{
+		a[i]  = vector4(inputs.a[i].x, inputs.a[i].y, inputs.a[i].z, inputs.a[i].w);
+		b[i]  = vector4(inputs.b[i].x, inputs.b[i].y, inputs.b[i].z, inputs.b[i].w);
+		a3[i] = a[i].head<3>();
+
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				m[i](row, column) = inputs.m[i](row, column);
+				n[i](row, column) = inputs.n[i](row, column);
+			}
+		}
+
+		q[i] = quaternion(inputs.q[i].w, inputs.q[i].x, inputs.q[i].y, inputs.q[i].z);
+		p[i] = quaternion(inputs.p[i].w, inputs.p[i].x, inputs.p[i].y, inputs.p[i].z);
+
+		rotation[i].setIdentity();
+		rotation[i].topLeftCorner<3, 3>() = q[i].toRotationMatrix();
+	}
+
+	bench_operation(reporter, "vec128_add", "eigen", r.data(), [&](size_t i) { r[i] = a[i] + b[i]; });
+	bench_operation(reporter, "vec128_sub", "eigen", r.data(), [&](size_t i) { r[i] = a[i] - b[i]; });
+	bench_operation(reporter, "vec128_mul", "eigen", r.data(), [&](size_t i) { r[i] = a[i].cwiseProduct(b[i]); });
+	bench_operation(reporter, "vec128_div", "eigen", r.data(), [&](size_t i) { r[i] = a[i].cwiseQuotient(b[i]); });
+	bench_operation(reporter, "vec128_negate", "eigen", r.data(), [&](size_t i) { r[i] = -a[i]; });
+
+	bench_operation(reporter, "vec128_min", "eigen", r.data(), [&](size_t i) { r[i] = a[i].cwiseMin(b[i]); });
+	bench_operation(reporter, "vec128_max", "eigen", r.data(), [&](size_t i) { r[i] = a[i].cwiseMax(b[i]); });
+
+	bench_operation(reporter, "vec128_floor", "eigen", r.data(), [&](size_t i) { r[i] = a[i].array().floor(); });
+	bench_operation(reporter, "vec128_ceil", "eigen", r.data(), [&](size_t i) { r[i] = a[i].array().ceil(); });
+	bench_operation(reporter, "vec128_sqrt", "eigen", r.data(), [&](size_t i) { r[i] = a[i].cwiseSqrt(); });
+	bench_operation(reporter, "vec128_invsqrt", "eigen", r.data(), [&](size_t i) { r[i] = a[i].array().rsqrt(); });
+	bench_operation(reporter, "vec128_reciprocal", "eigen", r.data(), [&](size_t i) { r[i] = a[i].cwiseInverse(); });
+	bench_operation(reporter, "vec128_saturate", "eigen", r.data(), [&](size_t i) { r[i] = a[i].cwiseMax(0.f).cwiseMin(1.f); });
+
+	bench_operation(reporter, "vec128_dot2", "eigen", f.data(), [&](size_t i) { f[i] = a[i].head<2>().dot(b[i].head<2>()); });
+	bench_operation(reporter, "vec128_dot3", "eigen", f.data(), [&](size_t i) { f[i] = a[i].head<3>().dot(b[i].head<3>()); });
+	bench_operation(reporter, "vec128_dot4", "eigen", f.data(), [&](size_t i) { f[i] = a[i].dot(b[i]); });
+	bench_operation(reporter, "vec128_cross", "eigen", r.data(), [&](size_t i) { r[i] = a[i].cross3(b[i]); });
+	bench_operation(reporter, "vec128_length3", "eigen", f.data(), [&](size_t i) { f[i] = a[i].head<3>().norm(); });
+	bench_operation(reporter, "vec128_length4", "eigen", f.data(), [&](size_t i) { f[i] = a[i].norm(); });
+	bench_operation(reporter, "vec128_normalize3", "eigen", r3.data(), [&](size_t i) { r3[i] = a3[i].normalized(); });
+	bench_operation(reporter, "vec128_normalize4", "eigen", r.data(), [&](size_t i) { r[i] = a[i].normalized(); });
+
+	// Row vectors as in fuse
+
+	bench_operation(reporter, "mat128_transpose", "eigen", rm.data(), [&](size_t i) { rm[i] = m[i].transpose(); });
+	bench_operation(reporter, "mat128_transform4<mat128>", "eigen", rm.data(), [&](size_t i) { rm[i].noalias() = m[i] * n[i]; });
+	bench_operation(reporter, "mat128_inverse4", "eigen", rm.data(), [&](size_t i) { rm[i] = m[i].inverse(); });
+	bench_operation(reporter, "mat128_determinant3", "eigen", f.data(), [&](size_t i) { f[i] = m[i].topLeftCorner<3, 3>().determinant(); });
+	bench_operation(reporter, "mat128_determinant4", "eigen", f.data(), [&](size_t i) { f[i] = m[i].determinant(); });
+
+	bench_operation(reporter, "mat128_transform4<vec128>", "eigen", r.data(), [&](size_t i) { r[i].transpose().noalias() = a[i].transpose() * m[i]; });
+	bench_operation(reporter, "mat128_transform3", "eigen", r.data(), [&](size_t i) { r[i].transpose().noalias() = a3[i].homogeneous().transpose() * m[i]; });
+	bench_operation(reporter, "mat128_transform_normal", "eigen", r3.data(), [&](size_t i) { r3[i].transpose().noalias() = a3[i].transpose() * m[i].topLeftCorner<3, 3>(); });
+
+	bench_operation(reporter, "to_quat128<mat128>", "eigen", rq.data(), [&](size_t i) { rq[i] = quaternion(rotation[i].topLeftCorner<3, 3>()); });
+
+	bench_operation(reporter, "quat128_mul", "eigen", rq.data(), [&](size_t i) { rq[i] = q[i] * p[i]; });
+	bench_operation(reporter, "quat128_inverse", "eigen", rq.data(), [&](size_t i) { rq[i] = q[i].inverse(); });
+	bench_operation(reporter, "quat128_conjugate", "eigen", rq.data(), [&](size_t i) { rq[i] = q[i].conjugate(); });
+	bench_operation(reporter, "quat128_transform", "eigen", r3.data(), [&](size_t i) { r3[i] = q[i] * a3[i]; });
+	bench_operation(reporter, "quat128_norm", "eigen", f.data(), [&](size_t i) { f[i] = q[i].norm(); });
+	bench_operation(reporter, "quat128_normalize", "eigen", rq.data(), [&](size_t i) { rq[i] = q[i].normalized(); });
+
+	bench_operation(reporter, "to_rotation4<quat128>", "eigen", rm.data(), [&](size_t i) { rm[i].setIdentity(); rm[i].topLeftCorner<3, 3>() = q[i].toRotationMatrix(); });
+}
+
+#endif
+
+/* DirectXMath, under the names of the equivalent vec128, mat128 and quat128 operations */
+
+#ifdef FUSE_BENCH_DIRECTXMATH
+
+static void bench_directxmath_operations(bench_reporter & reporter, const bench_operations_inputs & inputs)
+{
+	using namespace DirectX;
+
+	bench_array<XMVECTOR> a(BENCH_OPERATIONS_BATCH), b(BENCH_OPERATIONS_BATCH), q(BENCH_OPERATIONS_BATCH), p(BENCH_OPERATIONS_BATCH), r(BENCH_OPERATIONS_BATCH);
+	bench_array<XMMATRIX> m(BENCH_OPERATIONS_BATCH), n(BENCH_OPERATIONS_BATCH), rm(BENCH_OPERATIONS_BATCH), rotation(BENCH_OPERATIONS_BATCH);
+
+	bench_array<XMFLOAT3>   f3(BENCH_OPERATIONS_BATCH);
+	bench_array<XMFLOAT4X4> f4x4(BENCH_OPERATIONS_BATCH);
+	bench_array<float>      f(BENCH_OPERATIONS_BATCH);
+
+	for (size_t i = 0; i < BENCH_OPERATIONS_BATCH; i++)
+	{
+		a[i] = XMVectorSet(inputs.a[i].x, inputs.a[i].y, inputs.a[i].z, inputs.a[i].w);
+		b[i] = XMVectorSet(inputs.b[i].x, inputs.b[i].y, inputs.b[i].z, inputs.b[i].w);
+		q[i] = XMVectorSet(inputs.q[i].x, inputs.q[i].y, inputs.q[i].z, inputs.q[i].w);
+		p[i] = XMVectorSet(inputs.p[i].x, inputs.p[i].y, inputs.p[i].z, inputs.p[i].w);
+
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				f4x4[i](row, column) = inputs.m[i](row, column);
+			}
+		}
+
+		m[i] = XMLoadFloat4x4(&f4x4[i]);
+
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				f4x4[i](row, column) = inputs.n[i](row, column);
+			}
+		}
+
+		n[i]        = XMLoadFloat4x4(&f4x4[i]);
+		rotation[i] = XMMatrixRotationQuaternion(q[i]);
+
+		XMStoreFloat3(&f3[i], a[i]);
+	}
+
+	bench_operation(reporter, "vec128_load<float3>", "directxmath", r.data(), [&](size_t i) { r[i] = XMLoadFloat3(&f3[i]); });
+	bench_operation(reporter, "vec128_store<float3>", "directxmath", f3.data(), [&](size_t i) { XMStoreFloat3(&f3[i], a[i]); });
+	bench_operation(reporter, "vec128_get_x", "directxmath", f.data(), [&](size_t i) { f[i] = XMVectorGetX(a[i]); });
+	bench_operation(reporter, "vec128_set_x", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorSetX(a[i], f[i]); });
+
+	bench_operation(reporter, "vec128_add", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorAdd(a[i], b[i]); });
+	bench_operation(reporter, "vec128_sub", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorSubtract(a[i], b[i]); });
+	bench_operation(reporter, "vec128_mul", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorMultiply(a[i], b[i]); });
+	bench_operation(reporter, "vec128_div", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorDivide(a[i], b[i]); });
+	bench_operation(reporter, "vec128_negate", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorNegate(a[i]); });
+
+	bench_operation(reporter, "vec128_and", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorAndInt(a[i], b[i]); });
+	bench_operation(reporter, "vec128_or", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorOrInt(a[i], b[i]); });
+	bench_operation(reporter, "vec128_xor", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorXorInt(a[i], b[i]); });
+
+	bench_operation(reporter, "vec128_shuffle", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorPermute<0, 2, 5, 7>(a[i], b[i]); });
+	bench_operation(reporter, "vec128_swizzle", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorSwizzle<3, 2, 1, 0>(a[i]); });
+	bench_operation(reporter, "vec128_splat", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorSplatY(a[i]); });
+	bench_operation(reporter, "vec128_select", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorSelect(a[i], b[i], g_XMSelect0101); });
+	bench_operation(reporter, "vec128_permute", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorPermute<3, 4, 1, 6>(a[i], b[i]); });
+
+	bench_operation(reporter, "vec128_min", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorMin(a[i], b[i]); });
+	bench_operation(reporter, "vec128_max", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorMax(a[i], b[i]); });
+	bench_operation(reporter, "vec128_eq", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorEqual(a[i], b[i]); });
+	bench_operation(reporter, "vec128_gt", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorGreater(a[i], b[i]); });
+	bench_operation(reporter, "vec128_lt", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorLess(a[i], b[i]); });
+	bench_operation(reporter, "vec128_ge", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorGreaterOrEqual(a[i], b[i]); });
+	bench_operation(reporter, "vec128_le", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorLessOrEqual(a[i], b[i]); });
+
+	bench_operation(reporter, "vec128_floor", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorFloor(a[i]); });
+	bench_operation(reporter, "vec128_ceil", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorCeiling(a[i]); });
+	bench_operation(reporter, "vec128_sqrt", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorSqrt(a[i]); });
+	bench_operation(reporter, "vec128_invsqrt", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorReciprocalSqrt(a[i]); });
+	bench_operation(reporter, "vec128_reciprocal", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorReciprocal(a[i]); });
+	bench_operation(reporter, "vec128_saturate", "directxmath", r.data(), [&](size_t i) { r[i] = XMVectorSaturate(a[i]); });
+
+	bench_operation(reporter, "vec128_dot2", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector2Dot(a[i], b[i]); });
+	bench_operation(reporter, "vec128_dot3", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector3Dot(a[i], b[i]); });
+	bench_operation(reporter, "vec128_dot4", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector4Dot(a[i], b[i]); });
+	bench_operation(reporter, "vec128_cross", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector3Cross(a[i], b[i]); });
+	bench_operation(reporter, "vec128_length3", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector3Length(a[i]); });
+	bench_operation(reporter, "vec128_length4", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector4Length(a[i]); });
+	bench_operation(reporter, "vec128_normalize3", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector3Normalize(a[i]); });
+	bench_operation(reporter, "vec128_normalize4", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector4Normalize(a[i]); });
+
+	bench_operation(reporter, "mat128_load<float4x4>", "directxmath", rm.data(), [&](size_t i) { rm[i] = XMLoadFloat4x4(&f4x4[i]); });
+	bench_operation(reporter, "mat128_transpose", "directxmath", rm.data(), [&](size_t i) { rm[i] = XMMatrixTranspose(m[i]); });
+	bench_operation(reporter, "mat128_transform4<mat128>", "directxmath", rm.data(), [&](size_t i) { rm[i] = XMMatrixMultiply(m[i], n[i]); });
+	bench_operation(reporter, "mat128_inverse4", "directxmath", rm.data(), [&](size_t i) { rm[i] = XMMatrixInverse(nullptr, m[i]); });
+	bench_operation(reporter, "mat128_determinant4", "directxmath", r.data(), [&](size_t i) { r[i] = XMMatrixDeterminant(m[i]); });
+
+	bench_operation(reporter, "mat128_transform4<vec128>", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector4Transform(a[i], m[i]); });
+	bench_operation(reporter, "mat128_transform3", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector3Transform(a[i], m[i]); });
+	bench_operation(reporter, "mat128_transform_normal", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector3TransformNormal(a[i], m[i]); });
+
+	bench_operation(reporter, "to_quat128<mat128>", "directxmath", r.data(), [&](size_t i) { r[i] = XMQuaternionRotationMatrix(rotation[i]); });
+
+	bench_operation(reporter, "quat128_mul", "directxmath", r.data(), [&](size_t i) { r[i] = XMQuaternionMultiply(q[i], p[i]); });
+	bench_operation(reporter, "quat128_inverse", "directxmath", r.data(), [&](size_t i) { r[i] = XMQuaternionInverse(q[i]); });
+	bench_operation(reporter, "quat128_conjugate", "directxmath", r.data(), [&](size_t i) { r[i] = XMQuaternionConjugate(q[i]); });
+	bench_operation(reporter, "quat128_transform", "directxmath", r.data(), [&](size_t i) { r[i] = XMVector3Rotate(a[i], q[i]); });
+	bench_operation(reporter, "quat128_norm", "directxmath", r.data(), [&](size_t i) { r[i] = XMQuaternionLength(q[i]); });
+	bench_operation(reporter, "quat128_normalize", "directxmath", r.data(), [&](size_t i) { r[i] = XMQuaternionNormalize(q[i]); });
+
+	bench_operation(reporter, "to_rotation4<quat128>", "directxmath", rm.data(), [&](size_t i) { rm[i] = XMMatrixRotationQuaternion(q[i]); });
+}
+
+#endif
+
+void bench_operations(bench_reporter & reporter)
+{
+	bench_operations_inputs inputs;
+
+	bench_vec128_operations(reporter, inputs);
+	bench_mat128_operations(reporter, inputs);
+	bench_quat128_operations(reporter, inputs);
+	bench_matrix_operations(reporter, inputs);
+
+#ifdef FUSE_BENCH_EIGEN
+	bench_eigen_operations(reporter, inputs);
+#endif
+
+#ifdef FUSE_BENCH_DIRECTXMATH
+	bench_directxmath_operations(reporter, inputs);
+#endif
+}
\ No newline at end of file
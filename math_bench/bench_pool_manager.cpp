@@ -0,0 +1,183 @@
+#include "bench.hpp"
+
+#include <fuse/core/pool_manager.hpp>
+
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+
+using namespace fuse;
+
+#define BENCH_POOL_OPERATIONS (1 << 16)
+#define BENCH_POOL_REPEAT     5
+
+// The first fit search pool_manager did before the segregated lists, for comparison
+
+class bench_first_fit_pool
+{
+
+public:
+
+	bench_first_fit_pool(pool_size_t size) :
+		m_freeChunks({ { 0, size } }),
+		m_objectsCount(size) { }
+
+	pool_size_t allocate(pool_size_t elements)
+	{
+		auto it = m_freeChunks.begin();
+
+		for (; it != m_freeChunks.end() && it->second < elements; it++);
+
+		if (it == m_freeChunks.end())
+		{
+			return FUSE_POOL_INVALID;
+		}
+
+		it->second -= elements;
+
+		return it->first + it->second;
+	}
+
+	void free(pool_size_t offset, pool_size_t elements)
+	{
+		if (offset > m_objectsCount) return;
+
+		auto lb = m_freeChunks.lower_bound(offset);
+		auto ub = m_freeChunks.upper_bound(offset);
+
+		bool mergeLower = lb != m_freeChunks.end() && ((lb->first + lb->second) == offset);
+		bool mergeUpper = ub != m_freeChunks.end() && (ub->first == (offset + elements));
+
+		if (mergeLower)
+		{
+			if (mergeUpper)
+			{
+				lb->second += elements + ub->second;
+				m_freeChunks.erase(ub);
+			}
+			else
+			{
+				lb->second += elements;
+			}
+		}
+		else if (mergeUpper)
+		{
+			m_freeChunks.emplace(offset, elements + ub->second);
+			m_freeChunks.erase(ub);
+		}
+		else
+		{
+			m_freeChunks.emplace(offset, elements);
+		}
+	}
+
+private:
+
+	std::map<pool_size_t, pool_size_t> m_freeChunks;
+
+	uint32_t m_objectsCount;
+
+};
+
+/* Stress */
+
+// Mostly single descriptors with some tables, the pool is filled to about three
+// quarters then each operation frees a random allocation and makes a new one
+
+static pool_size_t bench_pool_allocation_size(std::mt19937 & generator)
+{
+	std::uniform_int_distribution<int> kind(0, 9);
+	std::uniform_int_distribution<pool_size_t> table(2, 32);
+
+	return kind(generator) < 7 ? 1 : table(generator);
+}
+
+template <typename Pool>
+static double bench_pool_stress(pool_size_t size, size_t & failures, std::unique_ptr<Pool> & pool)
+{
+	std::vector<std::pair<pool_size_t, pool_size_t>> live;
+
+	return bench_run(BENCH_POOL_REPEAT,
+		[&]()
+		{
+			pool.reset(new Pool(size));
+			live.clear();
+			failures = 0;
+		},
+		[&]()
+		{
+			std::mt19937 generator(1);
+
+			pool_size_t used = 0;
+
+			while (used < size / 4 * 3)
+			{
+				pool_size_t elements = bench_pool_allocation_size(generator);
+				pool_size_t offset   = pool->allocate(elements);
+
+				if (offset == FUSE_POOL_INVALID)
+				{
+					break;
+				}
+
+				live.emplace_back(offset, elements);
+				used += elements;
+			}
+
+			for (int i = 0; i < BENCH_POOL_OPERATIONS; i++)
+			{
+				if (!live.empty())
+				{
+					size_t index = std::uniform_int_distribution<size_t>(0, live.size() - 1)(generator);
+
+					pool->free(live[index].first, live[index].second);
+
+					live[index] = live.back();
+					live.pop_back();
+				}
+
+				pool_size_t elements = bench_pool_allocation_size(generator);
+				pool_size_t offset   = pool->allocate(elements);
+
+				if (offset == FUSE_POOL_INVALID)
+				{
+					++failures;
+				}
+				else
+				{
+					live.emplace_back(offset, elements);
+				}
+			}
+		});
+}
+
+void bench_pool_manager(bench_reporter & reporter)
+{
+	for (pool_size_t size : { 4096u, 65536u })
+	{
+		std::string name = "pool_manager/stress:" + std::to_string(size);
+
+		size_t failures = 0;
+
+		std::unique_ptr<pool_manager> segregated;
+
+		reporter.add(name.c_str(), "tlsf", bench_pool_stress(size, failures, segregated), BENCH_POOL_OPERATIONS);
+
+		pool_statistics statistics = segregated->get_statistics();
+
+		reporter.log() << std::left << std::setw(28) << name << std::right
+		               << statistics.freeElements << " free in " << statistics.freeBlocks << " blocks, largest "
+		               << statistics.largestFreeBlock << ", fragmentation " << std::setprecision(3) << statistics.fragmentation
+		               << ", " << failures << " failed allocations" << std::endl;
+
+		std::unique_ptr<bench_first_fit_pool> firstFit;
+
+		reporter.add(name.c_str(), "first_fit", bench_pool_stress(size, failures, firstFit), BENCH_POOL_OPERATIONS);
+
+		reporter.log() << std::left << std::setw(28) << name << std::right
+		               << failures << " failed allocations with first fit" << std::endl;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "bench.hpp"
+
+#include <fuse/resource_manager.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+using namespace fuse;
+
+#define BENCH_RESOURCES          4096
+#define BENCH_RESOURCE_LOOKUPS   (1 << 20)
+#define BENCH_RESOURCE_REPEAT    5
+
+/* Resources */
+
+class bench_resource :
+	public resource
+{
+
+public:
+
+	bench_resource(const char_t * name, resource_loader * loader, resource_manager * owner) :
+		resource(name, loader, owner) { }
+
+protected:
+
+	bool   load_impl(void) override { return true; }
+	void   unload_impl(void) override { }
+	size_t calculate_size_impl(void) override { return 0; }
+
+};
+
+class bench_manager :
+	public resource_manager
+{
+
+public:
+
+	bench_manager(void) :
+		resource_manager(FUSE_LITERAL("bench")) { }
+
+protected:
+
+	resource * create_impl(const char_t * name, resource_loader * loader) override { return new bench_resource(name, loader, this); }
+	void       free_impl(resource * r) override { delete r; }
+
+};
+
+// The lookups as resource_manager did them before being lock-free, for comparison
+
+class bench_locked_manager :
+	public lockable
+{
+
+public:
+
+	void add(const std::shared_ptr<resource> & r)
+	{
+		guard_type lock(m_lock);
+		m_namedResources[r->get_name()] = r->get_id();
+		m_resources[r->get_id()]        = r;
+	}
+
+	std::shared_ptr<resource> find_by_name(const char_t * name) const
+	{
+		guard_type lock(m_lock);
+
+		auto it = m_namedResources.find(name);
+
+		if (it != m_namedResources.end())
+		{
+			auto r = m_resources.find(it->second);
+			return r != m_resources.end() ? r->second : std::shared_ptr<resource>();
+		}
+
+		return std::shared_ptr<resource>();
+	}
+
+private:
+
+	std::unordered_map<string_t, resource::id_type>                  m_namedResources;
+	std::unordered_map<resource::id_type, std::shared_ptr<resource>> m_resources;
+
+};
+
+/* Contention */
+
+// Each thread looks up the names in its own random order, the total number of lookups is split among the threads
+
+template <typename Manager>
+static double bench_find_by_name(const Manager & manager, const std::vector<string_t> & names, unsigned int threads)
+{
+	std::vector<std::vector<const char_t *>> orders(threads);
+
+	for (unsigned int t = 0; t < threads; t++)
+	{
+		std::mt19937 generator(t);
+
+		for (const string_t & name : names)
+		{
+			orders[t].push_back(name.c_str());
+		}
+
+		std::shuffle(orders[t].begin(), orders[t].end(), generator);
+	}
+
+	size_t lookups = BENCH_RESOURCE_LOOKUPS / threads;
+
+	return bench_run(BENCH_RESOURCE_REPEAT, [](){}, [&]()
+	{
+		std::vector<std::thread> workers;
+
+		for (unsigned int t = 0; t < threads; t++)
+		{
+			workers.emplace_back([&, t]()
+			{
+				const std::vector<const char_t *> & order = orders[t];
+
+				size_t found = 0;
+
+				for (size_t i = 0; i < lookups; i++)
+				{
+					found += manager.find_by_name(order[i % order.size()]) ? 1 : 0;
+				}
+
+				bench_do_not_optimize(&found);
+			});
+		}
+
+		for (std::thread & worker : workers)
+		{
+			worker.join();
+		}
+	});
+}
+
+void bench_resource_manager(bench_reporter & reporter)
+{
+	bench_manager        manager;
+	bench_locked_manager locked;
+
+	std::vector<string_t> names;
+
+	for (int i = 0; i < BENCH_RESOURCES; i++)
+	{
+		stringstream_t ss;
+		ss << FUSE_LITERAL("textures/bench_") << i << FUSE_LITERAL(".dds");
+
+		names.push_back(ss.str());
+		locked.add(manager.create(names.back().c_str()));
+	}
+
+	std::vector<unsigned int> threadCounts = { 1, 2, 4, 8 };
+
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+
+	if (hardwareThreads > 8)
+	{
+		threadCounts.push_back(hardwareThreads);
+	}
+
+	for (unsigned int threads : threadCounts)
+	{
+		std::string name = "resource_find_by_name/threads:" + std::to_string(threads);
+
+		reporter.add(name.c_str(), "fuse", bench_find_by_name(manager, names, threads), BENCH_RESOURCE_LOOKUPS);
+		reporter.add(name.c_str(), "mutex", bench_find_by_name(locked, names, threads), BENCH_RESOURCE_LOOKUPS);
+	}
+}
\ No newline at end of file
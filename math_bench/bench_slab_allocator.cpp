@@ -0,0 +1,155 @@
+#include "bench.hpp"
+
+#include <fuse/core/allocators.hpp>
+#include <fuse/math.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fuse;
+
+#define BENCH_SLAB_LEVELS 5
+#define BENCH_SLAB_FANOUT 10
+#define BENCH_SLAB_NODES  111111
+#define BENCH_SLAB_REPEAT 5
+
+/* Nodes */
+
+// About the layout of a scene_graph_geometry: the transforms, the children,
+// the name and the shared resources
+
+struct alignas(16) bench_slab_node_data
+{
+	mat128                             local;
+	mat128                             global;
+	std::vector<bench_slab_node_data*> children;
+	std::string                        name;
+	std::shared_ptr<int>               mesh;
+};
+
+class alignas(16) bench_malloc_node :
+	public bench_slab_node_data
+{
+
+public:
+
+	FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+
+};
+
+class alignas(16) bench_slab_node :
+	public bench_slab_node_data
+{
+
+public:
+
+	FUSE_DECLARE_SLAB_ALLOCATOR_NEW(bench_slab_node, 16, FUSE_MEMORY_TAG_GENERAL)
+
+};
+
+FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(bench_malloc_node, 16)
+FUSE_DEFINE_SLAB_ALLOCATOR_NEW(bench_slab_node, 16, FUSE_MEMORY_TAG_GENERAL)
+
+/* Import and teardown */
+
+// The tree is created depth first like the importers do, each node with a
+// name long enough to go on the heap and its own resource allocated right
+// after it, which scatters the nodes allocated one by one
+
+template <typename Node>
+static Node * bench_import(int level = 0)
+{
+	Node * node = new Node();
+
+	node->local = mat128_identity();
+	node->name  = "imported_scene_node_" + std::to_string(level);
+	node->mesh  = std::make_shared<int>(level);
+
+	if (level < BENCH_SLAB_LEVELS)
+	{
+		for (int i = 0; i < BENCH_SLAB_FANOUT; i++)
+		{
+			node->children.push_back(bench_import<Node>(level + 1));
+		}
+	}
+
+	return node;
+}
+
+template <typename Node>
+static void bench_teardown(bench_slab_node_data * node)
+{
+	for (bench_slab_node_data * child : node->children)
+	{
+		bench_teardown<Node>(child);
+	}
+
+	delete static_cast<Node*>(node);
+}
+
+// As scene_graph::clear, the destructors run in place and the slots are taken back at once
+
+static void bench_discard(bench_slab_node_data * node, bench_slab_node::allocator_discard_list & slots)
+{
+	for (bench_slab_node_data * child : node->children)
+	{
+		bench_discard(child, slots);
+	}
+
+	static_cast<bench_slab_node*>(node)->~bench_slab_node();
+	slots.push(node);
+}
+
+static void bench_discard(bench_slab_node * root)
+{
+	bench_slab_node::allocator_discard_list slots;
+
+	bench_discard(root, slots);
+	bench_slab_node::discard_allocator_slots(slots);
+}
+
+template <typename Node>
+static void bench_import_teardown(bench_reporter & reporter, const char * variant, std::function<void(Node*)> teardown)
+{
+	Node * root = nullptr;
+
+	double importTime = bench_run(BENCH_SLAB_REPEAT,
+		[&]()
+		{
+			if (root)
+			{
+				teardown(root);
+			}
+		},
+		[&]()
+		{
+			root = bench_import<Node>();
+		});
+
+	double teardownTime = bench_run(BENCH_SLAB_REPEAT,
+		[&]()
+		{
+			if (!root)
+			{
+				root = bench_import<Node>();
+			}
+		},
+		[&]()
+		{
+			teardown(root);
+			root = nullptr;
+		});
+
+	reporter.add("slab_allocator/import", variant, importTime, BENCH_SLAB_NODES);
+	reporter.add("slab_allocator/teardown", variant, teardownTime, BENCH_SLAB_NODES);
+}
+
+void bench_slab_allocator(bench_reporter & reporter)
+{
+	bench_import_teardown<bench_malloc_node>(reporter, "aligned_malloc", [](bench_malloc_node * root) { bench_teardown<bench_malloc_node>(root); });
+	bench_import_teardown<bench_slab_node>(reporter, "slab", [](bench_slab_node * root) { bench_teardown<bench_slab_node>(root); bench_slab_node::reset_allocator_slabs(); });
+	bench_import_teardown<bench_slab_node>(reporter, "slab_release", [](bench_slab_node * root) { bench_teardown<bench_slab_node>(root); bench_slab_node::release_allocator_slabs(); });
+	bench_import_teardown<bench_slab_node>(reporter, "slab_discard", [](bench_slab_node * root) { bench_discard(root); });
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "bench.hpp"
+
+#include <fuse/tangent_space.hpp>
+#include <fuse/core/thread_pool.hpp>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace fuse;
+
+#define BENCH_TANGENT_GRID_SIZE 1024
+#define BENCH_TANGENT_REPEAT    5
+
+/* Benchmark */
+
+void bench_tangent_space(bench_reporter & reporter)
+{
+	std::vector<float3>   vertices;
+	std::vector<float2>   texcoords;
+	std::vector<uint32_t> indices;
+
+	bench_generate_sphere(vertices, indices, BENCH_TANGENT_GRID_SIZE, false, 0.f, &texcoords);
+
+	// The normals of the unit sphere are its positions
+
+	const std::vector<float3> & normals = vertices;
+
+	std::vector<float3> tangents(vertices.size());
+	std::vector<float3> bitangents(vertices.size());
+
+	size_t numTriangles = indices.size() / 3;
+
+	reporter.log() << "Mesh: " << vertices.size() << " vertices, " << numTriangles << " triangles" << std::endl;
+
+	std::vector<unsigned int> threadCounts = { 1, 2, 4, 8 };
+
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+
+	if (hardwareThreads > 8)
+	{
+		threadCounts.push_back(hardwareThreads);
+	}
+
+	for (unsigned int threads : threadCounts)
+	{
+		// The calling thread processes chunks too
+
+		std::unique_ptr<thread_pool> pool(threads > 1 ? new thread_pool(threads - 1) : nullptr);
+
+		std::string name = "mesh_tangents/threads:" + std::to_string(threads);
+
+		double milliseconds = bench_run(BENCH_TANGENT_REPEAT,
+			[]() {},
+			[&]()
+			{
+				compute_tangent_space(
+					vertices.data(), normals.data(), texcoords.data(),
+					indices.data(), indices.size(), vertices.size(),
+					tangents.data(), bitangents.data(),
+					pool.get());
+
+				bench_do_not_optimize(tangents.data());
+				bench_do_not_optimize(bitangents.data());
+			});
+
+		reporter.add(name.c_str(), "fuse", milliseconds, numTriangles);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "bench.hpp"
+
+#include <fuse/core/pool_manager.hpp>
+#include <fuse/core/transient_pool.hpp>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace fuse;
+
+#define BENCH_TRANSIENT_ALLOCATIONS (1 << 18)
+#define BENCH_TRANSIENT_PAGES       8192
+#define BENCH_TRANSIENT_FRAMES      2
+#define BENCH_TRANSIENT_REPEAT      10
+
+/* Frames */
+
+// A frame of descriptors, mostly single views with a table of 4 every 8, the
+// allocations are split among the threads as if each recorded a command list
+
+template <typename Allocate>
+static double bench_transient_frame(unsigned int threads, std::function<void(void)> setup, Allocate allocate)
+{
+	size_t allocations = BENCH_TRANSIENT_ALLOCATIONS / threads;
+
+	return bench_run(BENCH_TRANSIENT_REPEAT, setup, [&]()
+	{
+		std::vector<std::thread> workers;
+
+		for (unsigned int t = 0; t < threads; t++)
+		{
+			workers.emplace_back([&, t]()
+			{
+				auto allocator = allocate(t);
+
+				pool_size_t failures = 0;
+
+				for (size_t i = 0; i < allocations; i++)
+				{
+					failures += allocator((i & 7) == 7 ? 4u : 1u) == FUSE_POOL_INVALID;
+				}
+
+				bench_do_not_optimize(&failures);
+			});
+		}
+
+		for (std::thread & worker : workers)
+		{
+			worker.join();
+		}
+	});
+}
+
+void bench_transient_pool(bench_reporter & reporter)
+{
+	std::vector<unsigned int> threadCounts = { 1, 2, 4, 8 };
+
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+
+	if (hardwareThreads > 8)
+	{
+		threadCounts.push_back(hardwareThreads);
+	}
+
+	const pool_size_t pageSize = FUSE_TRANSIENT_PAGE_SIZE;
+	const pool_size_t size     = BENCH_TRANSIENT_PAGES * pageSize * BENCH_TRANSIENT_FRAMES;
+
+	for (unsigned int threads : threadCounts)
+	{
+		std::string name = "transient_pool/threads:" + std::to_string(threads);
+
+		// Each thread has its own linear allocator on the pages of the frame
+
+		transient_pool pool;
+		uint64_t       frameIndex = 0;
+
+		pool.init(0, pageSize, BENCH_TRANSIENT_PAGES, BENCH_TRANSIENT_FRAMES);
+
+		double transientTime = bench_transient_frame(threads,
+			[&]() { pool.begin_frame(++frameIndex); },
+			[&](unsigned int)
+			{
+				std::shared_ptr<transient_allocator> allocator = std::make_shared<transient_allocator>(&pool);
+				return [allocator](pool_size_t elements) { return allocator->allocate(elements); };
+			});
+
+		reporter.add(name.c_str(), "transient", transientTime, BENCH_TRANSIENT_ALLOCATIONS);
+
+		// The persistent pool behind a lock, the frees happen when the frame is done
+
+		std::unique_ptr<pool_manager> manager;
+		std::mutex                    lock;
+
+		double lockedTime = bench_transient_frame(threads,
+			[&]() { manager.reset(new pool_manager(size)); },
+			[&](unsigned int)
+			{
+				return [&](pool_size_t elements)
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					return manager->allocate(elements);
+				};
+			});
+
+		reporter.add(name.c_str(), "mutex", lockedTime, BENCH_TRANSIENT_ALLOCATIONS);
+	}
+}
\ No newline at end of file
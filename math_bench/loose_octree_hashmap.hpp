@@ -0,0 +1,214 @@
+#pragma once
+
+#include <fuse/geometry.hpp>
+#include <fuse/geometry/morton.hpp>
+#include <fuse/math.hpp>
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+namespace fuse
+{
+
+	/*
+	*
+	* Reference implementation of the previous loose_octree storage, nodes
+	* kept in a hashmap keyed by the octant Morton code and objects in lists.
+	* Only used to compare against loose_octree in the benchmarks.
+	*
+	*/
+
+	template <typename Object,
+	          typename BoundingVolume,
+	          typename BoundingVolumeFunctor,
+	          typename Comparator = std::equal_to<Object>>
+	class alignas(16) loose_octree_hashmap
+	{
+
+	public:
+
+		loose_octree_hashmap(const vec128 & center,
+		                     float halfextent,
+		                     unsigned int maxdepth,
+		                     BoundingVolumeFunctor functor = BoundingVolumeFunctor(),
+		                     Comparator comparator = Comparator()) :
+			m_center(center),
+			m_halfextent(vec128_set(halfextent, halfextent, halfextent, halfextent)),
+			m_maxdepth(maxdepth),
+			m_functor(functor),
+			m_comparator(comparator)
+		{
+			m_nodes.emplace(1, node());
+		}
+
+		bool insert(const Object & object)
+		{
+			aabb aabb = bounding_aabb(m_functor(object));
+
+			if (!contains(aabb::from_center_half_extents(m_center, m_halfextent * 2.f), aabb))
+			{
+				return false;
+			}
+
+			node_hashmap_iterator it = create_octant(calculate_fitting_octant(aabb));
+
+			it->second.objects.push_back(object);
+			increase_occupancy(it);
+
+			return true;
+		}
+
+		bool remove(const Object & object, const BoundingVolume & volume)
+		{
+			auto it = m_nodes.find(calculate_fitting_octant(bounding_aabb(volume)));
+
+			if (it != m_nodes.end())
+			{
+				for (auto listIt = it->second.objects.begin(); listIt != it->second.objects.end(); listIt++)
+				{
+					if (m_comparator(*listIt, object))
+					{
+						it->second.objects.erase(listIt);
+						decrease_occupancy(it);
+						return true;
+					}
+				}
+			}
+
+			return false;
+		}
+
+		template <typename QueryType, typename Visitor>
+		void query(const QueryType & query, Visitor visitor)
+		{
+			aabb rootAABB = aabb::from_center_half_extents(m_center, m_halfextent * 2.f);
+			traverse(1, rootAABB, query, visitor);
+		}
+
+	private:
+
+		struct node
+		{
+			std::list<Object> objects;
+			uint8_t           childrenMask;
+			uint32_t          occupancy;
+
+			node(void) : childrenMask(0), occupancy(0) { }
+		};
+
+		typedef std::unordered_map<morton_code, node> node_hashmap;
+		typedef typename node_hashmap::iterator       node_hashmap_iterator;
+
+		vec128 m_center;
+		vec128 m_halfextent;
+
+		unsigned int m_maxdepth;
+
+		BoundingVolumeFunctor m_functor;
+		Comparator            m_comparator;
+
+		node_hashmap m_nodes;
+
+		node_hashmap_iterator create_octant(morton_code octantLocation)
+		{
+			auto nodeInsertResult = m_nodes.emplace(octantLocation, node());
+
+			if (nodeInsertResult.second)
+			{
+				node_hashmap_iterator parent = create_octant(octantLocation >> 3);
+				parent->second.childrenMask |= (1 << (octantLocation & 7));
+			}
+
+			return nodeInsertResult.first;
+		}
+
+		morton_code calculate_fitting_octant(const aabb & aabb) const
+		{
+			vec128 hExtents = aabb.get_half_extents();
+
+			float maxExtent = std::max(std::max(vec128_get_x(hExtents), vec128_get_y(hExtents)), vec128_get_z(hExtents));
+
+			vec128 normalizedCentroid = vec128_add(vec128_sub(aabb.get_center(), m_center), m_halfextent);
+			normalizedCentroid = vec128_div(normalizedCentroid, vec128_add(m_halfextent, m_halfextent));
+
+			unsigned int fitDepth = (unsigned int) std::floor(std::log2(vec128_get_x(m_halfextent) / maxExtent));
+			unsigned int depth    = std::min(fitDepth, m_maxdepth);
+
+			float scale = (float) (1 << m_maxdepth);
+
+			vec128_f32 t = vec128_floor(vec128_mul(normalizedCentroid, vec128_set(scale, scale, scale, scale)));
+
+			morton_unpacked octreeCenterCoordinates = {
+				static_cast<uint32_t>(t.f32[0]),
+				static_cast<uint32_t>(t.f32[1]),
+				static_cast<uint32_t>(t.f32[2])
+			};
+
+			morton_code sentinel = 1ULL << (3L * m_maxdepth);
+
+			return (morton_encode3(octreeCenterCoordinates) | sentinel) >> (3 * (m_maxdepth - depth));
+		}
+
+		template <typename QueryType, typename Visitor>
+		void traverse(morton_code currentLocation, const aabb & current, const QueryType & query, Visitor visitor)
+		{
+			auto it = m_nodes.find(currentLocation);
+
+			if (it != m_nodes.end() &&
+			    it->second.occupancy > 0 &&
+			    intersects(current, query))
+			{
+				for (Object & o : it->second.objects)
+				{
+					if (intersects(query, m_functor(o)))
+					{
+						visitor(o);
+					}
+				}
+
+				vec128 nextHalfExtents = vec128_mul(current.get_half_extents(), vec128_set(.5f, .5f, .5f, .5f));
+				vec128 shiftSize       = vec128_mul(current.get_half_extents(), vec128_set(.25f, .25f, .25f, .25f));
+
+				for (int child = 0; child < 8; child++)
+				{
+					if (it->second.childrenMask & (1 << child))
+					{
+						vec128 centerShift = vec128_set(child & 1 ? 0.f : -0.f,
+						                                child & 2 ? 0.f : -0.f,
+						                                child & 4 ? 0.f : -0.f,
+						                                0.f);
+
+						centerShift = vec128_or(centerShift, shiftSize);
+
+						aabb childAABB = aabb::from_center_half_extents(vec128_add(current.get_center(), centerShift), nextHalfExtents);
+
+						traverse((currentLocation << 3) | child, childAABB, query, visitor);
+					}
+				}
+			}
+		}
+
+		void increase_occupancy(node_hashmap_iterator octant)
+		{
+			octant->second.occupancy++;
+
+			if (octant->first != 1)
+			{
+				increase_occupancy(m_nodes.find(octant->first >> 3));
+			}
+		}
+
+		void decrease_occupancy(node_hashmap_iterator octant)
+		{
+			octant->second.occupancy--;
+
+			if (octant->first != 1)
+			{
+				decrease_occupancy(m_nodes.find(octant->first >> 3));
+			}
+		}
+
+	};
+
+}
\ No newline at end of file
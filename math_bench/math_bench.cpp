@@ -0,0 +1,720 @@
+#include <fuse/math.hpp>
+#include <fuse/geometry.hpp>
+#include <fuse/geometry/loose_octree.hpp>
+#include <fuse/transform_hierarchy.hpp>
+
+#include "bench.hpp"
+#include "loose_octree_hashmap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace fuse;
+
+#define BENCH_OCTREE_HALF_EXTENT 1000.f
+#define BENCH_OCTREE_MAX_DEPTH   9
+
+struct alignas(16) bench_object
+{
+	sphere s;
+};
+
+struct bench_object_bounding_sphere
+{
+	inline sphere operator() (bench_object * o) const
+	{
+		return o->s;
+	}
+};
+
+using bench_object_vector  = std::vector<bench_object, aligned_allocator<bench_object, 16>>;
+using bench_octree         = loose_octree<bench_object*, sphere, bench_object_bounding_sphere>;
+using bench_octree_hashmap = loose_octree_hashmap<bench_object*, sphere, bench_object_bounding_sphere>;
+
+/* Scene generation */
+
+void bench_generate_objects(bench_object_vector & objects, size_t n, unsigned int seed)
+{
+	std::mt19937 generator(seed);
+
+	std::uniform_real_distribution<float> position(-BENCH_OCTREE_HALF_EXTENT * .9f, BENCH_OCTREE_HALF_EXTENT * .9f);
+	std::uniform_real_distribution<float> radius(.5f, 10.f);
+
+	objects.resize(n);
+
+	for (bench_object & o : objects)
+	{
+		o.s = sphere(float3(position(generator), position(generator), position(generator)), radius(generator));
+	}
+}
+
+void bench_jitter_objects(bench_object_vector & objects, std::vector<sphere, aligned_allocator<sphere, 16>> & old, unsigned int seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> delta(-5.f, 5.f);
+
+	old.resize(objects.size());
+
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		old[i] = objects[i].s;
+
+		vec128 center = vec128_add(objects[i].s.get_center(), vec128_set(delta(generator), delta(generator), delta(generator), 0.f));
+		vec128 bound  = vec128_set(BENCH_OCTREE_HALF_EXTENT * .9f, BENCH_OCTREE_HALF_EXTENT * .9f, BENCH_OCTREE_HALF_EXTENT * .9f, 0.f);
+
+		objects[i].s.set_center(vec128_max(vec128_min(center, bound), vec128_negate(bound)));
+	}
+}
+
+frustum bench_frustum(float distance)
+{
+	// Camera on the negative z axis looking at the center of the scene
+
+	float4x4 view       = look_at_lh(float3(0, 0, -distance), float3(0, 0, 0), float3(0, 1, 0));
+	float4x4 projection = bench_perspective_lh(1.f, 16.f / 9.f, .1f, distance + 2.f * BENCH_OCTREE_HALF_EXTENT);
+	return frustum(view * projection);
+}
+
+/* Octree benchmarks */
+
+template <typename Octree>
+void bench_loose_octree(bench_reporter & reporter, const char * variant, size_t n, int repetitions)
+{
+	bench_object_vector objects;
+	std::vector<sphere, aligned_allocator<sphere, 16>> old;
+
+	bench_generate_objects(objects, n, 42);
+
+	vec128 center = vec128_zero();
+	frustum f     = bench_frustum(BENCH_OCTREE_HALF_EXTENT);
+
+	Octree octree(center, BENCH_OCTREE_HALF_EXTENT, BENCH_OCTREE_MAX_DEPTH);
+
+	double insertTime = bench_run(repetitions,
+		[&]()
+	{
+		octree = Octree(center, BENCH_OCTREE_HALF_EXTENT, BENCH_OCTREE_MAX_DEPTH);
+	},
+		[&]()
+	{
+		for (bench_object & o : objects)
+		{
+			octree.insert(&o);
+		}
+	});
+
+	unsigned int seed = 0;
+
+	double moveTime = bench_run(repetitions,
+		[&]()
+	{
+		bench_jitter_objects(objects, old, seed++);
+	},
+		[&]()
+	{
+		// Same pattern as scene::on_scene_graph_node_move
+
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			octree.remove(&objects[i], old[i]);
+			octree.insert(&objects[i]);
+		}
+	});
+
+	size_t visible = 0;
+
+	double queryTime = bench_run(repetitions,
+		[&]() { visible = 0; },
+		[&]()
+	{
+		octree.query(f, [&](bench_object *) { visible++; });
+	});
+
+	reporter.add("loose_octree::insert", variant, insertTime, n);
+	reporter.add("loose_octree::remove+insert", variant, moveTime, n);
+	reporter.add("loose_octree::query<frustum>", variant, queryTime, n);
+}
+
+void bench_loose_octree_batch(bench_reporter & reporter, size_t n, int repetitions)
+{
+	bench_object_vector objects;
+	bench_generate_objects(objects, n, 42);
+
+	frustum f = bench_frustum(BENCH_OCTREE_HALF_EXTENT);
+
+	// Far enough to have most of the scene inside the frustum
+	frustum wide = bench_frustum(4.f * BENCH_OCTREE_HALF_EXTENT);
+
+	bench_octree octree(vec128_zero(), BENCH_OCTREE_HALF_EXTENT, BENCH_OCTREE_MAX_DEPTH);
+
+	for (bench_object & o : objects)
+	{
+		octree.insert(&o);
+	}
+
+	bench_octree::objects_vector visible;
+	visible.reserve(n);
+
+	double queryTime = bench_run(repetitions,
+		[&]() { visible.clear(); },
+		[&]()
+	{
+		octree.query_batch(f, visible);
+	});
+
+	double wideQueryTime = bench_run(repetitions,
+		[&]() { visible.clear(); },
+		[&]()
+	{
+		octree.query(wide, [&](bench_object * o) { visible.push_back(o); });
+	});
+
+	double wideQueryBatchTime = bench_run(repetitions,
+		[&]() { visible.clear(); },
+		[&]()
+	{
+		octree.query_batch(wide, visible);
+	});
+
+	// Flat array of spheres, no hierarchy
+
+	std::vector<sphere, aligned_allocator<sphere, 16>> spheres(n);
+	std::vector<uint32_t> indices(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		spheres[i] = objects[i].s;
+	}
+
+	size_t numVisible = 0;
+
+	double scalarTime = bench_run(repetitions,
+		[&]() { numVisible = 0; },
+		[&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			if (intersects(spheres[i], f))
+			{
+				indices[numVisible++] = (uint32_t) i;
+			}
+		}
+	});
+
+	simd_instruction_set defaultInstructionSet = simd_get_instruction_set();
+
+	simd_set_instruction_set(FUSE_SIMD_SSE41);
+
+	double simdTime = bench_run(repetitions,
+		[&]() { numVisible = 0; },
+		[&]()
+	{
+		numVisible = frustum_cull(f, spheres.data(), n, indices.data());
+	});
+
+	size_t simdVisible = numVisible;
+
+	// 8 spheres at a time
+
+	double avxTime = 0;
+
+	if (simd_set_instruction_set(FUSE_SIMD_AVX))
+	{
+		avxTime = bench_run(repetitions,
+			[&]() { numVisible = 0; },
+			[&]()
+		{
+			numVisible = frustum_cull(f, spheres.data(), n, indices.data());
+		});
+
+		if (numVisible != simdVisible)
+		{
+			reporter.log() << "frustum_cull<sphere>: " << numVisible << " visible with avx, " << simdVisible << " with sse" << std::endl;
+		}
+	}
+
+	simd_set_instruction_set(defaultInstructionSet);
+
+	reporter.add("loose_octree::query_batch", "pool", queryTime, n);
+	reporter.add("loose_octree::query<frustum>", "wide", wideQueryTime, n);
+	reporter.add("loose_octree::query_batch", "wide", wideQueryBatchTime, n);
+	reporter.add("intersects<sphere, frustum>", "scalar", scalarTime, n);
+	reporter.add("frustum_cull<sphere>", "soa", simdTime, n);
+
+	if (avxTime > 0)
+	{
+		reporter.add("frustum_cull<sphere>", "soa avx", avxTime, n);
+	}
+}
+
+/* Transform benchmarks */
+
+class alignas(16) bench_transform_node :
+	public transform_hierarchy<bench_transform_node>
+{
+
+public:
+
+	FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+
+	using children_iterator = std::vector<bench_transform_node*>::iterator;
+
+	bench_transform_node(bench_transform_node * parent) :
+		m_parent(parent)
+	{
+		if (parent)
+		{
+			parent->m_children.push_back(this);
+		}
+	}
+
+	// Same as scene_graph_node::update_node
+
+	inline void update(void)
+	{
+		if (was_moved())
+		{
+			get_global_matrix();
+			set_moved(false);
+		}
+	}
+
+	bench_transform_node *             m_parent;
+	std::vector<bench_transform_node*> m_children;
+
+};
+
+FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(bench_transform_node, 16)
+
+namespace fuse
+{
+
+	template <>
+	inline bench_transform_node * get_transform_hierarchy_parent(transform_hierarchy<bench_transform_node> * node)
+	{
+		return static_cast<bench_transform_node*>(node)->m_parent;
+	}
+
+	template <>
+	inline bench_transform_node::children_iterator get_transform_hierarchy_children_begin(transform_hierarchy<bench_transform_node> * node)
+	{
+		return static_cast<bench_transform_node*>(node)->m_children.begin();
+	}
+
+	template <>
+	inline bench_transform_node::children_iterator get_transform_hierarchy_children_end(transform_hierarchy<bench_transform_node> * node)
+	{
+		return static_cast<bench_transform_node*>(node)->m_children.end();
+	}
+
+}
+
+void bench_transforms(bench_reporter & reporter, size_t n, int repetitions)
+{
+	// Random tree created breadth first, each transform has up to 8 children,
+	// the nodes are created in the same order in both hierarchies
+
+	std::mt19937 generator(42);
+
+	std::uniform_int_distribution<uint32_t> children(1, 8);
+
+	std::uniform_real_distribution<float> translation(-10.f, 10.f);
+	std::uniform_real_distribution<float> angle(0.f, 6.28f);
+	std::uniform_real_distribution<float> scale(.5f, 2.f);
+
+	std::vector<uint32_t> parents(n);
+	std::vector<vec128, aligned_allocator<vec128, 16>> t(n), r(n), s(n);
+
+	parents[0] = FUSE_TRANSFORM_INVALID_HANDLE;
+
+	for (size_t i = 1, parent = 0; i < n; parent++)
+	{
+		for (uint32_t k = children(generator); k > 0 && i < n; k--)
+		{
+			parents[i++] = (uint32_t) parent;
+		}
+	}
+
+	for (size_t i = 0; i < n; i++)
+	{
+		t[i] = vec128_set(translation(generator), translation(generator), translation(generator), 0.f);
+		r[i] = to_quat128(quaternion(float3(0, 1, 0), angle(generator)));
+		s[i] = vec128_set(scale(generator), scale(generator), scale(generator), 0.f);
+	}
+
+	std::vector<bench_transform_node*> nodes(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		nodes[i] = new bench_transform_node(i == 0 ? nullptr : nodes[parents[i]]);
+	}
+
+	transform_system system;
+	std::vector<transform_handle> handles(n);
+
+	system.reserve(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		handles[i] = system.create(i == 0 ? FUSE_TRANSFORM_INVALID_HANDLE : handles[parents[i]]);
+	}
+
+	// Moves a fraction of the transforms, then updates the world matrices
+
+	auto benchMove = [&](size_t stride, const char * variant)
+	{
+		double lazyTime = bench_run(repetitions,
+			[&]()
+		{
+			for (size_t i = 0; i < n; i += stride)
+			{
+				nodes[i]->set_local_translation(t[i]);
+				nodes[i]->set_local_rotation(r[i]);
+				nodes[i]->set_local_scale(s[i]);
+			}
+		},
+			[&]()
+		{
+			for (bench_transform_node * node : nodes)
+			{
+				node->update();
+			}
+		});
+
+		double systemTime = bench_run(repetitions,
+			[&]()
+		{
+			for (size_t i = 0; i < n; i += stride)
+			{
+				system.set_local_translation(handles[i], t[i]);
+				system.set_local_rotation(handles[i], r[i]);
+				system.set_local_scale(handles[i], s[i]);
+			}
+		},
+			[&]()
+		{
+			system.update();
+			system.clear_moved();
+		});
+
+		std::string lazyVariant   = std::string("lazy ") + variant;
+		std::string systemVariant = std::string("flat ") + variant;
+
+		reporter.add("transform update", lazyVariant.c_str(), lazyTime, n);
+		reporter.add("transform update", systemVariant.c_str(), systemTime, n);
+	};
+
+	benchMove(1, "all");
+	benchMove(10, "10%");
+
+	size_t mismatches = 0;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		if (std::memcmp(&nodes[i]->get_global_matrix(), &system.get_world_matrix(handles[i]), sizeof(mat128)))
+		{
+			mismatches++;
+		}
+	}
+
+	if (mismatches)
+	{
+		reporter.log() << "transform update: " << mismatches << " world matrices differ between lazy and flat" << std::endl;
+	}
+
+	for (bench_transform_node * node : nodes)
+	{
+		delete node;
+	}
+}
+
+/* Batched transform benchmarks */
+
+template <typename T>
+size_t bench_count_mismatches(const T * a, const T * b, size_t n)
+{
+	const float * fa = reinterpret_cast<const float*>(a);
+	const float * fb = reinterpret_cast<const float*>(b);
+
+	size_t mismatches = 0;
+
+	for (size_t i = 0; i < n * sizeof(T) / sizeof(float); i++)
+	{
+		if (std::abs(fa[i] - fb[i]) > 1e-3f * std::max(1.f, std::abs(fa[i])))
+		{
+			mismatches++;
+		}
+	}
+
+	return mismatches;
+}
+
+void bench_mat128_stream(bench_reporter & reporter, size_t n, int repetitions)
+{
+	using vec128_vector = std::vector<vec128, aligned_allocator<vec128, 16>>;
+	using mat128_vector = std::vector<mat128, aligned_allocator<mat128, 16>>;
+	using sphere_vector = std::vector<sphere, aligned_allocator<sphere, 16>>;
+
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> value(-100.f, 100.f);
+
+	mat128 m = to_scale4(vec128_set(1.f, 2.f, 3.f, 0.f)) *
+		(to_rotation4(to_quat128(quaternion(float3(0, 1, 0), 1.f))) * to_translation4(vec128_set(4.f, 5.f, 6.f, 0.f)));
+
+	std::vector<float3> points(n);
+	std::vector<float4> transformedPoints(n), expectedPoints(n);
+
+	vec128_vector vectors(n), transformedVectors(n), expectedVectors(n);
+	mat128_vector matrices(n), transformedMatrices(n), expectedMatrices(n);
+	sphere_vector spheres(n), transformedSpheres(n), expectedSpheres(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		points[i]  = float3(value(generator), value(generator), value(generator));
+		vectors[i] = vec128_set(value(generator), value(generator), value(generator), 1.f);
+		spheres[i] = sphere(points[i], std::abs(value(generator)));
+
+		for (int j = 0; j < 4; j++)
+		{
+			matrices[i].c[j] = vec128_set(value(generator), value(generator), value(generator), value(generator));
+		}
+	}
+
+	// The single element functions, one item at a time
+
+	double scalarPointsTime = bench_run(repetitions, [](){}, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			_mm_storeu_ps(expectedPoints[i].m, mat128_transform3(vec128_load(points[i]), m));
+		}
+	});
+
+	double scalarVectorsTime = bench_run(repetitions, [](){}, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			expectedVectors[i] = mat128_transform4(vectors[i], m);
+		}
+	});
+
+	double scalarMatricesTime = bench_run(repetitions, [](){}, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			expectedMatrices[i] = matrices[i] * m;
+		}
+	});
+
+	double scalarSpheresTime = bench_run(repetitions, [](){}, [&]()
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			expectedSpheres[i] = transform_affine(spheres[i], m);
+		}
+	});
+
+	reporter.add("mat128_transform3", "scalar", scalarPointsTime, n);
+	reporter.add("mat128_transform4", "scalar", scalarVectorsTime, n);
+	reporter.add("operator*<mat128>", "scalar", scalarMatricesTime, n);
+	reporter.add("transform_affine<sphere>", "scalar", scalarSpheresTime, n);
+
+	const std::pair<simd_instruction_set, const char *> instructionSets[] = {
+		{ FUSE_SIMD_SSE2, "sse2" },
+		{ FUSE_SIMD_SSE41, "sse4.1" },
+		{ FUSE_SIMD_AVX, "avx" },
+		{ FUSE_SIMD_AVX2, "avx2+fma" }
+	};
+
+	simd_instruction_set defaultInstructionSet = simd_get_instruction_set();
+
+	for (auto & instructionSet : instructionSets)
+	{
+		if (!simd_set_instruction_set(instructionSet.first))
+		{
+			continue;
+		}
+
+		double pointsTime = bench_run(repetitions, [](){}, [&]()
+		{
+			mat128_transform_stream(points.data(), transformedPoints.data(), n, m);
+		});
+
+		double vectorsTime = bench_run(repetitions, [](){}, [&]()
+		{
+			mat128_transform_stream(vectors.data(), transformedVectors.data(), n, m);
+		});
+
+		double matricesTime = bench_run(repetitions, [](){}, [&]()
+		{
+			mat128_multiply_stream(matrices.data(), transformedMatrices.data(), n, m);
+		});
+
+		double spheresTime = bench_run(repetitions, [](){}, [&]()
+		{
+			transform_affine(spheres.data(), transformedSpheres.data(), n, m);
+		});
+
+		reporter.add("mat128_transform_stream<float3>", instructionSet.second, pointsTime, n);
+		reporter.add("mat128_transform_stream<vec128>", instructionSet.second, vectorsTime, n);
+		reporter.add("mat128_multiply_stream", instructionSet.second, matricesTime, n);
+		reporter.add("transform_affine<sphere[]>", instructionSet.second, spheresTime, n);
+
+		size_t mismatches =
+			bench_count_mismatches(transformedPoints.data(), expectedPoints.data(), n) +
+			bench_count_mismatches(transformedVectors.data(), expectedVectors.data(), n) +
+			bench_count_mismatches(transformedMatrices.data(), expectedMatrices.data(), n) +
+			bench_count_mismatches(transformedSpheres.data(), expectedSpheres.data(), n);
+
+		if (mismatches)
+		{
+			reporter.log() << instructionSet.second << " streams: " << mismatches << " values differ from the scalar functions" << std::endl;
+		}
+	}
+
+	simd_set_instruction_set(defaultInstructionSet);
+}
+
+static void bench_usage(const char * executable)
+{
+	std::cerr << "Usage: " << executable << " [objects] [--filter <substring>] [--json <file>]" << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+	// math_bench [objects] [--filter <substring>] [--json <file>]
+
+	const int Repetitions = 10;
+
+	size_t      objects = 50000;
+	std::string filter;
+	std::string jsonFile;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--help" || argument == "-h")
+		{
+			bench_usage(argv[0]);
+			return 0;
+		}
+		else if (argument == "--filter" || argument == "--json")
+		{
+			if (i + 1 >= argc)
+			{
+				std::cerr << argument << " needs a value" << std::endl;
+				bench_usage(argv[0]);
+				return 1;
+			}
+
+			(argument == "--filter" ? filter : jsonFile) = argv[++i];
+		}
+		else
+		{
+			// The objects count, the whole argument has to be a number
+
+			size_t parsed = 0;
+
+			try
+			{
+				if (!argument.empty() && argument[0] != '-')
+				{
+					objects = std::stoul(argument, &parsed);
+				}
+			}
+			catch (const std::exception &)
+			{
+				parsed = 0;
+			}
+
+			if (parsed == 0 || parsed != argument.size())
+			{
+				std::cerr << "Unrecognized argument " << argument << std::endl;
+				bench_usage(argv[0]);
+				return 1;
+			}
+		}
+	}
+
+	bench_reporter reporter(std::cout, filter);
+
+	std::cout << "Objects: " << objects << ", repetitions: " << Repetitions << " (best time)" << std::endl;
+
+	if (reporter.enabled("loose_octree"))
+	{
+		bench_loose_octree<bench_octree>(reporter, "pool", objects, Repetitions);
+		bench_loose_octree_batch(reporter, objects, Repetitions);
+		bench_loose_octree<bench_octree_hashmap>(reporter, "hashmap", objects, Repetitions);
+	}
+
+	if (reporter.enabled("transform"))
+	{
+		bench_transforms(reporter, 1000000, Repetitions);
+	}
+
+	if (reporter.enabled("stream"))
+	{
+		bench_mat128_stream(reporter, 1000000, Repetitions);
+	}
+
+	bench_operations(reporter);
+
+	if (reporter.enabled("resource"))
+	{
+		bench_resource_manager(reporter);
+	}
+
+	if (reporter.enabled("pool_manager"))
+	{
+		bench_pool_manager(reporter);
+	}
+
+	if (reporter.enabled("transient_pool"))
+	{
+		bench_transient_pool(reporter);
+	}
+
+	if (reporter.enabled("frame_arena"))
+	{
+		bench_frame_arena(reporter);
+	}
+
+	if (reporter.enabled("slab_allocator"))
+	{
+		bench_slab_allocator(reporter);
+	}
+
+	if (reporter.enabled("mesh"))
+	{
+		bench_mesh_optimizer(reporter);
+		bench_mesh_simplifier(reporter);
+		bench_mesh_clusters(reporter);
+		bench_occlusion_buffer(reporter);
+		bench_tangent_space(reporter);
+	}
+
+	if (!jsonFile.empty())
+	{
+		std::ofstream json(jsonFile);
+
+		if (!json)
+		{
+			std::cerr << "Cannot open " << jsonFile << std::endl;
+			return 1;
+		}
+
+		reporter.write_json(json, argv[0]);
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -16,6 +16,12 @@ using namespace fuse;
 
 static std::ofstream g_log;
 
+#ifdef _MSC_VER
+#define TEST_FUNCTION_SIGNATURE __FUNCSIG__
+#else
+#define TEST_FUNCTION_SIGNATURE __PRETTY_FUNCTION__
+#endif
+
 std::ostream & operator<< (std::ostream & os, const Eigen::Quaternionf & q)
 {
 	quaternion r(q.w(), q.x(), q.y(), q.z());
@@ -33,12 +39,12 @@ void test_print_all(std::ostream & os, Arg1 && arg1, Args && ... args)
 
 #define TEST_SUCCESS_LOG(OutputStream)\
 {\
-	OutputStream << "Test " << __FUNCSIG__ << " OK" << std::endl;\
+	OutputStream << "Test " << TEST_FUNCTION_SIGNATURE << " OK" << std::endl;\
 }
 
 #define TEST_FAIL_LOG(OutputStream, Iteration, ...)\
 {\
-	OutputStream << "Test failed at " << __FUNCSIG__ << "@" << __FILE__ << ":" << __LINE__ << " Iteration #" << Iteration << std::endl;\
+	OutputStream << "Test failed at " << TEST_FUNCTION_SIGNATURE << "@" << __FILE__ << ":" << __LINE__ << " Iteration #" << Iteration << std::endl;\
 	test_print_all(OutputStream, __VA_ARGS__);\
 }
 
@@ -66,6 +66,15 @@ namespace fuse
 		mat128 worldViewProjection;
 	};
 
+	struct cb_vertex_decode
+	{
+		float3 positionScale;
+		float __fill0;
+
+		float3 positionOffset;
+		float __fill1;
+	};
+
 	struct cb_light
 	{
 		uint32_t type;
@@ -100,8 +109,9 @@ namespace fuse
 
 	struct cb_per_object
 	{
-		cb_transform transform;
-		cb_material  material;
+		cb_transform     transform;
+		cb_material      material;
+		cb_vertex_decode vertexDecode;
 	};
 
 	struct cb_per_light
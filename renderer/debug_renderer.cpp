@@ -169,7 +169,9 @@ void debug_renderer::render_lines(
 
 		}
 
-		m_lines.clear();
+		// A new vector rather than clear, the storage goes with the frame arena reset
+
+		m_lines = decltype(m_lines)();
 	}
 }
 
@@ -86,8 +86,8 @@ namespace fuse
 
 		debug_renderer_configuration m_configuration;
 
-		std::vector<debug_line>    m_lines;
-		std::vector<debug_texture> m_textures;
+		std::vector<debug_line, frame_allocator<debug_line>> m_lines;
+		std::vector<debug_texture>                           m_textures;
 
 		bool create_debug_pso(ID3D12Device * device);
 		bool create_debug_texture_pso(ID3D12Device * device);
@@ -92,10 +92,13 @@ void deferred_renderer::render_gbuffer(
 	mat128 viewProjection    = view * projection;
 	mat128 invViewProjection = mat128_inverse4(viewProjection);
 
+	frustum_planes_soa frustumPlanes(camera->get_frustum());
+
 	/* Setup the pipeline state */
 
-	auto queryPSO   = m_queryPST.get_pso_instance(device);
-	auto gbufferPSO = m_gbufferPST.get_pso_instance(device);
+	auto queryPSO             = m_queryPST.get_pso_instance(device);
+	auto gbufferPSO           = m_gbufferPST.get_pso_instance(device, { { "COMPRESSED_VERTICES", "0" } });
+	auto compressedGBufferPSO = m_gbufferPST.get_pso_instance(device, { { "COMPRESSED_VERTICES", "1" } });
 
 	commandList->SetPipelineState(gbufferPSO);
 
@@ -131,12 +134,42 @@ void deferred_renderer::render_gbuffer(
 
 	uint32_t objectIndex = 0;
 
+	ID3D12PipelineState * currentPSO = gbufferPSO;
+
 	/* Temp */
 
 	for (auto it = begin; it != end; it++)
 	{
 		scene_graph_geometry * geometry = *it;
 
+		gpu_mesh_ptr mesh = geometry->get_gpu_mesh();
+
+		if (!mesh || !mesh->load())
+		{
+			++objectIndex;
+			continue;
+		}
+
+		/* Cluster culling */
+
+		const mesh_lod & lod = mesh->get_lod(geometry->get_lod());
+
+		m_visibleRanges.clear();
+
+		if (m_clusterCulling && lod.firstIndex == 0 && mesh->get_num_clusters() > 1)
+		{
+			if (!m_clusterCuller.cull(mesh->get_clusters(), mesh->get_num_clusters(), geometry->get_global_matrix(), frustumPlanes, camera->get_position(), m_visibleRanges))
+			{
+				++objectIndex;
+				continue;
+			}
+		}
+		else
+		{
+			mesh_index_range range = { lod.firstIndex, lod.numIndices };
+			m_visibleRanges.push_back(range);
+		}
+
 		/* Fill buffer per object */
 
 		auto world = geometry->get_global_matrix();;
@@ -147,6 +180,9 @@ void deferred_renderer::render_gbuffer(
 		cbPerObject.transform.worldView           = world * view;
 		cbPerObject.transform.worldViewProjection = world * viewProjection;
 
+		cbPerObject.vertexDecode.positionScale  = mesh->get_position_scale();
+		cbPerObject.vertexDecode.positionOffset = mesh->get_position_offset();
+
 		auto objectMaterial = geometry->get_material();
 
 		material * materialData = (objectMaterial && objectMaterial->load()) ? objectMaterial.get() : &defaultMaterial;
@@ -166,16 +202,22 @@ void deferred_renderer::render_gbuffer(
 
 			commandList->SetGraphicsRootConstantBufferView(1, address);
 
-			gpu_mesh_ptr mesh = geometry->get_gpu_mesh();
-
 			/* Draw */
 
-			if (mesh && mesh->load())
+			ID3D12PipelineState * meshPSO = mesh->is_compressed() ? compressedGBufferPSO : gbufferPSO;
+
+			if (meshPSO != currentPSO)
 			{
-				commandList->IASetVertexBuffers(0, 2, mesh->get_vertex_buffers());
-				commandList->IASetIndexBuffer(&mesh->get_index_data());
+				commandList->SetPipelineState(meshPSO);
+				currentPSO = meshPSO;
+			}
+
+			commandList->IASetVertexBuffers(0, 2, mesh->get_vertex_buffers());
+			commandList->IASetIndexBuffer(&mesh->get_index_data());
 
-				commandList->DrawIndexedInstanced(mesh->get_num_indices(), 1, 0, 0, 0);
+			for (const mesh_index_range & range : m_visibleRanges)
+			{
+				commandList->DrawIndexedInstanced(range.numIndices, 1, range.firstIndex, 0, 0);
 			}
 		}
 
@@ -324,7 +366,7 @@ bool deferred_renderer::create_gbuffer_pso(ID3D12Device * device)
 		gbufferPSODesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 		gbufferPSODesc.pRootSignature        = m_gbufferRS.get();
 
-		m_gbufferPST = pipeline_state_template({},	gbufferPSODesc, "5_0");
+		m_gbufferPST = pipeline_state_template({ { "COMPRESSED_VERTICES", { "0", "1" } } }, gbufferPSODesc, "5_0");
 
 		m_gbufferPST.set_vertex_shader(FUSE_LITERAL("shaders/deferred_shading_gbuffer.hlsl"), "gbuffer_vs");
 		m_gbufferPST.set_pixel_shader(FUSE_LITERAL("shaders/deferred_shading_gbuffer.hlsl"), "gbuffer_ps");
@@ -336,11 +378,26 @@ bool deferred_renderer::create_gbuffer_pso(ID3D12Device * device)
 			// Adjust the input desc since gpu_mesh uses slot 0 for position and
 			// slot 1 for non position data (tangent space vectors, texcoords, ...)
 
-			if (strcmp(elementDesc.SemanticName, "POSITION"))
+			if (strcmp(elementDesc.SemanticName, "POSITION") && strcmp(elementDesc.SemanticName, "QPOSITION"))
 			{
 				elementDesc.InputSlot = 1;
 			}
 
+			// The compressed meshes attributes are not floats (see vertex_compression.hpp)
+
+			if (!strcmp(elementDesc.SemanticName, "QPOSITION"))
+			{
+				elementDesc.Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+			}
+			else if (!strcmp(elementDesc.SemanticName, "OCTNORMAL") || !strcmp(elementDesc.SemanticName, "OCTTANGENT"))
+			{
+				elementDesc.Format = DXGI_FORMAT_R16G16_SNORM;
+			}
+			else if (!strcmp(elementDesc.SemanticName, "HTEXCOORD"))
+			{
+				elementDesc.Format = DXGI_FORMAT_R16G16_FLOAT;
+			}
+
 		});
 
 		/* Occlusion query PSO */
@@ -8,6 +8,7 @@
 #include <fuse/camera.hpp>
 #include <fuse/directx_helper.hpp>
 #include <fuse/gpu_upload_manager.hpp>
+#include <fuse/mesh_clusters.hpp>
 #include <fuse/core/properties_macros.hpp>
 #include <fuse/gpu_command_queue.hpp>
 #include <fuse/gpu_graphics_command_list.hpp>
@@ -95,11 +96,24 @@ namespace fuse
 		deferred_renderer_configuration m_configuration;
 		const char * m_shadowMapAlgorithmDefine;
 
+		cluster_culler                m_clusterCuller;
+		std::vector<mesh_index_range> m_visibleRanges;
+
+		bool m_clusterCulling = true;
+
 		bool create_psos(ID3D12Device * device);
 		bool create_gbuffer_pso(ID3D12Device * device);
 		bool create_shading_pst(ID3D12Device * device);
 		bool create_skydome_pso(ID3D12Device * device);
 
+	public:
+
+		// Draws only the clusters of LOD 0 in the frustum and facing the camera
+
+		FUSE_PROPERTIES_BY_VALUE(
+			(cluster_culling, m_clusterCulling)
+		)
+
 	};
 
 }
@@ -3,8 +3,18 @@
 
 #include <sstream>
 
+// Width of the software occlusion buffer, the height follows the aspect ratio of the render
+
+#define FUSE_OCCLUSION_BUFFER_WIDTH 256
+
 using namespace fuse;
 
+static bool init_occlusion_buffer(occlusion_buffer & buffer, const uint2 & renderResolution)
+{
+	uint32_t height = (FUSE_OCCLUSION_BUFFER_WIDTH * renderResolution.y + renderResolution.x - 1) / renderResolution.x;
+	return buffer.init(FUSE_OCCLUSION_BUFFER_WIDTH, height);
+}
+
 bool realtime_renderer::init(gpu_render_context & renderContext, render_configuration * renderConfiguration)
 {
 	m_renderContext       = &renderContext;
@@ -39,7 +49,8 @@ bool realtime_renderer::init(gpu_render_context & renderContext, render_configur
 
 	return m_deferredRenderer.init(device, rendererCFG) &&
 		m_skydomeRenderer.init(device) &&
-		setup_shadow_mapping(device);
+		setup_shadow_mapping(device) &&
+		init_occlusion_buffer(m_occlusionBuffer, m_renderResolution);
 }
 
 void realtime_renderer::shutdown(void)
@@ -48,6 +59,7 @@ void realtime_renderer::shutdown(void)
 
 	m_deferredRenderer.shutdown();
 	m_skydomeRenderer.shutdown();
+	m_occlusionBuffer.shutdown();
 
 	m_gbufferSRVTable.clear();
 }
@@ -146,6 +158,35 @@ void realtime_renderer::render(D3D12_GPU_VIRTUAL_ADDRESS cbPerFrameAddress, scen
 
 	m_renderedGeometry = scene->frustum_culling(camera->get_frustum());
 
+	scene->select_lods(
+		m_renderedGeometry.begin(),
+		m_renderedGeometry.end(),
+		camera,
+		static_cast<float>(m_renderResolution.y),
+		m_renderConfiguration->get_lod_pixel_error());
+
+	// The shadows are cast by the geometry hidden from the camera too, only the gbuffer skips it.
+	// Copied in a new vector: the storage of the previous frame went with the frame arena reset.
+
+	m_visibleGeometry = frame_geometry_vector(m_renderedGeometry.begin(), m_renderedGeometry.end());
+
+	if (m_renderConfiguration->get_occlusion_culling())
+	{
+		auto visibleEnd = scene->occlusion_culling(
+			m_visibleGeometry.begin(),
+			m_visibleGeometry.end(),
+			camera,
+			m_occlusionBuffer,
+			m_renderConfiguration->get_max_occluders(),
+			m_threadPool);
+
+		m_visibleGeometry.erase(visibleEnd, m_visibleGeometry.end());
+	}
+	else
+	{
+		scene->release_occluders();
+	}
+
 	//FUSE_LOG(FUSE_LITERAL("realtime_renderer"), stringstream_t() << "Drawing " << m_renderables.size() << " objects.");
 
 	auto geometry = std::make_pair(m_renderedGeometry.begin(), m_renderedGeometry.end());
@@ -157,6 +198,8 @@ void realtime_renderer::render(D3D12_GPU_VIRTUAL_ADDRESS cbPerFrameAddress, scen
 	commandList->RSSetViewports(1, &fullscreenViewport);
 	commandList->RSSetScissorRects(1, &fullscreenScissorRect);
 
+	m_deferredRenderer.set_cluster_culling(m_renderConfiguration->get_cluster_culling());
+
 	m_deferredRenderer.render_gbuffer(
 		device,
 		commandQueue,
@@ -166,8 +209,8 @@ void realtime_renderer::render(D3D12_GPU_VIRTUAL_ADDRESS cbPerFrameAddress, scen
 		gbuffer,
 		*m_depthBuffer.get(),
 		camera,
-		geometry.first,
-		geometry.second);
+		m_visibleGeometry.begin(),
+		m_visibleGeometry.end());
 
 	//g_visualDebugger.add(device, commandList, bufferIndex, *gbufferResources[0].get(), XMUINT2(16, 16), g_visualDebugger.get_textures_scale());
 
@@ -284,6 +327,8 @@ void realtime_renderer::render(D3D12_GPU_VIRTUAL_ADDRESS cbPerFrameAddress, scen
 
 		/* Sun shadow map */
 
+		m_shadowMapper.set_lod_bias(m_renderConfiguration->get_shadow_lod_bias());
+
 		m_shadowMapper.render(
 			device,
 			commandQueue,
@@ -456,6 +501,7 @@ void realtime_renderer::update_render_configuration(void)
 			release_resources();
 			render_resource_manager::get_singleton_pointer()->clear();
 			m_renderResolution = m_renderConfiguration->get_render_resolution();
+			init_occlusion_buffer(m_occlusionBuffer, m_renderResolution);
 			break;
 
 		case FUSE_RVAR_VSM_FLOAT_PRECISION:
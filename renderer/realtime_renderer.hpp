@@ -64,7 +64,11 @@ namespace fuse
 
 		visual_debugger * m_visualDebugger;
 
-		geometry_vector m_renderedGeometry;
+		frame_geometry_vector m_renderedGeometry;
+		frame_geometry_vector m_visibleGeometry;
+
+		occlusion_buffer m_occlusionBuffer;
+		thread_pool    * m_threadPool = nullptr;
 
 		std::vector<scoped_cbv_uav_srv_descriptor> m_gbufferSRVTable;
 
@@ -75,10 +79,12 @@ namespace fuse
 
 		FUSE_PROPERTIES_BY_VALUE(
 			(visual_debugger, m_visualDebugger)
+			(thread_pool, m_threadPool)
 		)
 
 		FUSE_PROPERTIES_BY_CONST_REFERENCE_READ_ONLY(
 			(culling_results, m_renderedGeometry)
+			(visible_geometry, m_visibleGeometry)
 		)
 
 	};
@@ -2,9 +2,9 @@
 
 using namespace fuse;
 
-std::set<render_variables> render_configuration::get_updates(void)
+render_configuration::updates_set render_configuration::get_updates(void)
 {
-	std::set<render_variables> updates;
-	updates.swap(m_updatedVars);
+	updates_set updates(m_updatedVars.begin(), m_updatedVars.end());
+	m_updatedVars.clear();
 	return updates;
 }
\ No newline at end of file
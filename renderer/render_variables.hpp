@@ -14,6 +14,12 @@ enum render_variables
 
 	FUSE_RVAR_RENDER_RESOLUTION,
 
+	FUSE_RVAR_LOD_PIXEL_ERROR,
+	FUSE_RVAR_SHADOW_LOD_BIAS,
+	FUSE_RVAR_CLUSTER_CULLING,
+	FUSE_RVAR_OCCLUSION_CULLING,
+	FUSE_RVAR_MAX_OCCLUDERS,
+
 	FUSE_RVAR_SHADOW_MAP_RESOLUTION,
 
 	FUSE_RVAR_SHADOW_MAPPING_ALGORITHM,
@@ -50,12 +56,22 @@ namespace fuse
 		render_configuration(const render_configuration &) = delete;
 		render_configuration(render_configuration &&) = delete;
 
-		std::set<render_variables> get_updates(void);
+		// Allocated from the frame arena of the calling thread
+
+		using updates_set = std::set<render_variables, std::less<render_variables>, frame_allocator<render_variables>>;
+
+		updates_set get_updates(void);
 
 	private:
 
 		FUSE_RENDERER_VARIABLE(uint2, FUSE_RVAR_RENDER_RESOLUTION, render_resolution, 1280, 720)
 
+		FUSE_RENDERER_VARIABLE(float,    FUSE_RVAR_LOD_PIXEL_ERROR, lod_pixel_error, 1.f)
+		FUSE_RENDERER_VARIABLE(uint32_t, FUSE_RVAR_SHADOW_LOD_BIAS, shadow_lod_bias, 1)
+		FUSE_RENDERER_VARIABLE(bool,     FUSE_RVAR_CLUSTER_CULLING, cluster_culling, true)
+		FUSE_RENDERER_VARIABLE(bool,     FUSE_RVAR_OCCLUSION_CULLING, occlusion_culling, true)
+		FUSE_RENDERER_VARIABLE(uint32_t, FUSE_RVAR_MAX_OCCLUDERS, max_occluders, 16)
+
 		FUSE_RENDERER_VARIABLE(uint32_t, FUSE_RVAR_SHADOW_MAP_RESOLUTION, shadow_map_resolution, 1024)
 
 		FUSE_RENDERER_VARIABLE(shadow_mapping_algorithm, FUSE_RVAR_SHADOW_MAPPING_ALGORITHM, shadow_mapping_algorithm, FUSE_SHADOW_MAPPING_EVSM2)
@@ -1,6 +1,7 @@
 #include "renderer_application.hpp"
 
 #include <fuse/core.hpp>
+#include <fuse/core/thread_pool.hpp>
 
 #include <fuse/compile_shader.hpp>
 #include <fuse/pipeline_state.hpp>
@@ -75,6 +76,7 @@ std::array<render_resource, NUM_BUFFERS> g_sdsmConstantBuffer;
 
 std::unique_ptr<mipmap_generator> g_mipmapGenerator;
 std::unique_ptr<assimp_loader>    g_sceneLoader;
+std::unique_ptr<scene_cache>      g_sceneCache;
 								       
 resource_factory                     g_resourceFactory;
 std::unique_ptr<image_manager>       g_imageManager;
@@ -96,6 +98,7 @@ fps_camera_controller g_cameraController;
 bitmap_font_ptr    g_font;
 
 scene              g_scene;
+thread_pool        g_updateThreadPool;
 
 realtime_renderer g_realtimeRenderer;
 text_renderer     g_textRenderer;
@@ -272,6 +275,10 @@ bool renderer_application::on_render_context_created(gpu_render_context & render
 
 	composerCFG.rtvFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
 
+	// The occlusion culling shares the pool of the scene updates
+
+	g_realtimeRenderer.set_thread_pool(&g_updateThreadPool);
+
 	if (g_realtimeRenderer.init(m_renderContext, &g_renderConfiguration) &&
 		g_visualDebugger.init(device, debugRendererCFG) &&
 	    g_tonemapper.init(device) &&
@@ -319,11 +326,37 @@ bool renderer_application::import_scene(const char_t * filename)
 
 	commandList.reset_command_list(nullptr);
 
-	g_sceneLoader = std::make_unique<assimp_loader>(filename);
+	// Assimp is skipped when the scene cache was written from the same file
+
+	g_sceneCache = std::make_unique<scene_cache>(filename);
 
 	g_scene.clear();
 
-	if (!g_scene.import(g_sceneLoader.get()) ||
+	bool imported = false;
+
+	if (g_sceneCache->read())
+	{
+		g_sceneLoader.reset();
+		imported = g_scene.import(g_sceneCache.get(), g_updateThreadPool);
+
+		// Corrupted meshes in the cache, they are imported and written again
+
+		if (!imported)
+		{
+			g_scene.clear();
+		}
+	}
+
+	if (!imported)
+	{
+		g_sceneLoader = std::make_unique<assimp_loader>(filename);
+		g_scene.set_compress_meshes(true);
+		g_scene.set_generate_lods(true);
+		g_scene.set_build_clusters(true);
+		imported = g_scene.import(g_sceneLoader.get(), g_updateThreadPool, g_sceneCache.get());
+	}
+
+	if (!imported ||
 	    //!g_scene.import_cameras(g_sceneLoader.get()) ||
 	    //!g_scene.import_lights(g_sceneLoader.get()) ||
 	    !g_scene.get_skydome()->init(get_device(), SKYDOME_WIDTH, SKYDOME_HEIGHT, NUM_BUFFERS))
@@ -511,7 +544,7 @@ void renderer_application::on_update(float dt)
 	std::lock_guard<std::mutex> updateLock(g_updateMutex);
 
 	g_cameraController.on_update(dt);
-	g_scene.update();
+	g_scene.update(g_updateThreadPool);
 }
 
 void renderer_application::upload_per_frame_resources(ID3D12Device * device, gpu_command_queue & commandQueue, gpu_graphics_command_list & commandList, gpu_ring_buffer & ringBuffer, ID3D12Resource * cbPerFrameBuffer)
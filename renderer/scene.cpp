@@ -2,17 +2,23 @@
 
 #include <fuse/resource_factory.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <iterator>
 #include <stack>
+#include <unordered_map>
 
 using namespace fuse;
 
 #define OCTREE_MAX_DEPTH 9
 
-FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(scene, 16)
+FUSE_DEFINE_TAGGED_ALIGNED_ALLOCATOR_NEW(scene, 16, FUSE_MEMORY_TAG_SCENE)
 
 scene::scene(void) :
 	m_boundsGrowth(true),
+	m_compressMeshes(false),
+	m_generateLods(false),
+	m_buildClusters(false),
 	m_activeCamera(nullptr) {}
 
 static const float3 & to_float3(const aiVector3D & color)
@@ -90,7 +96,7 @@ aiCamera * find_camera(const aiScene * scene, aiNode * node)
 	return nullptr;
 }
 
-void scene::create_scene_graph_assimp(assimp_loader * loader, const aiScene * scene, aiNode * node, scene_graph_node * parent)
+void scene::create_scene_graph_assimp(assimp_loader * loader, const aiScene * scene, aiNode * node, scene_graph_node * parent, std::vector<std::pair<scene_graph_geometry*, aiNode*>> & geometry)
 {
 	if (node)
 	{
@@ -132,56 +138,14 @@ void scene::create_scene_graph_assimp(assimp_loader * loader, const aiScene * sc
 
 			for (int i = 0; i < node->mNumChildren; ++i)
 			{
-				create_scene_graph_assimp(loader, scene, node->mChildren[i], newNode);
+				create_scene_graph_assimp(loader, scene, node->mChildren[i], newNode, geometry);
 			}
 
 			switch (newNode->get_type())
 			{
 			case FUSE_SCENE_GRAPH_GEOMETRY:
-			{
-				scene_graph_geometry * gNode = static_cast<scene_graph_geometry*>(newNode);
-
-				unsigned int meshIndex = node->mMeshes[0];
-				unsigned int materialIndex = scene->mMeshes[meshIndex]->mMaterialIndex;
-
-				mesh_ptr nodeMesh = loader->create_mesh(meshIndex);
-
-				if (nodeMesh && nodeMesh->load())
-				{
-
-					if (!nodeMesh->has_storage_semantic(FUSE_MESH_STORAGE_TANGENTS))
-					{
-						nodeMesh->calculate_tangent_space();
-					}
-
-					// TODO: remove phony texcoords to handle the objects with no diffuse texture (add shaders permutations)
-
-					if (nodeMesh->add_storage_semantic(FUSE_MESH_STORAGE_TEXCOORDS0))
-					{
-						FUSE_LOG_OPT(FUSE_LITERAL("assimp_loader"), FUSE_LITERAL("Added phony texcoords to mesh."));
-					}
-
-					gpu_mesh_ptr nodeGPUMesh = resource_factory::get_singleton_pointer()->create<gpu_mesh>(FUSE_RESOURCE_TYPE_GPU_MESH, nodeMesh->get_name());
-					material_ptr nodeMaterial = loader->create_material(materialIndex);
-
-					if (nodeGPUMesh && nodeGPUMesh->load() &&
-						nodeMaterial && nodeMaterial->load())
-					{
-						sphere s = bounding_sphere(
-							reinterpret_cast<const float3 *>(nodeMesh->get_vertices()),
-							reinterpret_cast<const float3 *>(nodeMesh->get_vertices()) + nodeMesh->get_num_vertices());
-
-						gNode->set_local_bounding_sphere(s);
-
-						gNode->set_gpu_mesh(nodeGPUMesh);
-						gNode->set_material(nodeMaterial);
-
-						m_geometry.push_back(gNode);
-					}
-				}
-
-				on_geometry_add(static_cast<scene_graph_geometry*>(newNode));
-			}
+				// Loaded in parallel once the whole graph is created
+				geometry.emplace_back(static_cast<scene_graph_geometry*>(newNode), node);
 				break;
 			case FUSE_SCENE_GRAPH_CAMERA:
 			{
@@ -212,7 +176,68 @@ void scene::create_scene_graph_assimp(assimp_loader * loader, const aiScene * sc
 	}
 }
 
+static void cache_scene_graph(scene_cache * cache, scene_graph_node * node, uint32_t parent, const std::unordered_map<scene_graph_node*, std::pair<uint32_t, uint32_t>> & geometry)
+{
+	scene_cache_node cached = {};
+
+	cached.type        = node->get_type();
+	cached.parent      = parent;
+	cached.name        = node->get_name();
+
+	cached.translation = to_float3(node->get_local_translation());
+	cached.rotation    = to_quaternion(node->get_local_rotation());
+	cached.scale       = to_float3(node->get_local_scale());
+
+	cached.mesh        = FUSE_SCENE_CACHE_INVALID_INDEX;
+	cached.material    = FUSE_SCENE_CACHE_INVALID_INDEX;
+
+	switch (node->get_type())
+	{
+	case FUSE_SCENE_GRAPH_GEOMETRY:
+	{
+		scene_graph_geometry * gNode = static_cast<scene_graph_geometry*>(node);
+
+		auto it = geometry.find(node);
+
+		if (it != geometry.end())
+		{
+			cached.mesh     = it->second.first;
+			cached.material = it->second.second;
+		}
+
+		cached.boundingSphere = to_float4(gNode->get_local_bounding_sphere().get_sphere_vector());
+	}
+		break;
+	case FUSE_SCENE_GRAPH_CAMERA:
+	{
+		const camera * cam = static_cast<scene_graph_camera*>(node)->get_camera();
+
+		cached.cameraPosition    = cam->get_position();
+		cached.cameraOrientation = cam->get_orientation();
+		cached.znear             = cam->get_znear();
+		cached.zfar              = cam->get_zfar();
+	}
+		break;
+	}
+
+	uint32_t index = static_cast<uint32_t>(cache->get_nodes().size());
+
+	cache->add_node(cached);
+
+	for (scene_graph_node * child : *node)
+	{
+		cache_scene_graph(cache, child, index, geometry);
+	}
+}
+
 bool scene::import(assimp_loader * loader)
+{
+	// No workers, everything is loaded by the calling thread in wait()
+	thread_pool pool(0);
+	return import(loader, pool);
+}
+
+bool scene::import(assimp_loader * loader, thread_pool & pool, scene_cache * cache)
 {
 	if (!loader->is_loaded())
 	{
@@ -221,12 +246,260 @@ bool scene::import(assimp_loader * loader)
 	
 	const aiScene * scene = loader->get_scene();
 
-	create_scene_graph_assimp(loader, scene, scene->mRootNode, m_sceneGraph.get_root());
+	std::vector<std::pair<scene_graph_geometry*, aiNode*>> geometry;
+
+	create_scene_graph_assimp(loader, scene, scene->mRootNode, m_sceneGraph.get_root(), geometry);
+	m_activeCamera = m_cameras.empty() ? nullptr : m_cameras[0];
+
+	// The cache is rebuilt from the files Assimp read, the textures are added with the materials
+
+	if (cache)
+	{
+		cache->clear();
+
+		for (const string_t & filename : loader->get_source_files())
+		{
+			cache->add_source_file(filename.c_str());
+		}
+	}
+
+	// Each mesh is loaded by one task (nodes can share meshes), which then loads its GPU
+	// mesh asynchronously. The materials are loaded asynchronously too. The loader processes
+	// the meshes as it loads them, so the meshes evicted by a resource budget load the same.
+
+	std::vector<bool>    meshQueued(scene->mNumMeshes, false);
+	std::vector<uint8_t> meshCached(scene->mNumMeshes, 0);
+	std::vector<float4>  meshBounds(scene->mNumMeshes);
+
+	loader->set_compress_meshes(m_compressMeshes);
+	loader->set_generate_lods(m_generateLods);
+	loader->set_build_clusters(m_buildClusters);
+	loader->set_thread_pool(&pool);
+
+	for (auto & g : geometry)
+	{
+		unsigned int meshIndex     = g.second->mMeshes[0];
+		unsigned int materialIndex = scene->mMeshes[meshIndex]->mMaterialIndex;
+
+		if (!meshQueued[meshIndex])
+		{
+			meshQueued[meshIndex] = true;
+
+			pool.enqueue([loader, meshIndex, cache, &meshCached, &meshBounds, &pool]()
+			{
+				mesh_ptr nodeMesh = loader->create_mesh(meshIndex);
+
+				if (nodeMesh && nodeMesh->load())
+				{
+
+					// The decoded positions, as the mesh can be compressed already
+
+					std::vector<float3> positions(nodeMesh->get_num_vertices());
+
+					for (uint32_t i = 0; i < nodeMesh->get_num_vertices(); i++)
+					{
+						positions[i] = nodeMesh->decode_position(i);
+					}
+
+					sphere s = bounding_sphere(positions.data(), positions.data() + positions.size());
+
+					meshBounds[meshIndex] = to_float4(s.get_sphere_vector());
+
+					if (cache)
+					{
+						meshCached[meshIndex] = cache->save_mesh(meshIndex, nodeMesh.get());
+					}
+
+					gpu_mesh_ptr nodeGPUMesh = resource_factory::get_singleton_pointer()->create<gpu_mesh>(FUSE_RESOURCE_TYPE_GPU_MESH, nodeMesh->get_name());
+
+					if (nodeGPUMesh)
+					{
+						nodeGPUMesh->load_async(pool);
+					}
+
+				}
+			});
+		}
+
+		material_ptr nodeMaterial = loader->create_material(materialIndex);
+
+		if (nodeMaterial)
+		{
+			nodeMaterial->load_async(pool);
+		}
+	}
+
+	pool.wait();
+
+	// Mesh and material of the geometry nodes to write in the cache
+
+	std::unordered_map<scene_graph_node*, std::pair<uint32_t, uint32_t>> cachedGeometry;
+
+	for (auto & g : geometry)
+	{
+		scene_graph_geometry * gNode = g.first;
+
+		unsigned int meshIndex     = g.second->mMeshes[0];
+		unsigned int materialIndex = scene->mMeshes[meshIndex]->mMaterialIndex;
+
+		mesh_ptr     nodeMesh     = loader->create_mesh(meshIndex);
+		material_ptr nodeMaterial = loader->create_material(materialIndex);
+		gpu_mesh_ptr nodeGPUMesh  = nodeMesh ? resource_factory::get_singleton_pointer()->create<gpu_mesh>(FUSE_RESOURCE_TYPE_GPU_MESH, nodeMesh->get_name()) : nullptr;
+
+		// Loaded already unless evicted meanwhile by a resource budget
+
+		if (nodeGPUMesh && nodeGPUMesh->load() &&
+			nodeMaterial && nodeMaterial->load() &&
+			nodeMesh->load())
+		{
+			gNode->set_local_bounding_sphere(sphere(to_vec128(meshBounds[meshIndex])));
+
+			gNode->set_gpu_mesh(nodeGPUMesh);
+			gNode->set_material(nodeMaterial);
+
+			m_geometry.push_back(gNode);
+
+			if (cache && meshCached[meshIndex])
+			{
+				cache->save_material(materialIndex, nodeMaterial.get());
+				cachedGeometry[gNode] = std::make_pair(meshIndex, materialIndex);
+			}
+		}
+
+		on_geometry_add(gNode);
+	}
+
+	if (cache)
+	{
+		for (scene_graph_node * child : *m_sceneGraph.get_root())
+		{
+			cache_scene_graph(cache, child, FUSE_SCENE_CACHE_INVALID_INDEX, cachedGeometry);
+		}
+
+		if (!cache->write())
+		{
+			FUSE_LOG_OPT_DEBUG(FUSE_LITERAL("Failed to write the scene cache."));
+		}
+	}
+
+	return true;
+}
+
+bool scene::import(scene_cache * cache, thread_pool & pool)
+{
+	std::vector<std::pair<scene_graph_geometry*, const scene_cache_node*>> geometry;
+
+	create_scene_graph_cache(cache, geometry);
 	m_activeCamera = m_cameras.empty() ? nullptr : m_cameras[0];
 
+	// The meshes were processed before being cached, they are just mapped from
+	// their .fmesh files when the GPU meshes load them as dependencies
+
+	for (auto & g : geometry)
+	{
+		if (g.second->mesh == FUSE_SCENE_CACHE_INVALID_INDEX)
+		{
+			continue;
+		}
+
+		gpu_mesh_ptr nodeGPUMesh  = resource_factory::get_singleton_pointer()->create<gpu_mesh>(FUSE_RESOURCE_TYPE_GPU_MESH, cache->get_mesh_filename(g.second->mesh).c_str());
+		material_ptr nodeMaterial = cache->create_material(g.second->material);
+
+		if (nodeGPUMesh)
+		{
+			nodeGPUMesh->load_async(pool);
+		}
+
+		if (nodeMaterial)
+		{
+			nodeMaterial->load_async(pool);
+		}
+	}
+
+	pool.wait();
+
+	for (auto & g : geometry)
+	{
+		scene_graph_geometry   * gNode  = g.first;
+		const scene_cache_node * cached = g.second;
+
+		if (cached->mesh != FUSE_SCENE_CACHE_INVALID_INDEX)
+		{
+			gpu_mesh_ptr nodeGPUMesh  = resource_factory::get_singleton_pointer()->create<gpu_mesh>(FUSE_RESOURCE_TYPE_GPU_MESH, cache->get_mesh_filename(cached->mesh).c_str());
+			material_ptr nodeMaterial = cache->create_material(cached->material);
+
+			// A mesh that fails to load is corrupted, the scene needs to be imported again
+
+			if (!nodeGPUMesh || !nodeGPUMesh->load() ||
+				!nodeMaterial || !nodeMaterial->load())
+			{
+				FUSE_LOG_OPT_DEBUG(stringstream_t() << "Failed to load \"" << cache->get_mesh_filename(cached->mesh) << "\" from the scene cache.");
+				return false;
+			}
+
+			gNode->set_local_bounding_sphere(sphere(to_vec128(cached->boundingSphere)));
+
+			gNode->set_gpu_mesh(nodeGPUMesh);
+			gNode->set_material(nodeMaterial);
+
+			m_geometry.push_back(gNode);
+		}
+
+		on_geometry_add(gNode);
+	}
+
 	return true;
 }
 
+void scene::create_scene_graph_cache(scene_cache * cache, std::vector<std::pair<scene_graph_geometry*, const scene_cache_node*>> & geometry)
+{
+	const std::vector<scene_cache_node> & nodes = cache->get_nodes();
+
+	std::vector<scene_graph_node*> created(nodes.size());
+
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		const scene_cache_node & cached = nodes[i];
+
+		scene_graph_node * parent = cached.parent < i ? created[cached.parent] : m_sceneGraph.get_root();
+		scene_graph_node * newNode;
+
+		switch (cached.type)
+		{
+		case FUSE_SCENE_GRAPH_GEOMETRY:
+			newNode = parent->add_child<scene_graph_geometry>();
+			geometry.emplace_back(static_cast<scene_graph_geometry*>(newNode), &cached);
+			break;
+		case FUSE_SCENE_GRAPH_CAMERA:
+		{
+			scene_graph_camera * cNode = parent->add_child<scene_graph_camera>();
+			camera * cam = cNode->get_camera();
+
+			cam->set_position(cached.cameraPosition);
+			cam->set_orientation(cached.cameraOrientation);
+			cam->set_znear(cached.znear);
+			cam->set_zfar(cached.zfar);
+
+			m_cameras.push_back(cNode);
+
+			newNode = cNode;
+		}
+			break;
+		default:
+			newNode = parent->add_child<scene_graph_group>();
+			break;
+		}
+
+		newNode->set_name(cached.name.c_str());
+
+		newNode->set_local_rotation(cached.rotation);
+		newNode->set_local_translation(cached.translation);
+		newNode->set_local_scale(cached.scale);
+
+		created[i] = newNode;
+	}
+}
+
 static bool find_node_by_name(const aiScene * scene, const aiString & name, aiNode ** outNode, mat128 * outTransform)
 {
 	*outNode = nullptr;
@@ -346,7 +619,7 @@ bool scene::import_lights(assimp_loader * loader)
 	return true;
 }
 
-std::pair<geometry_iterator, geometry_iterator> scene::get_geometry(void)
+std::pair<geometry_vector::iterator, geometry_vector::iterator> scene::get_geometry(void)
 {
 	return std::make_pair(m_geometry.begin(), m_geometry.end());
 }
@@ -387,17 +660,190 @@ void scene::recalculate_octree(void)
 	});
 }
 
-geometry_vector scene::frustum_culling(const frustum & f)
+frame_geometry_vector scene::frustum_culling(const frustum & f)
 {
-	geometry_vector geometry;
-	m_octree.query(f, [&](scene_graph_geometry * r) { geometry.push_back(r); });
+	frame_geometry_vector geometry;
+	m_octree.query_batch(f, geometry);
 	return geometry;
 }
 
+void scene::select_lods(geometry_iterator begin, geometry_iterator end, const camera * camera, float viewportHeight, float pixelError)
+{
+	// Pixels covered by one unit at distance one
+
+	float projection = .5f * viewportHeight / std::tan(.5f * camera->get_fovy());
+	float3 eye       = camera->get_position();
+
+	for (auto it = begin; it != end; it++)
+	{
+		scene_graph_geometry * g = *it;
+
+		gpu_mesh_ptr gpuMesh = g->get_gpu_mesh();
+
+		uint32_t lod = 0;
+
+		if (gpuMesh && gpuMesh->load())
+		{
+			float4 globalSphere = to_float4(g->get_global_bounding_sphere().get_sphere_vector());
+			float4 localSphere  = to_float4(g->get_local_bounding_sphere().get_sphere_vector());
+
+			float3 center   = float3(globalSphere.x, globalSphere.y, globalSphere.z) - eye;
+			float  distance = std::sqrt(dot(center, center)) - globalSphere.w;
+
+			// The LOD errors are in object space, the ratio of the radii brings them to world space
+
+			if (distance > 0.f && localSphere.w > 0.f)
+			{
+				float pixelsPerUnit = projection * globalSphere.w / (distance * localSphere.w);
+
+				while (lod + 1 < gpuMesh->get_num_lods() && gpuMesh->get_lod(lod + 1).error * pixelsPerUnit <= pixelError)
+				{
+					++lod;
+				}
+			}
+		}
+
+		g->set_lod(lod);
+	}
+}
+
+geometry_iterator scene::occlusion_culling(geometry_iterator begin, geometry_iterator end, const camera * camera, occlusion_buffer & buffer, uint32_t maxOccluders, thread_pool * pool)
+{
+	mat128 viewProjection = mat128_load(camera->get_view_matrix() * camera->get_projection_matrix());
+
+	buffer.clear(viewProjection);
+
+	// Pixels of the buffer covered by one unit at distance one
+
+	float projection = .5f * buffer.get_height() / std::tan(.5f * camera->get_fovy());
+	float3 eye       = camera->get_position();
+
+	// The geometry with the largest projected bounding sphere makes the occluders
+
+	std::vector<std::pair<float, scene_graph_geometry*>> candidates;
+
+	for (auto it = begin; it != end; it++)
+	{
+		scene_graph_geometry * g = *it;
+
+		if (g->get_gpu_mesh())
+		{
+			float4 globalSphere = to_float4(g->get_global_bounding_sphere().get_sphere_vector());
+
+			float3 center   = float3(globalSphere.x, globalSphere.y, globalSphere.z) - eye;
+			float  distance = std::max(std::sqrt(dot(center, center)), globalSphere.w);
+			float  radius   = projection * globalSphere.w / distance;
+
+			if (radius >= FUSE_SCENE_MIN_OCCLUDER_RADIUS)
+			{
+				candidates.emplace_back(radius, g);
+			}
+		}
+	}
+
+	size_t numOccluders = std::min<size_t>(maxOccluders, candidates.size());
+
+	std::partial_sort(candidates.begin(), candidates.begin() + numOccluders, candidates.end(),
+		[](const std::pair<float, scene_graph_geometry*> & a, const std::pair<float, scene_graph_geometry*> & b) { return a.first > b.first; });
+
+	// The CPU mesh is the dependency of the GPU mesh, named after it. Only the occluders
+	// of this frame hold it so the other meshes can be evicted by the resource manager.
+
+	std::vector<mesh_ptr> occluderMeshes;
+
+	occluderMeshes.reserve(numOccluders);
+
+	for (size_t i = 0; i < numOccluders; i++)
+	{
+		scene_graph_geometry * g = candidates[i].second;
+
+		mesh_ptr mesh = resource_factory::get_singleton_pointer()->create<fuse::mesh>(FUSE_RESOURCE_TYPE_MESH, g->get_gpu_mesh()->get_name());
+
+		if (!mesh)
+		{
+			continue;
+		}
+
+		occluderMeshes.push_back(mesh);
+
+		// Checked under the mesh lock, the status alone could be read while an eviction unloads it
+
+		if (pool)
+		{
+			if (!mesh->is_loaded())
+			{
+				mesh->load_async(*pool);
+				continue;
+			}
+		}
+		else if (!mesh->load())
+		{
+			continue;
+		}
+
+		float4 globalSphere = to_float4(g->get_global_bounding_sphere().get_sphere_vector());
+		float4 localSphere  = to_float4(g->get_local_bounding_sphere().get_sphere_vector());
+
+		// The coarsest LOD whose error stays under a pixel of the buffer, the LODs only
+		// use vertices of the mesh so they never leave its bounding box
+
+		float3   center   = float3(globalSphere.x, globalSphere.y, globalSphere.z) - eye;
+		float    distance = std::sqrt(dot(center, center)) - globalSphere.w;
+		uint32_t lod      = 0;
+
+		if (distance > 0.f && localSphere.w > 0.f)
+		{
+			float pixelsPerUnit = projection * globalSphere.w / (distance * localSphere.w);
+
+			while (lod + 1 < mesh->get_num_lods() && mesh->get_lod(lod + 1).error * pixelsPerUnit <= 1.f)
+			{
+				++lod;
+			}
+		}
+
+		const uint32_t * indices    = mesh->get_lod_indices(lod);
+		uint32_t         numIndices = mesh->get_lod(lod).numIndices;
+
+		if (mesh->is_compressed())
+		{
+			buffer.add_occluder(
+				mesh->get_compressed_positions(), mesh->get_num_vertices(),
+				indices, numIndices,
+				g->get_global_matrix(),
+				mesh->get_position_scale(),
+				mesh->get_position_offset());
+		}
+		else
+		{
+			buffer.add_occluder(
+				reinterpret_cast<const float3 *>(mesh->get_vertices()), mesh->get_num_vertices(),
+				indices, numIndices,
+				g->get_global_matrix());
+		}
+	}
+
+	buffer.render(pool);
+
+	m_occluderMeshes.swap(occluderMeshes);
+
+	return std::remove_if(begin, end, [&buffer](scene_graph_geometry * g)
+	{
+		vec128 sphere = g->get_global_bounding_sphere().get_sphere_vector();
+		vec128 radius = vec128_splat<FUSE_W>(sphere);
+
+		return !buffer.test(aabb::from_center_half_extents(sphere, radius));
+	});
+}
+
+void scene::release_occluders(void)
+{
+	m_occluderMeshes.clear();
+}
+
 void scene::draw_octree(visual_debugger * debugger)
 {
 	m_octree.traverse(
-		[=](const aabb & aabb, geometry_octree::objects_list_iterator begin, geometry_octree::objects_list_iterator end)
+		[=](const aabb & aabb, geometry_octree::objects_iterator begin, geometry_octree::objects_iterator end)
 	{
 		debugger->add(aabb, color_rgba(1, 0, 0, 1));
 	});
@@ -458,6 +904,11 @@ void scene::update(void)
 	m_sceneGraph.update();
 }
 
+void scene::update(thread_pool & pool)
+{
+	m_sceneGraph.update(pool);
+}
+
 void scene::on_geometry_add(scene_graph_geometry * g)
 {
 	g->add_listener(this);
@@ -481,6 +932,30 @@ void scene::on_scene_graph_node_move(scene_graph_node * node, const mat128 & old
 	}
 }
 
+void scene::on_scene_graph_node_move_batch(const std::vector<const scene_graph_node_move*> & moves)
+{
+	// Take all the moved geometry out of the octree first, then reinsert it
+	// refitting the octree only once if anything ended up out of bounds
+
+	for (const scene_graph_node_move * move : moves)
+	{
+		scene_graph_geometry * g = static_cast<scene_graph_geometry*>(move->node);
+		m_octree.remove(g, transform_affine(g->get_local_bounding_sphere(), move->oldTransform));
+	}
+
+	bool outOfBounds = false;
+
+	for (const scene_graph_node_move * move : moves)
+	{
+		outOfBounds |= !m_octree.insert(static_cast<scene_graph_geometry*>(move->node));
+	}
+
+	if (outOfBounds && m_boundsGrowth)
+	{
+		fit_octree();
+	}
+}
+
 bool FUSE_VECTOR_CALL scene::ray_pick(ray r, scene_graph_geometry * & node, float & t)
 {
 	return m_octree.ray_pick(r, node, t);
@@ -4,15 +4,21 @@
 #include <fuse/assimp_loader.hpp>
 #include <fuse/camera.hpp>
 #include <fuse/geometry/loose_octree.hpp>
+#include <fuse/occlusion_buffer.hpp>
 #include <fuse/scene_graph.hpp>
 
 #include "light.hpp"
+#include "scene_cache.hpp"
 #include "skydome.hpp"
 #include "visual_debugger.hpp"
 
 #include <vector>
 #include <utility>
 
+// Projected radius, in pixels of the occlusion buffer, of the smallest occluders
+
+#define FUSE_SCENE_MIN_OCCLUDER_RADIUS 4.f
+
 namespace fuse
 {
 
@@ -26,7 +32,11 @@ namespace fuse
 
 	using geometry_octree   = loose_octree<scene_graph_geometry*, sphere, geometry_bounding_sphere>;
 	using geometry_vector   = std::vector<scene_graph_geometry*>;
-	using geometry_iterator = geometry_vector::iterator;
+
+	// The culling results only live for the frame, they are allocated from the frame arena of the render thread
+
+	using frame_geometry_vector = std::vector<scene_graph_geometry*, frame_allocator<scene_graph_geometry*>>;
+	using geometry_iterator     = frame_geometry_vector::iterator;
 
 	using camera_vector   = std::vector<scene_graph_camera*>;
 	using camera_iterator = camera_vector::iterator;
@@ -48,7 +58,7 @@ namespace fuse
 
 	public:
 
-		FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+		FUSE_DECLARE_TAGGED_ALIGNED_ALLOCATOR_NEW(16, FUSE_MEMORY_TAG_SCENE)
 
 		scene(void);
 		scene(const scene &) = delete;
@@ -57,10 +67,12 @@ namespace fuse
 		void clear(void);
 
 		bool import(assimp_loader * loader);
+		bool import(assimp_loader * loader, thread_pool & pool, scene_cache * cache = nullptr);
+		bool import(scene_cache * cache, thread_pool & pool);
 		bool import_cameras(fuse::assimp_loader * loader);
 		bool import_lights(fuse::assimp_loader * loader);
 
-		std::pair<geometry_iterator, geometry_iterator> get_geometry(void);
+		std::pair<geometry_vector::iterator, geometry_vector::iterator> get_geometry(void);
 		std::pair<camera_iterator, camera_iterator>     get_cameras(void);
 		std::pair<light_iterator, light_iterator>       get_lights(void);
 
@@ -68,7 +80,21 @@ namespace fuse
 
 		void recalculate_octree(void);
 
-		geometry_vector frustum_culling(const frustum & f);
+		frame_geometry_vector frustum_culling(const frustum & f);
+
+		// Picks the coarsest LOD of each geometry whose error, scaled as the projected
+		// bounding sphere, stays under pixelError pixels on a viewport viewportHeight high
+
+		void select_lods(geometry_iterator begin, geometry_iterator end, const camera * camera, float viewportHeight, float pixelError);
+
+		// Draws the (at most maxOccluders) geometry with the largest projected bounding sphere in
+		// the occlusion buffer, then removes the geometry whose bounding box is hidden behind it
+		// and returns the new end of the range. The CPU meshes of the occluders are held until
+		// the next call or release_occluders(), the ones still loading are skipped meanwhile.
+
+		geometry_iterator occlusion_culling(geometry_iterator begin, geometry_iterator end, const camera * camera, occlusion_buffer & buffer, uint32_t maxOccluders, thread_pool * pool = nullptr);
+
+		void release_occluders(void);
 
 		inline void set_scene_bounds(const vec128 & center, float halfExtents) { m_sceneBounds = aabb::from_center_half_extents(center, vec128_set(halfExtents, halfExtents, halfExtents, halfExtents)); }
 		inline aabb get_scene_bounds(void) const { return m_sceneBounds; }
@@ -93,8 +119,10 @@ namespace fuse
 		void remove_listener(scene_listener * listener);
 
 		void update(void);
+		void update(thread_pool & pool);
 
 		void on_scene_graph_node_move(scene_graph_node * node, const mat128 & oldTransform, const mat128 & newTransform);
+		void on_scene_graph_node_move_batch(const std::vector<const scene_graph_node_move*> & moves);
 
 		bool FUSE_VECTOR_CALL ray_pick(ray r, scene_graph_geometry * & node, float & t);
 
@@ -113,13 +141,21 @@ namespace fuse
 
 		scene_graph_camera * m_activeCamera;
 		bool m_boundsGrowth;
+		bool m_compressMeshes;
+		bool m_generateLods;
+		bool m_buildClusters;
 
 		std::vector<scene_listener*> m_listeners;
 
+		std::vector<mesh_ptr> m_occluderMeshes;
+
 	public:
 
 		FUSE_PROPERTIES_BY_VALUE (
 			(bounds_growth, m_boundsGrowth)
+			(compress_meshes, m_compressMeshes)
+			(generate_lods, m_generateLods)
+			(build_clusters, m_buildClusters)
 		)
 
 		FUSE_PROPERTIES_BY_CONST_REFERENCE_READ_ONLY (
@@ -132,7 +168,8 @@ namespace fuse
 		void on_geometry_add(scene_graph_geometry * g);
 		void on_geometry_remove(scene_graph_geometry * g);
 
-		void create_scene_graph_assimp(assimp_loader * loader, const aiScene * scene, aiNode * node, scene_graph_node * parent);
+		void create_scene_graph_assimp(assimp_loader * loader, const aiScene * scene, aiNode * node, scene_graph_node * parent, std::vector<std::pair<scene_graph_geometry*, aiNode*>> & geometry);
+		void create_scene_graph_cache(scene_cache * cache, std::vector<std::pair<scene_graph_geometry*, const scene_cache_node*>> & geometry);
 
 	};
 
@@ -0,0 +1,505 @@
+#include "scene_cache.hpp"
+
+#include <fuse/resource_factory.hpp>
+#include <fuse/resource_types.hpp>
+#include <fuse/core/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+
+using namespace fuse;
+
+struct scene_cache_header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t hash;
+	uint32_t numNodes;
+	uint32_t numMaterials;
+	uint32_t numFiles;
+};
+
+// Smallest records on disk, with empty strings, to check the counts in the header
+
+#define FUSE_SCENE_CACHE_MIN_NODE_SIZE (\
+	sizeof(scene_cache_node::type) + sizeof(scene_cache_node::parent) + sizeof(uint32_t) +\
+	sizeof(scene_cache_node::translation) + sizeof(scene_cache_node::rotation) + sizeof(scene_cache_node::scale) +\
+	sizeof(scene_cache_node::mesh) + sizeof(scene_cache_node::material) + sizeof(scene_cache_node::boundingSphere) +\
+	sizeof(scene_cache_node::cameraPosition) + sizeof(scene_cache_node::cameraOrientation) +\
+	sizeof(scene_cache_node::znear) + sizeof(scene_cache_node::zfar))
+
+#define FUSE_SCENE_CACHE_MIN_MATERIAL_SIZE (\
+	sizeof(color_rgb) * 4 + sizeof(float) * 4 + sizeof(uint32_t) + sizeof(uint32_t) * 3)
+
+#define FUSE_SCENE_CACHE_MIN_FILE_SIZE (sizeof(uint32_t) + sizeof(uint64_t) * 2)
+
+/* File status */
+
+// Missing files have size and time 0, so a file appearing makes the cache stale too
+
+static bool get_file_status(const char_t * filename, uint64_t * size, uint64_t * time)
+{
+#ifdef _WIN32
+	struct _stat64 status;
+	bool found = _wstat64(string_widen(string_t(filename)).c_str(), &status) == 0;
+#else
+	struct stat status;
+	bool found = stat(string_narrow(string_t(filename)).c_str(), &status) == 0;
+#endif
+
+	*size = found ? static_cast<uint64_t>(status.st_size) : 0;
+	*time = found ? static_cast<uint64_t>(status.st_mtime) : 0;
+
+	return found;
+}
+
+static scene_cache_file make_cache_file(const string_t & filename)
+{
+	scene_cache_file file;
+	file.filename = string_narrow(filename);
+	get_file_status(filename.c_str(), &file.size, &file.time);
+	return file;
+}
+
+/* Source hash */
+
+static uint64_t hash_source_file(const char_t * filename)
+{
+	// FNV-1a on 64 bit words rather than bytes, the source files can be hundreds of MB
+
+	mapped_file file;
+
+	if (!file.open(filename))
+	{
+		return 0;
+	}
+
+	const uint64_t prime = 0x100000001B3ULL;
+
+	uint64_t hash = 0xCBF29CE484222325ULL;
+
+	hash = (hash ^ FUSE_SCENE_CACHE_VERSION) * prime;
+	hash = (hash ^ file.get_size()) * prime;
+
+	const uint8_t * data = file.get_data();
+	size_t          size = file.get_size();
+
+	size_t i = 0;
+
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, data + i, sizeof(uint64_t));
+		hash = (hash ^ word) * prime;
+	}
+
+	for (; i < size; i++)
+	{
+		hash = (hash ^ data[i]) * prime;
+	}
+
+	// 0 means no source
+
+	return hash ? hash : 1;
+}
+
+/* Serialization */
+
+template <typename T>
+static inline void write_value(std::ostream & os, const T & value)
+{
+	os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+static inline void write_value(std::ostream & os, const std::string & s)
+{
+	write_value(os, static_cast<uint32_t>(s.size()));
+	os.write(s.data(), s.size());
+}
+
+template <typename T>
+static inline bool read_value(std::istream & is, T & value)
+{
+	return !!is.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+// The string cannot go past the end of the file, whatever its size says
+
+static inline bool read_value(std::istream & is, std::string & s, uint64_t fileSize)
+{
+	uint32_t size;
+
+	if (!read_value(is, size) || static_cast<uint64_t>(is.tellg()) + size > fileSize)
+	{
+		return false;
+	}
+
+	s.resize(size);
+
+	return size == 0 || !!is.read(&s[0], size);
+}
+
+/* Materials */
+
+static void set_material_textures(material * m, const scene_cache_material & cached)
+{
+	m->set_diffuse_texture(cached.diffuseTexture.c_str());
+	m->set_specular_texture(cached.specularTexture.c_str());
+	m->set_normal_map(cached.normalMap.c_str());
+}
+
+/* scene_cache */
+
+scene_cache::scene_cache(const char_t * filename) :
+	m_filename(filename)
+{
+	m_hash = hash_source_file(filename);
+}
+
+bool scene_cache::read(void)
+{
+	clear();
+
+	string_t filename = m_filename + FUSE_LITERAL(".fscene");
+
+	uint64_t fileSize, fileTime;
+
+	if (!m_hash || !get_file_status(filename.c_str(), &fileSize, &fileTime))
+	{
+		return false;
+	}
+
+	std::ifstream file(filename.c_str(), std::ios::binary);
+
+	scene_cache_header header;
+
+	if (!file || !read_value(file, header) ||
+	    header.magic != FUSE_SCENE_CACHE_MAGIC ||
+	    header.version != FUSE_SCENE_CACHE_VERSION ||
+	    header.hash != m_hash)
+	{
+		return false;
+	}
+
+	// The counts are checked before allocating anything
+
+	uint64_t minSize = sizeof(scene_cache_header) +
+		header.numNodes * static_cast<uint64_t>(FUSE_SCENE_CACHE_MIN_NODE_SIZE) +
+		header.numMaterials * static_cast<uint64_t>(FUSE_SCENE_CACHE_MIN_MATERIAL_SIZE) +
+		header.numFiles * static_cast<uint64_t>(FUSE_SCENE_CACHE_MIN_FILE_SIZE);
+
+	if (minSize > fileSize)
+	{
+		FUSE_LOG_OPT_DEBUG(stringstream_t() << "Scene cache \"" << filename << "\" is corrupted.");
+		return false;
+	}
+
+	m_nodes.resize(header.numNodes);
+	m_materials.resize(header.numMaterials);
+	m_files.resize(header.numFiles);
+
+	bool success = true;
+
+	for (scene_cache_node & node : m_nodes)
+	{
+		std::string name;
+
+		success = success &&
+			read_value(file, node.type) &&
+			read_value(file, node.parent) &&
+			read_value(file, name, fileSize) &&
+			read_value(file, node.translation) &&
+			read_value(file, node.rotation) &&
+			read_value(file, node.scale) &&
+			read_value(file, node.mesh) &&
+			read_value(file, node.material) &&
+			read_value(file, node.boundingSphere) &&
+			read_value(file, node.cameraPosition) &&
+			read_value(file, node.cameraOrientation) &&
+			read_value(file, node.znear) &&
+			read_value(file, node.zfar);
+
+		node.name = to_string_t(name);
+	}
+
+	for (scene_cache_material & material : m_materials)
+	{
+		success = success &&
+			read_value(file, material.diffuseAlbedo) &&
+			read_value(file, material.specularAlbedo) &&
+			read_value(file, material.baseAlbedo) &&
+			read_value(file, material.emissive) &&
+			read_value(file, material.metallic) &&
+			read_value(file, material.roughness) &&
+			read_value(file, material.subsurface) &&
+			read_value(file, material.specular) &&
+			read_value(file, material.materialType) &&
+			read_value(file, material.diffuseTexture, fileSize) &&
+			read_value(file, material.specularTexture, fileSize) &&
+			read_value(file, material.normalMap, fileSize);
+	}
+
+	for (scene_cache_file & cached : m_files)
+	{
+		success = success &&
+			read_value(file, cached.filename, fileSize) &&
+			read_value(file, cached.size) &&
+			read_value(file, cached.time);
+	}
+
+	if (!success)
+	{
+		FUSE_LOG_OPT_DEBUG(stringstream_t() << "Scene cache \"" << filename << "\" is corrupted.");
+		clear();
+		return false;
+	}
+
+	// A changed side file, or a missing or rewritten mesh, is a cache miss
+
+	for (const scene_cache_file & cached : m_files)
+	{
+		scene_cache_file current = make_cache_file(to_string_t(cached.filename));
+
+		if (current.size != cached.size || current.time != cached.time)
+		{
+			FUSE_LOG_OPT_DEBUG(stringstream_t() << "Scene cache \"" << filename << "\" is stale, \"" << to_string_t(cached.filename) << "\" changed.");
+			clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool scene_cache::write(void) const
+{
+	if (!m_hash)
+	{
+		return false;
+	}
+
+	std::ofstream file((m_filename + FUSE_LITERAL(".fscene")).c_str(), std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	// The meshes were saved before, they are checked as the side files
+
+	std::vector<scene_cache_file> files = m_files;
+
+	for (const scene_cache_node & node : m_nodes)
+	{
+		if (node.mesh != FUSE_SCENE_CACHE_INVALID_INDEX)
+		{
+			scene_cache_file meshFile = make_cache_file(get_mesh_filename(node.mesh));
+
+			auto it = std::find_if(files.begin(), files.end(), [&](const scene_cache_file & f) { return f.filename == meshFile.filename; });
+
+			if (it == files.end())
+			{
+				files.push_back(meshFile);
+			}
+		}
+	}
+
+	scene_cache_header header = {
+		FUSE_SCENE_CACHE_MAGIC,
+		FUSE_SCENE_CACHE_VERSION,
+		m_hash,
+		static_cast<uint32_t>(m_nodes.size()),
+		static_cast<uint32_t>(m_materials.size()),
+		static_cast<uint32_t>(files.size())
+	};
+
+	write_value(file, header);
+
+	for (const scene_cache_node & node : m_nodes)
+	{
+		write_value(file, node.type);
+		write_value(file, node.parent);
+		write_value(file, string_narrow(node.name));
+		write_value(file, node.translation);
+		write_value(file, node.rotation);
+		write_value(file, node.scale);
+		write_value(file, node.mesh);
+		write_value(file, node.material);
+		write_value(file, node.boundingSphere);
+		write_value(file, node.cameraPosition);
+		write_value(file, node.cameraOrientation);
+		write_value(file, node.znear);
+		write_value(file, node.zfar);
+	}
+
+	for (const scene_cache_material & material : m_materials)
+	{
+		write_value(file, material.diffuseAlbedo);
+		write_value(file, material.specularAlbedo);
+		write_value(file, material.baseAlbedo);
+		write_value(file, material.emissive);
+		write_value(file, material.metallic);
+		write_value(file, material.roughness);
+		write_value(file, material.subsurface);
+		write_value(file, material.specular);
+		write_value(file, material.materialType);
+		write_value(file, material.diffuseTexture);
+		write_value(file, material.specularTexture);
+		write_value(file, material.normalMap);
+	}
+
+	for (const scene_cache_file & cached : files)
+	{
+		write_value(file, cached.filename);
+		write_value(file, cached.size);
+		write_value(file, cached.time);
+	}
+
+	return !!file;
+}
+
+void scene_cache::clear(void)
+{
+	m_nodes.clear();
+	m_materials.clear();
+	m_files.clear();
+}
+
+bool scene_cache::load(resource * r)
+{
+	if (!string_equals(r->get_owner()->get_type(), FUSE_RESOURCE_TYPE_MATERIAL))
+	{
+		return false;
+	}
+
+	uint32_t id;
+	istringstream_t ss(r->get_name());
+
+	ss >> id;
+
+	if (ss.fail() || id >= m_materials.size())
+	{
+		return false;
+	}
+
+	const scene_cache_material & cached = m_materials[id];
+
+	material * m = static_cast<material *>(r);
+
+	m->set_diffuse_albedo(cached.diffuseAlbedo);
+	m->set_specular_albedo(cached.specularAlbedo);
+	m->set_base_albedo(cached.baseAlbedo);
+	m->set_emissive(cached.emissive);
+
+	m->set_metallic(cached.metallic);
+	m->set_roughness(cached.roughness);
+	m->set_subsurface(cached.subsurface);
+	m->set_specular(cached.specular);
+	m->set_material_type(cached.materialType);
+
+	set_material_textures(m, cached);
+
+	return true;
+}
+
+void scene_cache::unload(resource *)
+{
+
+}
+
+string_t scene_cache::get_mesh_filename(uint32_t meshIndex) const
+{
+	return m_filename + FUSE_LITERAL(".") + to_string_t(meshIndex) + FUSE_LITERAL(".fmesh");
+}
+
+std::shared_ptr<mesh> scene_cache::create_mesh(uint32_t meshIndex)
+{
+	// No loader, the mesh loads the .fmesh file named as the resource
+	return resource_factory::get_singleton_pointer()->create<mesh>(FUSE_RESOURCE_TYPE_MESH, get_mesh_filename(meshIndex).c_str());
+}
+
+std::shared_ptr<material> scene_cache::create_material(uint32_t materialIndex)
+{
+	std::shared_ptr<material> m = resource_factory::get_singleton_pointer()->create<material>(FUSE_RESOURCE_TYPE_MATERIAL, (to_string_t(materialIndex) + FUSE_LITERAL("_cache_material_") + m_filename).c_str(), default_parameters(), this);
+
+	// The textures are known before the load, so load_async loads them first as dependencies
+
+	if (m && m->get_status() == FUSE_RESOURCE_NOT_LOADED && materialIndex < m_materials.size())
+	{
+		set_material_textures(m.get(), m_materials[materialIndex]);
+	}
+
+	return m;
+}
+
+bool scene_cache::save_mesh(uint32_t meshIndex, const mesh * m) const
+{
+	return m_hash && m->save_fmesh(get_mesh_filename(meshIndex).c_str());
+}
+
+void scene_cache::save_material(uint32_t materialIndex, material * m)
+{
+	if (materialIndex >= m_materials.size())
+	{
+		m_materials.resize(materialIndex + 1);
+	}
+
+	scene_cache_material & cached = m_materials[materialIndex];
+
+	cached.diffuseAlbedo   = m->get_diffuse_albedo();
+	cached.specularAlbedo  = m->get_specular_albedo();
+	cached.baseAlbedo      = m->get_base_albedo();
+	cached.emissive        = m->get_emissive();
+
+	cached.metallic        = m->get_metallic();
+	cached.roughness       = m->get_roughness();
+	cached.subsurface      = m->get_subsurface();
+	cached.specular        = m->get_specular();
+	cached.materialType    = m->get_material_type();
+
+	cached.diffuseTexture  = m->get_diffuse_texture();
+	cached.specularTexture = m->get_specular_texture();
+	cached.normalMap       = m->get_normal_map();
+
+	add_texture_file(cached.diffuseTexture);
+	add_texture_file(cached.specularTexture);
+	add_texture_file(cached.normalMap);
+}
+
+void scene_cache::add_node(const scene_cache_node & node)
+{
+	m_nodes.push_back(node);
+}
+
+void scene_cache::add_source_file(const char_t * filename)
+{
+	scene_cache_file file = make_cache_file(filename);
+
+	auto it = std::find_if(m_files.begin(), m_files.end(), [&](const scene_cache_file & f) { return f.filename == file.filename; });
+
+	if (it == m_files.end())
+	{
+		m_files.push_back(file);
+	}
+}
+
+void scene_cache::add_texture_file(const std::string & filename)
+{
+	// Embedded textures are named "*<index>"
+
+	if (filename.empty() || filename[0] == '*')
+	{
+		return;
+	}
+
+	bool absolute = filename[0] == '/' || filename[0] == '\\' || (filename.size() > 1 && filename[1] == ':');
+
+	size_t   separator = m_filename.find_last_of(FUSE_LITERAL("/\\"));
+	string_t directory = separator != string_t::npos ? m_filename.substr(0, separator + 1) : string_t();
+
+	add_source_file(((absolute ? string_t() : directory) + to_string_t(filename)).c_str());
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <fuse/core.hpp>
+#include <fuse/material.hpp>
+#include <fuse/mesh.hpp>
+#include <fuse/resource.hpp>
+
+#include <string>
+#include <vector>
+
+#define FUSE_SCENE_CACHE_MAGIC         0x4E435346 // "FSCN"
+#define FUSE_SCENE_CACHE_VERSION       4
+#define FUSE_SCENE_CACHE_INVALID_INDEX 0xFFFFFFFF
+
+namespace fuse
+{
+
+	// Nodes are stored in depth first order, the parent always comes before its children
+
+	struct scene_cache_node
+	{
+		uint32_t   type;
+		uint32_t   parent;
+		string_t   name;
+
+		float3     translation;
+		quaternion rotation;
+		float3     scale;
+
+		// Geometry nodes
+
+		uint32_t   mesh;
+		uint32_t   material;
+		float4     boundingSphere;
+
+		// Camera nodes
+
+		float3     cameraPosition;
+		quaternion cameraOrientation;
+		float      znear;
+		float      zfar;
+	};
+
+	struct scene_cache_material
+	{
+		color_rgb    diffuseAlbedo;
+		color_rgb    specularAlbedo;
+		color_rgb    baseAlbedo;
+		color_rgb    emissive;
+
+		float        metallic;
+		float        roughness;
+		float        subsurface;
+		float        specular;
+
+		uint32_t     materialType;
+
+		std::string  diffuseTexture;
+		std::string  specularTexture;
+		std::string  normalMap;
+	};
+
+	// A side file of the source (.mtl, .bin, textures) or a cached mesh, the cache is
+	// stale when its size or modification time changed
+
+	struct scene_cache_file
+	{
+		std::string filename;
+		uint64_t    size;
+		uint64_t    time;
+	};
+
+	/*
+	*
+	* On disk cache of a scene imported through Assimp, keyed by a hash of the
+	* source file and by the size and modification time of the side files it
+	* references. "<scene>.fscene" holds the scene graph and the materials,
+	* the processed meshes are written next to it as "<scene>.<index>.fmesh"
+	* and mapped in memory when loaded. The cache is also the loader of the
+	* materials it creates.
+	*
+	*/
+
+	class scene_cache :
+		public resource_loader
+	{
+
+	public:
+
+		scene_cache(const char_t * filename);
+
+		// True if the cache exists, was written from the current source and side
+		// files, and all its meshes are there with the size they were written with
+
+		bool read(void);
+		bool write(void) const;
+
+		void clear(void);
+
+		bool load(resource * r) override;
+		void unload(resource * r) override;
+
+		string_t get_mesh_filename(uint32_t meshIndex) const;
+
+		std::shared_ptr<mesh>     create_mesh(uint32_t meshIndex);
+		std::shared_ptr<material> create_material(uint32_t materialIndex);
+
+		bool save_mesh(uint32_t meshIndex, const mesh * m) const;
+		void save_material(uint32_t materialIndex, material * m);
+
+		void add_node(const scene_cache_node & node);
+
+		// Texture paths are relative to the source file, as Assimp reports them
+
+		void add_source_file(const char_t * filename);
+		void add_texture_file(const std::string & filename);
+
+		inline const std::vector<scene_cache_node> & get_nodes(void) const { return m_nodes; }
+
+	private:
+
+		string_t m_filename;
+		uint64_t m_hash;
+
+		std::vector<scene_cache_node>     m_nodes;
+		std::vector<scene_cache_material> m_materials;
+		std::vector<scene_cache_file>     m_files;
+
+	};
+
+}
\ No newline at end of file
@@ -1,14 +1,28 @@
 #include "scene_data.hlsli"
 #include "gbuffer.hlsli"
+#include "vertex_compression.hlsli"
 
 USE_CB_PER_FRAME(b0)
 
 cbuffer cbPerObject : register(b1)
 {
-	transform g_transform;
-	material  g_material;
+	transform     g_transform;
+	material      g_material;
+	vertex_decode g_vertexDecode;
 };
 
+#if COMPRESSED_VERTICES
+
+struct VSInput
+{
+	float4 position  : QPOSITION;
+	float2 normal    : OCTNORMAL;
+	float2 tangent   : OCTTANGENT;
+	float2 texcoord  : HTEXCOORD0;
+};
+
+#else
+
 struct VSInput
 {
 	float3 position  : POSITION;
@@ -18,6 +32,8 @@ struct VSInput
 	float2 texcoord  : TEXCOORD0;
 };
 
+#endif
+
 struct PSInput
 {
 	float4 positionCS : SV_Position;
@@ -39,15 +55,27 @@ PSInput gbuffer_vs(VSInput input)
 {
 
 	PSInput output = (PSInput) 0;
+
+#if COMPRESSED_VERTICES
+	float3 position  = decode_position(input.position, g_vertexDecode);
+	float3 normal    = octahedral_decode(input.normal);
+	float3 tangent   = octahedral_decode(input.tangent);
+	float3 bitangent = decode_bitangent(normal, tangent, input.position);
+#else
+	float3 position  = input.position;
+	float3 normal    = input.normal;
+	float3 tangent   = input.tangent;
+	float3 bitangent = input.bitangent;
+#endif
 	
-	float4 positionH = float4(input.position, 1);
+	float4 positionH = float4(position, 1);
 	
 	output.positionCS  = mul(positionH, g_transform.worldViewProjection);
 	output.position    = mul(positionH, g_transform.world).xyz;
 	
-	output.normal    = mul(input.normal,    (float3x3) g_transform.world);
-	output.tangent   = mul(input.tangent,   (float3x3) g_transform.world);
-	output.bitangent = mul(input.bitangent, (float3x3) g_transform.world);
+	output.normal    = mul(normal,    (float3x3) g_transform.world);
+	output.tangent   = mul(tangent,   (float3x3) g_transform.world);
+	output.bitangent = mul(bitangent, (float3x3) g_transform.world);
 	output.texcoord  = input.texcoord;
 	
 	return output;
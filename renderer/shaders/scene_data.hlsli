@@ -51,6 +51,12 @@ struct transform
 	float4x4 worldViewProjection;
 };
 
+struct vertex_decode
+{
+	float3 positionScale;
+	float3 positionOffset;
+};
+
 struct material
 {
 	float3 baseColor;
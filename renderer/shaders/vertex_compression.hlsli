@@ -0,0 +1,33 @@
+#ifndef __VERTEX_COMPRESSION__
+#define __VERTEX_COMPRESSION__
+
+/* Decoders of the compressed meshes layout (see vertex_compression.hpp) */
+
+float2 sign_not_zero(in float2 v)
+{
+	return float2(v.x >= 0 ? 1 : -1, v.y >= 0 ? 1 : -1);
+}
+
+float3 octahedral_decode(in float2 e)
+{
+	float3 v = float3(e, 1 - abs(e.x) - abs(e.y));
+
+	if (v.z < 0)
+	{
+		v.xy = (1 - abs(v.yx)) * sign_not_zero(v.xy);
+	}
+
+	return normalize(v);
+}
+
+float3 decode_position(in float4 position, in vertex_decode decode)
+{
+	return position.xyz * decode.positionScale + decode.positionOffset;
+}
+
+float3 decode_bitangent(in float3 normal, in float3 tangent, in float4 position)
+{
+	return cross(normal, tangent) * (position.w * 2 - 1);
+}
+
+#endif
\ No newline at end of file
@@ -14,6 +14,7 @@ bool shadow_mapper::init(ID3D12Device * device, const shadow_mapper_configuratio
 void shadow_mapper::shutdown(void)
 {
 	m_pso.reset();
+	m_compressedPSO.reset();
 	m_rs.reset();
 }
 
@@ -61,9 +62,35 @@ void shadow_mapper::render(
 
 	commandList->SetGraphicsRootConstantBufferView(0, cbPerFrame);
 
-	/* Render loop */
+	/* Transform the geometries to light space */
+
+	m_worldLightSpace.clear();
 
 	for (auto it = begin; it != end; it++)
+	{
+		gpu_mesh_ptr mesh = (*it)->get_gpu_mesh();
+
+		if (mesh && mesh->load() && mesh->is_compressed())
+		{
+			// The quantized positions are decoded by the world matrix, the pass has no normals
+			mat128 decode = to_scale4(to_vec128(mesh->get_position_scale())) * to_translation4(to_vec128(mesh->get_position_offset()));
+			m_worldLightSpace.push_back(decode * (*it)->get_global_matrix());
+		}
+		else
+		{
+			m_worldLightSpace.push_back((*it)->get_global_matrix());
+		}
+	}
+
+	mat128_multiply_stream(m_worldLightSpace.data(), m_worldLightSpace.data(), m_worldLightSpace.size(), lightMatrix);
+
+	/* Render loop */
+
+	ID3D12PipelineState * currentPSO = m_pso.get();
+
+	size_t index = 0;
+
+	for (auto it = begin; it != end; it++, index++)
 	{
 
 		D3D12_GPU_VIRTUAL_ADDRESS cbPerLight;
@@ -75,8 +102,7 @@ void shadow_mapper::render(
 
 			scene_graph_geometry * geometry = *it;
 
-			mat128 worldLightSpace = geometry->get_global_matrix() * lightMatrix;
-			memcpy(cbData, &worldLightSpace, sizeof(mat128));
+			memcpy(cbData, &m_worldLightSpace[index], sizeof(mat128));
 
 			/* Draw */
 
@@ -88,10 +114,22 @@ void shadow_mapper::render(
 
 				commandList.resource_barrier_transition(mesh->get_resource(), D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER | D3D12_RESOURCE_STATE_INDEX_BUFFER);
 
+				ID3D12PipelineState * meshPSO = mesh->is_compressed() ? m_compressedPSO.get() : m_pso.get();
+
+				if (meshPSO != currentPSO)
+				{
+					commandList->SetPipelineState(meshPSO);
+					currentPSO = meshPSO;
+				}
+
 				commandList->IASetVertexBuffers(0, 1, mesh->get_vertex_buffers());
 				commandList->IASetIndexBuffer(&mesh->get_index_data());
 
-				commandList->DrawIndexedInstanced(mesh->get_num_indices(), 1, 0, 0, 0);
+				// The shadow map texels are larger than the pixels of the view the LOD was chosen for
+
+				const mesh_lod & lod = mesh->get_lod(geometry->get_lod() + m_lodBias);
+
+				commandList->DrawIndexedInstanced(lod.numIndices, 1, lod.firstIndex, 0, 0);
 			}
 		}
 	}
@@ -157,7 +195,7 @@ bool shadow_mapper::create_regular_pso(ID3D12Device * device)
 		psoDesc.SampleDesc               = { 1, 0 };
 		psoDesc.PrimitiveTopologyType    = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 
-		return !FUSE_HR_FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pso)));
+		return create_psos(device, psoDesc, inputLayoutVector);
 
 	}
 
@@ -195,7 +233,7 @@ bool shadow_mapper::create_vsm_pso(ID3D12Device * device)
 		psoDesc.SampleDesc                         = { 1, 0 };
 		psoDesc.PrimitiveTopologyType              = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 
-		return !FUSE_HR_FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pso)));
+		return create_psos(device, psoDesc, inputLayoutVector);
 
 	}
 
@@ -233,7 +271,7 @@ bool shadow_mapper::create_evsm2_pso(ID3D12Device * device)
 		psoDesc.SampleDesc               = { 1, 0 };
 		psoDesc.PrimitiveTopologyType    = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 
-		return !FUSE_HR_FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pso)));
+		return create_psos(device, psoDesc, inputLayoutVector);
 
 	}
 
@@ -271,9 +309,31 @@ bool shadow_mapper::create_evsm4_pso(ID3D12Device * device)
 		psoDesc.SampleDesc               = { 1, 0 };
 		psoDesc.PrimitiveTopologyType    = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 
-		return !FUSE_HR_FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pso)));
+		return create_psos(device, psoDesc, inputLayoutVector);
 
 	}
 
 	return false;
+}
+
+bool shadow_mapper::create_psos(ID3D12Device * device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC & psoDesc, const std::vector<D3D12_INPUT_ELEMENT_DESC> & inputLayout)
+{
+	// Same shader for the compressed meshes, the IA converts their 16 bit positions
+
+	std::vector<D3D12_INPUT_ELEMENT_DESC> compressedInputLayout = inputLayout;
+
+	for (D3D12_INPUT_ELEMENT_DESC & elementDesc : compressedInputLayout)
+	{
+		if (!strcmp(elementDesc.SemanticName, "POSITION"))
+		{
+			elementDesc.Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+		}
+	}
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC compressedPSODesc = psoDesc;
+
+	compressedPSODesc.InputLayout = make_input_layout_desc(compressedInputLayout);
+
+	return !FUSE_HR_FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pso))) &&
+	       !FUSE_HR_FAILED(device->CreateGraphicsPipelineState(&compressedPSODesc, IID_PPV_ARGS(&m_compressedPSO)));
 }
\ No newline at end of file
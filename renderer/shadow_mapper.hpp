@@ -47,10 +47,15 @@ namespace fuse
 		
 		com_ptr<ID3D12RootSignature> m_rs;
 		com_ptr<ID3D12PipelineState> m_pso;
+		com_ptr<ID3D12PipelineState> m_compressedPSO;
 
 		D3D12_VIEWPORT m_viewport;
 		D3D12_RECT     m_scissorRect;
 
+		uint32_t       m_lodBias = 0;
+
+		std::vector<mat128, aligned_allocator<mat128, 16>> m_worldLightSpace;
+
 		bool create_debug_pso(ID3D12Device * device);
 		bool create_rs(ID3D12Device * device);
 		bool create_regular_pso(ID3D12Device * device);
@@ -58,6 +63,8 @@ namespace fuse
 		bool create_evsm2_pso(ID3D12Device * device);
 		bool create_evsm4_pso(ID3D12Device * device);
 
+		bool create_psos(ID3D12Device * device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC & psoDesc, const std::vector<D3D12_INPUT_ELEMENT_DESC> & inputLayout);
+
 	public:
 
 		FUSE_PROPERTIES_BY_CONST_REFERENCE(
@@ -65,6 +72,12 @@ namespace fuse
 			(scissor_rect, m_scissorRect)
 		)
 
+		// LODs coarser than the ones selected for the view, added to scene_graph_geometry::get_lod
+
+		FUSE_PROPERTIES_BY_VALUE(
+			(lod_bias, m_lodBias)
+		)
+
 	};
 
 }
\ No newline at end of file
@@ -252,6 +252,9 @@ void wx_editor_gui::create_shadow_mapping_page(wxAuiNotebook * notebook)
 	panelSizer->Add(new wxStaticText(panel, wxID_ANY, _("Shadow Map Resolution")), 0, wxEXPAND | wxALL, padding);
 	panelSizer->Add(FUSE_WX_SPIN_RV(panel, int, shadow_map_resolution, 256, 4096, 256), 0, wxEXPAND | wxALL, padding);
 
+	panelSizer->Add(new wxStaticText(panel, wxID_ANY, _("LOD Bias")), 0, wxEXPAND | wxALL, padding);
+	panelSizer->Add(FUSE_WX_SPIN_RV(panel, int, shadow_lod_bias, 0, FUSE_MESH_MAX_LODS - 1, 1), 0, wxEXPAND | wxALL, padding);
+
 	panelSizer->Add(algoNotebook, 1, wxEXPAND | wxALL, padding);
 
 	panel->SetSizerAndFit(panelSizer);
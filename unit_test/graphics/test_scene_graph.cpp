@@ -0,0 +1,174 @@
+#include "../unit_test.hpp"
+
+#include <fuse/scene_graph.hpp>
+#include <fuse/core/thread_pool.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace fuse;
+
+#define TEST_SCENE_GRAPH_NODES     20000
+#define TEST_SCENE_GRAPH_LISTENERS 8
+#define TEST_SCENE_GRAPH_ROUNDS    6
+
+struct alignas(16) test_scene_graph_move
+{
+	size_t node;
+	mat128 oldTransform;
+	mat128 newTransform;
+};
+
+// Records the moves by index of the node in the order of creation, so that the
+// sequences of two graphs built the same way can be compared
+
+struct test_scene_graph_listener :
+	scene_graph_node_listener
+{
+
+	const std::unordered_map<scene_graph_node*, size_t> * indices;
+	std::vector<test_scene_graph_move, aligned_allocator<test_scene_graph_move, 16>> moves;
+
+	void on_scene_graph_node_move(scene_graph_node * node, const mat128 & oldTransform, const mat128 & newTransform) override
+	{
+		test_scene_graph_move move = { indices->at(node), oldTransform, newTransform };
+		moves.push_back(move);
+	}
+
+};
+
+// The listeners outlive the graph, the nodes notify them when destroyed
+
+struct test_scene_graph_instance
+{
+	test_scene_graph_listener                     listeners[TEST_SCENE_GRAPH_LISTENERS];
+	std::unordered_map<scene_graph_node*, size_t> indices;
+	std::vector<scene_graph_node*>                nodes;
+	scene_graph                                   graph;
+};
+
+// Chains and wide levels mixed, so that the serial levels of the parallel update
+// end on leaves, on deep subtrees and on moved nodes
+
+static void test_scene_graph_build(test_scene_graph_instance & instance, unsigned int seed)
+{
+	std::mt19937 generator(seed);
+
+	std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+	instance.nodes.push_back(instance.graph.get_root());
+
+	for (size_t i = 1; i < TEST_SCENE_GRAPH_NODES; i++)
+	{
+		float shape = uniform(generator);
+
+		size_t parent = shape < .3f ? i - 1 :
+			shape < .6f ? std::uniform_int_distribution<size_t>(0, std::min<size_t>(i - 1, 64))(generator) :
+			std::uniform_int_distribution<size_t>(0, i - 1)(generator);
+
+		instance.nodes.push_back(instance.nodes[parent]->add_child<scene_graph_group>());
+	}
+
+	for (size_t i = 0; i < instance.nodes.size(); i++)
+	{
+		instance.indices[instance.nodes[i]] = i;
+	}
+
+	for (test_scene_graph_listener & listener : instance.listeners)
+	{
+		listener.indices = &instance.indices;
+
+		for (scene_graph_node * node : instance.nodes)
+		{
+			if (uniform(generator) < .2f)
+			{
+				node->add_listener(&listener);
+			}
+		}
+	}
+}
+
+static void test_scene_graph_move_nodes(test_scene_graph_instance & instance, unsigned int seed, float probability)
+{
+	std::mt19937 generator(seed);
+
+	std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+	for (scene_graph_node * node : instance.nodes)
+	{
+		if (uniform(generator) < probability)
+		{
+			float3 axis = normalize(float3(uniform(generator) - .5f, uniform(generator) - .5f, uniform(generator) + .1f));
+
+			node->set_local_translation(float3(uniform(generator) * 4.f - 2.f, uniform(generator) * 4.f - 2.f, uniform(generator) * 4.f - 2.f));
+			node->set_local_rotation(quaternion(axis, uniform(generator) * 6.f));
+			node->set_local_scale(float3(.5f + uniform(generator), .5f + uniform(generator), .5f + uniform(generator)));
+		}
+	}
+}
+
+static bool test_scene_graph_equal(const mat128 & a, const mat128 & b)
+{
+	return std::memcmp(&a, &b, sizeof(mat128)) == 0;
+}
+
+void test_scene_graph(void)
+{
+	thread_pool pool(3);
+
+	for (unsigned int seed = 1; seed <= 4; seed++)
+	{
+		std::unique_ptr<test_scene_graph_instance> serial(new test_scene_graph_instance);
+		std::unique_ptr<test_scene_graph_instance> parallel(new test_scene_graph_instance);
+
+		test_scene_graph_build(*serial, seed);
+		test_scene_graph_build(*parallel, seed);
+
+		// The first round moves every node, the root too in some of the others
+
+		for (unsigned int round = 0; round < TEST_SCENE_GRAPH_ROUNDS; round++)
+		{
+			float probability = round == 0 ? 1.f : round % 2 ? .01f : .2f;
+
+			test_scene_graph_move_nodes(*serial, seed * 100 + round, probability);
+			test_scene_graph_move_nodes(*parallel, seed * 100 + round, probability);
+
+			serial->graph.update();
+			parallel->graph.update(pool);
+
+			for (int l = 0; l < TEST_SCENE_GRAPH_LISTENERS; l++)
+			{
+				const auto & a = serial->listeners[l].moves;
+				const auto & b = parallel->listeners[l].moves;
+
+				bool equal = a.size() == b.size();
+
+				for (size_t i = 0; equal && i < a.size(); i++)
+				{
+					equal = a[i].node == b[i].node &&
+						test_scene_graph_equal(a[i].oldTransform, b[i].oldTransform) &&
+						test_scene_graph_equal(a[i].newTransform, b[i].newTransform);
+				}
+
+				FUSE_TEST_CHECK(equal);
+				FUSE_TEST_CHECK(round > 0 || !a.empty());
+
+				serial->listeners[l].moves.clear();
+				parallel->listeners[l].moves.clear();
+			}
+
+			size_t mismatches = 0;
+
+			for (size_t i = 0; i < serial->nodes.size(); i++)
+			{
+				mismatches += !test_scene_graph_equal(serial->nodes[i]->get_global_matrix(), parallel->nodes[i]->get_global_matrix());
+			}
+
+			FUSE_TEST_CHECK(mismatches == 0);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "unit_test.hpp"
+
+#include <fuse/math.hpp>
+#include <fuse/geometry.hpp>
+#include <fuse/geometry/affine_transforms.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace fuse;
+
+#define TEST_DECOMPOSE_MATRICES 1000
+
+// The rotations are compared by the cosine of half the angle between them. The float4x4
+// overload uses the scalar approximate square root and is only compared loosely.
+
+#define TEST_DECOMPOSE_ROTATION_TOLERANCE 1e-5f
+#define TEST_DECOMPOSE_OVERLOAD_TOLERANCE 1e-2f
+#define TEST_DECOMPOSE_SCALE_TOLERANCE    1e-5f
+
+static float test_decompose_rotation_error(vec128 a, vec128 b)
+{
+	float4 x = to_float4(a);
+	float4 y = to_float4(b);
+
+	float dot = x.x * y.x + x.y * y.y + x.z * y.z + x.w * y.w;
+
+	return 1.f - std::abs(dot) / std::sqrt((x.x * x.x + x.y * x.y + x.z * x.z + x.w * x.w) * (y.x * y.x + y.y * y.y + y.z * y.z + y.w * y.w));
+}
+
+void test_decompose_affine(void)
+{
+	std::mt19937 generator(1);
+
+	std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+	float maxRotationError    = 0.f;
+	float maxOverloadError    = 0.f;
+	float maxScaleError       = 0.f;
+	float maxTranslationError = 0.f;
+
+	for (int i = 0; i < TEST_DECOMPOSE_MATRICES; i++)
+	{
+		// A unit quaternion, normalize uses an approximate square root
+
+		float3 axis(uniform(generator) - .5f, uniform(generator) - .5f, uniform(generator) - .5f);
+		float  angle = 6.f * uniform(generator);
+
+		axis = axis * (std::sin(.5f * angle) / std::sqrt(dot(axis, axis)));
+
+		float4     scale(.1f + 4.f * uniform(generator), .1f + 4.f * uniform(generator), .1f + 4.f * uniform(generator), 1.f);
+		quaternion rotation(std::cos(.5f * angle), axis.x, axis.y, axis.z);
+		float4     translation(20.f * uniform(generator) - 10.f, 20.f * uniform(generator) - 10.f, 20.f * uniform(generator) - 10.f, 1.f);
+
+		mat128 m = to_scale4(to_vec128(scale)) * to_rotation4(to_quat128(rotation)) * to_translation4(to_vec128(translation));
+
+		vec128 s, r, t;
+		decompose_affine(m, &s, &r, &t);
+
+		// Same rotation as the float4x4 overload
+
+		float3     fs, ft;
+		quaternion fr;
+
+		decompose_affine(to_float4x4(m), &fs, &fr, &ft);
+
+		float4 decomposedScale       = to_float4(s);
+		float4 decomposedTranslation = to_float4(t);
+
+		maxRotationError = std::max(maxRotationError, test_decompose_rotation_error(r, to_quat128(rotation)));
+		maxOverloadError = std::max(maxOverloadError, test_decompose_rotation_error(r, to_quat128(fr)));
+
+		for (int k = 0; k < 3; k++)
+		{
+			maxScaleError       = std::max(maxScaleError, std::abs(decomposedScale.m[k] - scale.m[k]) / scale.m[k]);
+			maxTranslationError = std::max(maxTranslationError, std::abs(decomposedTranslation.m[k] - translation.m[k]));
+		}
+	}
+
+	unit_test_log() << "decompose_affine: rotation error " << maxRotationError << " (" << maxOverloadError << " to the float4x4 overload), scale error " << maxScaleError << std::endl;
+
+	FUSE_TEST_CHECK(maxRotationError < TEST_DECOMPOSE_ROTATION_TOLERANCE);
+	FUSE_TEST_CHECK(maxOverloadError < TEST_DECOMPOSE_OVERLOAD_TOLERANCE);
+	FUSE_TEST_CHECK(maxScaleError < TEST_DECOMPOSE_SCALE_TOLERANCE);
+	FUSE_TEST_CHECK(maxTranslationError == 0.f);
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "unit_test.hpp"
+
+#include <fuse/mesh_simplifier.hpp>
+
+#include <cmath>
+#include <vector>
+
+using namespace fuse;
+
+#define TEST_SIMPLIFY_GRID_SIZE 64
+
+// The thinnest triangle accepted in the result, as in mesh_simplifier.cpp
+
+#define TEST_SIMPLIFY_MIN_QUALITY .1f
+
+// A latitude/longitude sphere with a vertex on each pole, the last column is at the
+// same positions as the first one, as a texture seam would have it
+
+static void test_generate_sphere(std::vector<float3> & vertices, std::vector<uint32_t> & indices, uint32_t n)
+{
+	const float pi = 3.14159265f;
+
+	vertices.emplace_back(0.f, 1.f, 0.f);
+	vertices.emplace_back(0.f, -1.f, 0.f);
+
+	for (uint32_t i = 1; i < n; i++)
+	{
+		for (uint32_t j = 0; j <= n; j++)
+		{
+			float theta = pi * i / n;
+			float phi   = 2.f * pi * (j % n) / n;
+
+			vertices.emplace_back(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+		}
+	}
+
+	for (uint32_t j = 0; j < n; j++)
+	{
+		uint32_t top    = 2 + j;
+		uint32_t bottom = 2 + (n - 2) * (n + 1) + j;
+
+		uint32_t caps[6] = { 0, top + 1, top, 1, bottom, bottom + 1 };
+
+		indices.insert(indices.end(), caps, caps + 6);
+	}
+
+	for (uint32_t i = 1; i + 1 < n; i++)
+	{
+		for (uint32_t j = 0; j < n; j++)
+		{
+			uint32_t a = 2 + (i - 1) * (n + 1) + j;
+			uint32_t b = a + n + 1;
+
+			uint32_t quad[6] = { a, a + 1, b, a + 1, b + 1, b };
+
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+void test_mesh_simplifier(void)
+{
+	std::vector<float3>   vertices;
+	std::vector<uint32_t> indices;
+
+	test_generate_sphere(vertices, indices, TEST_SIMPLIFY_GRID_SIZE);
+
+	std::vector<uint32_t> destination(indices.size());
+
+	const size_t ratios[] = { 4, 16 };
+
+	for (size_t ratio : ratios)
+	{
+		size_t target = indices.size() / ratio / 3 * 3;
+		size_t result = simplify(destination.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), target, 1.f);
+
+		// On a sphere centered on the origin, a triangle facing the center is inverted
+
+		size_t inverted = 0;
+		size_t slivers  = 0;
+
+		for (size_t i = 0; i < result; i += 3)
+		{
+			const float3 p[3] = { vertices[destination[i]], vertices[destination[i + 1]], vertices[destination[i + 2]] };
+
+			float3 n = cross(p[1] - p[0], p[2] - p[0]);
+
+			float3 e0 = p[1] - p[0];
+			float3 e1 = p[2] - p[1];
+			float3 e2 = p[0] - p[2];
+
+			float quality = 3.46410162f * std::sqrt(dot(n, n)) / (dot(e0, e0) + dot(e1, e1) + dot(e2, e2));
+
+			inverted += dot(n, p[0] + p[1] + p[2]) <= 0.f;
+			slivers  += quality < TEST_SIMPLIFY_MIN_QUALITY;
+		}
+
+		unit_test_log() << "mesh_simplifier: " << indices.size() / 3 << " -> " << result / 3 << " triangles (target " << target / 3 << "), " <<
+			inverted << " inverted, " << slivers << " slivers" << std::endl;
+
+		FUSE_TEST_CHECK(inverted == 0);
+		FUSE_TEST_CHECK(slivers == 0);
+		FUSE_TEST_CHECK(result <= target + target / 10);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include "unit_test.hpp"
+
+#include <fuse/occlusion_buffer.hpp>
+#include <fuse/core/thread_pool.hpp>
+#include <fuse/geometry/affine_transforms.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace fuse;
+
+#define TEST_OCCLUSION_WIDTH   160
+#define TEST_OCCLUSION_HEIGHT  90
+#define TEST_OCCLUSION_SCENES  4
+#define TEST_OCCLUSION_BOXES   2000
+#define TEST_OCCLUSION_SPHERES 8
+#define TEST_OCCLUSION_SPHERE  24
+
+// The buffer samples the coverage at the pixel centers in single precision: an edge
+// passing within this fraction of a pixel of a center, or a depth within this much
+// of the occluders, may go either way
+
+#define TEST_OCCLUSION_EDGE_TOLERANCE  (1. / 64.)
+#define TEST_OCCLUSION_DEPTH_TOLERANCE 1e-5
+
+#define TEST_OCCLUSION_FOVY   1.
+#define TEST_OCCLUSION_ASPECT (16. / 9.)
+#define TEST_OCCLUSION_ZNEAR  .1
+#define TEST_OCCLUSION_ZFAR   100.
+
+struct test_occlusion_point
+{
+	double x, y, z;
+};
+
+/* Reference */
+
+// The camera is at the origin looking down z, with the perspective of the renderer:
+// the screen position of a point in pixels (y down) and its depth z/w
+
+static test_occlusion_point test_occlusion_project(const test_occlusion_point & p, uint32_t width, uint32_t height)
+{
+	double h = 1. / std::tan(TEST_OCCLUSION_FOVY * .5);
+	double w = h / TEST_OCCLUSION_ASPECT;
+	double q = TEST_OCCLUSION_ZFAR / (TEST_OCCLUSION_ZFAR - TEST_OCCLUSION_ZNEAR);
+
+	test_occlusion_point screen;
+
+	screen.x = (w * p.x / p.z * .5 + .5) * width;
+	screen.y = (.5 - h * p.y / p.z * .5) * height;
+	screen.z = q - q * TEST_OCCLUSION_ZNEAR / p.z;
+
+	return screen;
+}
+
+// Keeps the nearest depth of the triangle (either facing) at the pixel centers closer
+// than tolerance pixels to it, a negative tolerance only keeps the ones inside by as much
+
+static void test_occlusion_rasterize(std::vector<double> & depth, uint32_t width, uint32_t height, const test_occlusion_point * v, double tolerance)
+{
+	double x[3] = { v[0].x, v[1].x, v[2].x };
+	double y[3] = { v[0].y, v[1].y, v[2].y };
+	double z[3] = { v[0].z, v[1].z, v[2].z };
+
+	double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+	if (std::abs(area) < 1e-12)
+	{
+		return;
+	}
+
+	if (area < 0.)
+	{
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(z[1], z[2]);
+		area = -area;
+	}
+
+	double a[3], b[3], c[3];
+
+	for (int k = 0; k < 3; k++)
+	{
+		int j = k == 2 ? 0 : k + 1;
+
+		double length = std::sqrt((y[k] - y[j]) * (y[k] - y[j]) + (x[j] - x[k]) * (x[j] - x[k]));
+
+		a[k] = (y[k] - y[j]) / length;
+		b[k] = (x[j] - x[k]) / length;
+		c[k] = -(a[k] * x[k] + b[k] * y[k]);
+	}
+
+	double zx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+	double zy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+	double z0 = z[0] - zx * x[0] - zy * y[0];
+
+	int minX = std::max(0, static_cast<int>(std::floor(std::min(x[0], std::min(x[1], x[2])) - tolerance)));
+	int minY = std::max(0, static_cast<int>(std::floor(std::min(y[0], std::min(y[1], y[2])) - tolerance)));
+	int maxX = std::min(static_cast<int>(width) - 1, static_cast<int>(std::ceil(std::max(x[0], std::max(x[1], x[2])) + tolerance)));
+	int maxY = std::min(static_cast<int>(height) - 1, static_cast<int>(std::ceil(std::max(y[0], std::max(y[1], y[2])) + tolerance)));
+
+	for (int py = minY; py <= maxY; py++)
+	{
+		for (int px = minX; px <= maxX; px++)
+		{
+			double cx = px + .5;
+			double cy = py + .5;
+
+			if (a[0] * cx + b[0] * cy + c[0] >= -tolerance &&
+				a[1] * cx + b[1] * cy + c[1] >= -tolerance &&
+				a[2] * cx + b[2] * cy + c[2] >= -tolerance)
+			{
+				double & d = depth[py * width + px];
+				d = std::min(d, zx * cx + zy * cy + z0);
+			}
+		}
+	}
+}
+
+/* Scene */
+
+// A unit sphere tessellated as a latitude/longitude grid, facing outwards
+
+static void test_occlusion_sphere(std::vector<float3> & vertices, std::vector<uint32_t> & indices, uint32_t n)
+{
+	const float pi = 3.14159265f;
+
+	for (uint32_t i = 0; i <= n; i++)
+	{
+		for (uint32_t j = 0; j <= n; j++)
+		{
+			float theta = pi * i / n;
+			float phi   = 2.f * pi * j / n;
+
+			vertices.emplace_back(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+		}
+	}
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		for (uint32_t j = 0; j < n; j++)
+		{
+			uint32_t a = i * (n + 1) + j;
+			uint32_t b = a + n + 1;
+
+			uint32_t quad[6] = { a, a + 1, b, a + 1, b + 1, b };
+
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+void test_occlusion_buffer(void)
+{
+	std::vector<float3>   vertices;
+	std::vector<uint32_t> indices;
+
+	test_occlusion_sphere(vertices, indices, TEST_OCCLUSION_SPHERE);
+
+	double h = 1. / std::tan(TEST_OCCLUSION_FOVY * .5);
+	double w = h / TEST_OCCLUSION_ASPECT;
+	double q = TEST_OCCLUSION_ZFAR / (TEST_OCCLUSION_ZFAR - TEST_OCCLUSION_ZNEAR);
+
+	mat128 viewProjection = mat128_load(float4x4(
+		static_cast<float>(w), 0, 0, 0,
+		0, static_cast<float>(h), 0, 0,
+		0, 0, static_cast<float>(q), 1,
+		0, 0, static_cast<float>(-q * TEST_OCCLUSION_ZNEAR), 0));
+
+	occlusion_buffer buffer;
+	occlusion_buffer parallelBuffer;
+	thread_pool      pool(3);
+
+	FUSE_TEST_CHECK(buffer.init(TEST_OCCLUSION_WIDTH, TEST_OCCLUSION_HEIGHT));
+	FUSE_TEST_CHECK(parallelBuffer.init(TEST_OCCLUSION_WIDTH, TEST_OCCLUSION_HEIGHT));
+
+	uint32_t width  = buffer.get_width();
+	uint32_t height = buffer.get_height();
+
+	size_t totalVisible = 0;
+	size_t totalCulled  = 0;
+	size_t falseNegatives = 0;
+
+	for (unsigned int scene = 0; scene < TEST_OCCLUSION_SCENES; scene++)
+	{
+		std::mt19937 generator(scene + 1);
+
+		std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+		// Spheres in the middle of the view, the boxes are around and behind them
+
+		std::vector<float4> spheres;
+		std::vector<mat128, aligned_allocator<mat128, 16>> worlds;
+
+		for (int i = 0; i < TEST_OCCLUSION_SPHERES; i++)
+		{
+			float4 s(16.f * uniform(generator) - 8.f, 8.f * uniform(generator) - 4.f, 15.f + 15.f * uniform(generator), 1.5f + 2.5f * uniform(generator));
+
+			spheres.push_back(s);
+			worlds.push_back(to_scale4(vec128_set(s.w, s.w, s.w, 1.f)) * to_translation4(vec128_set(s.x, s.y, s.z, 1.f)));
+		}
+
+		buffer.clear(viewProjection);
+		parallelBuffer.clear(viewProjection);
+
+		for (const mat128 & world : worlds)
+		{
+			buffer.add_occluder(vertices.data(), vertices.size(), indices.data(), indices.size(), world);
+			parallelBuffer.add_occluder(vertices.data(), vertices.size(), indices.data(), indices.size(), world);
+		}
+
+		buffer.render();
+		parallelBuffer.render(&pool);
+
+		// The tiles and chunks never change the result
+
+		FUSE_TEST_CHECK(std::equal(buffer.get_depth(), buffer.get_depth() + width * height, parallelBuffer.get_depth()));
+
+		// Nearest occluder at each pixel center, the coverage is extended by the tolerance
+
+		std::vector<double> occluderDepth(width * height, 1.);
+
+		for (const float4 & s : spheres)
+		{
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				test_occlusion_point triangle[3];
+
+				for (int k = 0; k < 3; k++)
+				{
+					const float3 & v = vertices[indices[i + k]];
+
+					test_occlusion_point p = { v.x * s.w + s.x, v.y * s.w + s.y, v.z * s.w + s.z };
+					triangle[k] = test_occlusion_project(p, width, height);
+				}
+
+				test_occlusion_rasterize(occluderDepth, width, height, triangle, TEST_OCCLUSION_EDGE_TOLERANCE);
+			}
+		}
+
+		for (int i = 0; i < TEST_OCCLUSION_BOXES; i++)
+		{
+			float3 center(28.f * uniform(generator) - 14.f, 14.f * uniform(generator) - 7.f, 10.f + 50.f * uniform(generator));
+			float3 halfExtents(.2f + 1.3f * uniform(generator), .2f + 1.3f * uniform(generator), .2f + 1.3f * uniform(generator));
+
+			bool visible = buffer.test(aabb::from_center_half_extents(center, halfExtents));
+
+			// The box is visible when one of its faces is in front of the occluders at a pixel center
+
+			std::vector<double> boxDepth(width * height, std::numeric_limits<double>::infinity());
+
+			test_occlusion_point corners[8];
+
+			for (int k = 0; k < 8; k++)
+			{
+				test_occlusion_point p = {
+					center.x + (k & 1 ? halfExtents.x : -halfExtents.x),
+					center.y + (k & 2 ? halfExtents.y : -halfExtents.y),
+					center.z + (k & 4 ? halfExtents.z : -halfExtents.z) };
+
+				corners[k] = test_occlusion_project(p, width, height);
+			}
+
+			const int faces[6][4] = { { 0, 1, 3, 2 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 }, { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 3, 7, 5 } };
+
+			for (const int * face : faces)
+			{
+				test_occlusion_point triangles[2][3] = {
+					{ corners[face[0]], corners[face[1]], corners[face[2]] },
+					{ corners[face[0]], corners[face[2]], corners[face[3]] } };
+
+				test_occlusion_rasterize(boxDepth, width, height, triangles[0], -TEST_OCCLUSION_EDGE_TOLERANCE);
+				test_occlusion_rasterize(boxDepth, width, height, triangles[1], -TEST_OCCLUSION_EDGE_TOLERANCE);
+			}
+
+			bool reference = false;
+
+			for (size_t p = 0; p < boxDepth.size() && !reference; p++)
+			{
+				reference = boxDepth[p] < occluderDepth[p] - TEST_OCCLUSION_DEPTH_TOLERANCE;
+			}
+
+			falseNegatives += reference && !visible;
+
+			totalVisible += reference;
+			totalCulled  += !visible;
+		}
+	}
+
+	unit_test_log() << "occlusion_buffer: " << totalVisible << " boxes visible, " << totalCulled << " culled, "
+	                << falseNegatives << " false negatives" << std::endl;
+
+	FUSE_TEST_CHECK(falseNegatives == 0);
+
+	// The scenes hide some of the boxes, the test would pass with a buffer culling nothing otherwise
+
+	FUSE_TEST_CHECK(totalCulled > 0);
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "unit_test.hpp"
+
+#include <fuse/core.hpp>
+#include <fuse/math.hpp>
+#include <fuse/geometry.hpp>
+#include <fuse/geometry/affine_transforms.hpp>
+#include <fuse/transform_system_node.hpp>
+#include <fuse/transform_hierarchy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace fuse;
+
+#define TEST_TRANSFORM_NODES     5000
+#define TEST_TRANSFORM_ROUNDS    6
+#define TEST_TRANSFORM_REPARENTS 200
+
+// The flat transforms replace transform_hierarchy in scene_graph_node when FUSE_FLAT_TRANSFORMS
+// is set, both nodes below do what scene_graph_node::update_node does with them
+
+class alignas(16) test_lazy_node :
+	public transform_hierarchy<test_lazy_node>
+{
+
+public:
+
+	FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+
+	using children_iterator = std::vector<test_lazy_node*>::iterator;
+
+	test_lazy_node(test_lazy_node * parent) :
+		m_parent(parent)
+	{
+		if (parent)
+		{
+			parent->m_children.push_back(this);
+		}
+	}
+
+	bool update_node(mat128 & oldTransform, mat128 & newTransform)
+	{
+		if (was_moved())
+		{
+			oldTransform = get_previous_global_matrix();
+			newTransform = get_global_matrix();
+			set_moved(false);
+			return true;
+		}
+
+		return false;
+	}
+
+	void reparent(test_lazy_node * parent)
+	{
+		if (m_parent)
+		{
+			m_parent->m_children.erase(std::find(m_parent->m_children.begin(), m_parent->m_children.end(), this));
+		}
+
+		switch_parent(parent);
+
+		if (parent)
+		{
+			parent->m_children.push_back(this);
+		}
+	}
+
+	test_lazy_node *             m_parent;
+	std::vector<test_lazy_node*> m_children;
+
+};
+
+FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(test_lazy_node, 16)
+
+namespace fuse
+{
+
+	template <>
+	inline test_lazy_node * get_transform_hierarchy_parent(transform_hierarchy<test_lazy_node> * node)
+	{
+		return static_cast<test_lazy_node*>(node)->m_parent;
+	}
+
+	template <>
+	inline void set_transform_hierarchy_parent(transform_hierarchy<test_lazy_node> * node, transform_hierarchy<test_lazy_node> * parent)
+	{
+		static_cast<test_lazy_node*>(node)->m_parent = static_cast<test_lazy_node*>(parent);
+	}
+
+	template <>
+	inline test_lazy_node::children_iterator get_transform_hierarchy_children_begin(transform_hierarchy<test_lazy_node> * node)
+	{
+		return static_cast<test_lazy_node*>(node)->m_children.begin();
+	}
+
+	template <>
+	inline test_lazy_node::children_iterator get_transform_hierarchy_children_end(transform_hierarchy<test_lazy_node> * node)
+	{
+		return static_cast<test_lazy_node*>(node)->m_children.end();
+	}
+
+}
+
+class alignas(16) test_flat_node :
+	public transform_system_node
+{
+
+public:
+
+	FUSE_DECLARE_ALIGNED_ALLOCATOR_NEW(16)
+
+	test_flat_node(test_flat_node * parent) :
+		transform_system_node(parent) {}
+
+	using transform_system_node::switch_parent;
+
+	bool update_node(mat128 & oldTransform, mat128 & newTransform)
+	{
+		if (was_moved())
+		{
+			oldTransform = get_previous_global_matrix();
+			newTransform = get_global_matrix();
+			set_moved(false);
+			return true;
+		}
+
+		return false;
+	}
+
+};
+
+FUSE_DEFINE_ALIGNED_ALLOCATOR_NEW(test_flat_node, 16)
+
+static bool test_transform_equal(const mat128 & a, const mat128 & b)
+{
+	return std::memcmp(&a, &b, sizeof(mat128)) == 0;
+}
+
+static float test_transform_difference(const mat128 & a, const mat128 & b)
+{
+	float difference = 0.f;
+
+	for (int c = 0; c < 4; c++)
+	{
+		float4 x = to_float4(a.c[c]);
+		float4 y = to_float4(b.c[c]);
+
+		for (int k = 0; k < 4; k++)
+		{
+			difference = std::max(difference, std::abs(x.m[k] - y.m[k]) / std::max(1.f, std::abs(y.m[k])));
+		}
+	}
+
+	return difference;
+}
+
+void test_transform_system(void)
+{
+	std::mt19937 generator(1);
+
+	std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+	// Parents are created before their children, in both hierarchies in the same order
+
+	std::vector<std::unique_ptr<test_lazy_node>> lazy;
+	std::vector<std::unique_ptr<test_flat_node>> flat;
+
+	std::vector<size_t> parents(TEST_TRANSFORM_NODES, 0);
+
+	for (size_t i = 0; i < TEST_TRANSFORM_NODES; i++)
+	{
+		if (i > 0)
+		{
+			parents[i] = uniform(generator) < .5f ? i - 1 : std::uniform_int_distribution<size_t>(0, i - 1)(generator);
+		}
+
+		lazy.emplace_back(new test_lazy_node(i ? lazy[parents[i]].get() : nullptr));
+		flat.emplace_back(new test_flat_node(i ? flat[parents[i]].get() : nullptr));
+	}
+
+	size_t wrongMoves     = 0;
+	size_t wrongMatrices  = 0;
+	float  maxSRTError    = 0.f;
+
+	for (int round = 0; round < TEST_TRANSFORM_ROUNDS; round++)
+	{
+		float probability = round == 0 ? 1.f : round % 2 ? .02f : .2f;
+
+		for (size_t i = 0; i < TEST_TRANSFORM_NODES; i++)
+		{
+			if (uniform(generator) < probability)
+			{
+				float3 axis  = float3(uniform(generator) - .5f, uniform(generator) - .5f, uniform(generator) - .5f);
+				float  angle = 6.f * uniform(generator);
+
+				axis = axis * (std::sin(.5f * angle) / std::sqrt(dot(axis, axis)));
+
+				vec128 t = vec128_set(4.f * uniform(generator) - 2.f, 4.f * uniform(generator) - 2.f, 4.f * uniform(generator) - 2.f, 0.f);
+				vec128 r = vec128_set(axis.x, axis.y, axis.z, std::cos(.5f * angle));
+				float  k = .8f + .4f * uniform(generator);
+				vec128 s = vec128_set(k, k, k, 0.f);
+
+				lazy[i]->set_local_translation(t);
+				lazy[i]->set_local_rotation(r);
+				lazy[i]->set_local_scale(s);
+
+				flat[i]->set_local_translation(t);
+				flat[i]->set_local_rotation(r);
+				flat[i]->set_local_scale(s);
+			}
+		}
+
+		// The same nodes are reported moved, with the same matrices
+
+		for (size_t i = 0; i < TEST_TRANSFORM_NODES; i++)
+		{
+			mat128 lazyOld, lazyNew, flatOld, flatNew;
+
+			bool lazyMoved = lazy[i]->update_node(lazyOld, lazyNew);
+			bool flatMoved = flat[i]->update_node(flatOld, flatNew);
+
+			wrongMoves += lazyMoved != flatMoved ||
+				(lazyMoved && !(test_transform_equal(lazyOld, flatOld) && test_transform_equal(lazyNew, flatNew)));
+
+			wrongMatrices += !test_transform_equal(lazy[i]->get_global_matrix(), flat[i]->get_global_matrix());
+		}
+
+		// The global rotation as the cameras read it, decomposed from different matrices
+		// by the two (transform_hierarchy leaves the scale out of its chain)
+
+		for (size_t i = 0; i < TEST_TRANSFORM_NODES; i += 17)
+		{
+			mat128 lazyR = to_rotation4(lazy[i]->get_global_rotation());
+			mat128 flatR = to_rotation4(flat[i]->get_global_rotation());
+
+			maxSRTError = std::max(maxSRTError, test_transform_difference(flatR, lazyR));
+		}
+	}
+
+	unit_test_log() << "transform_system: " << wrongMoves << " moves and " << wrongMatrices << " matrices differ, SRT error " << maxSRTError << std::endl;
+
+	FUSE_TEST_CHECK(wrongMoves == 0);
+	FUSE_TEST_CHECK(wrongMatrices == 0);
+	FUSE_TEST_CHECK(maxSRTError < 1e-2f);
+
+	// Reparenting keeps the global matrix of the node, up to the precision of decompose_affine
+	// (to_quaternion goes through the approximated square_root and copysign, which loses a few
+	// percent when a component is close to zero). A parent is always created before its children
+	// so the new one is never a descendant. The subtrees accumulate the error, transform_hierarchy
+	// has to do worse
+
+	float maxNodeError = 0.f;
+
+	std::vector<mat128, aligned_allocator<mat128, 16>> before;
+
+	for (size_t i = 0; i < TEST_TRANSFORM_NODES; i++)
+	{
+		before.push_back(flat[i]->get_global_matrix());
+	}
+
+	for (int k = 0; k < TEST_TRANSFORM_REPARENTS; k++)
+	{
+		size_t node   = std::uniform_int_distribution<size_t>(1, TEST_TRANSFORM_NODES - 1)(generator);
+		size_t parent = std::uniform_int_distribution<size_t>(0, node - 1)(generator);
+
+		mat128 global = flat[node]->get_global_matrix();
+
+		lazy[node]->reparent(k % 10 ? lazy[parent].get() : nullptr);
+		flat[node]->switch_parent(k % 10 ? flat[parent].get() : nullptr);
+
+		maxNodeError = std::max(maxNodeError, test_transform_difference(flat[node]->get_global_matrix(), global));
+	}
+
+	float maxLazyError = 0.f;
+	float maxFlatError = 0.f;
+
+	for (size_t i = 0; i < TEST_TRANSFORM_NODES; i++)
+	{
+		maxLazyError = std::max(maxLazyError, test_transform_difference(lazy[i]->get_global_matrix(), before[i]));
+		maxFlatError = std::max(maxFlatError, test_transform_difference(flat[i]->get_global_matrix(), before[i]));
+	}
+
+	unit_test_log() << "transform_system: " << maxNodeError << " relative error on the reparented nodes, " <<
+		maxFlatError << " on the hierarchy (" << maxLazyError << " for transform_hierarchy)" << std::endl;
+
+	FUSE_TEST_CHECK(maxNodeError < 5e-2f);
+	FUSE_TEST_CHECK(maxFlatError <= maxLazyError);
+
+	// Children first, as the scene graph destroys them
+
+	while (!flat.empty())
+	{
+		flat.pop_back();
+	}
+}
\ No newline at end of file
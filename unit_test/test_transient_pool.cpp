@@ -0,0 +1,152 @@
+#include "unit_test.hpp"
+
+#include <fuse/core.hpp>
+#include <fuse/core/transient_pool.hpp>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace fuse;
+
+#define TEST_TRANSIENT_THREADS         4
+#define TEST_TRANSIENT_PAGE_SIZE       4
+#define TEST_TRANSIENT_PAGES_PER_FRAME 256
+#define TEST_TRANSIENT_FRAMES          2
+
+typedef std::vector<std::pair<pool_size_t, pool_size_t>> test_transient_ranges;
+
+// Each allocator allocates on its own thread, as the thread_local ones of the
+// renderer do, and keeps its pages from one round to the next
+
+static test_transient_ranges test_transient_round(std::vector<transient_allocator> & allocators, unsigned int seed, size_t allocations)
+{
+	std::vector<test_transient_ranges> threadRanges(allocators.size());
+	std::vector<std::thread>           threads;
+
+	for (size_t t = 0; t < allocators.size(); t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			std::mt19937 gen(seed + static_cast<unsigned int>(t));
+			std::uniform_int_distribution<pool_size_t> sizes(1, 3);
+
+			for (size_t i = 0; i < allocations; i++)
+			{
+				pool_size_t elements = sizes(gen);
+				pool_size_t offset   = allocators[t].allocate(elements);
+
+				if (offset != FUSE_POOL_INVALID)
+				{
+					threadRanges[t].emplace_back(offset, elements);
+				}
+			}
+		});
+	}
+
+	for (std::thread & thread : threads)
+	{
+		thread.join();
+	}
+
+	test_transient_ranges ranges;
+
+	for (const test_transient_ranges & r : threadRanges)
+	{
+		ranges.insert(ranges.end(), r.begin(), r.end());
+	}
+
+	return ranges;
+}
+
+// The ranges of the epoch do not overlap and stay in the segment of the frame
+
+static void test_transient_check(const transient_pool & pool, test_transient_ranges ranges)
+{
+	pool_size_t segmentSize  = pool.get_pages_per_frame() * pool.get_page_size();
+	pool_size_t segmentFirst = static_cast<pool_size_t>(pool.get_frame_index() % pool.get_num_frames()) * segmentSize;
+
+	std::sort(ranges.begin(), ranges.end());
+
+	for (size_t i = 0; i < ranges.size(); i++)
+	{
+		FUSE_TEST_CHECK(ranges[i].first >= segmentFirst && ranges[i].first + ranges[i].second <= segmentFirst + segmentSize);
+
+		if (i > 0)
+		{
+			FUSE_TEST_CHECK(ranges[i - 1].first + ranges[i - 1].second <= ranges[i].first);
+		}
+	}
+}
+
+void test_transient_pool(void)
+{
+	ostringstream_t log;
+	logger          testLogger(&log);
+
+	transient_pool pool;
+
+	FUSE_TEST_CHECK(pool.init(0, TEST_TRANSIENT_PAGE_SIZE, TEST_TRANSIENT_PAGES_PER_FRAME, TEST_TRANSIENT_FRAMES));
+
+	std::vector<transient_allocator> allocators(TEST_TRANSIENT_THREADS, transient_allocator(&pool));
+
+	// init starts frame 0, the main loop starts it again before the first frame, then
+	// the frames go on, come back to the same index and restart the same frame twice
+
+	const uint64_t frames[] = { 0, 0, 1, 2, 2, 3, 0, 0 };
+
+	unsigned int seed = 1;
+
+	for (size_t f = 0; f < sizeof(frames) / sizeof(frames[0]); f++)
+	{
+		if (f > 0)
+		{
+			uint64_t epoch = pool.get_epoch();
+			pool.begin_frame(frames[f]);
+			FUSE_TEST_CHECK(pool.get_epoch() != epoch);
+		}
+
+		// Two rounds in the frame: the pages kept by the allocators are reused within it
+
+		test_transient_ranges ranges = test_transient_round(allocators, seed++, 40);
+		test_transient_ranges second = test_transient_round(allocators, seed++, 40);
+
+		ranges.insert(ranges.end(), second.begin(), second.end());
+
+		test_transient_check(pool, ranges);
+	}
+
+	// Running out of pages fails without touching the pool, and is logged once per frame
+
+	pool.begin_frame(4);
+
+	transient_allocator & allocator = allocators.front();
+
+	size_t failures = 0;
+
+	for (int i = 0; i < 1000; i++)
+	{
+		failures += allocator.allocate(TEST_TRANSIENT_PAGE_SIZE) == FUSE_POOL_INVALID;
+	}
+
+	FUSE_TEST_CHECK(failures == 1000 - TEST_TRANSIENT_PAGES_PER_FRAME);
+	FUSE_TEST_CHECK(pool.get_used_pages() == TEST_TRANSIENT_PAGES_PER_FRAME);
+	FUSE_TEST_CHECK(pool.allocate_pages(0) == FUSE_POOL_INVALID);
+
+	pool.begin_frame(5);
+
+	FUSE_TEST_CHECK(allocator.allocate(TEST_TRANSIENT_PAGE_SIZE) != FUSE_POOL_INVALID);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		allocator.allocate(TEST_TRANSIENT_PAGE_SIZE);
+	}
+
+	string_t logged = log.str();
+
+	size_t lines = std::count(logged.begin(), logged.end(), FUSE_LITERAL('\n'));
+
+	FUSE_TEST_CHECK(lines == 2);
+}
\ No newline at end of file
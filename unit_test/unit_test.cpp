@@ -0,0 +1,80 @@
+#include "unit_test.hpp"
+
+#include <cstring>
+#include <string>
+
+struct unit_test
+{
+	const char * name;
+	void      (* function)(void);
+};
+
+static size_t g_failures;
+
+static const unit_test g_tests[] = {
+	{ "decompose_affine", test_decompose_affine },
+	{ "mesh_simplifier", test_mesh_simplifier },
+	{ "occlusion_buffer", test_occlusion_buffer },
+#ifdef FUSE_UNIT_TEST_GRAPHICS
+	{ "scene_graph", test_scene_graph },
+#endif
+	{ "transform_system", test_transform_system },
+	{ "transient_pool", test_transient_pool }
+};
+
+bool unit_test_check(bool condition, const char * expression, const char * file, int line)
+{
+	if (!condition)
+	{
+		g_failures++;
+		std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+	}
+
+	return condition;
+}
+
+size_t unit_test_get_failures(void)
+{
+	return g_failures;
+}
+
+std::ostream & unit_test_log(void)
+{
+	return std::cout;
+}
+
+int main(int argc, char * argv[])
+{
+	// unit_test [test ...], runs all the tests when none is given
+
+	bool found = argc == 1;
+
+	for (const unit_test & test : g_tests)
+	{
+		bool selected = argc == 1;
+
+		for (int i = 1; i < argc; i++)
+		{
+			selected = selected || std::strcmp(argv[i], test.name) == 0;
+		}
+
+		if (selected)
+		{
+			size_t failures = g_failures;
+
+			test.function();
+
+			std::cout << test.name << ": " << (g_failures == failures ? "passed" : "failed") << std::endl;
+
+			found = true;
+		}
+	}
+
+	if (!found)
+	{
+		std::cerr << "Usage: " << argv[0] << " [test ...], unknown test" << std::endl;
+		return 1;
+	}
+
+	return g_failures ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+
+/* Checks */
+
+// Counts the failure and prints the expression, the test goes on
+
+#define FUSE_TEST_CHECK(Condition) unit_test_check(static_cast<bool>(Condition), #Condition, __FILE__, __LINE__)
+
+bool unit_test_check(bool condition, const char * expression, const char * file, int line);
+
+size_t unit_test_get_failures(void);
+
+std::ostream & unit_test_log(void);
+
+/* Tests */
+
+// Random scale, rotation and translation composed then decomposed by the mat128
+// overload, which gives them back and agrees with the float4x4 overload
+
+void test_decompose_affine(void);
+
+// A sphere simplified to a quarter and a sixteenth of its triangles, with no
+// triangle turned inside out and no sliver
+
+void test_mesh_simplifier(void);
+
+// Boxes tested against random spheres compared to a double precision rasterization
+// of the same triangles, a box the reference sees is never culled
+// (see occlusion_buffer.hpp for the tolerance)
+
+void test_occlusion_buffer(void);
+
+// The flat transform_system against transform_hierarchy on random hierarchies,
+// with the same moves and global matrices bit for bit, and reparenting that keeps
+// the global matrices
+
+void test_transform_system(void);
+
+// Pages handed out by the transient_allocator of several threads over repeated
+// and equal frame indices, no element is given to two allocations of an epoch
+
+void test_transient_pool(void);
+
+#ifdef FUSE_UNIT_TEST_GRAPHICS
+
+// Random hierarchies updated on a thread pool and serially, with the same global
+// matrices and the same move notifications for each listener, bit for bit
+
+void test_scene_graph(void);
+
+#endif
\ No newline at end of file